@@ -153,8 +153,7 @@ begin
 	inst_rom : rom
 	generic	map (
 					rom_cells					=> MAP_SIZE_ROM,
-					reset_value					=> ROM_FILL,
-					filename					=> ROM_FILE
+					reset_value					=> ROM_FILL
 				)
 	port map	(
 					-- General
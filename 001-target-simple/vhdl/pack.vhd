@@ -68,7 +68,6 @@ package PACK is
 	----------------------------------------------------------------------------
 	-- Constants
 
-	constant ROM_FILE		: string			:= "b65.rom";								-- rom filename
 	constant ROM_FILL		: std_logic_vector	:= x"FF";									-- rom fill value
 
 	constant MAP_START_RAM	: integer			:= conv_integer(x"0000");					-- start address     0 : RAM
@@ -120,8 +119,7 @@ package PACK is
 	component rom is
 	generic	(
 				rom_cells				:			integer				:= 1024;			-- number of memory cells
-				reset_value				:			std_logic_vector	:= x"FF";			-- ROM reset value
-				filename				:			string				:= ""				-- ROM initialization binary file
+				reset_value				:			std_logic_vector	:= x"FF"			-- ROM reset value
 			);
 	port	(
 				-- General
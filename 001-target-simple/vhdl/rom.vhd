@@ -16,7 +16,8 @@
 --     along with B65.  If not, see <http://www.gnu.org/licenses/>.
 
 ----------------------------------------------------------------------------------
--- Binary file initialized read only memory
+-- Software image initialized read only memory (ROM_INIT from the b65_rom package, generated
+-- by rom2coe with the software build: no file is read at the simulation start)
 
 -------------------------------------------------------------------------------
 -- Libraries
@@ -25,11 +26,9 @@ library ieee;
 use ieee.std_logic_1164.all;
 use ieee.std_logic_unsigned.all;
 use ieee.numeric_std.all;
-use std.textio.all;
-use ieee.std_logic_textio.all;
 
 library b65;
-use b65.PACK.Log;
+use b65.b65_rom.all;
 
 -------------------------------------------------------------------------------
 -- Entity
@@ -37,8 +36,7 @@ use b65.PACK.Log;
 entity rom is
 	generic	(
 				rom_cells				:			integer				:= 1024;			-- number of memory cells
-				reset_value				:			std_logic_vector	:= x"FF";			-- ROM reset value
-				filename				:			string				:= ""				-- ROM initialization binary file
+				reset_value				:			std_logic_vector	:= x"FF"			-- ROM reset value
 			);
 	port	(
 				-- General
@@ -62,15 +60,26 @@ architecture behavioral of rom is
 	-- Memory data
 	type ROM_MEMORY is array(0 to rom_cells-1) of std_logic_vector(7 downto 0);
 
+	----------------------------------------------------------------------------
+	-- Functions
+
+	-- Memory content: the software image, then the fill value
+	function rom_content return ROM_MEMORY is
+		variable content		: ROM_MEMORY	:= (others => reset_value);
+	begin
+		for mem_address in ROM_INIT'range loop
+			if (mem_address < rom_cells) then
+				content(mem_address)	:= ROM_INIT(mem_address);
+			end if;
+		end loop;
+		return content;
+	end;
+
 	----------------------------------------------------------------------------
 	-- Signals
 
 	-- Memory
-	signal memory		: ROM_MEMORY;
-	signal initialized	: std_logic		:= '0';
-
-	-- File types
-	type CHAR_FILE is file of character;
+	signal memory		: ROM_MEMORY	:= rom_content;
 
 begin
 
@@ -89,37 +98,6 @@ begin
 		end if; -- clock event
 	end process;
 
-	-- Rom initialization from binary file
-	rom_initialize : process(clock)
-		file		var_file_handle		: CHAR_FILE;
-		variable	var_char			: character;
-		variable	var_address			: integer;
-	begin
-		if (clock'event and clock='1') then
-			if (reset = '1') and (initialized = '0') then
-
-				-- Reset ROM
-				for mem_address in 0 to rom_cells-1 loop
-					memory(mem_address)	<= reset_value;
-				end loop;
-
-				-- Initialize ROM from binary file
-				file_open(var_file_handle, filename);
-				var_address				:= 0;
-				while (var_address < rom_cells) and (not endfile(var_file_handle)) loop
-					read(var_file_handle, var_char);
-					memory(var_address)	<= std_logic_vector(to_unsigned(character'pos(var_char), 8));
-					var_address			:= var_address + 1;
-				end loop;
-				file_close(var_file_handle);
-
-				initialized				<= '1';
-				Log("INFO : rom initialized with [" & filename & "]");				
-
-			end if; -- reset
-		end if; -- clock event
-	end process;
-
 end behavioral;
 
 -------------------------------------------------------------------------------
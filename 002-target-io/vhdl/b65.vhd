@@ -35,6 +35,9 @@ use b65.PACK.all;
 -- Entity
 
 entity board is
+generic	(
+			fast_sim				:			boolean				:= false				-- Simulation profile: no PWM and display multiplexing (digits in int_top.ext_digit)
+		);
 end board;
 
 -------------------------------------------------------------------------------
@@ -75,6 +78,9 @@ architecture behavioral of board is
 	-- Components
 
 	component top is
+	generic	(
+			fast_sim				:			boolean				:= false				-- No PWM and display multiplexing
+		);
 	port(
 			-- General
 			clock					: in		std_logic;								-- Clock
@@ -100,6 +106,9 @@ begin
 	-- Components map
 
 	int_top : top
+	generic map	(
+					fast_sim					=> fast_sim
+				)
 	port map	(
 					-- General
 					clock					=> clock,
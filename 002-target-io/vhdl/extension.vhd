@@ -24,8 +24,9 @@
 --			bit[7] = unused
 --			bit[6] = unused
 --			bit[5] = unused
---			bit[4] = UART rx interrupt      (0=disable         , 1=enable)
---			bit[3] = input change interrupt (0=disable         , 1=enable)
+--			bit[4] = UART rx triggered      (status: set at every UART interrupt trigger, write 0 to clear)
+--			bit[3] = input changed          (status: set at every input change trigger  , write 0 to clear)
+--			         (both interrupts are always generated, there is no enable)
 --			bit[2] = output invert          (0=don't invert    , 1=invert)
 --			bit[1] = digits invert          (0=don't invert    , 1=invert)
 --			bit[0] = digits direct drive    (0=use CHARMAP     , 1=direct drive '.gfedcba')
@@ -74,6 +75,9 @@ use b65.PACK.all;
 -- Entity
 
 entity ext is
+	generic	(
+				fast_sim				:			boolean				:= false			-- Simulation profile: outputs and digits without PWM (see below)
+			);
 	port	(
 				-- General
 				clock					: in		std_logic;								-- Clock
@@ -469,104 +473,126 @@ begin
 		end if; -- clock event
 	end process;
 
-	-- pwm counter
-	pwm_generator : process(clock) begin
-		if (clock'event and clock='1') then
-			-- If (system is in reset state)
-			if (reset = '1') then
-				pwm_counter				<= x"00";
-			else
-				-- Increment PWM counter
-				pwm_counter				<= pwm_counter + x"01";
-			end if; -- reset
-		end if; -- clock event
-	end process;
+	-- PWM outputs and digits (33% and 66% modes)
+	gen_pwm : if (not fast_sim) generate
 
-	-- generate the digit pwm output
-	set_pwm_digit : process(clock)
+		-- pwm counter
+		pwm_generator : process(clock) begin
+			if (clock'event and clock='1') then
+				-- If (system is in reset state)
+				if (reset = '1') then
+					pwm_counter				<= x"00";
+				else
+					-- Increment PWM counter
+					pwm_counter				<= pwm_counter + x"01";
+				end if; -- reset
+			end if; -- clock event
+		end process;
+
+		-- generate the digit pwm output
+		set_pwm_digit : process(clock)
 	
-		-- Set a digit
-		procedure PROC_SET_OUT(constant id : in integer; signal val : in std_logic_vector(1 downto 0)) is begin
-
-			digit(id)			<= (others => '0');
+			-- Set a digit
+			procedure PROC_SET_OUT(constant id : in integer; signal val : in std_logic_vector(1 downto 0)) is begin
 
-			if (val = "00") then
-				digit(id)		<= (others => '0');
-			elsif (val = "01") then
-				if (pwm_counter > x"AA") then
-					digit(id)	<= digit_val(id);
-				end if;
-			elsif (val = "10") then
-				if (pwm_counter > x"55") then
-					digit(id)	<= digit_val(id);
-				end if;
-			else
-				digit(id)		<= digit_val(id);
-			end if;		
-		end procedure;
-	begin
-		if (clock'event and clock='1') then
-			-- If (system is in reset state)
-			if (reset = '1') then
-				digit			<= (others => (others => '0'));
-			else
-				PROC_SET_OUT(0, reg(5)(1 downto 0));
-				PROC_SET_OUT(1, reg(5)(3 downto 2));
-				PROC_SET_OUT(2, reg(5)(5 downto 4));
-				PROC_SET_OUT(3, reg(5)(7 downto 6));
-			end if; -- reset
-		end if; -- clock event
-	end process;
+				digit(id)			<= (others => '0');
 
-	-- generate all the outputs
-	set_outputs : process(clock)
+				if (val = "00") then
+					digit(id)		<= (others => '0');
+				elsif (val = "01") then
+					if (pwm_counter > x"AA") then
+						digit(id)	<= digit_val(id);
+					end if;
+				elsif (val = "10") then
+					if (pwm_counter > x"55") then
+						digit(id)	<= digit_val(id);
+					end if;
+				else
+					digit(id)		<= digit_val(id);
+				end if;		
+			end procedure;
+		begin
+			if (clock'event and clock='1') then
+				-- If (system is in reset state)
+				if (reset = '1') then
+					digit			<= (others => (others => '0'));
+				else
+					PROC_SET_OUT(0, reg(5)(1 downto 0));
+					PROC_SET_OUT(1, reg(5)(3 downto 2));
+					PROC_SET_OUT(2, reg(5)(5 downto 4));
+					PROC_SET_OUT(3, reg(5)(7 downto 6));
+				end if; -- reset
+			end if; -- clock event
+		end process;
+
+		-- generate all the outputs
+		set_outputs : process(clock)
 		
-		-- Set the output bit 'oid'
-		procedure PROC_SET_OUT(constant oid : in integer; signal val : in std_logic_vector(1 downto 0)) is begin
-			outputs(oid)			<= reg(0)(2);
-			if (val = "00") then
-				outputs(oid)		<= reg(0)(2);
-			elsif (val = "01") then
-				if (pwm_counter > x"AA") then
-					outputs(oid)	<= not reg(0)(2);
-				end if;
-			elsif (val = "10") then
-				if (pwm_counter > x"55") then
-					outputs(oid)	<= not reg(0)(2);
+			-- Set the output bit 'oid'
+			procedure PROC_SET_OUT(constant oid : in integer; signal val : in std_logic_vector(1 downto 0)) is begin
+				outputs(oid)			<= reg(0)(2);
+				if (val = "00") then
+					outputs(oid)		<= reg(0)(2);
+				elsif (val = "01") then
+					if (pwm_counter > x"AA") then
+						outputs(oid)	<= not reg(0)(2);
+					end if;
+				elsif (val = "10") then
+					if (pwm_counter > x"55") then
+						outputs(oid)	<= not reg(0)(2);
+					end if;
+				else
+					outputs(oid)		<= not reg(0)(2);
 				end if;
-			else
-				outputs(oid)		<= not reg(0)(2);
-			end if;
-		end PROC_SET_OUT;
+			end PROC_SET_OUT;
 
-	begin
-		if (clock'event and clock='1') then
-			-- If (system is in reset state)
-			if (reset = '1') then
-				outputs <= (others => '0');
-			else
-				PROC_SET_OUT( 0, reg(1)(1 downto 0));
-				PROC_SET_OUT( 1, reg(1)(3 downto 2));
-				PROC_SET_OUT( 2, reg(1)(5 downto 4));
-				PROC_SET_OUT( 3, reg(1)(7 downto 6));
+		begin
+			if (clock'event and clock='1') then
+				-- If (system is in reset state)
+				if (reset = '1') then
+					outputs <= (others => '0');
+				else
+					PROC_SET_OUT( 0, reg(1)(1 downto 0));
+					PROC_SET_OUT( 1, reg(1)(3 downto 2));
+					PROC_SET_OUT( 2, reg(1)(5 downto 4));
+					PROC_SET_OUT( 3, reg(1)(7 downto 6));
 				
-				PROC_SET_OUT( 4, reg(2)(1 downto 0));
-				PROC_SET_OUT( 5, reg(2)(3 downto 2));
-				PROC_SET_OUT( 6, reg(2)(5 downto 4));
-				PROC_SET_OUT( 7, reg(2)(7 downto 6));
-
-				PROC_SET_OUT( 8, reg(3)(1 downto 0));
-				PROC_SET_OUT( 9, reg(3)(3 downto 2));
-				PROC_SET_OUT(10, reg(3)(5 downto 4));
-				PROC_SET_OUT(11, reg(3)(7 downto 6));
-
-				PROC_SET_OUT(12, reg(4)(1 downto 0));
-				PROC_SET_OUT(13, reg(4)(3 downto 2));
-				PROC_SET_OUT(14, reg(4)(5 downto 4));
-				PROC_SET_OUT(15, reg(4)(7 downto 6));
-			end if; -- reset
-		end if; -- clock event
-	end process;
+					PROC_SET_OUT( 4, reg(2)(1 downto 0));
+					PROC_SET_OUT( 5, reg(2)(3 downto 2));
+					PROC_SET_OUT( 6, reg(2)(5 downto 4));
+					PROC_SET_OUT( 7, reg(2)(7 downto 6));
+
+					PROC_SET_OUT( 8, reg(3)(1 downto 0));
+					PROC_SET_OUT( 9, reg(3)(3 downto 2));
+					PROC_SET_OUT(10, reg(3)(5 downto 4));
+					PROC_SET_OUT(11, reg(3)(7 downto 6));
+
+					PROC_SET_OUT(12, reg(4)(1 downto 0));
+					PROC_SET_OUT(13, reg(4)(3 downto 2));
+					PROC_SET_OUT(14, reg(4)(5 downto 4));
+					PROC_SET_OUT(15, reg(4)(7 downto 6));
+				end if; -- reset
+			end if; -- clock event
+		end process;
+
+	end generate;
+
+	-- Simulation profile: the PWM modes are full on, so outputs and digits change only on the registers
+	-- writes instead of every clock (nobody looks at the duty cycle in the simulated board)
+	gen_fast : if (fast_sim) generate
+
+		gen_outputs : for oid in 0 to 15 generate
+			outputs(oid)	<= '0'				when (reset = '1') else
+							   reg(0)(2)		when (reg(1 + oid / 4)(2 * (oid mod 4) + 1 downto 2 * (oid mod 4)) = "00") else
+							   not reg(0)(2);
+		end generate;
+
+		gen_digits : for id in 0 to 3 generate
+			digit(id)		<= (others => '0')	when (reset = '1') or (reg(5)(2 * id + 1 downto 2 * id) = "00") else
+							   digit_val(id);
+		end generate;
+
+	end generate;
 	
 	-- UART tx fifo
 	proc_uart_tx_fifo : process(clock) begin
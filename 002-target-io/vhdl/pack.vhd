@@ -68,7 +68,6 @@ package PACK is
 	----------------------------------------------------------------------------
 	-- Constants
 
-	constant ROM_FILE		: string			:= "b65.rom";								-- rom filename
 	constant ROM_FILL		: std_logic_vector	:= x"FF";									-- rom fill value
 
 	constant MAP_START_RAM	: integer			:= conv_integer(x"0000");					-- start address     0 : RAM
@@ -108,6 +107,9 @@ package PACK is
 	-- Components
 
 	component clock_manager is
+	generic	(
+				fast_sim				:			boolean				:= false			-- Simulation profile: one generator for both clocks
+			);
 	port	(
 				-- General
 				clk_in1					: in		std_logic;								-- Clock
@@ -152,6 +154,9 @@ package PACK is
 	end component;
 
 	component ext is
+	generic	(
+				fast_sim				:			boolean				:= false			-- Simulation profile: outputs and digits without PWM (see below)
+			);
 	port	(
 				-- General
 				clock					: in		std_logic;								-- Clock
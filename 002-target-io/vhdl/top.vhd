@@ -38,6 +38,9 @@ use b65.PACK.all;
 -- Entity
 
 entity top is
+generic	(
+			fast_sim				:			boolean				:= false				-- Simulation profile: no PWM and display multiplexing (see extension.vhd)
+		);
 port	(
 			-- General
 			clock					: in		std_logic;								-- Clock
@@ -145,6 +148,9 @@ begin
 	-- CPU is clocked at 5MHz because the FPGA cannot generate lower frequencies clocks
 
 	inst_clock_manager : clock_manager
+	generic map	(
+					fast_sim					=> fast_sim
+				)
 	port map	(
 					-- General
 					clk_in1						=> clock,				-- Input clock
@@ -225,6 +231,9 @@ begin
 				);
 
 	inst_ext : ext
+	generic map	(
+					fast_sim					=> fast_sim
+				)
 	port map	(
 					-- General
 					clock						=> clock_50M,
@@ -334,37 +343,49 @@ begin
 		end if; -- clock event
 	end process;
 
-	-- Generate 7 segments digits signals
-	digits_gen : process(clock_50M) begin
-		if (clock_50M'event and clock_50M='1') then
-			-- If (system is in reset state)
-			if (reset_system = '1') then
-				anode											<= (others => '1');
-				cathode											<= (others => '1');
-				digit_delay										<= (others => '0');
-				digit_select									<= "1000";
-				digit_select_id									<= 3;
-			else
-				-- Drive the output inverting the signals
-				anode											<= not digit_select;
-				cathode											<= not ext_digit(digit_select_id);
+	-- 7 segments digits multiplexing
+	gen_digits : if (not fast_sim) generate
+
+		-- Generate 7 segments digits signals
+		digits_gen : process(clock_50M) begin
+			if (clock_50M'event and clock_50M='1') then
+				-- If (system is in reset state)
+				if (reset_system = '1') then
+					anode											<= (others => '1');
+					cathode											<= (others => '1');
+					digit_delay										<= (others => '0');
+					digit_select									<= "1000";
+					digit_select_id									<= 3;
+				else
+					-- Drive the output inverting the signals
+					anode											<= not digit_select;
+					cathode											<= not ext_digit(digit_select_id);
 
-				digit_delay										<= digit_delay + 1;
+					digit_delay										<= digit_delay + 1;
 
-				-- Wait for refresh delay:  50MHz clock and a delay of 4ms : 4m * 50M = 200000 = x030D40
-				if (digit_delay = x"030D40") then
-					digit_delay									<= (others => '0');
-					digit_select								<= digit_select(2 downto 0) & digit_select(3);
+					-- Wait for refresh delay:  50MHz clock and a delay of 4ms : 4m * 50M = 200000 = x030D40
+					if (digit_delay = x"030D40") then
+						digit_delay									<= (others => '0');
+						digit_select								<= digit_select(2 downto 0) & digit_select(3);
 					
-					if (digit_select_id = 3) then
-						digit_select_id							<= 0;
-					else
-						digit_select_id							<= digit_select_id + 1;
+						if (digit_select_id = 3) then
+							digit_select_id							<= 0;
+						else
+							digit_select_id							<= digit_select_id + 1;
+						end if;
 					end if;
 				end if;
 			end if;
-		end if;
-	end process;
+		end process;
+
+	end generate;
+
+	-- Simulation profile: no multiplexing, the pins stay on the first selected digit (3), all the
+	-- digits are in ext_digit
+	gen_digits_fast : if (fast_sim) generate
+		anode			<= (others => '1')	when (reset_system = '1') else "0111";
+		cathode			<= (others => '1')	when (reset_system = '1') else not ext_digit(3);
+	end generate;
 
 end behavioral;
 
@@ -36,7 +36,13 @@ set files_vhdl [list 												\
 	"[file normalize "../../$Target_Path/vhdl/pack.vhd"]"			\
 	"[file normalize "../../$Target_Path/vhdl/uart.vhd"]"			\
 	"[file normalize "../../$Target_Path/vhdl/extension.vhd"]"		\
+	"[file normalize "../../$Target_Path/vhdl/crc.vhd"]"			\
+	"[file normalize "../../$Target_Path/vhdl/timer.vhd"]"			\
+	"[file normalize "../../$Target_Path/vhdl/intc.vhd"]"			\
+	"[file normalize "../../$Target_Path/vhdl/input-event.vhd"]"	\
+	"[file normalize "../../$Target_Path/vhdl/serial.vhd"]"			\
 	"[file normalize "../../$Target_Path/vhdl/soft-dl.vhd"]"		\
+	"[file normalize "../../$Target_Path/vhdl/ram-code.vhd"]"		\
 	"[file normalize "../../$Target_Path/vhdl/debounce.vhd"]"		\
 ]
 
@@ -53,7 +59,6 @@ set constraints [list 												\
 set cores [list 													\
 "[file normalize "../../$Target_Path/basys3/clock_manager.xci"]"	\
 "[file normalize "../../$Target_Path/basys3/ram.xci"]"				\
-"[file normalize "../../$Target_Path/basys3/ram_code.xci"]"			\
 ]
 
 # Setup output folder
@@ -0,0 +1,87 @@
+; Copyright 2023 Luca Bertossi
+;
+; This file is part of B65.
+; 
+;     B65 is free software: you can redistribute it and/or modify
+;     it under the terms of the GNU General Public License as published by
+;     the Free Software Foundation, either version 3 of the License, or
+;     (at your option) any later version.
+; 
+;     B65 is distributed in the hope that it will be useful,
+;     but WITHOUT ANY WARRANTY; without even the implied warranty of
+;     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+;     GNU General Public License for more details.
+; 
+;     You should have received a copy of the GNU General Public License
+;     along with B65.  If not, see <http://www.gnu.org/licenses/>.
+
+; ---------------------------------------------------------------------------
+; crt0.s
+; ---------------------------------------------------------------------------
+;
+; Startup code for the b65 RAM programs (see ram.cfg)
+;
+; The firmware calls the first byte of the program (console load command,
+; binary protocol EXEC): the C stack is the caller one, DATA is already in
+; place (loaded with the code), BSS is cleared here. main() or exit() return
+; to the caller with the result in A/X.
+
+.export   _init, _exit
+.import   _main
+
+.export   __STARTUP__ : absolute = 1        ; Mark as startup
+
+.import    zerobss, initlib, donelib
+
+.include  "zeropage.inc"
+
+; ---------------------------------------------------------------------------
+; Caller stacks (DATA: not cleared by zerobss)
+
+.segment  "DATA"
+
+exitsp:   .byte   0                    ; CPU stack pointer
+exitcsp:  .word   0                    ; C stack pointer
+exitval:  .word   0                    ; Result
+
+; ---------------------------------------------------------------------------
+; Place the startup code in a special segment
+
+.segment  "STARTUP"
+
+; ---------------------------------------------------------------------------
+; Program entry point (first byte)
+
+_init:    CLD                          ; Clear decimal mode
+
+          ; Keep the caller stacks for exit()
+          TSX
+          STX     exitsp
+          LDA     sp
+          LDX     sp+1
+          STA     exitcsp
+          STX     exitcsp+1
+
+          ; Call initialize functions
+          JSR     zerobss              ; Clear BSS segment
+          JSR     initlib              ; Run constructors
+
+          ; Call main()
+          JSR     _main
+
+_exit:    STA     exitval              ; main() result or exit() status
+          STX     exitval+1
+
+          ; Back to the caller stacks (exit() can be called at any depth)
+          LDX     exitsp
+          TXS
+          LDA     exitcsp
+          LDX     exitcsp+1
+          STA     sp
+          STX     sp+1
+
+          JSR     donelib              ; Run destructors
+
+          LDA     exitval
+          LDX     exitval+1
+          RTS
@@ -0,0 +1,49 @@
+// Copyright 2023 Luca Bertossi
+//
+// This file is part of B65.
+// 
+//     B65 is free software: you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation, either version 3 of the License, or
+//     (at your option) any later version.
+// 
+//     B65 is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+// 
+//     You should have received a copy of the GNU General Public License
+//     along with B65.  If not, see <http://www.gnu.org/licenses/>.
+
+///////////////////////////////////////////////////////////
+// Example RAM program
+//
+// Load it with the console 'load' command (XMODEM-CRC) or with b65cmd:
+// it shows "rAm" on the displays and returns the CRC-16 of the code ram
+
+///////////////////////////////////////////////////////////
+// Includes
+
+#include "extension.h"
+
+///////////////////////////////////////////////////////////
+// Entry point (called by crt0.s)
+
+int main(void)
+{
+	R_DIGIT3		= 'r';
+	R_DIGIT2		= 'A';
+	R_DIGIT1		= 'm';
+	R_DIGIT0		= ' ';
+
+	// CRC-16/CCITT-FALSE of the code ram (the CRC block reads the memory)
+	R_CRC_SEED		= 0xFFFFFFFF;
+	R_CRC_CTRL		= CRC_CTRL_SEED;
+	R_CRC_ADDRESS	= MAP_START_ROM;
+	R_CRC_LENGTH	= MAP_SIZE_ROM;
+	R_CRC_CTRL		= CRC_CTRL_START;
+
+	while (R_CRC_CTRL & CRC_CTRL_BUSY);
+
+	return R_CRC_RESULT;
+}
\ No newline at end of file
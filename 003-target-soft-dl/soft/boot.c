@@ -0,0 +1,49 @@
+// Copyright 2023 Luca Bertossi
+//
+// This file is part of B65.
+// 
+//     B65 is free software: you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation, either version 3 of the License, or
+//     (at your option) any later version.
+// 
+//     B65 is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+// 
+//     You should have received a copy of the GNU General Public License
+//     along with B65.  If not, see <http://www.gnu.org/licenses/>.
+
+///////////////////////////////////////////////////////////
+// Includes
+
+#include "extension.h"
+#include "timer.h"
+#include "boot.h"
+
+///////////////////////////////////////////////////////////
+// Globals
+
+// Variables shared with assembler (see crt0.s); both are in BSS, crt0.s clears them
+// unless the RAM is still zero from the FPGA configuration (see intc.vhd Reg[6])
+unsigned long	g_boot_time[BOOT_PHASES];
+unsigned char	g_boot_warm;
+
+// WAI support of the CPU core, set by main() (see cpu_wait_probe in direct.s)
+unsigned char	g_boot_wai;
+
+///////////////////////////////////////////////////////////
+// Functions
+
+///////////////////////////////////////////////////////////
+///
+/// Stamp the end of a boot phase
+///
+///	\param	Phase		:	Boot phase (BOOT_xxx)
+///
+///////////////////////////////////////////////////////////
+void bootMark(unsigned char Phase)
+{
+	g_boot_time[Phase] = timerMicroseconds();
+}
\ No newline at end of file
@@ -0,0 +1,52 @@
+// Copyright 2023 Luca Bertossi
+//
+// This file is part of B65.
+// 
+//     B65 is free software: you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation, either version 3 of the License, or
+//     (at your option) any later version.
+// 
+//     B65 is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+// 
+//     You should have received a copy of the GNU General Public License
+//     along with B65.  If not, see <http://www.gnu.org/licenses/>.
+
+///////////////////////////////////////////////////////////
+// Boot time markers
+//
+// Each boot phase end is stamped with the free running microseconds counter
+// (5 CPU cycles each): crt0.s stamps the startup phases, main() the others.
+// The counter starts at the system reset, the reset stamp includes the
+// software download (see soft-dl.vhd).
+
+///////////////////////////////////////////////////////////
+// Defines
+
+// Boot phases
+#define BOOT_RESET				0		// Reset vector (crt0.s)
+#define BOOT_BSS				1		// BSS ready, cleared or known zero (crt0.s)
+#define BOOT_MAIN				2		// DATA copied and constructors run (crt0.s)
+#define BOOT_DEVICES			3		// UART and interrupts ready
+#define BOOT_PROMPT				4		// Console prompt queued
+#define BOOT_PHASES				5
+
+// CPU cycles in one microsecond
+#define BOOT_CYCLES_US			5
+
+///////////////////////////////////////////////////////////
+// Globals
+
+// Shared with assembler (see crt0.s)
+extern unsigned long	g_boot_time[BOOT_PHASES];	// Phase stamps (microseconds from the system reset)
+extern unsigned char	g_boot_warm;				// 1 if the RAM was zero from the FPGA configuration, 2 if BSS was cleared
+extern unsigned char	g_boot_wai;					// 1 if WAI stops the CPU (see cpu_wait_probe in direct.s)
+
+///////////////////////////////////////////////////////////
+// Functions
+
+void			bootMark		(unsigned char Phase);
+unsigned char	cpu_wait_probe	(void);
\ No newline at end of file
@@ -0,0 +1,52 @@
+// Console commands table (generated by b65.sh from commands.lst, do not edit)
+//
+// Sorted by command name: ConsoleExecute finds a command with a binary search
+
+///////////////////////////////////////////////////////////
+// Commands handlers
+
+CONSOLE_HANDLER(help);
+CONSOLE_HANDLER(bench);
+CONSOLE_HANDLER(binary);
+CONSOLE_HANDLER(boot);
+CONSOLE_HANDLER(cls);
+CONSOLE_HANDLER(crc);
+CONSOLE_HANDLER(display);
+CONSOLE_HANDLER(dump);
+CONSOLE_HANDLER(echo);
+CONSOLE_HANDLER(escan);
+CONSOLE_HANDLER(go);
+#if (CONSOLE_HISTORY_RING != 0)
+CONSOLE_HANDLER(history);
+#endif
+CONSOLE_HANDLER(load);
+CONSOLE_HANDLER(reboot);
+CONSOLE_HANDLER(tasks);
+CONSOLE_HANDLER(upgrade);
+CONSOLE_HANDLER(write);
+
+///////////////////////////////////////////////////////////
+// Console commands table
+
+static const CONSOLE_COMMAND g_ConsoleCommand[] =
+{
+	CONSOLE_ENTRY("?", help, "show commands help"),
+	CONSOLE_ENTRY("bench", bench, "hot routines run time (microseconds)"),
+	CONSOLE_ENTRY("binary", binary, "Binary protocol for host tools (b65link)"),
+	CONSOLE_ENTRY("boot", boot, "boot phases time from the reset vector"),
+	CONSOLE_ENTRY("cls", cls, "clear screen"),
+	CONSOLE_ENTRY("crc", crc, "crc <0xstart> <0xlen>"),
+	CONSOLE_ENTRY("display", display, "display <4 chars> on lcd"),
+	CONSOLE_ENTRY("dump", dump, "dump <0xstart> <0xlen>"),
+	CONSOLE_ENTRY("echo", echo, "echo <string>"),
+	CONSOLE_ENTRY("escan", escan, "Escape sequence scan (CTRL+D to stop)"),
+	CONSOLE_ENTRY("go", go, "go [<0xaddress>] run again the RAM program"),
+#if (CONSOLE_HISTORY_RING != 0)
+	CONSOLE_ENTRY("history", history, "history print"),
+#endif
+	CONSOLE_ENTRY("load", load, "load [<0xaddress>] RAM program (XMODEM-CRC) and run it"),
+	CONSOLE_ENTRY("reboot", reboot, "Reboot CPU"),
+	CONSOLE_ENTRY("tasks", tasks, "tasks longest run time (microseconds)"),
+	CONSOLE_ENTRY("upgrade", upgrade, "Start software upgrade"),
+	CONSOLE_ENTRY("write", write, "write <0xaddress> <0xbyte>"),
+};
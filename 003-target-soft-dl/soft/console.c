@@ -21,6 +21,7 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "lib.h"
 #include "uart.h"
 #include "console.h"
 
@@ -30,7 +31,10 @@
 #define CONSOLE_MEMSET					memset
 #define CONSOLE_MEMCPY					memcpy
 #define CONSOLE_STRLEN					strlen
-#define CONSOLE_STRNCMP					strncmp
+#define CONSOLE_STRCMP					strcmp
+#define CONSOLE_STRTONUM				StrToNum
+#define CONSOLE_SHIFT_RIGHT				BufferShiftRight
+#define CONSOLE_SHIFT_LEFT				BufferShiftLeft
 
 #define CONSOLE_PUTSTRING				uartPutstring
 #define CONSOLE_PUTCHAR					uartPutchar
@@ -43,6 +47,10 @@
 #define CONSOLE_CLEAR_LINE_FROM_CURSOR	"\033[K"
 #define CONSOLE_MOVE_RIGHT				"\033[C\0"
 #define CONSOLE_MOVE_LEFT				"\033[D\0"
+#define CONSOLE_MOVE					"\033["		// Followed by the count and 'C' (right) or 'D' (left)
+#define CONSOLE_INSERT_CHAR				"\033[@"		// Shift the line right from the cursor
+#define CONSOLE_DELETE_CHAR				"\033[P"		// Shift the line left from the cursor
+#define CONSOLE_BACKSPACE				"\b"			// Move left without erasing
 
 // Ins mode
 #define CONSOLE_CURSOR_UNDERLINE		"\033[3 q\0"	// Overwrite
@@ -74,6 +82,92 @@ typedef enum _CONSOLE_CONTROL_
 ///////////////////////////////////////////////////////////
 // Console static
 
+// Terminal update of the current edit
+static unsigned char g_ConsoleOutput[CONSOLE_MAX_OUTPUT + 1];
+static unsigned char g_ConsoleOutputLen = 0;
+
+///////////////////////////////////////////////////////////
+///
+/// Send the pending terminal update
+///
+/// The update goes to the UART with one call, so it is
+/// queued and started as a single burst
+///
+///////////////////////////////////////////////////////////
+static void ConsoleFlush(void)
+{
+	if (g_ConsoleOutputLen == 0)
+		return;
+
+	g_ConsoleOutput[g_ConsoleOutputLen] = '\0';
+	CONSOLE_PUTSTRING(g_ConsoleOutput);
+	g_ConsoleOutputLen = 0;
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Add one character to the terminal update
+///
+///	\param	Byte	:	Character to add
+///
+///////////////////////////////////////////////////////////
+static void ConsoleOutputChar(unsigned char Byte)
+{
+	if (g_ConsoleOutputLen == CONSOLE_MAX_OUTPUT)
+		ConsoleFlush();
+
+	g_ConsoleOutput[g_ConsoleOutputLen++] = Byte;
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Add a string to the terminal update
+///
+///	\param	Str		:	Zero terminated string to add
+///
+///////////////////////////////////////////////////////////
+static void ConsoleOutput(const unsigned char *Str)
+{
+	while (*Str)
+		ConsoleOutputChar(*Str++);
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Add a cursor move to the terminal update (ESC[nC or ESC[nD)
+///
+///	\param	Count	:	Number of chars to move
+///	\param	Dir		:	'C' to move right, 'D' to move left
+///
+///////////////////////////////////////////////////////////
+static void ConsoleMove(unsigned char Count, unsigned char Dir)
+{
+	unsigned char	Hundreds	= '0';
+	unsigned char	Tens		= '0';
+
+	if (Count == 0)
+		return;
+
+	ConsoleOutput(CONSOLE_MOVE);
+
+	// One step is the default count; the digits by subtraction (no runtime division)
+	if (Count > 1)
+	{
+		for (; Count >= 100; Count -= 100)
+			Hundreds++;
+		for (; Count >= 10; Count -= 10)
+			Tens++;
+
+		if (Hundreds != '0')
+			ConsoleOutputChar(Hundreds);
+		if ((Hundreds != '0') || (Tens != '0'))
+			ConsoleOutputChar(Tens);
+		ConsoleOutputChar('0' + Count);
+	}
+
+	ConsoleOutputChar(Dir);
+}
+
 ///////////////////////////////////////////////////////////
 ///
 /// send the prompt
@@ -111,8 +205,7 @@ static void ConsolePrompt(CONSOLE_CONTEXT *Ctx)
 ///////////////////////////////////////////////////////////
 static void ConsoleMoveLeft(unsigned char Count)
 {
-	while (Count--)
-		CONSOLE_PUTSTRING(CONSOLE_MOVE_LEFT);
+	ConsoleMove(Count, 'D');
 }
 
 ///////////////////////////////////////////////////////////
@@ -124,30 +217,153 @@ static void ConsoleMoveLeft(unsigned char Count)
 ///////////////////////////////////////////////////////////
 static void ConsoleMoveRight(unsigned char Count)
 {
-	while (Count--)
-		CONSOLE_PUTSTRING(CONSOLE_MOVE_RIGHT);
+	ConsoleMove(Count, 'C');
+}
+
+#if (CONSOLE_HISTORY_RING != 0)
+///////////////////////////////////////////////////////////
+///
+/// Next history ring position
+///
+///	\param	Ctx		:	Console context
+///	\param	Pos		:	History ring position
+///
+///////////////////////////////////////////////////////////
+static unsigned char ConsoleHistoryNext(CONSOLE_CONTEXT *Ctx, unsigned char Pos)
+{
+	Pos++;
+	if (Pos == Ctx->historySize)
+		Pos = 0;
+
+	return Pos;
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Previous history ring position
+///
+///	\param	Ctx		:	Console context
+///	\param	Pos		:	History ring position
+///
+///////////////////////////////////////////////////////////
+static unsigned char ConsoleHistoryPrev(CONSOLE_CONTEXT *Ctx, unsigned char Pos)
+{
+	if (Pos == 0)
+		Pos = Ctx->historySize;
+
+	return Pos - 1;
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Find the command after a history command
+///
+///	\param	Ctx		:	Console context
+///	\param	Pos		:	Command position
+///
+/// \return	the next command position (the oldest after the newest)
+///
+///////////////////////////////////////////////////////////
+static unsigned char ConsoleHistoryNewer(CONSOLE_CONTEXT *Ctx, unsigned char Pos)
+{
+	while (Ctx->history[Pos] != '\0')
+		Pos = ConsoleHistoryNext(Ctx, Pos);
+
+	Pos = ConsoleHistoryNext(Ctx, Pos);
+	if (Pos == Ctx->historyHead)
+		Pos = Ctx->historyTail;
+
+	return Pos;
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Find the command before a history command
+///
+///	\param	Ctx		:	Console context
+///	\param	Pos		:	Command position (historyHead for the newest)
+///
+/// \return	the previous command position (the newest before the oldest)
+///
+///////////////////////////////////////////////////////////
+static unsigned char ConsoleHistoryOlder(CONSOLE_CONTEXT *Ctx, unsigned char Pos)
+{
+	if (Pos == Ctx->historyTail)
+		Pos = Ctx->historyHead;
+
+	// From the terminator of the previous command back to its first char
+	Pos = ConsoleHistoryPrev(Ctx, Pos);
+	do
+	{
+		if (Pos == Ctx->historyTail)
+			return Pos;
+
+		Pos = ConsoleHistoryPrev(Ctx, Pos);
+
+	} while (Ctx->history[Pos] != '\0');
+
+	return ConsoleHistoryNext(Ctx, Pos);
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Copy a history command (it can wrap around the ring end)
+///
+///	\param	Ctx		:	Console context
+///	\param	Pos		:	Command position
+///	\param	Buffer	:	Destination (CONSOLE_MAX_COMMAND bytes)
+///
+///////////////////////////////////////////////////////////
+static void ConsoleHistoryCopy(CONSOLE_CONTEXT *Ctx, unsigned char Pos, unsigned char *Buffer)
+{
+	while ((*Buffer = Ctx->history[Pos]) != '\0')
+	{
+		Buffer++;
+		Pos = ConsoleHistoryNext(Ctx, Pos);
+	}
 }
 
-#if (CONSOLE_MAX_HISTORY > 1)
 ///////////////////////////////////////////////////////////
 ///
 /// Save the current buffer to the history
 ///
 ///	\param	Ctx		:	Console context
 ///
+/// \note	The oldest commands are dropped until the new one fits
+///
 ///////////////////////////////////////////////////////////
 static void ConsoleHistoryWrite(CONSOLE_CONTEXT *Ctx)
 {
-	CONSOLE_MEMCPY(Ctx->history[Ctx->historyWrite], Ctx->buffer, Ctx->end + 1);
+	unsigned char Len = Ctx->end + 1;
+	unsigned char Index;
+	unsigned char Byte;
 
-	Ctx->historyRead = Ctx->historyWrite;
+	if (Len > Ctx->historySize)
+		return;
 
-	Ctx->historyWrite++;
-	if (Ctx->historyWrite == CONSOLE_MAX_HISTORY)
-		Ctx->historyWrite = 0;
+	while ((unsigned char) (Ctx->historySize - Ctx->historyUsed) < Len)
+	{
+		do
+		{
+			Byte				= Ctx->history[Ctx->historyTail];
+			Ctx->historyTail	= ConsoleHistoryNext(Ctx, Ctx->historyTail);
+			Ctx->historyUsed--;
 
-	if (Ctx->historyCount < CONSOLE_MAX_HISTORY)
-		Ctx->historyCount++;
+		} while (Byte != '\0');
+
+		Ctx->historyCount--;
+	}
+
+	Ctx->historyRead = Ctx->historyHead;
+
+	for (Index = 0; Index < Len; Index++)
+	{
+		Ctx->history[Ctx->historyHead]	= Ctx->buffer[Index];
+		Ctx->historyHead				= ConsoleHistoryNext(Ctx, Ctx->historyHead);
+	}
+
+	Ctx->historyUsed += Len;
+	Ctx->historyCount++;
 }
 
 ///////////////////////////////////////////////////////////
@@ -164,34 +380,24 @@ static void ConsoleHistoryWrite(CONSOLE_CONTEXT *Ctx)
 ///////////////////////////////////////////////////////////
 static unsigned char* ConsoleHistoryRecall(CONSOLE_CONTEXT *Ctx, unsigned char Dir)
 {
-	unsigned char *Buf;
-
 	if (Ctx->historyCount == 0)
 		return 0;
 
 	if (Ctx->historyActive)
 	{
 		if (Dir == CONSOLE_CTRL_ARROW_DOWN)
-		{
-			Ctx->historyRead++;
-			if (Ctx->historyRead == Ctx->historyCount)
-				Ctx->historyRead = 0;	
-		}
+			Ctx->historyRead = ConsoleHistoryNewer(Ctx, Ctx->historyRead);
 		else
-		{
-			if (Ctx->historyRead == 0)
-				Ctx->historyRead = Ctx->historyCount-1;
-			else
-				Ctx->historyRead--;
-		}
+			Ctx->historyRead = ConsoleHistoryOlder(Ctx, Ctx->historyRead);
 	}
 
-	Buf = Ctx->history[Ctx->historyRead];
+	// The command is copied to the current buffer (see ConsoleSetBuffer)
+	ConsoleHistoryCopy(Ctx, Ctx->historyRead, Ctx->buffer);
 
 	Ctx->historyActive = 1;
-	return Buf;
+	return Ctx->buffer;
 }
-#endif // (CONSOLE_MAX_HISTORY > 1)
+#endif // (CONSOLE_HISTORY_RING != 0)
 
 #if (CONSOLE_MAX_HISTORY > 0)
 ///////////////////////////////////////////////////////////
@@ -210,8 +416,8 @@ static void ConsoleSetBuffer(CONSOLE_CONTEXT *Ctx, unsigned char *Buffer)
 		return;
 
 	// Reset terminal
-	if (Ctx->current > 0)
-		ConsoleMoveLeft(Ctx->current);
+	ConsoleMoveLeft(Ctx->current);
+	ConsoleOutput(CONSOLE_CLEAR_LINE_FROM_CURSOR);
 
 	// Set new buffer
 	Len = CONSOLE_STRLEN(Buffer);
@@ -225,8 +431,7 @@ static void ConsoleSetBuffer(CONSOLE_CONTEXT *Ctx, unsigned char *Buffer)
 	Ctx->end		= Len;
 
 	// Update terminal
-	CONSOLE_PUTSTRING(CONSOLE_CLEAR_LINE_FROM_CURSOR);
-	CONSOLE_PUTSTRING(Ctx->buffer);
+	ConsoleOutput(Ctx->buffer);
 }
 #endif // (CONSOLE_MAX_HISTORY > 0)
 
@@ -240,46 +445,42 @@ static void ConsoleSetBuffer(CONSOLE_CONTEXT *Ctx, unsigned char *Buffer)
 ///////////////////////////////////////////////////////////
 static void ConsoleInsert(CONSOLE_CONTEXT *Ctx, unsigned char Byte)
 {
-	unsigned char Index = Ctx->end;
+	// The line is full (keep room for the terminator)
+#if (CONSOLE_INS_MODE != 0)
+	if ((Ctx->end >= CONSOLE_MAX_COMMAND - 1) && ((Ctx->insmode == CONSOLE_INS_INSERT) || (Ctx->current == Ctx->end)))
+#else
+	if (Ctx->end >= CONSOLE_MAX_COMMAND - 1)
+#endif
+		return;
 
 #if (CONSOLE_INS_MODE != 0)
 	if (Ctx->insmode == CONSOLE_INS_INSERT)
 #endif
 	{
-		if (Index > CONSOLE_MAX_COMMAND - 1)
-			Index = CONSOLE_MAX_COMMAND - 1;
-
 		// Make room for a char (if due)
-		while (Ctx->current < Index)
-		{
-			Ctx->buffer[Index] = Ctx->buffer[Index-1];
-			Index--;
-		}
+		CONSOLE_SHIFT_RIGHT(&Ctx->buffer[Ctx->current], Ctx->end - Ctx->current);
 	}
 
 	// Add one char
 	Ctx->buffer[Ctx->current] = Byte;
-	if (Ctx->current < CONSOLE_MAX_COMMAND)
-	{
-	#if (CONSOLE_INS_MODE != 0)
-		if ((Ctx->insmode == CONSOLE_INS_INSERT) || (Ctx->current == Ctx->end))
-	#endif
-			Ctx->end++;
+#if (CONSOLE_INS_MODE != 0)
+	if ((Ctx->insmode == CONSOLE_INS_INSERT) || (Ctx->current == Ctx->end))
+#endif
+		Ctx->end++;
 
-		Ctx->current++;
-	}
+	Ctx->current++;
+	Ctx->buffer[Ctx->end] = '\0';
 	
-	// Adjust the terminal
+	// Adjust the terminal (the tail is shifted by the terminal, the cursor stays after the new char)
 #if (CONSOLE_INS_MODE != 0)
 	if ((Ctx->insmode == CONSOLE_INS_INSERT) && (Ctx->current != Ctx->end))
 #else
 	if (Ctx->current != Ctx->end)
 #endif
 	{
-		Ctx->buffer[Ctx->end] = '\0';
-		CONSOLE_PUTSTRING(CONSOLE_CLEAR_LINE_FROM_CURSOR);
-		CONSOLE_PUTSTRING(&Ctx->buffer[Ctx->current-1]);
-		ConsoleMoveLeft(Ctx->end - Ctx->current);
+		ConsoleOutput(CONSOLE_INSERT_CHAR);
+		ConsoleOutputChar(Byte);
+		ConsoleFlush();
 	}
 	else
 		CONSOLE_PUTCHAR(Byte);
@@ -298,27 +499,16 @@ static void ConsoleInsert(CONSOLE_CONTEXT *Ctx, unsigned char Byte)
 ///////////////////////////////////////////////////////////
 static void ConsoleBackspace(CONSOLE_CONTEXT *Ctx)
 {
-	unsigned char Index;
-
 	if ((Ctx->current > 0) && (Ctx->current <= Ctx->end))
 	{
-		CONSOLE_PUTSTRING(CONSOLE_MOVE_LEFT);
-		CONSOLE_PUTSTRING(CONSOLE_CLEAR_LINE_FROM_CURSOR);
+		// The terminal shifts the tail left
+		ConsoleOutput(CONSOLE_BACKSPACE CONSOLE_DELETE_CHAR);
 
-		Index = Ctx->current - 1;
-		while (Index < Ctx->end)
-		{
-			Ctx->buffer[Index] = Ctx->buffer[Index+1];
-			Index++;
-		}
+		CONSOLE_SHIFT_LEFT(&Ctx->buffer[Ctx->current - 1], Ctx->end - Ctx->current + 1);
 
 		Ctx->end--;
 		Ctx->current--;
 		Ctx->buffer[Ctx->end] = '\0';
-
-		CONSOLE_PUTSTRING(&Ctx->buffer[Ctx->current]);
-		if (Ctx->current < Ctx->end)
-			ConsoleMoveLeft(Ctx->end - Ctx->current);
 	}
 }
 
@@ -331,30 +521,97 @@ static void ConsoleBackspace(CONSOLE_CONTEXT *Ctx)
 ///////////////////////////////////////////////////////////
 static void ConsoleCancel(CONSOLE_CONTEXT *Ctx)
 {
-	unsigned char Index;
-
 	if ((Ctx->end > 0) && (Ctx->current < Ctx->end))
 	{
-		CONSOLE_PUTSTRING(CONSOLE_CLEAR_LINE_FROM_CURSOR);
+		// The terminal shifts the tail left, the cursor does not move
+		ConsoleOutput(CONSOLE_DELETE_CHAR);
 
-		Index = Ctx->current;
-		while (Index < Ctx->end)
-		{
-			Ctx->buffer[Index] = Ctx->buffer[Index+1];
-			Index++;
-		}
+		CONSOLE_SHIFT_LEFT(&Ctx->buffer[Ctx->current], Ctx->end - Ctx->current);
 
-		if (Ctx->end > 0)
-			Ctx->end--;
-	
+		Ctx->end--;
 		Ctx->buffer[Ctx->end] = '\0';
+	}
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Split the command line into arguments
+///
+/// The line is copied and split once: argv[n] points to the
+/// zero terminated argument, argn[n] is its numeric value
+/// (if valid, see StrToNum)
+///
+///	\param	Args	:	Arguments
+///	\param	Buffer	:	Command line (zero terminated)
+///
+///////////////////////////////////////////////////////////
+static void ConsoleTokenize(CONSOLE_ARGS *Args, const unsigned char *Buffer)
+{
+	unsigned char  *Line	= Args->line;
+	unsigned char	Mask	= 0x01;
+
+	CONSOLE_MEMCPY(Line, Buffer, CONSOLE_MAX_COMMAND);
+
+	Args->argc		= 0;
+	Args->numeric	= 0;
+
+	while (Args->argc < CONSOLE_MAX_ARGS)
+	{
+		while (*Line == ' ')
+			++Line;
+
+		if (*Line == '\0')
+			break;
+
+		Args->argv[Args->argc] = Line;
+
+		while (*Line > ' ')
+			++Line;
+
+		if (*Line != '\0')
+			*Line++ = '\0';
+
+		if (CONSOLE_STRTONUM(Args->argv[Args->argc], &Args->argn[Args->argc]))
+			Args->numeric |= Mask;
+
+		Mask <<= 1;
+		Args->argc++;
+	}
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Find a command (binary search, the commands array is
+/// sorted by name, see commands.lst)
+///
+///	\param	Ctx		:	Console context
+///	\param	Name	:	Command name
+///
+///	\return	the command, NULL if not found
+///
+///////////////////////////////////////////////////////////
+static const CONSOLE_COMMAND *ConsoleFind(CONSOLE_CONTEXT *Ctx, const unsigned char *Name)
+{
+	unsigned char	Low		= 0;
+	unsigned char	High	= Ctx->commandCount;
+	unsigned char	Middle;
+	int				Compare;
 
-		CONSOLE_PUTSTRING(&Ctx->buffer[Ctx->current]);
-		ConsoleMoveLeft(Ctx->end - Ctx->current);
+	while (Low < High)
+	{
+		Middle	= (Low + High) >> 1;
+		Compare	= CONSOLE_STRCMP(Name, Ctx->command[Middle].command);
 
-		if (Ctx->current > 0)
-			Ctx->current--;
+		if (Compare == 0)
+			return &Ctx->command[Middle];
+
+		if (Compare < 0)
+			High	= Middle;
+		else
+			Low		= Middle + 1;
 	}
+
+	return NULL;
 }
 
 ///////////////////////////////////////////////////////////
@@ -366,9 +623,9 @@ static void ConsoleCancel(CONSOLE_CONTEXT *Ctx)
 ///////////////////////////////////////////////////////////
 static void ConsoleExecute(CONSOLE_CONTEXT *Ctx)
 {
-	unsigned char Done = 0;
-	unsigned char Index;
-	unsigned char Len;
+	static CONSOLE_ARGS		Args;
+	const CONSOLE_COMMAND  *Command = NULL;
+	unsigned char			Done	= 0;
 	
 	if (Ctx->end != 0)
 	{
@@ -378,22 +635,22 @@ static void ConsoleExecute(CONSOLE_CONTEXT *Ctx)
 		// If not commented out, execute
 		if (Ctx->buffer[0] != '#')
 		{
-			for (Index = 0; Index < Ctx->commandCount; Index++)
+			ConsoleTokenize(&Args, Ctx->buffer);
+
+			if (Args.argc != 0)
+				Command = ConsoleFind(Ctx, Args.argv[0]);
+
+			if (Command && Command->callback)
 			{
-				Len = CONSOLE_STRLEN(Ctx->command[Index].command);
-				if ((CONSOLE_STRNCMP(Ctx->command[Index].command, Ctx->buffer, Len) == 0) && Ctx->command[Index].callback)
-				{
-					CONSOLE_PUTSTRING(CONSOLE_NEWLINE);
+				CONSOLE_PUTSTRING(CONSOLE_NEWLINE);
 
-				#if (CONSOLE_CALLBACK_USER_ARG != 0)
-					Ctx->command[Index].callback(Ctx->buffer,  Ctx->command[Index].arg);
-				#else
-					Ctx->command[Index].callback(Ctx->buffer);
-				#endif
+			#if (CONSOLE_CALLBACK_USER_ARG != 0)
+				Command->callback(&Args, Command->arg);
+			#else
+				Command->callback(&Args);
+			#endif
 
-					Done = 1;
-					break;
-				}
+				Done = 1;
 			}
 
 			if (Done == 0)
@@ -407,7 +664,7 @@ static void ConsoleExecute(CONSOLE_CONTEXT *Ctx)
 			{
 				// Write History
 				if (Ctx->historyActive == 0)
-				#if (CONSOLE_MAX_HISTORY > 1)
+				#if (CONSOLE_HISTORY_RING != 0)
 					ConsoleHistoryWrite(Ctx);
 				#else
 					Ctx->historyCount = 1;
@@ -422,8 +679,9 @@ static void ConsoleExecute(CONSOLE_CONTEXT *Ctx)
 	Ctx->current	= 0;
 	Ctx->end		= 0;
 
-	// Draw prompt
-	ConsolePrompt(Ctx);
+	// Draw prompt (a deferred command draws it when done)
+	if (Ctx->deferred == 0)
+		ConsolePrompt(Ctx);
 }
 
 ///////////////////////////////////////////////////////////
@@ -455,9 +713,8 @@ static void ConsoleControlChar(CONSOLE_CONTEXT *Ctx, CONSOLE_CONTROL Ctrl)
 		break;	
 		
 		case CONSOLE_CTRL_CLEAR_LINE:
-			if (Ctx->current > 0)
-				ConsoleMoveLeft(Ctx->current);
-			CONSOLE_PUTSTRING(CONSOLE_CLEAR_LINE_FROM_CURSOR);
+			ConsoleMoveLeft(Ctx->current);
+			ConsoleOutput(CONSOLE_CLEAR_LINE_FROM_CURSOR);
 			Ctx->current	= 0;
 			Ctx->end		= 0;
 		break;
@@ -499,7 +756,7 @@ static void ConsoleControlChar(CONSOLE_CONTEXT *Ctx, CONSOLE_CONTROL Ctrl)
 	#if (CONSOLE_MAX_HISTORY > 0)
 		case CONSOLE_CTRL_ARROW_UP:
 		case CONSOLE_CTRL_ARROW_DOWN:
-			#if (CONSOLE_MAX_HISTORY > 1)
+			#if (CONSOLE_HISTORY_RING != 0)
 				ConsoleSetBuffer(Ctx, ConsoleHistoryRecall(Ctx, Ctrl));
 			#else
 				Ctx->historyActive = 1;
@@ -524,6 +781,9 @@ static void ConsoleControlChar(CONSOLE_CONTEXT *Ctx, CONSOLE_CONTROL Ctrl)
 			}
 		break;
 	}
+
+	// Send the terminal update of the edit
+	ConsoleFlush();
 	
 	#if (CONSOLE_MAX_HISTORY > 0)
 	if ((Ctrl != CONSOLE_CTRL_ARROW_UP) && (Ctrl != CONSOLE_CTRL_ARROW_DOWN))
@@ -539,7 +799,7 @@ static void ConsoleControlChar(CONSOLE_CONTEXT *Ctx, CONSOLE_CONTROL Ctrl)
 /// Initialize the console
 ///
 ///	\param	Ctx			:	Console context
-///	\param	Command		:	Array of recognized commands
+///	\param	Command		:	Array of recognized commands, sorted by name (see commands.lst)
 ///	\param	Count		:	Number of items in the commands array
 ///
 ///////////////////////////////////////////////////////////
@@ -590,6 +850,27 @@ void ConsoleAdd(CONSOLE_CONTEXT *Ctx, unsigned char Byte)
 {
 	unsigned char Set7E = 0;
 
+#if (CONSOLE_COOKED_MODE != 0)
+	// Printable char already echoed by the line discipline (the cursor is at the end of line)
+	if (Ctx->cooked != 0)
+	{
+		if ((Byte >= 0x20) && (Byte < 0x7F))
+		{
+			Ctx->cooked--;
+			Ctx->buffer[Ctx->end++]	= Byte;
+			Ctx->current			= Ctx->end;
+
+		#if (CONSOLE_MAX_HISTORY > 0)
+			Ctx->historyActive		= 0;
+		#endif
+			return;
+		}
+
+		// The line discipline is done, back to the raw mode
+		Ctx->cooked = 0;
+	}
+#endif
+
 	// Command character
 	if ((Ctx->status == CONSOLE_STATUS_IDLE) && (Byte >= 0x20) && (Byte < 0x7F))
 		ConsoleInsert(Ctx, Byte);
@@ -628,3 +909,115 @@ void ConsoleAdd(CONSOLE_CONTEXT *Ctx, unsigned char Byte)
 	if (Set7E)
 		Ctx->status = CONSOLE_STATUS_7E;
 }
+
+///////////////////////////////////////////////////////////
+///
+/// Called by a command handler that goes on in background
+/// (a task): the prompt is drawn by ConsoleDone
+///
+///	\param	Ctx		:	Console context
+///
+///////////////////////////////////////////////////////////
+void ConsoleDefer(CONSOLE_CONTEXT *Ctx)
+{
+	Ctx->deferred = 1;
+}
+
+///////////////////////////////////////////////////////////
+///
+/// The deferred command is done, draw the prompt
+///
+///	\param	Ctx		:	Console context
+///
+///////////////////////////////////////////////////////////
+void ConsoleDone(CONSOLE_CONTEXT *Ctx)
+{
+	Ctx->deferred = 0;
+
+	ConsolePrompt(Ctx);
+}
+
+#if (CONSOLE_HISTORY_RING != 0)
+///////////////////////////////////////////////////////////
+///
+/// Set the history ring memory (the history is empty)
+///
+///	\param	Ctx		:	Console context
+///	\param	Memory	:	History ring (NULL for no history)
+///	\param	Size	:	History ring size (up to 255 bytes, see CONSOLE_HISTORY_SIZE)
+///
+///////////////////////////////////////////////////////////
+void ConsoleHistoryInit(CONSOLE_CONTEXT *Ctx, unsigned char *Memory, unsigned char Size)
+{
+	Ctx->history		= Memory;
+	Ctx->historySize	= (Memory != NULL) ? Size : 0;
+	Ctx->historyUsed	= 0;
+	Ctx->historyTail	= 0;
+	Ctx->historyHead	= 0;
+	Ctx->historyRead	= 0;
+	Ctx->historyCount	= 0;
+	Ctx->historyActive	= 0;
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Copy a history command
+///
+///	\param	Ctx		:	Console context
+///	\param	Item	:	Command number (zero is the oldest)
+///	\param	Buffer	:	Destination (CONSOLE_MAX_COMMAND bytes)
+///
+/// \return	zero if there is no such command
+///
+///////////////////////////////////////////////////////////
+unsigned char ConsoleHistoryGet(CONSOLE_CONTEXT *Ctx, unsigned char Item, unsigned char *Buffer)
+{
+	unsigned char Pos = Ctx->historyTail;
+
+	if (Item >= Ctx->historyCount)
+		return 0;
+
+	while (Item--)
+		Pos = ConsoleHistoryNewer(Ctx, Pos);
+
+	ConsoleHistoryCopy(Ctx, Pos, Buffer);
+
+	return 1;
+}
+#endif
+
+#if (CONSOLE_COOKED_MODE != 0)
+///////////////////////////////////////////////////////////
+///
+/// Number of chars a line discipline can append to the command
+///
+///	\param	Ctx		:	Console context
+///
+///	\return	zero if the line discipline can't be used now (escape
+///			sequence in progress or cursor not at the end of line)
+///
+///////////////////////////////////////////////////////////
+unsigned char ConsoleCookedLimit(CONSOLE_CONTEXT *Ctx)
+{
+	if ((Ctx->status != CONSOLE_STATUS_IDLE) || (Ctx->current != Ctx->end) || (Ctx->end >= CONSOLE_MAX_COMMAND - 1))
+		return 0;
+
+	return CONSOLE_MAX_COMMAND - 1 - Ctx->end;
+}
+
+///////////////////////////////////////////////////////////
+///
+/// The line discipline is active: the next printable chars (up to
+/// Limit) are already echoed and they are appended to the command
+/// without any terminal update. The first non printable char ends
+/// the cooked mode and it's handled as usual.
+///
+///	\param	Ctx		:	Console context
+///	\param	Limit	:	Line discipline limit (see ConsoleCookedLimit)
+///
+///////////////////////////////////////////////////////////
+void ConsoleCooked(CONSOLE_CONTEXT *Ctx, unsigned char Limit)
+{
+	Ctx->cooked = Limit;
+}
+#endif
@@ -27,6 +27,7 @@
 // Optional fetures:
 // press insert        : toggle 'insert'/'overwrite' modes (CONSOLE_INS_MODE    required)
 // press arrow up/down : recall history items              (CONSOLE_MAX_HISTORY required)
+// cooked mode         : characters already echoed by a line discipline (CONSOLE_COOKED_MODE required)
 
 ///////////////////////////////////////////////////////////
 // Console definitions
@@ -34,10 +35,23 @@
 // Prompt string
 #define CONSOLE_PROMPT					">"
 
-// Maximum number of history commands - it costs 972 bytes of ROM (nearly independent from items count inthe range 2 to 6)
+// History mode
 // - set zero to disable history
-// - set one  to enable one history item - it costs 437 bytes of ROM
-#define CONSOLE_MAX_HISTORY				6
+// - set one  to enable history - it costs 437 bytes of ROM for one item
+#define CONSOLE_MAX_HISTORY				1
+
+// History ring (history enabled only): variable length commands, as many as fit (see ConsoleHistoryInit)
+// instead of the last command only
+#define CONSOLE_HISTORY_RING			1
+
+// History ring size in bytes (up to 255), each command takes its length plus one
+// byte: 192 bytes hold six full length commands or many more short ones
+#define CONSOLE_HISTORY_SIZE			192
+
+#if (CONSOLE_MAX_HISTORY == 0)
+#undef	CONSOLE_HISTORY_RING
+#define CONSOLE_HISTORY_RING			0
+#endif
 
 // Maximum length (in bytes) of a command, including parameters
 #define CONSOLE_MAX_COMMAND				32
@@ -48,10 +62,44 @@
 // Console callback user argument - it costs 82 bytes of ROM
 #define CONSOLE_CALLBACK_USER_ARG		0
 
+// Console accepts characters already echoed and assembled by a line discipline (see ConsoleCooked)
+#define CONSOLE_COOKED_MODE				1
+
+// Maximum number of arguments, including the command name (8 at most, see CONSOLE_ARGS numeric)
+#define CONSOLE_MAX_ARGS				6
+
+// Maximum length (in bytes) of a terminal update sent as one burst (keep it within the UART TX FIFO)
+#define CONSOLE_MAX_OUTPUT				16
+
+///////////////////////////////////////////////////////////
+// Console command arguments
+
+// The command line is split once into arguments (separated by spaces); argv[0] is the command name
+typedef struct _CONSOLE_ARGS_
+{
+	unsigned char				argc;							// Number of arguments
+	unsigned char			   *argv[CONSOLE_MAX_ARGS];			// Arguments (zero terminated, inside line)
+	unsigned short				argn[CONSOLE_MAX_ARGS];			// Numeric value of the arguments (0x hex or decimal)
+	unsigned char				numeric;						// Bit n set if argv[n] is a valid number (argn[n] is set)
+	unsigned char				line[CONSOLE_MAX_COMMAND];		// Command line copy
+	
+} CONSOLE_ARGS;
+
+// Mask of CONSOLE_ARGS numeric for the first Count arguments after the command name
+#define CONSOLE_ARGS_NUMERIC(Count)		((unsigned char) (((1 << (Count)) - 1) << 1))
+
 #if (CONSOLE_CALLBACK_USER_ARG != 0)
-	typedef void (*CONSOLE_CALLBACK)(unsigned char *Command, void *Arg);
+	typedef void (*CONSOLE_CALLBACK)(CONSOLE_ARGS *Args, void *Arg);
+
+	// Command handler declaration and command table entry (see commands.h)
+	#define CONSOLE_HANDLER(Name)					void Name(CONSOLE_ARGS *Args, void *Arg)
+	#define CONSOLE_ENTRY(Command, Callback, Help)	{ Command, Callback, 0, Help }
 #else
-	typedef void (*CONSOLE_CALLBACK)(unsigned char *Command);
+	typedef void (*CONSOLE_CALLBACK)(CONSOLE_ARGS *Args);
+
+	// Command handler declaration and command table entry (see commands.h)
+	#define CONSOLE_HANDLER(Name)					void Name(CONSOLE_ARGS *Args)
+	#define CONSOLE_ENTRY(Command, Callback, Help)	{ Command, Callback, Help }
 #endif
 
 ///////////////////////////////////////////////////////////
@@ -102,11 +150,19 @@ typedef struct _CONSOLE_CONTEXT_
 
 	unsigned char				current;		// Buffer current insert position
 	unsigned char				end;			// Buffer end position
+	unsigned char				deferred;		// A command runs in background, no prompt until ConsoleDone
+
+#if (CONSOLE_COOKED_MODE != 0)
+	unsigned char				cooked;			// Number of printable chars still accepted as already echoed
+#endif
 
-#if (CONSOLE_MAX_HISTORY > 1)
-	unsigned char				historyRead;	// History read position
-	unsigned char				historyWrite;	// History write position
-	unsigned char				history[CONSOLE_MAX_HISTORY][CONSOLE_MAX_COMMAND];
+#if (CONSOLE_HISTORY_RING != 0)
+	unsigned char			   *history;		// History ring: zero terminated commands, oldest first
+	unsigned char				historySize;	// History ring size (zero if none)
+	unsigned char				historyUsed;	// History ring bytes in use
+	unsigned char				historyTail;	// Oldest command position
+	unsigned char				historyHead;	// Write position (after the newest command)
+	unsigned char				historyRead;	// Recalled command position
 #endif
 
 #if (CONSOLE_MAX_HISTORY > 0)
@@ -128,3 +184,18 @@ typedef struct _CONSOLE_CONTEXT_
 
 void ConsoleInit	(CONSOLE_CONTEXT *Ctx, const CONSOLE_COMMAND *Command, unsigned char Count);
 void ConsoleAdd		(CONSOLE_CONTEXT *Ctx, unsigned char Byte);
+void ConsoleDefer	(CONSOLE_CONTEXT *Ctx);
+void ConsoleDone	(CONSOLE_CONTEXT *Ctx);
+
+// The command handler called ConsoleDefer and it's not done yet (don't add chars meanwhile)
+#define ConsoleBusy(Ctx)		((Ctx)->deferred != 0)
+
+#if (CONSOLE_HISTORY_RING != 0)
+void		  ConsoleHistoryInit	(CONSOLE_CONTEXT *Ctx, unsigned char *Memory, unsigned char Size);
+unsigned char ConsoleHistoryGet		(CONSOLE_CONTEXT *Ctx, unsigned char Item, unsigned char *Buffer);
+#endif
+
+#if (CONSOLE_COOKED_MODE != 0)
+unsigned char ConsoleCookedLimit	(CONSOLE_CONTEXT *Ctx);
+void		  ConsoleCooked			(CONSOLE_CONTEXT *Ctx, unsigned char Limit);
+#endif
@@ -23,17 +23,41 @@
 ;
 ; Startup code for b65
 
-.export   _init, _exit
-.import   _main
+.export   _init, _exit, cpu_boot
+.import   _main, cpu_resume
 
 .export   __STARTUP__ : absolute = 1        ; Mark as startup
 .import   __RAM_START__, __RAM_SIZE__       ; Linker generated
+.import   __ISTACK_START__, __ISTACK_SIZE__ ; Linker generated
+.import   __ZPSHADOW_START__                ; Linker generated
 .import   __STACKSIZE__                     ; Linker generated
+.import   __REG_START__                     ; Linker generated (registers base, see memory.map)
+.import   _g_boot_time, _g_boot_warm        ; Boot time markers (see boot.c)
 
 .import    copydata, zerobss, initlib, donelib
 
 .include  "zeropage.inc"
 
+REGTMR  = __REG_START__ + $20       ; Timer registers (see extension.h)
+REGINT  = __REG_START__ + $30       ; Interrupt controller registers (see extension.h)
+
+INT_BOOT_RAM_CLEAN = $01            ; R_INT_BOOT, RAM zero since the FPGA configuration
+INT_BOOT_CHECKPOINT = $02           ; R_INT_BOOT, simulation restored from a checkpoint
+
+; ---------------------------------------------------------------------------
+; Stamp the end of a boot phase with the microseconds counter (see boot.h)
+
+.macro    BOOT_MARK Phase
+          LDA     REGTMR+8             ; Microseconds [7:0], it latches the others
+          STA     _g_boot_time+(Phase)*4
+          LDA     REGTMR+9
+          STA     _g_boot_time+(Phase)*4+1
+          LDA     REGTMR+10
+          STA     _g_boot_time+(Phase)*4+2
+          LDA     REGTMR+11
+          STA     _g_boot_time+(Phase)*4+3
+.endmacro
+
 ; ---------------------------------------------------------------------------
 ; Place the startup code in a special segment
 
@@ -44,16 +68,67 @@
 
 _init:    CLD                          ; Clear decimal mode
 
+          ; Boot status, before the first RAM write clears the RAM clean bit
+          LDX     REGINT+6             ; R_INT_BOOT
+
+          ; The RAM survives any reset: a resume block left in page 0 is trusted only in a
+          ; simulation restored from a checkpoint
+          TXA
+          AND     #INT_BOOT_CHECKPOINT
+          BEQ     cpu_boot
+          JMP     cpu_resume           ; Simulation checkpoint (see direct.s), back to cpu_boot if none
+
+cpu_boot:                              ; X = boot status
+          ; Reset stamp, on the CPU stack until BSS is ready
+          LDA     REGTMR+8             ; Microseconds [7:0], it latches the others
+          PHA
+          LDA     REGTMR+9
+          PHA
+          LDA     REGTMR+10
+          PHA
+          LDA     REGTMR+11
+          PHA
+          TXA                          ; Boot status
+          PHA
+
           ; Set stack
           LDA     #<(__RAM_START__ + __RAM_SIZE__ + __STACKSIZE__)
           LDX     #>(__RAM_START__ + __RAM_SIZE__ + __STACKSIZE__)
           STA     sp
           STX     sp+1
 
-          ; Call initialize functions
+          ; Set IRQ handlers stack in the shadow zero page (see isr.s)
+          LDA     #<(__ISTACK_START__ + __ISTACK_SIZE__)
+          LDX     #>(__ISTACK_START__ + __ISTACK_SIZE__)
+          STA     __ZPSHADOW_START__ + sp
+          STX     __ZPSHADOW_START__ + sp + 1
+
+          ; Clear BSS unless the RAM is still zero from the FPGA configuration: no reset
+          ; clears the RAM block (reset button, reboot, upgrade), only the boot status
+          ; proves it untouched (see intc.vhd Reg[6])
+          PLA                          ; Boot status
+          LDX     #$01                 ; g_boot_warm = 1 : BSS zero from the FPGA configuration
+          AND     #INT_BOOT_RAM_CLEAN
+          BNE     bss_ready
           JSR     zerobss              ; Clear BSS segment
+          LDX     #$02                 ; g_boot_warm = 2 : BSS cleared
+bss_ready:
+          STX     _g_boot_warm
+
+          PLA                          ; BOOT_RESET stamp
+          STA     _g_boot_time+3
+          PLA
+          STA     _g_boot_time+2
+          PLA
+          STA     _g_boot_time+1
+          PLA
+          STA     _g_boot_time
+          BOOT_MARK 1                  ; BOOT_BSS
+
+          ; Call initialize functions (DATA is a few bytes, nothing to gain with a faster copy)
           JSR     copydata             ; Initialize DATA segment
           JSR     initlib              ; Run constructors
+          BOOT_MARK 2                  ; BOOT_MAIN
 
           ; Call main()
           JSR     _main
@@ -21,7 +21,21 @@
 ;
 ; Direct low level routines
 
-.export   _reboot
+.export   _reboot, _cpu_wait, _cpu_wait_probe, cpu_resume
+.import   _resume, cpu_boot
+.import   __REG_START__               ; Linker generated (registers base, see memory.map)
+
+REGTMR  = __REG_START__ + $20       ; Timer registers                (see extension.h)
+REGINT  = __REG_START__ + $30       ; Interrupt controller registers (see extension.h)
+
+INT_TIMER   = $04                   ; Timer interrupt source (see extension.h)
+PROBE_US    = 20                    ; cpu_wait_probe timer period (100 CPU cycles)
+
+; Simulation checkpoint resume block, at the top of page 0 (out of the ZP area, see b65.cfg)
+RESUME_MARK = $FC                   ; RESUME_VALID while the CPU sleeps in cpu_wait
+RESUME_SP   = $FD                   ; CPU stack pointer
+RESUME_INT  = $FE                   ; R_INT_ENABLE
+RESUME_VALID = $B6
 
 .segment  "CODE"
 .PC02                             ; Force 65C02 assembly mode
@@ -31,3 +45,111 @@
 
 _reboot:
             JMP ($FFFC)           ; Jump to reset vector
+
+
+; ---------------------------------------------------------------------------
+; Stop the CPU until an interrupt arrives
+;
+; The caller disables the interrupts (SEI) before checking for pending
+; events, then calls this routine only if there is nothing to do.
+; WAI runs with the interrupts still disabled: it goes on as soon as the
+; IRQ line is low (at once if an interrupt arrived after the check), then
+; CLI services the interrupt before returning, so no wake up waits for the
+; next one (SEI, WAI, CLI: the W65C02S idiom).
+;
+; WAI is a WDC W65C02S opcode, the Rockwell R65C02 followed by the r65c02_tc
+; core has no WAI: top.vhd feeds the core a NOP for it and holds the core
+; (RDY low) until the IRQ line goes low. main() runs cpu_wait_probe at every
+; boot and the boot command shows the result; with a core running WAI as a
+; NOP the task loop polls instead of sleeping and a simulation checkpoint
+; never finds the CPU idle (b65.vhd reports it)
+;
+; While sleeping the CPU state is only the stack pointer and the return
+; address on the stack: both are saved in the resume block with the enabled
+; interrupt sources, so a simulation checkpoint taken here (see b65.vhd) can
+; go on from the RAM content alone (see cpu_resume)
+
+_cpu_wait:
+            TSX                   ; Resume block
+            STX RESUME_SP
+            LDA REGINT            ; R_INT_ENABLE
+            STA RESUME_INT
+            LDA #RESUME_VALID
+            STA RESUME_MARK
+cpu_sleep:
+            .byte $CB             ; WAI, interrupts disabled: goes on when the IRQ line is low
+            STZ RESUME_MARK       ; Awake, the block is stale
+            CLI                   ; The interrupt is serviced here
+            RTS
+
+
+; ---------------------------------------------------------------------------
+; Check if WAI stops the CPU (C callable, unsigned char cpu_wait_probe(void))
+;
+; A one-shot timer interrupt is armed PROBE_US microseconds ahead, then WAI
+; runs with the interrupts disabled: a real WAI goes on when the IRQ line
+; goes low (the interrupt is not serviced), a NOP goes on at once. The timer
+; pending bit right after it tells which one ran. The timer is left stopped
+; and the interrupt enables are restored (call it before starting the timer)
+;
+; Returns 1 if WAI waited for the interrupt, 0 if it ran as a NOP
+
+_cpu_wait_probe:
+            PHP                   ; Save the interrupt disable flag
+            SEI
+            LDA REGINT            ; R_INT_ENABLE, the timer source only
+            PHA
+            LDA #INT_TIMER
+            STA REGINT
+            STA REGINT+2          ; R_INT_ACK, no stale trigger
+            STZ REGTMR            ; R_TMR_CTRL, stop
+            LDA #$01
+            STA REGTMR+1          ; R_TMR_STATUS, clear expired
+            LDA #49               ; R_TMR_PRESCALER, 1MHz tick
+            STA REGTMR+2
+            STZ REGTMR+3
+            LDA #PROBE_US-1       ; R_TMR_RELOAD
+            STA REGTMR+4
+            STZ REGTMR+5
+            LDA #$05              ; R_TMR_CTRL, one-shot, interrupt and run
+            STA REGTMR
+            .byte $CB             ; WAI
+            LDA REGINT+1          ; R_INT_PENDING, the timer is pending only after a wait
+            AND #INT_TIMER
+            TAX
+            STZ REGTMR            ; R_TMR_CTRL, stop
+            LDA #INT_TIMER
+            STA REGINT+2          ; R_INT_ACK
+            PLA
+            STA REGINT            ; R_INT_ENABLE
+            PLP                   ; Restore the interrupt disable flag
+            TXA
+            BEQ probe_done
+            LDA #$01
+probe_done:
+            LDX #$00
+            RTS
+
+
+; ---------------------------------------------------------------------------
+; Resume a simulation checkpoint (jumped to by crt0.s only when the boot
+; status tells a restored simulation, X is the boot status for cpu_boot)
+;
+; Goes on with the boot if the resume block is not valid, otherwise it goes
+; back to sleep in cpu_wait with the saved stack: the devices are out of
+; reset, resume() sets them again before the interrupts are enabled.
+; Nothing is pushed before the stack pointer is restored: the reset one
+; points inside the saved stack.
+
+cpu_resume:
+            LDA RESUME_MARK
+            CMP #RESUME_VALID
+            BEQ resume_valid
+            JMP cpu_boot
+resume_valid:
+            LDX RESUME_SP         ; Back to the cpu_wait caller stack
+            TXS
+            JSR _resume           ; Devices setup (see main.c)
+            LDA RESUME_INT
+            STA REGINT            ; R_INT_ENABLE
+            BRA cpu_sleep
\ No newline at end of file
@@ -15,8 +15,10 @@
 //     You should have received a copy of the GNU General Public License
 //     along with B65.  If not, see <http://www.gnu.org/licenses/>.
 
-// Extension registers
-#define REGEXT_BASE				0xDC00
+#include "memory.h"
+
+// Extension registers (see extension.vhd)
+#define REGEXT_BASE				(MAP_START_REG + 0x00)
 
 #define R_MODE					(*((unsigned char*) REGEXT_BASE + 0x00))
 #define R_OUT0					(*((unsigned char*) REGEXT_BASE + 0x01))
@@ -34,3 +36,115 @@
 #define R_RX_COUNT				(*((unsigned char*) REGEXT_BASE + 0x0D))
 #define R_RX					(*((unsigned char*) REGEXT_BASE + 0x0E))
 #define R_TX					(*((unsigned char*) REGEXT_BASE + 0x0F))
+#define R_TX_FREE				(*((unsigned char*) REGEXT_BASE + 0x0F))		// Read only (write is R_TX)
+#define R_COOKED_LIMIT			(*((unsigned char*) REGEXT_BASE + 0x0D))		// Write only (read is R_RX_COUNT)
+
+// R_MODE bits
+#define MODE_TX_IRQ				0x80
+#define MODE_COOKED				0x40
+
+// CRC accelerator registers (see crc.vhd)
+#define REGCRC_BASE				(MAP_START_REG + 0x10)
+
+#define R_CRC_CTRL				(*((unsigned char*)  REGCRC_BASE + 0x00))
+#define R_CRC_SEED				(*((unsigned long*) (REGCRC_BASE + 0x01)))
+#define R_CRC_RESULT			(*((unsigned long*) (REGCRC_BASE + 0x05)))
+#define R_CRC_DATA				(*((unsigned char*)  REGCRC_BASE + 0x09))
+#define R_CRC_ADDRESS			(*((unsigned short*)(REGCRC_BASE + 0x0A)))
+#define R_CRC_LENGTH			(*((unsigned short*)(REGCRC_BASE + 0x0C)))
+
+// R_CRC_CTRL bits
+#define CRC_CTRL_BUSY			0x80
+#define CRC_CTRL_START			0x04
+#define CRC_CTRL_SEED			0x02
+#define CRC_CTRL_32				0x01
+
+// Timer registers (see timer.vhd)
+#define REGTMR_BASE				(MAP_START_REG + 0x20)
+
+#define R_TMR_CTRL				(*((unsigned char*)  REGTMR_BASE + 0x00))
+#define R_TMR_STATUS			(*((unsigned char*)  REGTMR_BASE + 0x01))
+#define R_TMR_PRESCALER			(*((unsigned short*)(REGTMR_BASE + 0x02)))
+#define R_TMR_RELOAD			(*((unsigned short*)(REGTMR_BASE + 0x04)))
+#define R_TMR_COUNTER0			(*((unsigned char*)  REGTMR_BASE + 0x06))		// Read first, it latches R_TMR_COUNTER1
+#define R_TMR_COUNTER1			(*((unsigned char*)  REGTMR_BASE + 0x07))
+#define R_TMR_MICROSECONDS0		(*((unsigned char*)  REGTMR_BASE + 0x08))		// Read first, it latches R_TMR_MICROSECONDS1..3
+#define R_TMR_MICROSECONDS1		(*((unsigned char*)  REGTMR_BASE + 0x09))
+#define R_TMR_MICROSECONDS2		(*((unsigned char*)  REGTMR_BASE + 0x0A))
+#define R_TMR_MICROSECONDS3		(*((unsigned char*)  REGTMR_BASE + 0x0B))
+
+// R_TMR_CTRL bits
+#define TMR_CTRL_IRQ			0x04
+#define TMR_CTRL_PERIODIC		0x02
+#define TMR_CTRL_RUN			0x01
+
+// R_TMR_STATUS bits
+#define TMR_STATUS_EXPIRED		0x01
+
+// Interrupt controller registers (see intc.vhd)
+#define REGINT_BASE				(MAP_START_REG + 0x30)
+
+#define R_INT_ENABLE			(*((unsigned char*)  REGINT_BASE + 0x00))
+#define R_INT_PENDING			(*((unsigned char*)  REGINT_BASE + 0x01))
+#define R_INT_ACK				(*((unsigned char*)  REGINT_BASE + 0x02))
+#define R_INT_VECTOR			(*((unsigned char*)  REGINT_BASE + 0x03))
+#define R_INT_ACTIVE			(*((unsigned char*)  REGINT_BASE + 0x04))
+#define R_INT_ZP				(*((unsigned char*)  REGINT_BASE + 0x05))
+#define R_INT_BOOT				(*((unsigned char*)  REGINT_BASE + 0x06))
+
+// R_INT_ZP bits
+#define INT_ZP_SHADOW_ACTIVE	0x80
+#define INT_ZP_SHADOW			0x02
+#define INT_ZP_AUTO				0x01
+
+// R_INT_BOOT bits
+#define INT_BOOT_CHECKPOINT		0x02
+#define INT_BOOT_RAM_CLEAN		0x01
+
+// Interrupt sources (bit number is the priority, 0 is the highest)
+#define INT_UART				0x01
+#define INT_INPUT				0x02
+#define INT_TIMER				0x04
+#define INT_EVENT				0x08
+#define INT_SERIAL0				0x10
+#define INT_SERIAL1				0x20
+#define INT_SERIAL2				0x40
+#define INT_SERIAL3				0x80
+
+// Input events registers (see input-event.vhd)
+#define REGEVT_BASE				(MAP_START_REG + 0x40)
+
+#define R_EVT_COUNT				(*((unsigned char*)  REGEVT_BASE + 0x00))
+#define R_EVT_CTRL				(*((unsigned char*)  REGEVT_BASE + 0x01))
+#define R_EVT_CHANGED0			(*((unsigned char*)  REGEVT_BASE + 0x02))
+#define R_EVT_CHANGED1			(*((unsigned char*)  REGEVT_BASE + 0x03))
+#define R_EVT_CHANGED2			(*((unsigned char*)  REGEVT_BASE + 0x04))
+#define R_EVT_VALUE0			(*((unsigned char*)  REGEVT_BASE + 0x05))
+#define R_EVT_VALUE1			(*((unsigned char*)  REGEVT_BASE + 0x06))
+#define R_EVT_VALUE2			(*((unsigned char*)  REGEVT_BASE + 0x07))
+#define R_EVT_TIME				(*((unsigned long*) (REGEVT_BASE + 0x08)))
+
+// R_EVT_CTRL bits
+#define EVT_CTRL_OVERFLOW		0x80
+#define EVT_CTRL_POP			0x01
+
+// Serial channels registers (see serial.vhd), 16 registers for each channel
+#define REGSER_BASE(Channel)	(MAP_START_REG + 0x50 + ((Channel) << 4))
+
+#define R_SER_CTRL(Channel)		(*((unsigned char*)  REGSER_BASE(Channel) + 0x00))
+#define R_SER_STATUS(Channel)	(*((unsigned char*)  REGSER_BASE(Channel) + 0x01))
+#define R_SER_DIVISOR(Channel)	(*((unsigned short*)(REGSER_BASE(Channel) + 0x02)))
+#define R_SER_RX_COUNT(Channel)	(*((unsigned char*)  REGSER_BASE(Channel) + 0x04))
+#define R_SER_TX_FREE(Channel)	(*((unsigned char*)  REGSER_BASE(Channel) + 0x05))
+#define R_SER_RX(Channel)		(*((unsigned char*)  REGSER_BASE(Channel) + 0x06))
+#define R_SER_TX(Channel)		(*((unsigned char*)  REGSER_BASE(Channel) + 0x07))
+
+// R_SER_CTRL bits
+#define SER_CTRL_TX_IRQ			0x02
+#define SER_CTRL_RX_IRQ			0x01
+
+// R_SER_STATUS bits
+#define SER_STATUS_OVERFLOW		0x80
+#define SER_STATUS_TX_FULL		0x04
+#define SER_STATUS_TX_IDLE		0x02
+#define SER_STATUS_RX_READY		0x01
\ No newline at end of file
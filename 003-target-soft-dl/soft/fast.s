@@ -0,0 +1,296 @@
+; Copyright 2023 Luca Bertossi
+;
+; This file is part of B65.
+; 
+;     B65 is free software: you can redistribute it and/or modify
+;     it under the terms of the GNU General Public License as published by
+;     the Free Software Foundation, either version 3 of the License, or
+;     (at your option) any later version.
+; 
+;     B65 is distributed in the hope that it will be useful,
+;     but WITHOUT ANY WARRANTY; without even the implied warranty of
+;     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+;     GNU General Public License for more details.
+; 
+;     You should have received a copy of the GNU General Public License
+;     along with B65.  If not, see <http://www.gnu.org/licenses/>.
+
+; ---------------------------------------------------------------------------
+; fast.s
+; ---------------------------------------------------------------------------
+;
+; Hand written 65C02 versions of the firmware hot routines
+;
+; They replace the C versions with the same names (uart.c, lib.c) when the build
+; switch SOFT_ASM is 1 (see b65.sh and lib.h), with SOFT_ASM 0 this file is empty.
+;
+; cc65 __fastcall__ convention: the last argument is in A (char) or A/X (pointer),
+; the others are on the C stack (sp) and the callee removes them; the result is in
+; A/X. A, X, Y and the zero page ptr1..ptr4, tmp1..tmp4 are scratch.
+;
+; The cycles below are counted from the instructions (no wait for a full TX ring);
+; the console command bench measures both builds on the board
+
+.include  "zeropage.inc"
+
+.ifndef SOFT_ASM
+SOFT_ASM = 1
+.endif
+
+.if SOFT_ASM
+
+.export   _uartPutstring, _uartPutHexByte
+.export   _StrToNum
+.export   _BufferShiftRight, _BufferShiftLeft
+.import   _g_uart_tx_ring, _g_uart_tx_head, _g_uart_tx_tail
+.import   _uartTxKick
+.import   incsp2
+
+.segment  "RODATA"
+
+hex_digits:
+            .byte "0123456789ABCDEF"
+
+.segment  "CODE"
+
+.PC02                             ; Force 65C02 assembly mode
+
+; ---------------------------------------------------------------------------
+; Queue the char in A at the TX ring write index X (not published), wait while
+; the TX ring is full; it returns the next write index in X, Y is preserved
+
+tx_queue:
+            STA _g_uart_tx_ring,X ; Store at the write index (that slot is never in use)
+            INX                   ; Next write index
+            CPX _g_uart_tx_tail   ; If equal to the read index the ring is full
+            BEQ tx_queue_full
+            RTS
+tx_queue_full:
+            DEX                   ; Not queued, one slot is always empty
+            STX _g_uart_tx_head   ; Publish the queued chars
+            PHA                   ; Save A and Y (uartTxKick changes A, X and Y)
+            PHY
+            JSR _uartTxKick       ; Move chars to the TX fifo, a slot is freed sooner or later
+            PLY
+            PLA
+            LDX _g_uart_tx_head   ; Reload the write index
+            BRA tx_queue          ; Try again
+
+; ---------------------------------------------------------------------------
+; Put a string to the UART (void uartPutstring(const unsigned char *st))
+;
+; The string is queued, it waits only while the TX ring is full.
+; 25 cycles per char
+
+_uartPutstring:
+            STA ptr1              ; ptr1 = st
+            STX ptr1+1
+            LDX _g_uart_tx_head   ; X = TX ring write index
+            LDY #$00              ; Y = string index
+putstring_next:
+            LDA (ptr1),Y          ; Load the next char
+            BEQ putstring_done    ; Zero terminator
+            STA _g_uart_tx_ring,X ; Store at the write index (that slot is never in use)
+            INX                   ; Next write index
+            CPX _g_uart_tx_tail   ; If equal to the read index the ring is full
+            BEQ putstring_full
+putstring_char:
+            INY                   ; Next char
+            BNE putstring_next
+            INC ptr1+1            ; Next string page
+            BRA putstring_next
+putstring_full:
+            DEX                   ; Not queued
+            JSR tx_queue          ; Wait for a free slot and queue it
+            BRA putstring_char
+putstring_done:
+            STX _g_uart_tx_head   ; Publish the queued chars
+            JMP _uartTxKick       ; Start the transmission
+
+; ---------------------------------------------------------------------------
+; Put a hex byte to the UART (void uartPutHexByte(const unsigned char Byte))
+;
+; Table driven nibble to hex, both chars are queued with one kick.
+; 89 cycles plus the kick
+
+_uartPutHexByte:
+            STA tmp1              ; tmp1 = Byte
+            LSR A                 ; A = high nibble
+            LSR A
+            LSR A
+            LSR A
+            TAY
+            LDA hex_digits,Y      ; Nibble to hex char
+            LDX _g_uart_tx_head   ; X = TX ring write index
+            JSR tx_queue
+            LDA tmp1              ; A = low nibble
+            AND #$0F
+            TAY
+            LDA hex_digits,Y      ; Nibble to hex char
+            JSR tx_queue
+            STX _g_uart_tx_head   ; Publish the queued chars
+            JMP _uartTxKick       ; Start the transmission
+
+; ---------------------------------------------------------------------------
+; Convert a number string to short integer, hex with 0x prefix or decimal
+; (unsigned char StrToNum(const unsigned char *Str, unsigned short *Value))
+;
+; Same results of the C version (lib.c): the value wraps around over 0xFFFF,
+; Value is set only if the string is a valid number (the result is 1).
+; About 95 cycles per digit
+
+_StrToNum:
+            STA ptr2              ; ptr2 = Value
+            STX ptr2+1
+            LDA (sp)              ; ptr1 = Str (C stack)
+            STA ptr1
+            LDY #$01
+            LDA (sp),Y
+            STA ptr1+1
+            STZ tmp1              ; tmp1/tmp2 = Number
+            STZ tmp2
+            STZ tmp3              ; tmp3 = hex flag (bit 7)
+            LDY #$00              ; Y = string index
+            LDA (ptr1),Y          ; '0x' or '0X' prefix
+            CMP #'0'
+            BNE strtonum_first
+            INY
+            LDA (ptr1),Y
+            ORA #$20              ; To lower case
+            CMP #'x'
+            BNE strtonum_decimal
+            DEC tmp3              ; Hex (0xFF)
+            INY
+            BRA strtonum_first
+strtonum_decimal:
+            LDY #$00              ; Decimal from the first char
+strtonum_first:
+            LDA (ptr1),Y          ; An empty string is not a number
+            BEQ strtonum_invalid
+strtonum_char:
+            SEC                   ; '0' - '9'
+            SBC #'0'
+            CMP #10
+            BCC strtonum_digit
+            BIT tmp3              ; Letters only if hex
+            BPL strtonum_invalid
+            LDA (ptr1),Y          ; 'a' - 'f' or 'A' - 'F'
+            ORA #$20              ; To lower case
+            SEC
+            SBC #'a'
+            CMP #6
+            BCS strtonum_invalid
+            ADC #10               ; Carry is clear
+strtonum_digit:
+            BIT tmp3
+            BPL strtonum_times10
+            LDX #$04              ; Number = (Number << 4) | Digit
+strtonum_shift:
+            ASL tmp1
+            ROL tmp2
+            DEX
+            BNE strtonum_shift
+            ORA tmp1
+            STA tmp1
+            BRA strtonum_next
+strtonum_times10:
+            STA tmp4              ; tmp4 = Digit
+            ASL tmp1              ; Number * 2
+            ROL tmp2
+            LDA tmp1              ; A/X = Number * 2
+            LDX tmp2
+            ASL tmp1              ; Number * 8
+            ROL tmp2
+            ASL tmp1
+            ROL tmp2
+            CLC                   ; Number * 10 = Number * 8 + Number * 2
+            ADC tmp1
+            STA tmp1
+            TXA
+            ADC tmp2
+            STA tmp2
+            LDA tmp4              ; Number * 10 + Digit
+            CLC
+            ADC tmp1
+            STA tmp1
+            BCC strtonum_next
+            INC tmp2
+strtonum_next:
+            INY                   ; Next char (up to 255 chars)
+            BEQ strtonum_invalid
+            LDA (ptr1),Y
+            BNE strtonum_char
+            LDA tmp1              ; Valid: store Value
+            STA (ptr2)
+            LDA tmp2
+            LDY #$01
+            STA (ptr2),Y
+            LDA #$01              ; Return 1
+            BRA strtonum_exit
+strtonum_invalid:
+            LDA #$00              ; Return 0
+strtonum_exit:
+            LDX #$00
+            JMP incsp2            ; Remove Str from the C stack (A and X are preserved)
+
+; ---------------------------------------------------------------------------
+; Shift a buffer one byte right: Data[1..Count] = Data[0..Count-1]
+; (void BufferShiftRight(unsigned char *Data, unsigned char Count))
+;
+; 16 cycles per byte
+
+_BufferShiftRight:
+            STA tmp1              ; tmp1 = Count
+            LDA (sp)              ; ptr2 = Data (C stack)
+            STA ptr2
+            LDY #$01
+            LDA (sp),Y
+            STA ptr2+1
+            LDA ptr2              ; ptr1 = Data - 1
+            SEC
+            SBC #$01
+            STA ptr1
+            LDA ptr2+1
+            SBC #$00
+            STA ptr1+1
+            LDY tmp1              ; Y = Count, from the last byte down
+            BEQ shiftright_done
+shiftright_next:
+            LDA (ptr1),Y          ; Data[Y] = Data[Y - 1]
+            STA (ptr2),Y
+            DEY
+            BNE shiftright_next
+shiftright_done:
+            JMP incsp2            ; Remove Data from the C stack
+
+; ---------------------------------------------------------------------------
+; Shift a buffer one byte left: Data[0..Count-1] = Data[1..Count]
+; (void BufferShiftLeft(unsigned char *Data, unsigned char Count))
+;
+; 18 cycles per byte
+
+_BufferShiftLeft:
+            TAX                   ; X = Count
+            LDA (sp)              ; ptr2 = Data (C stack), ptr1 = Data + 1
+            STA ptr2
+            CLC
+            ADC #$01
+            STA ptr1
+            LDY #$01
+            LDA (sp),Y
+            STA ptr2+1
+            ADC #$00
+            STA ptr1+1
+            TXA
+            BEQ shiftleft_done
+            LDY #$00              ; Y = index, from the first byte up
+shiftleft_next:
+            LDA (ptr1),Y          ; Data[Y] = Data[Y + 1]
+            STA (ptr2),Y
+            INY
+            DEX
+            BNE shiftleft_next
+shiftleft_done:
+            JMP incsp2            ; Remove Data from the C stack
+
+.endif
\ No newline at end of file
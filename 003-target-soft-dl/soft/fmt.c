@@ -0,0 +1,277 @@
+// Copyright 2023 Luca Bertossi
+//
+// This file is part of B65.
+// 
+//     B65 is free software: you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation, either version 3 of the License, or
+//     (at your option) any later version.
+// 
+//     B65 is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+// 
+//     You should have received a copy of the GNU General Public License
+//     along with B65.  If not, see <http://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////
+// Includes
+
+#include "uart.h"
+#include "fmt.h"
+
+///////////////////////////////////////////////////////////
+// Globals
+
+const unsigned char	g_fmt_hex[16] = "0123456789ABCDEF";
+
+// Powers of ten for the subtract conversion (the units are what is left)
+static const unsigned short	g_fmt_power16[4] = { 10000, 1000, 100, 10 };
+static const unsigned long	g_fmt_power32[9] = { 1000000000, 100000000, 10000000, 1000000, 100000, 10000, 1000, 100, 10 };
+
+// Output buffer (see fmtStart)
+static unsigned char	   *g_fmt_buffer;
+static unsigned char		g_fmt_size;
+static unsigned char		g_fmt_length;
+
+///////////////////////////////////////////////////////////
+// Functions
+
+///////////////////////////////////////////////////////////
+///
+/// Start a formatted output into a caller buffer
+///
+///	\param	Buffer		:	Output buffer
+///	\param	Size		:	Buffer size (the flush burst size)
+///
+///////////////////////////////////////////////////////////
+void fmtStart(unsigned char *Buffer, unsigned char Size)
+{
+	g_fmt_buffer	= Buffer;
+	g_fmt_size		= Size;
+	g_fmt_length	= 0;
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Queue the buffer to the UART in one burst
+///
+/// It waits only while the TX ring is full
+///
+///////////////////////////////////////////////////////////
+void fmtFlush(void)
+{
+	unsigned char	Sent = 0;
+
+	while (Sent < g_fmt_length)
+		Sent += uartWriteBuffer(g_fmt_buffer + Sent, g_fmt_length - Sent);
+
+	g_fmt_length = 0;
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Add a char
+///
+///	\param	ch			:	Char to add
+///
+///////////////////////////////////////////////////////////
+void fmtChar(unsigned char ch)
+{
+	if (g_fmt_length == g_fmt_size)
+		fmtFlush();
+
+	g_fmt_buffer[g_fmt_length++] = ch;
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Add a string
+///
+///	\param	Str			:	Zero terminated string
+///
+///////////////////////////////////////////////////////////
+void fmtString(const unsigned char *Str)
+{
+	while (*Str)
+		fmtChar(*Str++);
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Add a char several times (padding)
+///
+///	\param	ch			:	Pad char
+///	\param	Count		:	Number of chars
+///
+///////////////////////////////////////////////////////////
+void fmtPad(unsigned char ch, unsigned char Count)
+{
+	while (Count--)
+		fmtChar(ch);
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Add a hex byte (two digits, no prefix)
+///
+///	\param	Value		:	Byte
+///
+///////////////////////////////////////////////////////////
+void fmtHex8(unsigned char Value)
+{
+	fmtChar(g_fmt_hex[Value >> 4]);
+	fmtChar(g_fmt_hex[Value & 0x0F]);
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Add a hex short (four digits, no prefix)
+///
+///	\param	Value		:	Short
+///
+///////////////////////////////////////////////////////////
+void fmtHex16(unsigned short Value)
+{
+	fmtHex8(Value >> 8);
+	fmtHex8(Value);
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Add a hex long (eight digits, no prefix)
+///
+///	\param	Value		:	Long
+///
+///////////////////////////////////////////////////////////
+void fmtHex32(unsigned long Value)
+{
+	fmtHex16(Value >> 16);
+	fmtHex16(Value);
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Add the decimal digits with the width padding
+///
+///	\param	Digits		:	Digits (no leading zeros)
+///	\param	Count		:	Number of digits
+///	\param	Width		:	Minimum width, FMT_ZERO to pad with '0'
+///	\param	Sign		:	'-' or 0 for none
+///
+///////////////////////////////////////////////////////////
+static void fmtDigits(const unsigned char *Digits, unsigned char Count, unsigned char Width, unsigned char Sign)
+{
+	unsigned char	Pad		= Width & ~FMT_ZERO;
+	unsigned char	Length	= Sign ? Count + 1 : Count;
+	unsigned char	Index;
+
+	Pad = (Pad > Length) ? Pad - Length : 0;
+
+	// The sign goes before the zeros and after the spaces
+	if ((Width & FMT_ZERO) == 0)
+		fmtPad(' ', Pad);
+	if (Sign)
+		fmtChar(Sign);
+	if (Width & FMT_ZERO)
+		fmtPad('0', Pad);
+
+	for (Index = 0; Index < Count; Index++)
+		fmtChar(Digits[Index]);
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Add a short magnitude in decimal with a sign
+///
+///	\param	Value		:	Magnitude
+///	\param	Width		:	Minimum width, FMT_ZERO to pad with '0'
+///	\param	Sign		:	'-' or 0 for none
+///
+///////////////////////////////////////////////////////////
+static void fmtDecimalSign(unsigned short Value, unsigned char Width, unsigned char Sign)
+{
+	unsigned char	Digits[5];
+	unsigned char	Count = 0;
+	unsigned char	Index;
+	unsigned char	Digit;
+
+	for (Index = 0; Index < sizeof(g_fmt_power16) / sizeof(unsigned short); Index++)
+	{
+		for (Digit = '0'; Value >= g_fmt_power16[Index]; Digit++)
+			Value -= g_fmt_power16[Index];
+
+		if ((Count != 0) || (Digit != '0'))
+			Digits[Count++] = Digit;
+	}
+
+	Digits[Count++] = '0' + (unsigned char) Value;
+
+	fmtDigits(Digits, Count, Width, Sign);
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Add an unsigned short in decimal
+///
+///	\param	Value		:	Short
+///	\param	Width		:	Minimum width, FMT_ZERO to pad with '0'
+///
+///////////////////////////////////////////////////////////
+void fmtDecimal(unsigned short Value, unsigned char Width)
+{
+	fmtDecimalSign(Value, Width, 0);
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Add a signed short in decimal
+///
+///	\param	Value		:	Short
+///	\param	Width		:	Minimum width (with the sign), FMT_ZERO to pad with '0'
+///
+///////////////////////////////////////////////////////////
+void fmtSigned(short Value, unsigned char Width)
+{
+	// -32768 wraps to itself, 0x8000 is its magnitude
+	if (Value < 0)
+		fmtDecimalSign(-Value, Width, '-');
+	else
+		fmtDecimalSign(Value, Width, 0);
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Add an unsigned long in decimal (the short values take
+/// the short table)
+///
+///	\param	Value		:	Long
+///	\param	Width		:	Minimum width, FMT_ZERO to pad with '0'
+///
+///////////////////////////////////////////////////////////
+void fmtDecimalLong(unsigned long Value, unsigned char Width)
+{
+	unsigned char	Digits[10];
+	unsigned char	Count = 0;
+	unsigned char	Index;
+	unsigned char	Digit;
+
+	if ((Value >> 16) == 0)
+	{
+		fmtDecimalSign(Value, Width, 0);
+		return;
+	}
+
+	for (Index = 0; Index < sizeof(g_fmt_power32) / sizeof(unsigned long); Index++)
+	{
+		for (Digit = '0'; Value >= g_fmt_power32[Index]; Digit++)
+			Value -= g_fmt_power32[Index];
+
+		if ((Count != 0) || (Digit != '0'))
+			Digits[Count++] = Digit;
+	}
+
+	Digits[Count++] = '0' + (unsigned char) Value;
+
+	fmtDigits(Digits, Count, Width, 0);
+}
\ No newline at end of file
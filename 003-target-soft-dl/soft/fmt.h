@@ -0,0 +1,51 @@
+// Copyright 2023 Luca Bertossi
+//
+// This file is part of B65.
+// 
+//     B65 is free software: you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation, either version 3 of the License, or
+//     (at your option) any later version.
+// 
+//     B65 is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+// 
+//     You should have received a copy of the GNU General Public License
+//     along with B65.  If not, see <http://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////
+// Formatted output (no printf, no runtime division)
+//
+// The builder calls append to the buffer given to fmtStart, fmtFlush queues it to the
+// UART in one burst (a full buffer is flushed on its own). Hex digits come from a table,
+// decimal digits from a powers of ten subtract table (at most 9 subtractions a digit).
+//
+// One output at a time: start, build and flush without yielding (see task.h).
+
+///////////////////////////////////////////////////////////
+// Defines
+
+// Decimal width flag: pad with '0' instead of ' ' (fmtDecimal(Value, 2 | FMT_ZERO) -> "07")
+#define FMT_ZERO			0x80
+
+// Hex digits table (shared with uart.c)
+extern const unsigned char	g_fmt_hex[16];
+
+///////////////////////////////////////////////////////////
+// Functions
+
+void			fmtStart		(unsigned char *Buffer, unsigned char Size);
+void			fmtFlush		(void);
+
+void			fmtChar			(unsigned char ch);
+void			fmtString		(const unsigned char *Str);
+void			fmtPad			(unsigned char ch, unsigned char Count);
+
+void			fmtHex8			(unsigned char Value);
+void			fmtHex16		(unsigned short Value);
+void			fmtHex32		(unsigned long Value);
+
+void			fmtDecimal		(unsigned short Value, unsigned char Width);
+void			fmtDecimalLong	(unsigned long Value, unsigned char Width);
+void			fmtSigned		(short Value, unsigned char Width);
\ No newline at end of file
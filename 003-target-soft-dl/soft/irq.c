@@ -0,0 +1,61 @@
+// Copyright 2023 Luca Bertossi
+//
+// This file is part of B65.
+// 
+//     B65 is free software: you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation, either version 3 of the License, or
+//     (at your option) any later version.
+// 
+//     B65 is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+// 
+//     You should have received a copy of the GNU General Public License
+//     along with B65.  If not, see <http://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////
+// Includes
+
+#include "extension.h"
+#include "irq.h"
+
+///////////////////////////////////////////////////////////
+// Globals
+
+// Variable shared with assembler (see isr.s), NULL for the sources without a C handler
+IRQ_HANDLER	g_irq_handler[IRQ_SOURCES];
+
+///////////////////////////////////////////////////////////
+// Functions
+
+///////////////////////////////////////////////////////////
+///
+/// Register the C handler of an interrupt source and
+/// enable the source (NULL disables it)
+///
+///	\param	Source		:	Interrupt source (IRQ_SOURCE_xxx)
+///	\param	Handler		:	Handler (irqXxx, see irq.h) or NULL
+///
+/// \note	the sources with an assembly handler (UART, input,
+///			timer, event) ignore the table
+/// \note	it can be called with the interrupts disabled: the
+///			interrupt flag is restored
+///
+///////////////////////////////////////////////////////////
+void irqRegister(unsigned char Source, IRQ_HANDLER Handler)
+{
+	unsigned char	Bit = 1 << Source;
+
+	asm("php");
+	asm("sei");
+
+	g_irq_handler[Source] = Handler;
+
+	if (Handler)
+		R_INT_ENABLE |= Bit;
+	else
+		R_INT_ENABLE &= ~Bit;
+
+	asm("plp");
+}
\ No newline at end of file
@@ -0,0 +1,48 @@
+// Copyright 2023 Luca Bertossi
+//
+// This file is part of B65.
+// 
+//     B65 is free software: you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation, either version 3 of the License, or
+//     (at your option) any later version.
+// 
+//     B65 is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+// 
+//     You should have received a copy of the GNU General Public License
+//     along with B65.  If not, see <http://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////
+// C interrupt handlers
+//
+// The sources without an assembly handler in isr.s (the serial channels) dispatch to the
+// C handler registered here. The handler runs on the shadow zero page with its own C stack
+// (see intc.vhd and crt0.s), so the trampoline saves no zero page location, only the Y register.
+//
+// A handler is named irqXxx (b65.sh checks it by name), takes no argument, acknowledges its
+// sources (R_INT_ACK) and must not enable the interrupts.
+
+///////////////////////////////////////////////////////////
+// Defines
+
+// Interrupt sources (see intc.vhd), the source bit is 1 << source
+#define IRQ_SOURCES			8
+#define IRQ_SOURCE_SERIAL0	4
+
+///////////////////////////////////////////////////////////
+// Types
+
+typedef void (*IRQ_HANDLER)(void);
+
+///////////////////////////////////////////////////////////
+// Globals
+
+// Handlers table shared with assembler (see isr.s)
+extern IRQ_HANDLER	g_irq_handler[IRQ_SOURCES];
+
+///////////////////////////////////////////////////////////
+// Functions
+
+void			irqRegister		(unsigned char Source, IRQ_HANDLER Handler);
\ No newline at end of file
@@ -45,8 +45,23 @@
 ; and runtime  is so high that I would  still advise people  to write  interrupt handlers in
 ; assembler.
 
+; In this target the hardware swaps the zero page instead (see intc.vhd Reg[5]): with the
+; automatic switch enabled the page 0 goes to a shadow bank from the IRQ vector fetch to the
+; RTI, and the shadow sp points to its own C stack (set in crt0.s). A C handler is registered
+; from C (see irq.h) and called by the irq_c trampoline, that saves the Y register (A and X
+; are saved on entry) and no zero page location. A handler runs with interrupts disabled (no
+; nesting) and must not call runtime routines keeping state outside page 0.
+
 .export   _irq_int, _nmi_int
-.import   _g_uart_rx_count
+.export   _uartTxKick
+.import   _g_task_events, _g_task_wake, _g_timer_ticks
+.import   _g_uart_rx_ring, _g_uart_rx_head, _g_uart_rx_tail, _g_uart_rx_overflow
+.import   _g_uart_tx_ring, _g_uart_tx_head, _g_uart_tx_tail
+.import   _g_irq_handler
+.import   __REG_START__               ; Linker generated (registers base, see memory.map)
+
+REGEXT  = __REG_START__ + $00       ; Extension registers            (see extension.h)
+REGINT  = __REG_START__ + $30       ; Interrupt controller registers (see extension.h)
 
 .segment  "CODE"
 
@@ -89,24 +104,146 @@ _irq_int:
            BNE irq_halt           ; If B = 1, BRK detected
 
             ; Interrupt code handler starts here
-            
-            ; If UART interrupt update _g_uart_rx_count
-			;   if (REGEXT0_MODE & 0x10)
-			;       _g_uart_rx_count = REGEXTD_RX_COUNT;
+
+            ; A blocked task could be ready now, the scheduler runs a new round (see task.c)
+            LDA #$01
+            STA _g_task_wake
+
+            ; Dispatch the highest priority pending source (see intc.vhd);
+            ; every handler comes back here until no source is pending
+irq_dispatch:
+            LDX REGINT+3          ; Load R_INT_VECTOR (source * 2, 0x10 if none)
+            JMP (irq_table,X)     ; Jump to the source handler
+
+irq_table:
+            .word irq_uart        ; Source 0 : UART rx/tx
+            .word irq_input       ; Source 1 : input change
+            .word irq_timer       ; Source 2 : timer expiration
+            .word irq_event       ; Source 3 : input event
+            .word irq_c           ; Source 4 : serial channel 0 (C handler)
+            .word irq_c           ; Source 5 : serial channel 1 (C handler)
+            .word irq_c           ; Source 6 : serial channel 2 (C handler)
+            .word irq_c           ; Source 7 : serial channel 3 (C handler)
+            .word irq_ret         ; No source pending
+
+irq_uart:
+            ; Acknowledge, move the received chars to the RX ring and refill the TX fifo (see uart.c)
+			;   R_INT_ACK = INT_UART;
+			;   if (!(R_MODE & MODE_COOKED)) while (R_RX_COUNT) g_uart_rx_ring[g_uart_rx_head++] = R_RX;
+			;   uartTxKick();
 			;
-            LDA $DC00             ; Load Extension register 0
-			AND #$10              ; Extract Isolate bit 4 (UART Rx interrupt)
-            BEQ _irq_clean        ; if not UART interrupt goto bit clean
-			LDA $DC0D             ; Load REGEXTD_RX_COUNT
-            STA _g_uart_rx_count  ; Copy loaded value to _g_uart_rx_count
-
-_irq_clean:
-            ; Clear bit 3,4 at 0xDC00
-			;   REGEXT0_MODE &= 0xE7;
+            LDA #$01              ; Set A = INT_UART
+            STA REGINT+2          ; Acknowledge (before reading the count, a new byte triggers again)
+            PHY                   ; Save Y register contents to stack (A and X are already saved)
+            LDY _g_uart_rx_head   ; Y = RX ring write index
+            BIT REGEXT            ; R_MODE bit 6 (V) : cooked mode, the line is still assembled in the RX fifo
+            BVS uart_rx_done      ;   (a TX interrupt), it's read at the cooked mode end
+uart_rx_next:
+			LDA REGEXT+$0D        ; Load REGEXTD_RX_COUNT
+            BEQ uart_rx_done      ; If zero the RX fifo is empty
+            LDA REGEXT+$0E        ; Load REGEXTD_RX
+            STA _g_uart_rx_ring,Y ; Store to the RX ring
+            INY                   ; Next write index
+            CPY _g_uart_rx_tail   ; If equal to the read index the ring is full
+            BNE uart_rx_next
+            DEY                   ; Ring full: drop the char
+            LDA #$01              ; Set A = 1
+            STA _g_uart_rx_overflow ; Set _g_uart_rx_overflow
+            BRA uart_rx_next
+uart_rx_done:
+            STY _g_uart_rx_head   ; Publish the received chars
+            JSR uart_tx_refill    ; Refill the TX fifo from the TX ring
+            PLY                   ; Restore Y register contents
+            BRA irq_dispatch
+
+irq_input:
+            ; Acknowledge and set the task event (see TASK_EVENT_INPUT)
+			;   R_INT_ACK = INT_INPUT;
+			;   _g_task_events |= INT_INPUT;
+			;
+            LDA #$02              ; Set A = INT_INPUT
+            STA REGINT+2          ; Acknowledge
+            TSB _g_task_events    ; Set the INT_INPUT bit
+            BRA irq_dispatch
+
+irq_event:
+            ; Acknowledge and set the task event (events are read from the queue, see TASK_EVENT_INPUT)
+			;   R_INT_ACK = INT_EVENT;
+			;   _g_task_events |= INT_EVENT;
+			;
+            LDA #$08              ; Set A = INT_EVENT
+            STA REGINT+2          ; Acknowledge
+            TSB _g_task_events    ; Set the INT_EVENT bit
+            BRA irq_dispatch
+
+irq_c:
+            ; C handler registered with irqRegister (see irq.c), the zero page is the shadow bank
+			;   if (g_irq_handler[source]) g_irq_handler[source]();
+			;   else { R_INT_ACK = 1 << source; R_INT_ENABLE &= ~(1 << source); }
 			;
-            LDA #$E7            ; Set A  = 0xE7
-            AND $DC00           ; Set A &= (the value at 0xDC00)
-            STA $DC00           ; Save A to 0xDC00
+            LDA _g_irq_handler+1,X ; Load the handler high byte (zero if none, no code in page 0)
+            BEQ irq_c_none
+            PHY                   ; Save Y register contents to stack (A and X are already saved)
+            JSR irq_c_call        ; Call the handler, it returns here
+            PLY                   ; Restore Y register contents
+            BRA irq_dispatch
+irq_c_call:
+            JMP (_g_irq_handler,X) ; Jump to the handler (X = source * 2)
+irq_c_none:
+            LDA irq_c_bit-8,X     ; Load the source bit (sources 4 to 7)
+            STA REGINT+2          ; Acknowledge
+            TRB REGINT+0          ; Disable the source
+            BRA irq_dispatch
+irq_c_bit:
+            .word $10, $20, $40, $80
+
+irq_timer:
+            ; Acknowledge and count the tick
+			;   R_INT_ACK = INT_TIMER;
+			;   _g_timer_ticks++;
+			;
+            LDA #$04              ; Set A = INT_TIMER
+            STA REGINT+2          ; Acknowledge
+            INC _g_timer_ticks    ; Increment _g_timer_ticks low byte
+            BNE irq_dispatch      ; if no carry dispatch the next source
+            INC _g_timer_ticks+1  ; Increment _g_timer_ticks high byte
+            BRA irq_dispatch
+
+; ---------------------------------------------------------------------------
+; UART TX fifo refill (see uart.c)
+;
+; Copy chars from the TX ring to the UART TX fifo, up to its free space.
+; Called with interrupts disabled, it changes A, X and Y
+
+uart_tx_refill:
+            LDX REGEXT+$0F        ; Load REGEXTD_TX_FREE
+            BEQ uart_tx_done      ; If zero the TX fifo is full
+            LDY _g_uart_tx_tail   ; Y = TX ring read index
+uart_tx_next:
+            CPY _g_uart_tx_head   ; If equal to the write index the ring is empty
+            BEQ uart_tx_store
+            LDA _g_uart_tx_ring,Y ; Load from the TX ring
+            STA REGEXT+$0F        ; Write to the TX fifo
+            INY                   ; Next read index
+            DEX                   ; One less free place in the TX fifo
+            BNE uart_tx_next
+uart_tx_store:
+            STY _g_uart_tx_tail   ; Release the sent chars
+uart_tx_done:
+            RTS
+
+; ---------------------------------------------------------------------------
+; UART TX kick (C callable, void uartTxKick(void))
+;
+; Start the transmission of the chars just queued to the TX ring; the TX
+; interrupt refills the fifo until the ring is empty
+
+_uartTxKick:
+            PHP                   ; Save the interrupt disable flag
+            SEI                   ; The IRQ handler uses the TX ring too
+            JSR uart_tx_refill
+            PLP                   ; Restore the interrupt disable flag
+            RTS
 
 ; ---------------------------------------------------------------------------
 ; IRQ return
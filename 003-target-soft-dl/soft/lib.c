@@ -18,45 +18,95 @@
 ///////////////////////////////////////////////////////////
 // Includes
 
+#include "lib.h"
+
 ///////////////////////////////////////////////////////////
-// Functions
+// Functions (see fast.s for the assembly versions)
+
+#if (SOFT_ASM == 0)
 
 ///////////////////////////////////////////////////////////
 ///
-/// Convert a Hex string starting with 0x to short integer
+/// Convert a number string to short integer, hex with 0x
+/// prefix or decimal (the value wraps around over 0xFFFF)
 ///
-///	\param	Hex				:	Hex string
-///	\param	buf				:	Pointer to input string after hex string
-///								(with eventual spaces removed)
+///	\param	Str				:	Number string (zero terminated)
+///	\param	Value			:	Converted value (set only if valid)
 ///
-/// \return unsigned short	:	converted short value
+/// \return unsigned char	:	1 if the string is a valid number
 ///
 ///////////////////////////////////////////////////////////
-unsigned short HexToNum(unsigned char *Hex, unsigned char **buf)
+unsigned char __fastcall__ StrToNum(const unsigned char *Str, unsigned short *Value)
 {
-	unsigned short	Value	= 0;
-	unsigned char	Byte	= 16;
-	unsigned char	Index	= 2;
+	unsigned short	Number	= 0;
+	unsigned char	Hex		= 0;
+	unsigned char	Digit;
 
-	if ((Hex[0] != '0') || ((Hex[1] != 'x') && (Hex[1] != 'X')))
+	if ((Str[0] == '0') && ((Str[1] == 'x') || (Str[1] == 'X')))
+	{
+		Hex  = 1;
+		Str += 2;
+	}
+
+	if (*Str == '\0')
 		return 0;
 
-	while (Hex[Index] > ' ')
+	do
 	{
-		Byte -= 4;
-		if (Hex[Index] <= '9')
-			Value |= (Hex[Index] - '0') << Byte;
+		Digit = *Str;
+
+		if ((Digit >= '0') && (Digit <= '9'))
+			Digit -= '0';
+		else if (Hex && (Digit >= 'A') && (Digit <= 'F'))
+			Digit -= 'A' - 10;
+		else if (Hex && (Digit >= 'a') && (Digit <= 'f'))
+			Digit -= 'a' - 10;
 		else
-			Value |= (Hex[Index] - '7') << Byte;
+			return 0;
 
-		Index++;
-	}
+		if (Hex)
+			Number = (Number << 4) | Digit;
+		else
+			Number = Number * 10 + Digit;
+
+	} while (*++Str);
 
-	while (Hex[Index] == ' ')
-		Index++;
+	*Value = Number;
+
+	return 1;
+}
+
+
+///////////////////////////////////////////////////////////
+///
+/// Shift a buffer one byte right (Data[1..Count] = Data[0..Count-1])
+///
+///	\param	Data			:	Buffer (Count + 1 bytes)
+///	\param	Count			:	Number of bytes to move
+///
+///////////////////////////////////////////////////////////
+void __fastcall__ BufferShiftRight(unsigned char *Data, unsigned char Count)
+{
+	while (Count > 0)
+	{
+		Data[Count] = Data[Count-1];
+		Count--;
+	}
+}
 
-	if (buf)
-		*buf = &Hex[Index];
+///////////////////////////////////////////////////////////
+///
+/// Shift a buffer one byte left (Data[0..Count-1] = Data[1..Count])
+///
+///	\param	Data			:	Buffer (Count + 1 bytes)
+///	\param	Count			:	Number of bytes to move
+///
+///////////////////////////////////////////////////////////
+void __fastcall__ BufferShiftLeft(unsigned char *Data, unsigned char Count)
+{
+	unsigned char Index;
 
-	return Value >> Byte;
+	for (Index = 0; Index < Count; Index++)
+		Data[Index] = Data[Index+1];
 }
+#endif
\ No newline at end of file
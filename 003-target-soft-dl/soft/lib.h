@@ -15,7 +15,19 @@
 //     You should have received a copy of the GNU General Public License
 //     along with B65.  If not, see <http://www.gnu.org/licenses/>.
 
+///////////////////////////////////////////////////////////
+// Build switch
+
+// Hot routines from the hand written 65C02 assembly (fast.s), 0 builds the C versions
+// (StrToNum, BufferShiftRight, BufferShiftLeft, uartPutstring and uartPutHexByte); b65.sh
+// passes it to cc65 and ca65 (-D SOFT_ASM=x)
+#ifndef SOFT_ASM
+	#define SOFT_ASM		1
+#endif
+
 ///////////////////////////////////////////////////////////
 // Functions
 
-unsigned short HexToNum(unsigned char *Hex, unsigned char **buf);
\ No newline at end of file
+unsigned char	__fastcall__ StrToNum			(const unsigned char *Str, unsigned short *Value);
+void			__fastcall__ BufferShiftRight	(unsigned char *Data, unsigned char Count);
+void			__fastcall__ BufferShiftLeft	(unsigned char *Data, unsigned char Count);
\ No newline at end of file
@@ -24,89 +24,410 @@
 #include "lib.h"
 #include "uart.h"
 #include "console.h"
+#include "crc.h"
+#include "timer.h"
+#include "proto.h"
+#include "xmodem.h"
+#include "task.h"
+#include "pool.h"
+#include "boot.h"
+#include "fmt.h"
 
 ///////////////////////////////////////////////////////////
 // Globals
 
-// Variable shared with assembler; it's updated in IRQ handler (see isr.s)
-unsigned char	g_uart_rx_count;
-
 // Console context
 CONSOLE_CONTEXT	g_console_context;
 
+// Free RAM between the firmware data (BSS) and the RAM programs, for the subsystems memory
+ARENA			g_arena;
+
+// Binary protocol context (host tools)
+PROTO_CONTEXT	g_proto_context;
+
+// Tasks (see task.h): console and protocol, inputs and leds, long console commands
+TASK			g_console_task	= { "console" };
+TASK			g_input_task	= { "input" };
+TASK			g_job_task		= { "job" };
+
+TASK * const	g_tasks[]		= { &g_console_task, &g_input_task, &g_job_task };
+
+// Input events queue overflows seen by the input task (shown by the tasks command)
+unsigned short	g_input_overflows;
+
+// Long console command state (one at a time, see ConsoleDefer)
+unsigned char  *g_job_data;
+unsigned short	g_job_length;
+
 ///////////////////////////////////////////////////////////
-// Assembler routines
+// Linker symbols (the firmware RAM data ends with BSS)
 
-extern void reboot();
+extern unsigned char _BSS_RUN__[];
+extern unsigned char _BSS_SIZE__[];
 
 ///////////////////////////////////////////////////////////
-// Functions declaration
+// Console commands table (handlers declaration and table, see commands.lst)
 
-void help		(unsigned char *Command);
-void cls		(unsigned char *Command);
-void echo		(unsigned char *Command);
-#if (CONSOLE_MAX_HISTORY > 0)
-void history	(unsigned char *Command);
-#endif
-void display	(unsigned char *Command);
-void dump		(unsigned char *Command);
-void write		(unsigned char *Command);
-void upgrade	(unsigned char *Command);
-void escan		(unsigned char *Command);
+#include "commands.h"
 
 ///////////////////////////////////////////////////////////
-// Console commands table
+// Tasks
 
-static const CONSOLE_COMMAND g_ConsoleCommand[] =
+///////////////////////////////////////////////////////////
+///
+/// Memory dump (see dump), one line each run
+///
+///	\param	Task		:	Task (see task.h)
+///
+/// \note	the output is 8 bytes per line Hex + ascii
+///     		00 00 00 00 00 00 00 00 ........
+///
+///			CTRL+C stops the dump
+///
+///////////////////////////////////////////////////////////
+#define DUMP_LINE		(8 * 3 + 8 + 2)
+
+static unsigned char dumpTask(TASK *Task)
 {
-	{	"?",		help,		"show commands help"		},
-	{	"cls",		cls,		"clear screen"				},
-	{	"echo",		echo,		"echo <string>"				},
+	unsigned char		Line[DUMP_LINE];
+	unsigned char		Count;
+	unsigned char		Offset;
+	unsigned char		Byte;
+	unsigned char		Rx;
 
-// No history command with only the last command
-#if (CONSOLE_MAX_HISTORY > 1)
-	{	"history",	history,	"history print"				},
-#endif
+	TASK_BEGIN(Task);
+
+	while (g_job_length != 0)
+	{
+		// Wait for the TX ring room of a whole line, the other tasks run meanwhile
+		TASK_WAIT_UNTIL(Task, uartTxFree() >= DUMP_LINE);
+
+		if (uartRead(&Rx) && (Rx == 0x03))
+			break;
+
+		Count = (g_job_length < 8) ? g_job_length : 8;
+
+		// The whole line is queued in one burst
+		fmtStart(Line, sizeof(Line));
+
+		for (Offset = 0; Offset < Count; Offset++)
+		{
+			fmtHex8(g_job_data[Offset]);
+			fmtChar(' ');
+		}
+
+		fmtPad(' ', (8 - Count) * 3);
+
+		for (Offset = 0; Offset < Count; Offset++)
+		{
+			Byte = g_job_data[Offset];
+			fmtChar(((Byte >= 0x20) && (Byte < 0x7F)) ? Byte : '.');
+		}
+
+		fmtString("\r\n");
+		fmtFlush();
+
+		g_job_data		+= Count;
+		g_job_length	-= Count;
+	}
+
+	ConsoleDone(&g_console_context);
+
+	TASK_END(Task);
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Escape sequence scan (see escan) until CTRL+D (0x04)
+///
+///	\param	Task		:	Task (see task.h)
+///
+///////////////////////////////////////////////////////////
+static unsigned char escanTask(TASK *Task)
+{
+	static unsigned char	Cnt;
+	unsigned char			Rx;
+
+	TASK_BEGIN(Task);
+
+	Cnt = 0;
+
+	do
+	{
+		TASK_WAIT_UNTIL(Task, uartRead(&Rx));
+
+		Cnt++;
+
+		uartPutHexByte(Rx);
+		uartPutchar(' ');
+
+		if (Cnt == 8)
+		{
+			Cnt = 0;
+			uartPutstring("\r\n");
+		}
+	}
+	while (Rx != 4);
+
+	ConsoleDone(&g_console_context);
+
+	TASK_END(Task);
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Use the UART hardware line discipline when the console can
+///
+/// \note	While the cursor is at the end of line the UART hardware echoes and assembles
+///			the line, the next UART interrupt comes at enter or at any control char
+///
+///////////////////////////////////////////////////////////
+static void consoleCooked(void)
+{
+	unsigned char	limit;
+
+	// No UART interrupt between the ring check and the mode switch
+	asm("php");
+	asm("sei");
+
+	if (!ConsoleBusy(&g_console_context) && ((R_MODE & MODE_COOKED) == 0) && (uartRxCount() == 0))
+	{
+		limit = ConsoleCookedLimit(&g_console_context);
+		if (limit != 0)
+		{
+			R_COOKED_LIMIT	= limit;
+			R_MODE		   |= MODE_COOKED;
+
+			// Not set if a char is just received
+			if (R_MODE & MODE_COOKED)
+				ConsoleCooked(&g_console_context, limit);
+		}
+	}
+
+	asm("plp");
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Console task: received chars to the console (or to the
+/// binary protocol while active)
+///
+///	\param	Task		:	Task (see task.h)
+///
+///////////////////////////////////////////////////////////
+static unsigned char consoleTask(TASK *Task)
+{
+	unsigned char	rx;
+
+	TASK_BEGIN(Task);
+
+	while (1)
+	{
+		// Console add (the binary protocol takes the received chars while active, a long command the console)
+		while ((g_proto_context.active == 0) && !ConsoleBusy(&g_console_context) && uartRead(&rx))
+			ConsoleAdd(&g_console_context, rx);
+
+		if (g_proto_context.active)
+			ProtoPoll(&g_proto_context);
+		else
+			consoleCooked();
+
+		TASK_WAIT_UNTIL(Task, (uartRxCount() != 0) && !ConsoleBusy(&g_console_context));
+	}
+
+	TASK_END(Task);
+}
 
-	{	"display",	display,	"display <4 chars> on lcd"	},
-	{	"dump",		dump,		"dump <0xstart> <0xlen>"	},
-	{	"write",	write,		"set <0xaddress> <0xbyte>"	},
+///////////////////////////////////////////////////////////
+///
+/// Input task: buttons and slides events to the leds
+///
+///	\param	Task		:	Task (see task.h)
+///
+///////////////////////////////////////////////////////////
+static unsigned char inputTask(TASK *Task)
+{
+	unsigned char	regval;
+	unsigned char	inval;
+	unsigned char	changed;
 
-	{	"reboot",	reboot,		"Reboot CPU"				},
-	{	"upgrade",	upgrade,	"Start software upgrade"	},
+	TASK_BEGIN(Task);
 
-	{	"escan",	escan,		"Escape sequence scan (CTRL+D to stop)"	},
-};
+	while (1)
+	{
+		while (R_EVT_COUNT != 0)
+		{
+			if (R_EVT_VALUE2 != 0)
+			{
+				// Any pushed button switches on all leds at different intensity
+				R_OUT0		= 0x00; // 0000.0000
+				R_OUT1		= 0x55; // 0101.0101
+				R_OUT2		= 0xAA; // 1010.1010
+				R_OUT3		= 0xFF; // 1111.1111
+			}
+			else
+			{
+				// Buttons release restores all the leds
+				changed = R_EVT_CHANGED2;
+
+				// Mirror slides to leds (7:0)
+				if ((R_EVT_CHANGED0 | changed) != 0)
+				{
+					inval = R_EVT_VALUE0;
+
+					regval = R_OUT0;
+					if (inval & 0x01) regval |= 0x03; else regval &= ~0x03;
+					if (inval & 0x02) regval |= 0x0C; else regval &= ~0x0C;
+					if (inval & 0x04) regval |= 0x30; else regval &= ~0x30;
+					if (inval & 0x08) regval |= 0xC0; else regval &= ~0xC0;
+					R_OUT0 = regval;
+
+					regval = R_OUT1;
+					if (inval & 0x10) regval |= 0x03; else regval &= ~0x03;
+					if (inval & 0x20) regval |= 0x0C; else regval &= ~0x0C;
+					if (inval & 0x40) regval |= 0x30; else regval &= ~0x30;
+					if (inval & 0x80) regval |= 0xC0; else regval &= ~0xC0;
+					R_OUT1 = regval;
+				}
+
+				// Mirror slides to leds (15:8)
+				if ((R_EVT_CHANGED1 | changed) != 0)
+				{
+					inval = R_EVT_VALUE1;
+
+					regval = R_OUT2;
+					if (inval & 0x01) regval |= 0x03; else regval &= ~0x03;
+					if (inval & 0x02) regval |= 0x0C; else regval &= ~0x0C;
+					if (inval & 0x04) regval |= 0x30; else regval &= ~0x30;
+					if (inval & 0x08) regval |= 0xC0; else regval &= ~0xC0;
+					R_OUT2 = regval;
+
+					regval = R_OUT3;
+					if (inval & 0x10) regval |= 0x03; else regval &= ~0x03;
+					if (inval & 0x20) regval |= 0x0C; else regval &= ~0x0C;
+					if (inval & 0x40) regval |= 0x30; else regval &= ~0x30;
+					if (inval & 0x80) regval |= 0xC0; else regval &= ~0xC0;
+					R_OUT3 = regval;
+				}
+			}
+
+			// Next event
+			R_EVT_CTRL = EVT_CTRL_POP;
+		}
+
+		// Events lost while the queue was full (the leds may miss a change until the next one)
+		if (R_EVT_CTRL & EVT_CTRL_OVERFLOW)
+		{
+			R_EVT_CTRL = EVT_CTRL_OVERFLOW;
+			g_input_overflows++;
+		}
+
+		// The event is cleared before reading the queue again, no event is lost
+		TASK_WAIT_EVENT(Task, TASK_EVENT_INPUT);
+	}
+
+	TASK_END(Task);
+}
 
 ///////////////////////////////////////////////////////////
 // Functions
 
+///////////////////////////////////////////////////////////
+///
+/// Check the numeric arguments of a command
+///
+///	\param	Args		:	Command arguments (see CONSOLE_ARGS)
+///	\param	Count		:	Number of numeric arguments after the command name
+///
+///	\return	1 if they are valid, otherwise 0 (an error is printed)
+///
+///////////////////////////////////////////////////////////
+static unsigned char argsNumeric(CONSOLE_ARGS *Args, unsigned char Count)
+{
+	if ((Args->numeric & CONSOLE_ARGS_NUMERIC(Count)) == CONSOLE_ARGS_NUMERIC(Count))
+		return 1;
+
+	uartPutstring("  ERROR : numeric arguments expected (0x hex or decimal)");
+
+	return 0;
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Get the RAM program address (optional first argument)
+///
+///	\param	Args		:	Command arguments (see CONSOLE_ARGS)
+///	\param	Address		:	program address (default MAP_START_PROGRAM)
+///
+///	\return	1 if it's valid, otherwise 0 (an error is printed)
+///
+///////////////////////////////////////////////////////////
+static unsigned char argsProgram(CONSOLE_ARGS *Args, unsigned short *Address)
+{
+	*Address = MAP_START_PROGRAM;
+
+	if (Args->argc > 1)
+	{
+		if (argsNumeric(Args, 1) == 0)
+			return 0;
+
+		*Address = Args->argn[1];
+	}
+
+	// Above the firmware data and the memory allocated from the arena, below the IRQ handlers stack
+	if ((*Address < (unsigned short) arenaMark(&g_arena)) || (*Address >= MAP_START_PROGRAM + MAP_SIZE_PROGRAM))
+	{
+		uartPutstring("  ERROR : address outside the free RAM");
+		return 0;
+	}
+
+	return 1;
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Call a RAM program and show its result
+///
+///	\param	Address		:	program entry point (see ram/crt0.s)
+///
+///////////////////////////////////////////////////////////
+static void runProgram(unsigned short Address)
+{
+	unsigned short Result;
+
+	Result = ((unsigned short (*)(void)) Address)();
+
+	uartPutstring("  program returned 0x");
+	uartPutHexByte(Result >> 8);
+	uartPutHexByte(Result);
+}
+
 ///////////////////////////////////////////////////////////
 ///
 /// Show a short help message
 ///
-///	\param	Command		:	User command string
+///	\param	Args		:	Command arguments (see CONSOLE_ARGS)
 ///
 ///////////////////////////////////////////////////////////
 #pragma warn (unused-param, push, off)
-void help(unsigned char *Command)
+void help(CONSOLE_ARGS *Args)
 {
+	unsigned char Line[64];
 	unsigned char Len;
 	unsigned char Index;
 
+	// One burst for each command (a longer line is flushed as the buffer fills)
 	for (Index = 0; Index < sizeof(g_ConsoleCommand) / sizeof(CONSOLE_COMMAND); Index++)
 	{
 		Len = strlen(g_ConsoleCommand[Index].command);
-		uartPutstring("  ");
-		uartPutstring(g_ConsoleCommand[Index].command);
-		Len = 16 - Len;
-		while(Len > 0)
-		{
-			uartPutstring(" ");
-			Len--;
-		}
-		uartPutstring(g_ConsoleCommand[Index].help);
-		uartPutstring("\r\n");
+
+		fmtStart(Line, sizeof(Line));
+		fmtString("  ");
+		fmtString(g_ConsoleCommand[Index].command);
+		fmtPad(' ', (Len < 16) ? 16 - Len : 1);
+		fmtString(g_ConsoleCommand[Index].help);
+		fmtString("\r\n");
+		fmtFlush();
 	}
 }
 #pragma warn (unused-param, pop)
@@ -115,11 +436,11 @@ void help(unsigned char *Command)
 ///
 /// Send the escape sequence to clear screen
 ///
-///	\param	Command		:	User command string
+///	\param	Args		:	Command arguments (see CONSOLE_ARGS)
 ///
 ///////////////////////////////////////////////////////////
 #pragma warn (unused-param, push, off)
-void cls(unsigned char *Command)
+void cls(CONSOLE_ARGS *Args)
 {
 	uartPutstring("\033[H\033[J");
 }
@@ -129,45 +450,49 @@ void cls(unsigned char *Command)
 ///
 /// echo a string
 ///
-///	\param	Command		:	User command string
+///	\param	Args		:	Command arguments (see CONSOLE_ARGS)
 ///
 ///////////////////////////////////////////////////////////
-void echo(unsigned char *Command)
+void echo(CONSOLE_ARGS *Args)
 {
-	uartPutstring(&Command[5]);
+	unsigned char Index;
+
+	for (Index = 1; Index < Args->argc; Index++)
+	{
+		if (Index > 1)
+			uartPutchar(' ');
+		uartPutstring(Args->argv[Index]);
+	}
 }
 
 ///////////////////////////////////////////////////////////
 ///
 /// Show the commands history
 ///
-///	\param	Command		:	User command string
+///	\param	Args		:	Command arguments (see CONSOLE_ARGS)
 ///
 ///////////////////////////////////////////////////////////
-#if (CONSOLE_MAX_HISTORY > 1)
+#if (CONSOLE_HISTORY_RING != 0)
 #pragma warn (unused-param, push, off)
-void history(unsigned char *Command)
+void history(CONSOLE_ARGS *Args)
 {
+	unsigned char Command[CONSOLE_MAX_COMMAND];
+	unsigned char Line[CONSOLE_MAX_COMMAND + 8];
 	unsigned char Index;
-	unsigned char Tens	= 0;
-	unsigned char Units = 0;
 
-	for (Index = 0; Index < g_console_context.historyCount; Index++)
+	fmtStart(Line, sizeof(Line));
+
+	// From the oldest one
+	for (Index = 0; ConsoleHistoryGet(&g_console_context, Index, Command); Index++)
 	{
-		uartPutstring("  [");
-		uartPutchar('0' + Tens);
-		uartPutchar('0' + Units);
-		uartPutstring("] ");
-		uartPutstring(g_console_context.history[Index]);
-		uartPutstring("\r\n");
-
-		Units++;
-		if (Units == 10)
-		{
-			Units = 0;
-			Tens++;
-		}
+		fmtString("  [");
+		fmtDecimal(Index, 2 | FMT_ZERO);
+		fmtString("] ");
+		fmtString(Command);
+		fmtString("\r\n");
 	}
+
+	fmtFlush();
 }
 #pragma warn (unused-param, pop)
 #endif
@@ -177,117 +502,120 @@ void history(unsigned char *Command)
 /// Display a string on the four 7-segments led displays
 /// of the basys3 board
 ///
-///	\param	Command		:	User command string
+///	\param	Args		:	Command arguments (see CONSOLE_ARGS)
 ///
 ///////////////////////////////////////////////////////////
-void display(unsigned char *Command)
+void display(CONSOLE_ARGS *Args)
 {
-	//             0123456789AB
 	// Command is "display 1234"
 	//                     ||||--> optional characters to display
 
-	unsigned char Len = strlen(Command);
+	unsigned char	Digit[4]	= { 0, 0, 0, 0 };
+	unsigned char	Index;
+
+	if (Args->argc > 1)
+		for (Index = 0; (Index < 4) && (Args->argv[1][Index] != '\0'); Index++)
+			Digit[Index] = Args->argv[1][Index];
 
-	if (Len >=  9) R_DIGIT3 = Command[ 8]; else R_DIGIT3 = 0; 
-	if (Len >= 10) R_DIGIT2 = Command[ 9]; else R_DIGIT2 = 0; 
-	if (Len >= 11) R_DIGIT1 = Command[10]; else R_DIGIT1 = 0; 
-	if (Len >= 12) R_DIGIT0 = Command[11]; else R_DIGIT0 = 0;
+	R_DIGIT3 = Digit[0];
+	R_DIGIT2 = Digit[1];
+	R_DIGIT1 = Digit[2];
+	R_DIGIT0 = Digit[3];
 }
 
 ///////////////////////////////////////////////////////////
 ///
 /// Dump a memory buffer
 ///
-///	\param	Command		:	User command string
+///	\param	Args		:	Command arguments (see CONSOLE_ARGS)
 ///
 /// \note	Command format is
 ///				dump <start> <size in bytes>
 ///
-///			the output is 8 bytes per line Hex + ascii
-///     		00 00 00 00 00 00 00 00 ........
+///			Parameters are Hex with '0x' prefix or decimal
 ///
-///			All parameters must be Hex with '0x' prefix
+///			The dump goes on in background (see dumpTask)
 ///
 ///////////////////////////////////////////////////////////
-void dump(unsigned char *Command)
+void dump(CONSOLE_ARGS *Args)
 {
-	unsigned char		Ascii[12];
-	unsigned char		Index	= 0;
-	unsigned char		Offset	= 0;
-	unsigned short		start;
-	unsigned char		length;
-	unsigned char		Byte;
-	unsigned char	   *data;
-
-	start	= HexToNum(&Command[5], &data);
-	length	= HexToNum(data, NULL);
-	data	= (unsigned char*) start;
-
-	while (Index < length)
-	{
-		Byte = data[Index];
-
-		uartPutHexByte(Byte);
-		uartPutchar(' ');
-
-		if ((Byte >= 0x20) && (Byte < 0x7F))
-			Ascii[Offset] = Byte;
-		else
-			Ascii[Offset] = '.';
-
-		Index++;
-		Offset++;
-		if ((Offset == 8) || (Index == length))
-		{
-			while (Offset < 8)
-			{
-				uartPutstring("   ");
-				Offset++;
-			}
+	if (argsNumeric(Args, 2) == 0)
+		return;
 
-			Ascii[Offset++] = '\r';
-			Ascii[Offset++] = '\n';
-			Ascii[Offset]	= '\0';
-			uartPutstring(Ascii);
+	g_job_data		= (unsigned char*) Args->argn[1];
+	g_job_length	= Args->argn[2];
 
-			Offset = 0;
-		}
-	}
+	ConsoleDefer(&g_console_context);
+	taskStart(&g_job_task, dumpTask);
 }
 
 ///////////////////////////////////////////////////////////
 ///
 /// Write a single memory location
 ///
-///	\param	Command		:	User command string
+///	\param	Args		:	Command arguments (see CONSOLE_ARGS)
 ///
 /// \note	Command format is
-///				set <base address> <byte value>
+///				write <base address> <byte value>
 ///
-///			All parameters must be Hex with '0x' prefix
+///			Parameters are Hex with '0x' prefix or decimal
 ///
 ///////////////////////////////////////////////////////////
-void write(unsigned char *Command)
+void write(CONSOLE_ARGS *Args)
 {
 	unsigned short	base;
 	unsigned char	value;
-	unsigned char   *data;
 
-	base	= HexToNum(&Command[6], &data);
-	value	= HexToNum(data, NULL);
+	if (argsNumeric(Args, 2) == 0)
+		return;
+
+	base	= Args->argn[1];
+	value	= Args->argn[2];
 	
 	*((unsigned char*) base) = value;
 }
 
+///////////////////////////////////////////////////////////
+///
+/// Compute CRC-16 and CRC-32 of a memory buffer
+///
+///	\param	Args		:	Command arguments (see CONSOLE_ARGS)
+///
+/// \note	Command format is
+///				crc <start> <size in bytes>
+///
+///			Parameters are Hex with '0x' prefix or decimal
+///
+///////////////////////////////////////////////////////////
+void crc(CONSOLE_ARGS *Args)
+{
+	unsigned char		Line[32];
+	unsigned short		start;
+	unsigned short		length;
+
+	if (argsNumeric(Args, 2) == 0)
+		return;
+
+	start	= Args->argn[1];
+	length	= Args->argn[2];
+
+	fmtStart(Line, sizeof(Line));
+	fmtString("  crc16 ");
+	fmtHex16(crcMemory(CRC_16, (void*) start, length));
+	fmtString("\r\n  crc32 ");
+	fmtHex32(crcMemory(CRC_32, (void*) start, length));
+	fmtFlush();
+}
+
 ///////////////////////////////////////////////////////////
 ///
 /// Upgrade the software (using the UART)
 ///
-///	\param	Command		:	User command string
+///	\param	Args		:	Command arguments (see CONSOLE_ARGS)
 ///
 ///////////////////////////////////////////////////////////
 #pragma warn (unused-param, push, off)
-void upgrade(unsigned char *Command)
+void upgrade(CONSOLE_ARGS *Args)
 {
 	R_DIGIT3 = 0;
 	R_DIGIT2 = 0;
@@ -298,41 +626,318 @@ void upgrade(unsigned char *Command)
 }
 #pragma warn (unused-param, pop)
 
+///////////////////////////////////////////////////////////
+///
+/// Receive a RAM program (XMODEM-CRC) and run it
+///
+///	\param	Args		:	Command arguments (see CONSOLE_ARGS)
+///
+/// \note	Command format is
+///				load [<address>]
+///
+///			The program is linked with ram/ram.cfg, the default
+///			address is MAP_START_PROGRAM
+///
+///////////////////////////////////////////////////////////
+void load(CONSOLE_ARGS *Args)
+{
+	unsigned char	Line[40];
+	unsigned short	Address;
+	unsigned short	Length;
+	unsigned char	Result;
+
+	if (argsProgram(Args, &Address) == 0)
+		return;
+
+	uartPutstring("  XMODEM-CRC receive, start the transfer\r\n");
+
+	Result = xmodemReceive((unsigned char*) Address, MAP_START_PROGRAM + MAP_SIZE_PROGRAM - Address, &Length);
+	if (Result != XMODEM_OK)
+	{
+		uartPutstring("\r\n  ERROR : transfer failed (");
+		uartPutHexByte(Result);
+		uartPutstring(")");
+		return;
+	}
+
+	fmtStart(Line, sizeof(Line));
+	fmtString("\r\n  loaded ");
+	fmtDecimal(Length, 0);
+	fmtString(" bytes at 0x");
+	fmtHex16(Address);
+	fmtString("\r\n");
+	fmtFlush();
+
+	runProgram(Address);
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Run again a RAM program
+///
+///	\param	Args		:	Command arguments (see CONSOLE_ARGS)
+///
+/// \note	Command format is
+///				go [<address>]
+///
+///////////////////////////////////////////////////////////
+void go(CONSOLE_ARGS *Args)
+{
+	unsigned short	Address;
+
+	if (argsProgram(Args, &Address) == 0)
+		return;
+
+	runProgram(Address);
+}
+
 ///////////////////////////////////////////////////////////
 ///
 /// Escape sequence scan until CTR+D (0x04) is received
 ///
-///	\param	Command		:	User command string
+///	\param	Args		:	Command arguments (see CONSOLE_ARGS)
+///
+/// \note	The scan goes on in background (see escanTask)
 ///
 ///////////////////////////////////////////////////////////
 #pragma warn (unused-param, push, off)
-void escan(unsigned char *Command)
+void escan(CONSOLE_ARGS *Args)
 {
-	unsigned char Rx	= 0;
-	unsigned char Cnt	= 0;
-	
-	// CTRL+D is 0x04
-	while (Rx != 4)
+	ConsoleDefer(&g_console_context);
+	taskStart(&g_job_task, escanTask);
+}
+#pragma warn (unused-param, pop)
+
+///////////////////////////////////////////////////////////
+///
+/// Switch the UART to the binary protocol for host tools
+/// (see proto.h), the EXIT request goes back to the console
+///
+///	\param	Args		:	Command arguments (see CONSOLE_ARGS)
+///
+///////////////////////////////////////////////////////////
+#pragma warn (unused-param, push, off)
+void binary(CONSOLE_ARGS *Args)
+{
+	ProtoStart(&g_proto_context);
+}
+#pragma warn (unused-param, pop)
+
+///////////////////////////////////////////////////////////
+///
+/// Show the longest run time of each task and of the
+/// scheduler round (the worst case latency) and the input
+/// events queue overflows, then reset them
+///
+///	\param	Args		:	Command arguments (see CONSOLE_ARGS)
+///
+///////////////////////////////////////////////////////////
+#pragma warn (unused-param, push, off)
+void tasks(CONSOLE_ARGS *Args)
+{
+	unsigned char	Line[48];
+	unsigned char	Index;
+	unsigned char	Len;
+	TASK		   *Task;
+
+	fmtStart(Line, sizeof(Line));
+
+	for (Index = 0; Index < sizeof(g_tasks) / sizeof(TASK*); Index++)
 	{
-		if (g_uart_rx_count != 0)
-		{
-			g_uart_rx_count--;
-			Rx = R_RX;
-			Cnt++;
-			
-			uartPutHexByte(Rx);
-			uartPutchar(' ');
+		Task = g_tasks[Index];
+		Len  = strlen(Task->name);
+
+		fmtString("  ");
+		fmtString(Task->name);
+		fmtPad(' ', (Len < 10) ? 10 - Len : 0);
+
+		fmtString("max ");
+		fmtDecimal(Task->maxTime, 5);
+		fmtString(Task->function ? " us\r\n" : " us (stopped)\r\n");
+
+		Task->maxTime = 0;
+	}
+
+	fmtString("  round     max ");
+	fmtDecimal(g_task_max_round, 5);
+	fmtString(" us\r\n  input queue overflows ");
+	fmtDecimal(g_input_overflows, 0);
+	fmtFlush();
+
+	g_task_max_round	= 0;
+	g_input_overflows	= 0;
+}
+#pragma warn (unused-param, pop)
+
+///////////////////////////////////////////////////////////
+///
+/// Measure the hot routines (the assembly or the C versions,
+/// see SOFT_ASM in lib.h), BENCH_CALLS calls each
+///
+///	\param	Args		:	Command arguments (see CONSOLE_ARGS)
+///
+/// \note	the loop overhead is included, the UART output of
+///			the put routines fits the empty TX ring (no wait)
+///
+///////////////////////////////////////////////////////////
+#define BENCH_CALLS		50
+#define BENCH_TESTS		7
 
-			if (Cnt == 8)
+#pragma warn (unused-param, push, off)
+void bench(CONSOLE_ARGS *Args)
+{
+	static const unsigned char * const Name[BENCH_TESTS] =
+	{
+		"StrToNum 0xBEEF  ",
+		"StrToNum 65535   ",
+		"BufferShiftRight ",
+		"BufferShiftLeft  ",
+		"uartPutHexByte   ",
+		"uartPutstring    ",
+		"fmtDecimal 65535 "
+	};
+
+	unsigned char	Buffer[CONSOLE_MAX_COMMAND];
+	unsigned char	Line[48];
+	unsigned long	Time[BENCH_TESTS];
+	unsigned long	Start;
+	unsigned short	Value;
+	unsigned char	Test;
+	unsigned char	Index;
+
+	// The put routines output fits the empty TX ring
+	while (uartTxFree() != UART_RING_SIZE - 1);
+
+	for (Test = 0; Test < BENCH_TESTS; Test++)
+	{
+		Start = timerMicroseconds();
+
+		for (Index = 0; Index < BENCH_CALLS; Index++)
+		{
+			switch (Test)
 			{
-				Cnt = 0;
-				uartPutstring("\r\n");
+				case 0: StrToNum("0xBEEF", &Value);							break;
+				case 1: StrToNum("65535", &Value);							break;
+				case 2: BufferShiftRight(Buffer, CONSOLE_MAX_COMMAND - 1);	break;
+				case 3: BufferShiftLeft(Buffer, CONSOLE_MAX_COMMAND - 1);	break;
+				case 4: uartPutHexByte(Index);								break;
+				case 5: uartPutstring(".");									break;
+				case 6: fmtStart(Buffer, 5); fmtDecimal(65535, 0);			break;
 			}
 		}
-	}	
+
+		Time[Test] = timerMicroseconds() - Start;
+	}
+
+	fmtStart(Line, sizeof(Line));
+	fmtString("\r\n");
+
+	for (Test = 0; Test < BENCH_TESTS; Test++)
+	{
+		fmtString("  ");
+		fmtString(Name[Test]);
+		fmtDecimalLong(Time[Test], 6);
+		fmtString(" us\r\n");
+	}
+
+	fmtString(SOFT_ASM ? "  (fast.s, " : "  (C, ");
+	fmtDecimal(BENCH_CALLS, 0);
+	fmtString(" calls each)");
+	fmtFlush();
 }
 #pragma warn (unused-param, pop)
 
+///////////////////////////////////////////////////////////
+///
+/// Show the boot time: each phase end from the reset vector
+/// (see boot.h), in microseconds and CPU cycles
+///
+///	\param	Args		:	Command arguments (see CONSOLE_ARGS)
+///
+///////////////////////////////////////////////////////////
+#pragma warn (unused-param, push, off)
+void boot(CONSOLE_ARGS *Args)
+{
+	static const unsigned char * const Name[BOOT_PHASES] =
+	{
+		"reset     ",
+		"bss       ",
+		"main      ",
+		"devices   ",
+		"prompt    "
+	};
+
+	unsigned char	Line[48];
+	unsigned long	Time;
+	unsigned char	Phase;
+
+	fmtStart(Line, sizeof(Line));
+
+	for (Phase = 0; Phase < BOOT_PHASES; Phase++)
+	{
+		// The reset stamp is from the system reset, the others from the reset vector
+		Time = g_boot_time[Phase];
+		if (Phase != BOOT_RESET)
+			Time -= g_boot_time[BOOT_RESET];
+
+		fmtString("  ");
+		fmtString(Name[Phase]);
+		fmtDecimalLong(Time, 8);
+		fmtString(" us");
+
+		if (Phase != BOOT_RESET)
+		{
+			fmtDecimalLong(Time * BOOT_CYCLES_US, 10);
+			fmtString(" cycles");
+		}
+
+		fmtString("\r\n");
+	}
+
+	fmtString(g_boot_warm > 1 ? "  BSS cleared" : "  BSS zero from the FPGA configuration");
+	fmtString(g_boot_wai ? "\r\n  WAI stops the CPU" : "\r\n  WAI runs as a NOP (idle polling)");
+	fmtFlush();
+}
+#pragma warn (unused-param, pop)
+
+///////////////////////////////////////////////////////////
+// Devices
+
+///////////////////////////////////////////////////////////
+///
+/// Start the devices not needed by the prompt (see BOOT_PROMPT)
+///
+///////////////////////////////////////////////////////////
+static void devicesStart(void)
+{
+	// Periodic 1ms timer interrupt (1MHz tick, 1000 ticks period): it bounds the sleep time
+	timerStart(49, 999, TMR_CTRL_PERIODIC | TMR_CTRL_IRQ);
+
+	R_DIGIT_INTENSITY	= 0x55;
+	R_DIGIT3			= 'b';
+	R_DIGIT2			= '6';
+	R_DIGIT1			= '5';
+	R_DIGIT0			= ' ';
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Resume a simulation checkpoint (called by cpu_resume in direct.s)
+///
+/// The RAM is the one of the checkpoint but the devices are out of reset:
+/// they are set again as main() does, with interrupts still disabled
+/// (cpu_resume restores R_INT_ENABLE). The display shows the boot digits and
+/// the serial channels are not configured, run serialInit() again if needed.
+///
+///////////////////////////////////////////////////////////
+void resume(void)
+{
+	uartInit();
+	R_INT_ZP	 = INT_ZP_AUTO;
+
+	devicesStart();
+}
+
 ///////////////////////////////////////////////////////////
 // Entry point
 
@@ -343,94 +948,50 @@ void escan(unsigned char *Command)
 ///////////////////////////////////////////////////////////
 void main(void)
 {
-	unsigned char	delay;
-	unsigned char	regval;
-	unsigned char	inval;
-	unsigned char	oldval[2]	= { 0, 0 };
+	unsigned short End;
 
 	// Enable interrupt (otherwise cpu_irq signal has no effects on software)
 	asm("cli");
 
-	R_DIGIT_INTENSITY	= 0x55;
-	R_DIGIT3			= 'b';
-	R_DIGIT2			= '6';
-	R_DIGIT1			= '5';
-	R_DIGIT0			= ' ';
+	// Devices needed by the prompt first, the rest is done after it (see BOOT_PROMPT)
+
+	// UART rings, the TX fifo is refilled in the IRQ handler
+	uartInit();
+
+	// IRQ handlers run on the shadow zero page (C handlers, see isr.s)
+	R_INT_ZP	 = INT_ZP_AUTO;
+
+	// Enable the interrupt sources handled in isr.s (the C handlers enable theirs, see irq.h)
+	R_INT_ENABLE |= INT_UART | INT_EVENT | INT_TIMER;
+
+	bootMark(BOOT_DEVICES);
+
+	// RAM arena from the end of BSS to the RAM programs (empty if BSS goes beyond)
+	End = (unsigned short) _BSS_RUN__ + (unsigned short) _BSS_SIZE__;
+	arenaInit(&g_arena, (void*) End, (End < MAP_START_PROGRAM) ? MAP_START_PROGRAM - End : 0);
 
 	cls(NULL);
 	uartPutstring("b65 ready.\r\n");
 	ConsoleInit(&g_console_context, g_ConsoleCommand, sizeof(g_ConsoleCommand) / sizeof(CONSOLE_COMMAND) );
 
+#if (CONSOLE_HISTORY_RING != 0)
+	// Console history ring (no history if the arena is full)
+	ConsoleHistoryInit(&g_console_context, arenaAlloc(&g_arena, CONSOLE_HISTORY_SIZE), CONSOLE_HISTORY_SIZE);
+#endif
+
+	bootMark(BOOT_PROMPT);
+
 	// Enable upgrade to simulate vhdl upgrade process (see b65.vhd download_software.dl_done process)
 	// upgrade(0);
 
-	while(1)
-	{
-		// Delay
-		for (delay = 0; delay < 16; ++delay);
+	// WAI support of the CPU core (see cpu_wait in direct.s), before the timer starts
+	g_boot_wai = cpu_wait_probe();
 
-		// Console add
-		if (g_uart_rx_count != 0)
-		{
-			g_uart_rx_count--;
-			ConsoleAdd(&g_console_context, R_RX);
-		}
-	
-		// Inputs and Leds
-		if (R_IN2 != 0)
-		{
-			// Any pushed button switches on all leds at different intensity
-			R_OUT0		= 0x00; // 0000.0000
-			R_OUT1		= 0x55; // 0101.0101
-			R_OUT2		= 0xAA; // 1010.1010
-			R_OUT3		= 0xFF; // 1111.1111
-			
-			oldval[0] = 0xF0;
-			oldval[1] = 0xFF;
-		}
-		else
-		{
-			// Mirror slides to leds (7:0)
-			inval = R_IN0;
-			if (inval != oldval[0])
-			{			
-				oldval[0] = inval;
-
-				regval = R_OUT0;
-				if (inval & 0x01) regval |= 0x03; else regval &= ~0x03;
-				if (inval & 0x02) regval |= 0x0C; else regval &= ~0x0C;
-				if (inval & 0x04) regval |= 0x30; else regval &= ~0x30;
-				if (inval & 0x08) regval |= 0xC0; else regval &= ~0xC0;
-				R_OUT0 = regval;
-			
-				regval = R_OUT1;
-				if (inval & 0x10) regval |= 0x03; else regval &= ~0x03;
-				if (inval & 0x20) regval |= 0x0C; else regval &= ~0x0C;
-				if (inval & 0x40) regval |= 0x30; else regval &= ~0x30;
-				if (inval & 0x80) regval |= 0xC0; else regval &= ~0xC0;
-				R_OUT1 = regval;
-			}
-		
-			// Mirror slides to leds (15:8)
-			inval = R_IN1;
-			if (inval != oldval[1])
-			{			
-				oldval[1] = inval;
-
-				regval = R_OUT2;
-				if (inval & 0x01) regval |= 0x03; else regval &= ~0x03;
-				if (inval & 0x02) regval |= 0x0C; else regval &= ~0x0C;
-				if (inval & 0x04) regval |= 0x30; else regval &= ~0x30;
-				if (inval & 0x08) regval |= 0xC0; else regval &= ~0xC0;
-				R_OUT2 = regval;
-
-				regval = R_OUT3;
-				if (inval & 0x10) regval |= 0x03; else regval &= ~0x03;
-				if (inval & 0x20) regval |= 0x0C; else regval &= ~0x0C;
-				if (inval & 0x40) regval |= 0x30; else regval &= ~0x30;
-				if (inval & 0x80) regval |= 0xC0; else regval &= ~0xC0;
-				R_OUT3 = regval;
-			}
-		}
-	}
-}
+	devicesStart();
+
+	// The job task is started by the long commands
+	taskStart(&g_console_task,	consoleTask);
+	taskStart(&g_input_task,	inputTask);
+
+	taskRun(g_tasks, sizeof(g_tasks) / sizeof(TASK*));
+}
\ No newline at end of file
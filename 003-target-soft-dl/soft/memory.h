@@ -0,0 +1,7 @@
+// b65 memory map (generated by b65.sh from memory.map, do not edit)
+
+#define MAP_START_REG			0xDC00		// devices registers
+#define MAP_START_ROM			0xE000		// code ram
+#define MAP_SIZE_ROM			0x2000
+#define MAP_START_PROGRAM		0x1000		// RAM programs
+#define MAP_SIZE_PROGRAM		0xC600
@@ -0,0 +1,64 @@
+// Copyright 2023 Luca Bertossi
+//
+// This file is part of B65.
+// 
+//     B65 is free software: you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation, either version 3 of the License, or
+//     (at your option) any later version.
+// 
+//     B65 is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+// 
+//     You should have received a copy of the GNU General Public License
+//     along with B65.  If not, see <http://www.gnu.org/licenses/>.
+
+///////////////////////////////////////////////////////////
+// Includes
+
+#include <stddef.h>
+
+#include "pool.h"
+
+///////////////////////////////////////////////////////////
+// Functions
+
+///////////////////////////////////////////////////////////
+///
+/// Initialize an arena
+///
+///	\param	Arena		:	Arena
+///	\param	Memory		:	Arena memory
+///	\param	Size		:	Arena size in bytes
+///
+///////////////////////////////////////////////////////////
+void arenaInit(ARENA *Arena, void *Memory, unsigned short Size)
+{
+	Arena->next	= (unsigned char*) Memory;
+	Arena->end	= (unsigned char*) Memory + Size;
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Allocate memory from an arena
+///
+///	\param	Arena		:	Arena
+///	\param	Size		:	Size in bytes
+///
+/// \return	void*		:	Memory, NULL if the arena has not enough
+///							free bytes
+///
+///////////////////////////////////////////////////////////
+void *arenaAlloc(ARENA *Arena, unsigned short Size)
+{
+	unsigned char *Memory = Arena->next;
+
+	if (Size > arenaFree(Arena))
+		return NULL;
+
+	Arena->next += Size;
+
+	return Memory;
+}
\ No newline at end of file
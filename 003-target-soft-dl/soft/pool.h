@@ -0,0 +1,50 @@
+// Copyright 2023 Luca Bertossi
+//
+// This file is part of B65.
+// 
+//     B65 is free software: you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation, either version 3 of the License, or
+//     (at your option) any later version.
+// 
+//     B65 is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+// 
+//     You should have received a copy of the GNU General Public License
+//     along with B65.  If not, see <http://www.gnu.org/licenses/>.
+
+///////////////////////////////////////////////////////////
+// Constant time allocator (no cc65 heap)
+//
+// ARENA : bump allocator for memory that lives as long as the subsystem using it;
+//         arenaMark / arenaRelease give back everything allocated after a mark
+//
+// It's for the main loop (tasks), not for the IRQ handlers.
+
+///////////////////////////////////////////////////////////
+// Defines
+
+// Arena mark and release (everything allocated after the mark is freed)
+#define arenaMark(Arena)			((Arena)->next)
+#define arenaRelease(Arena, Mark)	((Arena)->next = (Mark))
+
+// Arena free bytes
+#define arenaFree(Arena)			((unsigned short) ((Arena)->end - (Arena)->next))
+
+///////////////////////////////////////////////////////////
+// Structures
+
+typedef struct _ARENA_
+{
+	unsigned char			   *next;			// First free byte
+	unsigned char			   *end;			// First byte after the arena
+
+} ARENA;
+
+///////////////////////////////////////////////////////////
+// Functions
+
+void			arenaInit		(ARENA *Arena, void *Memory, unsigned short Size);
+void		   *arenaAlloc		(ARENA *Arena, unsigned short Size);
\ No newline at end of file
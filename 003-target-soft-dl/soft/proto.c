@@ -0,0 +1,266 @@
+// Copyright 2023 Luca Bertossi
+//
+// This file is part of B65.
+// 
+//     B65 is free software: you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation, either version 3 of the License, or
+//     (at your option) any later version.
+// 
+//     B65 is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+// 
+//     You should have received a copy of the GNU General Public License
+//     along with B65.  If not, see <http://www.gnu.org/licenses/>.
+
+///////////////////////////////////////////////////////////
+// Includes
+
+#include <string.h>
+
+#include "uart.h"
+#include "proto.h"
+
+///////////////////////////////////////////////////////////
+// Static functions
+
+///////////////////////////////////////////////////////////
+///
+/// Add a buffer to an 8 bit sum
+///
+///	\param	Data	:	bytes to add
+///	\param	Length	:	number of bytes
+///	\param	Sum		:	initial sum
+///
+///	\return	the updated sum
+///
+///////////////////////////////////////////////////////////
+static unsigned char ProtoSum(const unsigned char *Data, unsigned char Length, unsigned char Sum)
+{
+	while (Length--)
+		Sum += *Data++;
+
+	return Sum;
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Queue bytes to the UART, waiting only while the TX ring is full
+///
+///	\param	Data	:	bytes to send
+///	\param	Length	:	number of bytes
+///
+///////////////////////////////////////////////////////////
+static void ProtoSend(const unsigned char *Data, unsigned char Length)
+{
+	unsigned char Sent;
+
+	while (Length != 0)
+	{
+		Sent	= uartWriteBuffer(Data, Length);
+		Data   += Sent;
+		Length -= Sent;
+	}
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Send the response to the current request
+///
+///	\param	Ctx		:	Protocol context
+///	\param	Status	:	PROTO_OK or PROTO_ERR_xxx
+///	\param	Data	:	response payload
+///	\param	Length	:	response payload length
+///
+///////////////////////////////////////////////////////////
+static void ProtoReply(PROTO_CONTEXT *Ctx, unsigned char Status, const unsigned char *Data, unsigned char Length)
+{
+	unsigned char Header[4];
+	unsigned char Checksum;
+
+	Header[0]	= PROTO_SYNC_RESPONSE;
+	Header[1]	= Ctx->seq;
+	Header[2]	= Status;
+	Header[3]	= Length;
+
+	Checksum	= 0 - ProtoSum(Data, Length, Ctx->seq + Status + Length);
+
+	ProtoSend(Header, 4);
+	ProtoSend(Data, Length);
+	ProtoSend(&Checksum, 1);
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Execute the current request (checksum already verified)
+///
+///	\param	Ctx		:	Protocol context
+///
+///////////////////////////////////////////////////////////
+static void ProtoExecute(PROTO_CONTEXT *Ctx)
+{
+	unsigned char  *Address	= (unsigned char*) (Ctx->payload[0] | (Ctx->payload[1] << 8));
+	unsigned char	Count	= Ctx->payload[2];
+	unsigned char	Index;
+	unsigned short	Result;
+
+	switch (Ctx->command)
+	{
+		case PROTO_CMD_PING:
+			Ctx->payload[0] = PROTO_VERSION;
+			Ctx->payload[1] = PROTO_MAX_DATA;
+			ProtoReply(Ctx, PROTO_OK, Ctx->payload, 2);
+		break;
+
+		// Read and write are done in blocks, the register variants access the same address count times
+		case PROTO_CMD_READ:
+		case PROTO_CMD_REG_READ:
+			if ((Ctx->length != 3) || (Count > PROTO_MAX_DATA))
+				break;
+
+			if (Ctx->command == PROTO_CMD_READ)
+				ProtoReply(Ctx, PROTO_OK, Address, Count);
+			else
+			{
+				for (Index = 0; Index < Count; Index++)
+					Ctx->payload[Index] = *Address;
+
+				ProtoReply(Ctx, PROTO_OK, Ctx->payload, Count);
+			}
+		return;
+
+		case PROTO_CMD_WRITE:
+		case PROTO_CMD_REG_WRITE:
+			if (Ctx->length < 2)
+				break;
+
+			if (Ctx->command == PROTO_CMD_WRITE)
+				memcpy(Address, &Ctx->payload[2], Ctx->length - 2);
+			else
+				for (Index = 2; Index < Ctx->length; Index++)
+					*Address = Ctx->payload[Index];
+
+			ProtoReply(Ctx, PROTO_OK, 0, 0);
+		return;
+
+		// The called code returns A (low) and X (high), it can use the C stack and the zero page
+		case PROTO_CMD_EXEC:
+			if (Ctx->length != 2)
+				break;
+
+			Result			= ((unsigned short (*)(void)) Address)();
+			Ctx->payload[0]	= Result;
+			Ctx->payload[1]	= Result >> 8;
+			ProtoReply(Ctx, PROTO_OK, Ctx->payload, 2);
+		return;
+
+		case PROTO_CMD_EXIT:
+			ProtoReply(Ctx, PROTO_OK, 0, 0);
+			Ctx->active = 0;
+		return;
+
+		default:
+			ProtoReply(Ctx, PROTO_ERR_COMMAND, 0, 0);
+		return;
+	}
+
+	// Wrong payload length for the command
+	ProtoReply(Ctx, PROTO_ERR_LENGTH, 0, 0);
+}
+
+///////////////////////////////////////////////////////////
+// Functions
+
+///////////////////////////////////////////////////////////
+///
+/// Switch the UART to the binary protocol
+///
+///	\param	Ctx		:	Protocol context
+///
+///	\note	The caller stops feeding the console while the
+///			context is active (see main loop)
+///
+///////////////////////////////////////////////////////////
+void ProtoStart(PROTO_CONTEXT *Ctx)
+{
+	memset(Ctx, 0, sizeof(PROTO_CONTEXT));
+
+	Ctx->active = 1;
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Parse and execute the requests in the RX ring
+///
+///	\param	Ctx		:	Protocol context
+///
+///	\note	It returns when the RX ring is empty or after
+///			the EXIT request (the following chars are left
+///			to the console)
+///
+///////////////////////////////////////////////////////////
+void ProtoPoll(PROTO_CONTEXT *Ctx)
+{
+	unsigned char Byte;
+
+	while (Ctx->active)
+	{
+		// The payload is copied from the RX ring in blocks
+		if (Ctx->state == PROTO_STATE_PAYLOAD)
+		{
+			Ctx->index += uartReadBuffer(&Ctx->payload[Ctx->index], Ctx->length - Ctx->index);
+			if (Ctx->index != Ctx->length)
+				return;
+
+			Ctx->state = PROTO_STATE_CHECKSUM;
+		}
+
+		if (uartRead(&Byte) == 0)
+			return;
+
+		switch (Ctx->state)
+		{
+			// Anything else than the sync byte is discarded (console text, a broken request)
+			case PROTO_STATE_SYNC:
+				if (Byte == PROTO_SYNC_REQUEST)
+					Ctx->state = PROTO_STATE_SEQ;
+			break;
+
+			case PROTO_STATE_SEQ:
+				Ctx->seq		= Byte;
+				Ctx->state		= PROTO_STATE_COMMAND;
+			break;
+
+			case PROTO_STATE_COMMAND:
+				Ctx->command	= Byte;
+				Ctx->state		= PROTO_STATE_LENGTH;
+			break;
+
+			case PROTO_STATE_LENGTH:
+				Ctx->length		= Byte;
+				Ctx->index		= 0;
+
+				if (Byte > PROTO_MAX_PAYLOAD)
+				{
+					ProtoReply(Ctx, PROTO_ERR_LENGTH, 0, 0);
+					Ctx->state	= PROTO_STATE_SYNC;
+				}
+				else if (Byte == 0)
+					Ctx->state	= PROTO_STATE_CHECKSUM;
+				else
+					Ctx->state	= PROTO_STATE_PAYLOAD;
+			break;
+
+			case PROTO_STATE_CHECKSUM:
+				Ctx->state		= PROTO_STATE_SYNC;
+
+				if ((unsigned char) (ProtoSum(Ctx->payload, Ctx->length, Ctx->seq + Ctx->command + Ctx->length) + Byte) != 0)
+					ProtoReply(Ctx, PROTO_ERR_CHECKSUM, 0, 0);
+				else
+					ProtoExecute(Ctx);
+			break;
+		}
+	}
+}
\ No newline at end of file
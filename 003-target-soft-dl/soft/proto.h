@@ -0,0 +1,100 @@
+// Copyright 2023 Luca Bertossi
+//
+// This file is part of B65.
+// 
+//     B65 is free software: you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation, either version 3 of the License, or
+//     (at your option) any later version.
+// 
+//     B65 is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+// 
+//     You should have received a copy of the GNU General Public License
+//     along with B65.  If not, see <http://www.gnu.org/licenses/>.
+
+///////////////////////////////////////////////////////////
+// Binary protocol for host tools (see b65link)
+//
+// Request  : PROTO_SYNC_REQUEST  seq command length [payload] checksum
+// Response : PROTO_SYNC_RESPONSE seq status  length [payload] checksum
+//
+// The checksum makes zero the 8 bit sum of all the bytes from seq to checksum.
+// Requests are executed in order, the response has the same seq of the request:
+// the host can send more requests without waiting (up to the RX ring size).
+//
+// Commands (addresses are little endian):
+//
+//	PING		: -									-> version, max data
+//	READ		: address[2] count					-> data[count]          (memory read)
+//	WRITE		: address[2] data[]					-> -                    (memory write)
+//	REG_READ	: address[2] count					-> data[count]          (count reads of the same address)
+//	REG_WRITE	: address[2] data[]					-> -                    (writes to the same address)
+//	EXEC		: address[2]						-> result[2]            (call, A/X returned)
+//	EXIT		: -									-> -                    (back to the console)
+
+///////////////////////////////////////////////////////////
+// Defines
+
+#define PROTO_VERSION			1
+
+#define PROTO_SYNC_REQUEST		0xB6
+#define PROTO_SYNC_RESPONSE		0xB7
+
+// Maximum data bytes of a request or response (the payload adds the address)
+#define PROTO_MAX_DATA			128
+#define PROTO_MAX_PAYLOAD		(PROTO_MAX_DATA + 2)
+
+// Commands
+#define PROTO_CMD_PING			0x00
+#define PROTO_CMD_READ			0x01
+#define PROTO_CMD_WRITE			0x02
+#define PROTO_CMD_REG_READ		0x03
+#define PROTO_CMD_REG_WRITE		0x04
+#define PROTO_CMD_EXEC			0x05
+#define PROTO_CMD_EXIT			0x06
+
+// Response status
+#define PROTO_OK				0x00
+#define PROTO_ERR_CHECKSUM		0x01
+#define PROTO_ERR_COMMAND		0x02
+#define PROTO_ERR_LENGTH		0x03
+
+///////////////////////////////////////////////////////////
+// Enumeratives
+
+typedef enum _PROTO_STATE_
+{
+	PROTO_STATE_SYNC,				// Waiting for the request sync byte
+	PROTO_STATE_SEQ,
+	PROTO_STATE_COMMAND,
+	PROTO_STATE_LENGTH,
+	PROTO_STATE_PAYLOAD,
+	PROTO_STATE_CHECKSUM
+
+} PROTO_STATE;
+
+///////////////////////////////////////////////////////////
+// Structures
+
+typedef struct _PROTO_CONTEXT_
+{
+	unsigned char				active;			// Binary mode active (the console is not fed)
+	PROTO_STATE					state;			// Request parser state
+
+	unsigned char				seq;			// Current request
+	unsigned char				command;
+	unsigned char				length;
+	unsigned char				index;			// Payload bytes received
+
+	unsigned char				payload[PROTO_MAX_PAYLOAD];
+
+} PROTO_CONTEXT;
+
+///////////////////////////////////////////////////////////
+// Functions
+
+void ProtoStart	(PROTO_CONTEXT *Ctx);
+void ProtoPoll	(PROTO_CONTEXT *Ctx);
\ No newline at end of file
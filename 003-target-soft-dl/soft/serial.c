@@ -0,0 +1,123 @@
+// Copyright 2023 Luca Bertossi
+//
+// This file is part of B65.
+// 
+//     B65 is free software: you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation, either version 3 of the License, or
+//     (at your option) any later version.
+// 
+//     B65 is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+// 
+//     You should have received a copy of the GNU General Public License
+//     along with B65.  If not, see <http://www.gnu.org/licenses/>.
+
+
+///////////////////////////////////////////////////////////
+// Includes
+
+#include <stddef.h>
+
+#include "extension.h"
+#include "irq.h"
+#include "serial.h"
+
+///////////////////////////////////////////////////////////
+// Globals
+
+// Variable shared with assembler; it's updated in IRQ handler (see isr.s)
+unsigned char	g_serial_event;
+
+///////////////////////////////////////////////////////////
+// Functions
+
+///////////////////////////////////////////////////////////
+///
+/// Initialize a serial channel
+///
+///	\param	Channel		:	serial channel (0 to SERIAL_CHANNELS - 1, see pack.vhd)
+///	\param	Divisor		:	baud divisor (SERIAL_921600, SERIAL_115200, ...)
+///	\param	Control		:	SER_CTRL_RX_IRQ and/or SER_CTRL_TX_IRQ
+///
+/// \note	the channel interrupt source is enabled with the
+///			irqSerial handler when Control has an IRQ bit
+///
+///////////////////////////////////////////////////////////
+void serialInit(unsigned char Channel, unsigned short Divisor, unsigned char Control)
+{
+	R_SER_CTRL(Channel)		= 0;
+	R_SER_DIVISOR(Channel)	= Divisor;
+	R_SER_STATUS(Channel)	= SER_STATUS_OVERFLOW;
+	R_SER_CTRL(Channel)		= Control;
+
+	irqRegister(IRQ_SOURCE_SERIAL0 + Channel, (Control & (SER_CTRL_RX_IRQ | SER_CTRL_TX_IRQ)) ? irqSerial : NULL);
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Write bytes to a serial channel without waiting
+///
+///	\param	Channel		:	serial channel
+///	\param	Data		:	bytes to write
+///	\param	Length		:	number of bytes to write
+///
+///	\return	number of bytes written (limited by the TX fifo free space)
+///
+///////////////////////////////////////////////////////////
+unsigned short serialWrite(unsigned char Channel, const unsigned char *Data, unsigned short Length)
+{
+	unsigned short	Count	= R_SER_TX_FREE(Channel);
+
+	if (Count > Length)
+		Count = Length;
+
+	for (Length = 0; Length < Count; ++Length)
+		R_SER_TX(Channel) = Data[Length];
+
+	return Count;
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Serial channels IRQ handler (registered by serialInit,
+/// see irq.h)
+///
+/// It runs on the shadow zero page (see intc.vhd), so it's
+/// plain C: acknowledge all the active serial channels and
+/// set their bits in g_serial_event
+///
+///////////////////////////////////////////////////////////
+void irqSerial(void)
+{
+	unsigned char	Active	= R_INT_ACTIVE & 0xF0;
+
+	R_INT_ACK		 = Active;
+	g_serial_event	|= Active;
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Read bytes from a serial channel without waiting
+///
+///	\param	Channel		:	serial channel
+///	\param	Data		:	buffer for the read bytes
+///	\param	Length		:	buffer size
+///
+///	\return	number of bytes read (limited by the RX fifo count)
+///
+///////////////////////////////////////////////////////////
+unsigned short serialRead(unsigned char Channel, unsigned char *Data, unsigned short Length)
+{
+	unsigned short	Count	= R_SER_RX_COUNT(Channel);
+
+	if (Count > Length)
+		Count = Length;
+
+	for (Length = 0; Length < Count; ++Length)
+		Data[Length] = R_SER_RX(Channel);
+
+	return Count;
+}
\ No newline at end of file
@@ -0,0 +1,39 @@
+// Copyright 2023 Luca Bertossi
+//
+// This file is part of B65.
+// 
+//     B65 is free software: you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation, either version 3 of the License, or
+//     (at your option) any later version.
+// 
+//     B65 is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+// 
+//     You should have received a copy of the GNU General Public License
+//     along with B65.  If not, see <http://www.gnu.org/licenses/>.
+
+
+///////////////////////////////////////////////////////////
+// Defines
+
+// Baud divisors (50MHz / baud - 1)
+#define SERIAL_921600		53
+#define SERIAL_115200		433
+#define SERIAL_9600			5207
+
+///////////////////////////////////////////////////////////
+// Globals
+
+// Serial channels interrupts (INT_SERIAL0..3 bits), set in IRQ handler (see isr.s)
+extern unsigned char	g_serial_event;
+
+///////////////////////////////////////////////////////////
+// Functions
+
+void			serialInit		(unsigned char Channel, unsigned short Divisor, unsigned char Control);
+unsigned short	serialWrite		(unsigned char Channel, const unsigned char *Data, unsigned short Length);
+unsigned short	serialRead		(unsigned char Channel, unsigned char *Data, unsigned short Length);
+void			irqSerial		(void);						// IRQ handler (see irq.h)
\ No newline at end of file
@@ -0,0 +1,195 @@
+// Copyright 2023 Luca Bertossi
+//
+// This file is part of B65.
+// 
+//     B65 is free software: you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation, either version 3 of the License, or
+//     (at your option) any later version.
+// 
+//     B65 is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+// 
+//     You should have received a copy of the GNU General Public License
+//     along with B65.  If not, see <http://www.gnu.org/licenses/>.
+
+///////////////////////////////////////////////////////////
+// Includes
+
+#include <stddef.h>
+
+#include "extension.h"
+#include "timer.h"
+#include "task.h"
+
+///////////////////////////////////////////////////////////
+// Globals
+
+// Variables shared with assembler; they're set in IRQ handler (see isr.s)
+unsigned char	g_task_events;
+unsigned char	g_task_wake;
+
+unsigned short	g_task_max_round;
+
+///////////////////////////////////////////////////////////
+// Assembler routines
+
+extern void cpu_wait();
+
+///////////////////////////////////////////////////////////
+// Static functions
+
+///////////////////////////////////////////////////////////
+///
+/// Read the low 16 bits of the microseconds counter
+///
+/// \note	enough for a task run or a round (up to 65ms)
+///
+///////////////////////////////////////////////////////////
+static unsigned short taskMicroseconds(void)
+{
+	unsigned short Value;
+
+	// The lowest byte first, it latches the others
+	((unsigned char*) &Value)[0] = R_TMR_MICROSECONDS0;
+	((unsigned char*) &Value)[1] = R_TMR_MICROSECONDS1;
+
+	return Value;
+}
+
+///////////////////////////////////////////////////////////
+// Functions
+
+///////////////////////////////////////////////////////////
+///
+/// Start (or restart from the beginning) a task
+///
+///	\param	Task		:	Task
+///	\param	Function	:	Task body (see TASK_BEGIN)
+///
+///////////////////////////////////////////////////////////
+void taskStart(TASK *Task, TASK_FUNCTION Function)
+{
+	Task->line		= 0;
+	Task->function	= Function;
+	g_task_wake		= 1;
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Stop a task, it's not called anymore
+///
+///	\param	Task		:	Task
+///
+///////////////////////////////////////////////////////////
+void taskStop(TASK *Task)
+{
+	Task->function	= NULL;
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Set events (see TASK_WAIT_EVENT)
+///
+///	\param	Events		:	Events bits
+///
+/// \note	it can be called with the interrupts disabled (C IRQ
+///			handlers too): the interrupt flag is restored
+///
+///////////////////////////////////////////////////////////
+void taskSignal(unsigned char Events)
+{
+	// The IRQ handlers set bits too
+	asm("php");
+	asm("sei");
+	g_task_events  |= Events;
+	asm("plp");
+
+	g_task_wake		= 1;
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Get and clear events
+///
+///	\param	Events		:	Events bits to check
+///
+/// \return	unsigned char	:	the set bits of Events (zero if none)
+///
+///////////////////////////////////////////////////////////
+unsigned char taskEvent(unsigned char Events)
+{
+	asm("php");
+	asm("sei");
+	Events		   &= g_task_events;
+	g_task_events  &= ~Events;
+	asm("plp");
+
+	return Events;
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Run the tasks forever (round robin, in array order)
+///
+///	\param	Tasks		:	Array of tasks, stopped ones are skipped (see taskStart)
+///	\param	Count		:	Number of tasks
+///
+/// \note	When no task is ready the CPU sleeps until the next
+///			interrupt (at least one each timer period): a blocked
+///			task is checked again after any interrupt.
+///
+///			The run time of each task and of each round is measured,
+///			the longest ones are kept (TASK maxTime, g_task_max_round)
+///
+///////////////////////////////////////////////////////////
+void taskRun(TASK * const *Tasks, unsigned char Count)
+{
+	TASK		   *Task;
+	unsigned char	Index;
+	unsigned char	Ready;
+	unsigned short	Round;
+	unsigned short	Start;
+	unsigned short	Time;
+
+	while (1)
+	{
+		// Any interrupt from now on needs a new round
+		g_task_wake	= 0;
+		Ready		= 0;
+		Round		= taskMicroseconds();
+
+		for (Index = 0; Index < Count; Index++)
+		{
+			Task = Tasks[Index];
+			if (Task->function == NULL)
+				continue;
+
+			Start = taskMicroseconds();
+
+			switch (Task->function(Task))
+			{
+				case TASK_READY:	Ready = 1;					break;
+				case TASK_ENDED:	Task->function = NULL;		break;
+			}
+
+			Time = taskMicroseconds() - Start;
+			if (Time > Task->maxTime)
+				Task->maxTime = Time;
+		}
+
+		Time = taskMicroseconds() - Round;
+		if (Time > g_task_max_round)
+			g_task_max_round = Time;
+
+		// Sleep until the next interrupt if all the tasks are blocked
+		asm("sei");
+
+		if ((Ready == 0) && (g_task_wake == 0))
+			cpu_wait();
+		else
+			asm("cli");
+	}
+}
\ No newline at end of file
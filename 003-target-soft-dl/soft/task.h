@@ -0,0 +1,100 @@
+// Copyright 2023 Luca Bertossi
+//
+// This file is part of B65.
+// 
+//     B65 is free software: you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation, either version 3 of the License, or
+//     (at your option) any later version.
+// 
+//     B65 is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+// 
+//     You should have received a copy of the GNU General Public License
+//     along with B65.  If not, see <http://www.gnu.org/licenses/>.
+
+///////////////////////////////////////////////////////////
+// Cooperative tasks (protothreads)
+//
+// A task is a function called by the scheduler at every round (see taskRun); it runs until
+// it yields or blocks, then it's called again and goes on from the same point (a switch
+// on the line of the last TASK_YIELD / TASK_WAIT_UNTIL, Duff's device).
+//
+// The task function local variables are lost at every yield: keep the state in statics or
+// in the task owner data, and don't put TASK_xxx macros inside a switch statement.
+//
+//	unsigned char blinkTask(TASK *Task)
+//	{
+//		TASK_BEGIN(Task);
+//		while (1)
+//		{
+//			R_OUT0 ^= 0xFF;
+//			TASK_SLEEP(Task, 500);
+//		}
+//		TASK_END(Task);
+//	}
+
+///////////////////////////////////////////////////////////
+// Defines
+
+// Task function results
+#define TASK_READY					0		// Yielded, call again at the next round
+#define TASK_WAITING				1		// Blocked on a condition (the CPU can sleep until an interrupt)
+#define TASK_ENDED					2		// Done, the scheduler doesn't call it anymore
+
+// Events set by the IRQ handlers (the interrupt source bits, see isr.s),
+// the other bits are free for taskSignal
+#define TASK_EVENT_INPUT			(INT_INPUT | INT_EVENT)
+
+// Task body start and end
+#define TASK_BEGIN(Task)			switch ((Task)->line) { case 0:
+#define TASK_END(Task)				} (Task)->line = 0; return TASK_ENDED
+
+// Give the CPU to the other tasks, go on at the next round
+#define TASK_YIELD(Task)			do { (Task)->line = __LINE__; return TASK_READY; case __LINE__: ; } while (0)
+
+// Block until Cond is true (checked at every round)
+#define TASK_WAIT_UNTIL(Task, Cond)	do { (Task)->line = __LINE__; case __LINE__: if (!(Cond)) return TASK_WAITING; } while (0)
+
+// Block for Ms milliseconds (timer ticks, up to 32767)
+#define TASK_SLEEP(Task, Ms)		do { (Task)->wake = timerTicks() + (Ms); TASK_WAIT_UNTIL(Task, (signed short) (timerTicks() - (Task)->wake) >= 0); } while (0)
+
+// Block until one of the Events is set (the received events are cleared)
+#define TASK_WAIT_EVENT(Task, Events)	TASK_WAIT_UNTIL(Task, taskEvent(Events) != 0)
+
+///////////////////////////////////////////////////////////
+// Structures
+
+typedef struct _TASK_ TASK;
+
+typedef unsigned char (*TASK_FUNCTION)(TASK *Task);
+
+struct _TASK_
+{
+	const unsigned char		   *name;
+	TASK_FUNCTION				function;		// Task body, NULL while stopped
+	unsigned short				line;			// Resume point (see TASK_BEGIN)
+	unsigned short				wake;			// TASK_SLEEP end (timer ticks)
+	unsigned short				maxTime;		// Longest run (microseconds)
+};
+
+///////////////////////////////////////////////////////////
+// Globals
+
+// Shared with assembler (see isr.s)
+extern unsigned char	g_task_events;		// Pending events (see taskSignal)
+extern unsigned char	g_task_wake;		// Set by any interrupt, the scheduler doesn't sleep
+
+// Longest scheduler round (microseconds), the worst case latency of a ready task
+extern unsigned short	g_task_max_round;
+
+///////////////////////////////////////////////////////////
+// Functions
+
+void			taskStart		(TASK *Task, TASK_FUNCTION Function);
+void			taskStop		(TASK *Task);
+void			taskSignal		(unsigned char Events);
+unsigned char	taskEvent		(unsigned char Events);
+void			taskRun			(TASK * const *Tasks, unsigned char Count);
\ No newline at end of file
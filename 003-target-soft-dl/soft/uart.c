@@ -19,36 +19,187 @@
 // Includes
 
 #include "extension.h"
+#include "lib.h"
+#include "uart.h"
+#include "fmt.h"
+
+///////////////////////////////////////////////////////////
+// Globals
+
+// Variables shared with assembler; they're updated in IRQ handler (see isr.s)
+unsigned char	g_uart_rx_ring[UART_RING_SIZE];
+unsigned char	g_uart_rx_head;
+unsigned char	g_uart_rx_tail;
+unsigned char	g_uart_rx_overflow;
+unsigned char	g_uart_tx_ring[UART_RING_SIZE];
+unsigned char	g_uart_tx_head;
+unsigned char	g_uart_tx_tail;
 
 ///////////////////////////////////////////////////////////
 // Functions
 
+///////////////////////////////////////////////////////////
+///
+/// Initialize the UART driver
+///
+/// The rings are empty (BSS), enable the TX interrupt: the
+/// IRQ handler refills the TX fifo from the TX ring
+///
+///////////////////////////////////////////////////////////
+void uartInit(void)
+{
+	R_MODE |= MODE_TX_IRQ;
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Read a char from the RX ring without waiting
+///
+///	\param	ch		:	read char
+///
+///	\return	1 if a char is read, 0 if the RX ring is empty
+///
+///////////////////////////////////////////////////////////
+unsigned char uartRead(unsigned char *ch)
+{
+	unsigned char	Tail	= g_uart_rx_tail;
+
+	if (Tail == g_uart_rx_head)
+		return 0;
+
+	*ch				= g_uart_rx_ring[Tail];
+	g_uart_rx_tail	= Tail + 1;
+
+	return 1;
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Read chars from the RX ring without waiting
+///
+///	\param	Data	:	buffer for the read chars
+///	\param	Length	:	buffer size
+///
+///	\return	number of chars read (limited by the RX ring count)
+///
+///////////////////////////////////////////////////////////
+unsigned short uartReadBuffer(unsigned char *Data, unsigned short Length)
+{
+	unsigned char	Tail	= g_uart_rx_tail;
+	unsigned short	Count;
+
+	for (Count = 0; (Count < Length) && (Tail != g_uart_rx_head); ++Count)
+	{
+		Data[Count] = g_uart_rx_ring[Tail];
+		++Tail;
+	}
+
+	g_uart_rx_tail = Tail;
+
+	return Count;
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Queue a char to the TX ring without waiting
+///
+///	\param	ch		:	char to write to the UART
+///
+///	\return	1 if the char is queued, 0 if the TX ring is full
+///
+///////////////////////////////////////////////////////////
+unsigned char uartWrite(const unsigned char ch)
+{
+	unsigned char	Head	= g_uart_tx_head;
+
+	if ((unsigned char) (Head + 1) == g_uart_tx_tail)
+		return 0;
+
+	g_uart_tx_ring[Head]	= ch;
+	g_uart_tx_head			= Head + 1;
+
+	uartTxKick();
+
+	return 1;
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Queue chars to the TX ring without waiting
+///
+///	\param	Data	:	chars to write to the UART
+///	\param	Length	:	number of chars to write
+///
+///	\return	number of chars queued (limited by the TX ring free space)
+///
+///////////////////////////////////////////////////////////
+unsigned short uartWriteBuffer(const unsigned char *Data, unsigned short Length)
+{
+	unsigned char	Head	= g_uart_tx_head;
+	unsigned short	Count;
+
+	for (Count = 0; (Count < Length) && ((unsigned char) (Head + 1) != g_uart_tx_tail); ++Count)
+	{
+		g_uart_tx_ring[Head] = Data[Count];
+		++Head;
+	}
+
+	g_uart_tx_head = Head;
+
+	uartTxKick();
+
+	return Count;
+}
+
 ///////////////////////////////////////////////////////////
 ///
 /// Put a char to the UART
 ///
+/// The char is queued, it waits only while the TX ring is full
+///
 ///	\param	ch : char to write to the UART
 ///
 ///////////////////////////////////////////////////////////
 void uartPutchar(const unsigned char ch)
 {
-	R_TX = ch;
+	// uartTxKick moves the chars to the TX fifo even with interrupts disabled
+	while (uartWrite(ch) == 0)
+		uartTxKick();
 }
 
+#if (SOFT_ASM == 0)
 ///////////////////////////////////////////////////////////
 ///
 /// Put a string to the UART
 ///
+/// The string is queued, it waits only while the TX ring is full
+///
 ///	\param	st : string to write to the UART
 ///
 ///////////////////////////////////////////////////////////
-void uartPutstring(const unsigned char *st)
+void __fastcall__ uartPutstring(const unsigned char *st)
 {
+	unsigned char	Head	= g_uart_tx_head;
+
 	while(*st)
 	{
-		R_TX = *st;
-		++st;
+		if ((unsigned char) (Head + 1) == g_uart_tx_tail)
+		{
+			// TX ring full: publish the queued chars and wait for a free place
+			g_uart_tx_head = Head;
+			uartTxKick();
+		}
+		else
+		{
+			g_uart_tx_ring[Head] = *st;
+			++Head;
+			++st;
+		}
 	}
+
+	g_uart_tx_head = Head;
+
+	uartTxKick();
 }
 
 ///////////////////////////////////////////////////////////
@@ -58,12 +209,9 @@ void uartPutstring(const unsigned char *st)
 ///	\param	Byte : Byte to write to the UART
 ///
 ///////////////////////////////////////////////////////////
-void uartPutHexByte(const unsigned char Byte)
+void __fastcall__ uartPutHexByte(const unsigned char Byte)
 {
-	unsigned char Hi = (Byte  >> 4) & 0x0F;
-	unsigned char Lo = Byte & 0x0F;
-
-	// 7 is ascii 55, adding +10 = 65 i.e. 'A'
-	R_TX = ((Hi <= 9)  ? '0' : '7') + Hi;
-	R_TX = ((Lo <= 9)  ? '0' : '7') + Lo;
+	uartPutchar(g_fmt_hex[Byte >> 4]);
+	uartPutchar(g_fmt_hex[Byte & 0x0F]);
 }
+#endif
\ No newline at end of file
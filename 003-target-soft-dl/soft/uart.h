@@ -15,9 +15,41 @@
 //     You should have received a copy of the GNU General Public License
 //     along with B65.  If not, see <http://www.gnu.org/licenses/>.
 
+///////////////////////////////////////////////////////////
+// Defines
+
+// Ring buffers size: the indexes are unsigned char and wrap around (see isr.s)
+#define UART_RING_SIZE		256
+
+// Chars ready in the RX ring
+#define uartRxCount()		((unsigned char) (g_uart_rx_head - g_uart_rx_tail))
+
+// Free room in the TX ring (one slot is always empty)
+#define uartTxFree()		((unsigned char) (g_uart_tx_tail - g_uart_tx_head - 1))
+
+///////////////////////////////////////////////////////////
+// Globals
+
+// Ring buffers shared with assembler (see isr.s); each index is written by one side only:
+// the IRQ handler writes the RX ring and reads the TX ring
+extern unsigned char	g_uart_rx_ring[UART_RING_SIZE];
+extern unsigned char	g_uart_rx_head;		// RX write index (IRQ handler)
+extern unsigned char	g_uart_rx_tail;		// RX read index
+extern unsigned char	g_uart_rx_overflow;	// Set by the IRQ handler when a char is dropped (RX ring full)
+extern unsigned char	g_uart_tx_ring[UART_RING_SIZE];
+extern unsigned char	g_uart_tx_head;		// TX write index
+extern unsigned char	g_uart_tx_tail;		// TX read index (IRQ handler and uartTxKick)
+
 ///////////////////////////////////////////////////////////
 // Functions
 
-void uartPutchar	(const unsigned char  ch);
-void uartPutstring	(const unsigned char *st);
-void uartPutHexByte	(const unsigned char Byte);
\ No newline at end of file
+void			uartInit		(void);
+unsigned char	uartRead		(unsigned char *ch);
+unsigned short	uartReadBuffer	(unsigned char *Data, unsigned short Length);
+unsigned char	uartWrite		(const unsigned char ch);
+unsigned short	uartWriteBuffer	(const unsigned char *Data, unsigned short Length);
+void			uartTxKick		(void);
+
+void				uartPutchar		(const unsigned char  ch);
+void __fastcall__	uartPutstring	(const unsigned char *st);		// fast.s if SOFT_ASM
+void __fastcall__	uartPutHexByte	(const unsigned char Byte);		// fast.s if SOFT_ASM
\ No newline at end of file
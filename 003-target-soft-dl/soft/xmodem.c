@@ -0,0 +1,231 @@
+// Copyright 2023 Luca Bertossi
+//
+// This file is part of B65.
+// 
+//     B65 is free software: you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation, either version 3 of the License, or
+//     (at your option) any later version.
+// 
+//     B65 is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+// 
+//     You should have received a copy of the GNU General Public License
+//     along with B65.  If not, see <http://www.gnu.org/licenses/>.
+
+///////////////////////////////////////////////////////////
+// Includes
+
+#include "uart.h"
+#include "crc.h"
+#include "timer.h"
+#include "xmodem.h"
+
+///////////////////////////////////////////////////////////
+// Defines
+
+// Timeouts in timer ticks (1ms, see main)
+#define XMODEM_TIMEOUT			1000	// Wait for a char
+#define XMODEM_PURGE			100		// Line quiet after an error
+
+// Retries
+#define XMODEM_MAX_START		60		// 'C' sent waiting for the sender (one each timeout)
+#define XMODEM_MAX_ERRORS		10		// Consecutive errors on a block
+
+///////////////////////////////////////////////////////////
+// Static functions
+
+///////////////////////////////////////////////////////////
+///
+/// Receive bytes, waiting up to Timeout between them
+///
+///	\param	Data	:	received bytes
+///	\param	Length	:	number of bytes
+///	\param	Timeout	:	timer ticks
+///
+///	\return	1 if all the bytes are received, 0 on timeout
+///
+///////////////////////////////////////////////////////////
+static unsigned char xmodemGet(unsigned char *Data, unsigned short Length, unsigned short Timeout)
+{
+	unsigned short Start = timerTicks();
+	unsigned short Count;
+
+	while (Length != 0)
+	{
+		Count = uartReadBuffer(Data, Length);
+		if (Count != 0)
+		{
+			Data   += Count;
+			Length -= Count;
+			Start	= timerTicks();
+		}
+		else if ((unsigned short) (timerTicks() - Start) >= Timeout)
+			return 0;
+	}
+
+	return 1;
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Discard the received chars until the line is quiet
+///
+///////////////////////////////////////////////////////////
+static void xmodemPurge(void)
+{
+	unsigned char Byte;
+
+	while (xmodemGet(&Byte, 1, XMODEM_PURGE));
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Cancel the transfer
+///
+///////////////////////////////////////////////////////////
+static void xmodemCancel(void)
+{
+	xmodemPurge();
+
+	uartPutchar(XMODEM_CAN);
+	uartPutchar(XMODEM_CAN);
+	uartPutchar(XMODEM_CAN);
+}
+
+///////////////////////////////////////////////////////////
+// Functions
+
+///////////////////////////////////////////////////////////
+///
+/// Receive a file with XMODEM-CRC
+///
+/// The blocks are received in place and checked with the
+/// CRC block (CRC-16 with seed 0); the last block is
+/// padded by the sender (usually with 0x1A)
+///
+///	\param	Data	:	destination buffer
+///	\param	Size	:	destination buffer size
+///	\param	Length	:	received bytes (blocks size multiple)
+///
+///	\return	XMODEM_OK or XMODEM_ERR_xxx
+///
+///	\note	it needs the periodic 1ms timer interrupt
+///
+///////////////////////////////////////////////////////////
+unsigned char xmodemReceive(unsigned char *Data, unsigned short Size, unsigned short *Length)
+{
+	unsigned char	Header[2];
+	unsigned char	Crc[2];
+	unsigned char	Byte;
+	unsigned char	Block		= 1;			// Expected block number
+	unsigned char	Reply		= XMODEM_CRC;	// 'C' until the first block, then ACK or NAK
+	unsigned char	Errors		= 0;
+	unsigned short	Offset		= 0;			// Acknowledged bytes
+	unsigned short	BlockSize;
+	unsigned short	LastSize	= 0;
+	unsigned short	Dest;
+
+	*Length = 0;
+
+	while (1)
+	{
+		uartPutchar(Reply);
+
+		if (xmodemGet(&Byte, 1, XMODEM_TIMEOUT) == 0)
+		{
+			Errors++;
+			if (Errors >= ((Reply == XMODEM_CRC) ? XMODEM_MAX_START : XMODEM_MAX_ERRORS))
+			{
+				xmodemCancel();
+				return XMODEM_ERR_TIMEOUT;
+			}
+
+			if (Reply != XMODEM_CRC)
+				Reply = XMODEM_NAK;
+			continue;
+		}
+
+		switch (Byte)
+		{
+			case XMODEM_SOH:	BlockSize = 128;	break;
+			case XMODEM_STX:	BlockSize = 1024;	break;
+
+			case XMODEM_EOT:
+				uartPutchar(XMODEM_ACK);
+				*Length = Offset;
+			return XMODEM_OK;
+
+			case XMODEM_CAN:
+			return XMODEM_ERR_CANCEL;
+
+			// Line noise
+			default:
+				xmodemPurge();
+			continue;
+		}
+
+		// Block number and its complement
+		if ((xmodemGet(Header, 2, XMODEM_TIMEOUT) == 0) || ((Header[0] ^ Header[1]) != 0xFF))
+		{
+			xmodemPurge();
+			Reply = XMODEM_NAK;
+			Errors++;
+			continue;
+		}
+
+		// A repeated block (the ACK was lost) is received again in the same place
+		if (Header[0] == Block)
+			Dest = Offset;
+		else if ((Header[0] == (unsigned char) (Block - 1)) && (LastSize == BlockSize))
+			Dest = Offset - LastSize;
+		else
+		{
+			xmodemCancel();
+			return XMODEM_ERR_SEQUENCE;
+		}
+
+		if (BlockSize > Size - Dest)
+		{
+			xmodemCancel();
+			return XMODEM_ERR_SIZE;
+		}
+
+		// Data and CRC (big endian)
+		if ((xmodemGet(Data + Dest, BlockSize, XMODEM_TIMEOUT) == 0) || (xmodemGet(Crc, 2, XMODEM_TIMEOUT) == 0))
+		{
+			xmodemPurge();
+			Reply = XMODEM_NAK;
+			Errors++;
+		}
+		else
+		{
+			crcSeed(CRC_16, 0);
+			if ((unsigned short) crcMemoryAdd(CRC_16, Data + Dest, BlockSize) != ((Crc[0] << 8) | Crc[1]))
+			{
+				Reply = XMODEM_NAK;
+				Errors++;
+			}
+			else
+			{
+				if (Dest == Offset)
+				{
+					Block++;
+					Offset	   += BlockSize;
+					LastSize	= BlockSize;
+				}
+
+				Reply	= XMODEM_ACK;
+				Errors	= 0;
+			}
+		}
+
+		if (Errors >= XMODEM_MAX_ERRORS)
+		{
+			xmodemCancel();
+			return XMODEM_ERR_TIMEOUT;
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,43 @@
+// Copyright 2023 Luca Bertossi
+//
+// This file is part of B65.
+// 
+//     B65 is free software: you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation, either version 3 of the License, or
+//     (at your option) any later version.
+// 
+//     B65 is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+// 
+//     You should have received a copy of the GNU General Public License
+//     along with B65.  If not, see <http://www.gnu.org/licenses/>.
+
+///////////////////////////////////////////////////////////
+// XMODEM-CRC receiver (128 bytes blocks, 1024 bytes blocks of XMODEM-1K too)
+
+///////////////////////////////////////////////////////////
+// Defines
+
+// Control chars
+#define XMODEM_SOH				0x01	// 128 bytes block
+#define XMODEM_STX				0x02	// 1024 bytes block
+#define XMODEM_EOT				0x04	// End of transfer
+#define XMODEM_ACK				0x06
+#define XMODEM_NAK				0x15
+#define XMODEM_CAN				0x18	// Cancel
+#define XMODEM_CRC				'C'		// Receiver start, CRC mode
+
+// Results
+#define XMODEM_OK				0
+#define XMODEM_ERR_TIMEOUT		1		// No sender or too many errors
+#define XMODEM_ERR_CANCEL		2		// Cancelled by the sender
+#define XMODEM_ERR_SIZE			3		// The data doesn't fit the buffer
+#define XMODEM_ERR_SEQUENCE		4		// Unexpected block number
+
+///////////////////////////////////////////////////////////
+// Functions
+
+unsigned char	xmodemReceive	(unsigned char *Data, unsigned short Size, unsigned short *Length);
\ No newline at end of file
@@ -0,0 +1,459 @@
+// Copyright 2023 Luca Bertossi
+//
+// This file is part of B65.
+// 
+//     B65 is free software: you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation, either version 3 of the License, or
+//     (at your option) any later version.
+// 
+//     B65 is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+// 
+//     You should have received a copy of the GNU General Public License
+//     along with B65.  If not, see <http://www.gnu.org/licenses/>.
+
+///////////////////////////////////////////////////////////////////////////////
+// b65 compiled simulation testbench (Verilator)
+//
+// Drives the Verilog model of top.vhd (ghdl --synth, see b65Verilator in b65.sh) as b65.vhd does:
+// reset, software download of b65.rom on the UART, then the host requests of b65.host and the
+// standard input (a console terminal when interactive). The UART output of the board goes to
+// the standard output and to the optional capture file, the leds changes to the standard error.
+//
+// Usage: b65sim [options] <rom file>   (see Usage)
+
+#include <verilated.h>
+#include "Vtop.h"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+///////////////////////////////////////////////////////////////////////////////
+// Defines
+
+// Board clock and UART (see uart.vhd)
+#define CLOCK_HZ			50000000					// FPGA clock
+#define UART_BAUD			921600						// UART baud rate
+#define UART_BIT			(CLOCK_HZ / UART_BAUD)		// FPGA clocks per bit
+
+// Testbench timing (see b65.vhd)
+#define RESET_CLOCKS		25							// 500ns board reset
+#define DOWNLOAD_CLOCKS		64							// clocks from the reset to the software download
+#define HOST_CLOCKS			(CLOCK_HZ / 1000)			// host requests start 1ms after the download
+#define INPUT_CLOCKS		(CLOCK_HZ / 10000)			// standard input polled every 100us
+
+// UART transmit queue (a power of 2, larger than the biggest ROM)
+#define UART_QUEUE			0x10000
+
+///////////////////////////////////////////////////////////////////////////////
+// Types
+
+// UART transmitter (testbench -> board uart_rx), 8N1
+typedef struct
+{
+	unsigned char	Queue[UART_QUEUE];		// bytes to send
+	unsigned int	Head;					// next free position
+	unsigned int	Tail;					// next byte to send
+	unsigned int	Shift;					// start, data and stop bits, LSB first
+	int				Bits;					// bits left in Shift (0 = line idle)
+	int				Count;					// clocks left in the current bit
+} UART_TX;
+
+// UART receiver (board uart_tx -> testbench), 8N1
+typedef struct
+{
+	int				State;					// 0 = wait start bit, 1-8 = data bits, 9 = stop bit
+	int				Count;					// clocks to the middle of the next bit
+	unsigned int	Data;					// received bits
+} UART_RX;
+
+///////////////////////////////////////////////////////////////////////////////
+// Globals
+
+static UART_TX			Tx;
+static UART_RX			Rx;
+static volatile int		Stop		= 0;		// set by SIGINT
+static int				Terminal	= 0;		// standard input is a terminal (raw mode)
+static struct termios	TerminalMode;			// standard input mode to restore
+
+///////////////////////////////////////////////////////////////////////////////
+/// Print the command usage
+///
+static void Usage(void)
+{
+	fprintf(stderr, "Usage: b65sim [options] <rom file>\n");
+	fprintf(stderr, "\n");
+	fprintf(stderr, "  -t <time>  stop time (ghdl format: 500us, 20ms, 1s; default run until Ctrl-C)\n");
+	fprintf(stderr, "  -h <file>  host requests sent 1ms after the software download (b65.host)\n");
+	fprintf(stderr, "  -u <file>  bytes received from the board (b65.uart)\n");
+	fprintf(stderr, "  -s <hex>   slides value (default 0000)\n");
+	fprintf(stderr, "  -p <hex>   push buttons value (default 0)\n");
+	fprintf(stderr, "\n");
+	fprintf(stderr, "The standard input is sent to the board UART after the host requests.\n");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// Convert a ghdl style time (number and us, ms or s unit) to FPGA clocks
+///
+/// @param Text   time text
+///
+/// @return clocks, 0 if not valid
+///
+static unsigned long long ParseTime(const char *Text)
+{
+	char		*End;
+	double		Value	= strtod(Text, &End);
+
+	if (Value <= 0)
+		return 0;
+
+	if (strcmp(End, "us") == 0)
+		return (unsigned long long)(Value * (CLOCK_HZ / 1000000));
+	if (strcmp(End, "ms") == 0)
+		return (unsigned long long)(Value * (CLOCK_HZ / 1000));
+	if (strcmp(End, "s") == 0)
+		return (unsigned long long)(Value * CLOCK_HZ);
+
+	return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// Add bytes to the UART transmit queue
+///
+/// @param Data   bytes
+/// @param Size   number of bytes
+///
+/// @return number of bytes queued (the queue may be full)
+///
+static int TxSend(const unsigned char *Data, int Size)
+{
+	int		Sent;
+
+	for (Sent = 0; (Sent < Size) && ((Tx.Head - Tx.Tail) < UART_QUEUE); Sent++)
+		Tx.Queue[Tx.Head++ & (UART_QUEUE - 1)] = Data[Sent];
+
+	return Sent;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// UART transmitter clock
+///
+/// @return uart_rx line level
+///
+static int TxClock(void)
+{
+	int		Level;
+
+	if (Tx.Bits == 0)
+	{
+		if (Tx.Head == Tx.Tail)
+			return 1;
+
+		// Stop bit, data, start bit
+		Tx.Shift	= 0x200 | (Tx.Queue[Tx.Tail++ & (UART_QUEUE - 1)] << 1);
+		Tx.Bits		= 10;
+		Tx.Count	= UART_BIT;
+	}
+
+	Level = Tx.Shift & 1;
+
+	if (--Tx.Count == 0)
+	{
+		Tx.Shift	>>= 1;
+		Tx.Bits--;
+		Tx.Count	= UART_BIT;
+	}
+
+	return Level;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// UART receiver clock
+///
+/// @param Line   uart_tx line level
+///
+/// @return received byte, -1 if none
+///
+static int RxClock(int Line)
+{
+	if (Rx.State == 0)
+	{
+		// Start bit: sample the data bits in their middle
+		if (Line == 0)
+		{
+			Rx.State	= 1;
+			Rx.Count	= UART_BIT + UART_BIT / 2;
+			Rx.Data		= 0;
+		}
+		return -1;
+	}
+
+	if (--Rx.Count != 0)
+		return -1;
+
+	Rx.Count = UART_BIT;
+
+	if (Rx.State <= 8)
+	{
+		Rx.Data |= (Line & 1) << (Rx.State - 1);
+		Rx.State++;
+		return -1;
+	}
+
+	// Stop bit (a framing error drops the byte)
+	Rx.State = 0;
+	return Line ? (int)Rx.Data : -1;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// Restore the terminal mode (at exit)
+///
+static void TerminalRestore(void)
+{
+	if (Terminal)
+		tcsetattr(STDIN_FILENO, TCSANOW, &TerminalMode);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// Ctrl-C handler: stop the simulation at the next clock
+///
+static void StopHandler(int Signal)
+{
+	(void)Signal;
+	Stop = 1;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// Read a whole file
+///
+/// @param Name   file name
+/// @param Size   file size (output)
+///
+/// @return file data (to free), NULL on error
+///
+static unsigned char *FileRead(const char *Name, int *Size)
+{
+	FILE			*File	= fopen(Name, "rb");
+	unsigned char	*Data;
+	long			Length;
+
+	if (File == NULL)
+		return NULL;
+
+	fseek(File, 0, SEEK_END);
+	Length = ftell(File);
+	fseek(File, 0, SEEK_SET);
+
+	Data = (unsigned char *)malloc(Length > 0 ? Length : 1);
+	if ((Data != NULL) && (fread(Data, 1, Length, File) != (size_t)Length))
+	{
+		free(Data);
+		Data = NULL;
+	}
+
+	fclose(File);
+	*Size = (int)Length;
+	return Data;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// Main
+///
+int main(int argc, char **argv)
+{
+	const char			*RomName	= NULL;
+	const char			*HostName	= NULL;
+	const char			*UartName	= NULL;
+	FILE				*UartFile	= NULL;
+	unsigned char		*Rom;
+	unsigned char		*Host		= NULL;
+	int					RomSize;
+	int					HostSize	= 0;
+	int					HostSent	= 0;
+	int					Input		= 1;		// standard input open
+	unsigned int		Slides		= 0;
+	unsigned int		Push		= 0;
+	unsigned int		Leds		= 0;
+	unsigned long long	StopClocks	= 0;
+	unsigned long long	Clocks;
+	unsigned long long	HostClocks	= 0;		// clock of the host requests start (0 = download running)
+	struct timespec		Start;
+	struct timespec		End;
+	double				Seconds;
+	int					Option;
+
+	// Arguments
+	while ((Option = getopt(argc, argv, "t:h:u:s:p:")) != -1)
+	{
+		switch (Option)
+		{
+			case 't':
+				StopClocks = ParseTime(optarg);
+				if (StopClocks == 0)
+				{
+					fprintf(stderr, "ERROR : invalid stop time %s\n", optarg);
+					return 1;
+				}
+				break;
+
+			case 'h':	HostName	= optarg;								break;
+			case 'u':	UartName	= optarg;								break;
+			case 's':	Slides		= strtoul(optarg, NULL, 16) & 0xFFFF;	break;
+			case 'p':	Push		= strtoul(optarg, NULL, 16) & 0xF;		break;
+
+			default:
+				Usage();
+				return 1;
+		}
+	}
+
+	if (optind != argc - 1)
+	{
+		Usage();
+		return 1;
+	}
+	RomName = argv[optind];
+
+	// Software and host requests
+	Rom = FileRead(RomName, &RomSize);
+	if (Rom == NULL)
+	{
+		fprintf(stderr, "ERROR : can't read %s\n", RomName);
+		return 1;
+	}
+
+	if (HostName != NULL)
+	{
+		Host = FileRead(HostName, &HostSize);
+		if (Host == NULL)
+			fprintf(stderr, "INFO  : no host requests (%s not found)\n", HostName);
+	}
+
+	if (UartName != NULL)
+	{
+		UartFile = fopen(UartName, "wb");
+		if (UartFile == NULL)
+		{
+			fprintf(stderr, "ERROR : can't create %s\n", UartName);
+			return 1;
+		}
+	}
+
+	// Interactive console: keys are sent as typed, the board echoes them
+	if (isatty(STDIN_FILENO) && (tcgetattr(STDIN_FILENO, &TerminalMode) == 0))
+	{
+		struct termios	Raw	= TerminalMode;
+
+		Raw.c_lflag &= ~(ICANON | ECHO);
+		Raw.c_cc[VMIN]	= 0;
+		Raw.c_cc[VTIME]	= 0;
+		Terminal = (tcsetattr(STDIN_FILENO, TCSANOW, &Raw) == 0);
+		atexit(TerminalRestore);
+	}
+	signal(SIGINT, StopHandler);
+
+	// Model
+	VerilatedContext	*Context	= new VerilatedContext;
+	Context->commandArgs(argc, argv);
+	Vtop				*Top		= new Vtop(Context);
+
+	Top->clock		= 0;
+	Top->reset		= 1;
+	Top->slide		= Slides;
+	Top->push		= Push;
+	Top->uart_rx	= 1;
+	Top->serial_rx	= 0;
+	Top->eval();
+
+	fprintf(stderr, "INFO  : software download of %s (%d bytes)\n", RomName, RomSize);
+	clock_gettime(CLOCK_MONOTONIC, &Start);
+
+	for (Clocks = 0; !Stop && ((StopClocks == 0) || (Clocks < StopClocks)); Clocks++)
+	{
+		int		Byte;
+
+		// Inputs (the serial channels are looped back as in b65.vhd)
+		Top->reset		= (Clocks < RESET_CLOCKS);
+		Top->uart_rx	= TxClock();
+		Top->serial_rx	= Top->serial_tx;
+
+		// One FPGA clock
+		Top->clock		= 1;
+		Top->eval();
+		Top->clock		= 0;
+		Top->eval();
+
+		// Board UART output
+		Byte = RxClock(Top->uart_tx);
+		if (Byte >= 0)
+		{
+			putchar(Byte);
+			fflush(stdout);
+			if (UartFile != NULL)
+				fputc(Byte, UartFile);
+		}
+
+		// Leds changes
+		if (Top->led != Leds)
+		{
+			Leds = Top->led;
+			fprintf(stderr, "%12.3f us: led %04X\n", (double)Clocks * 1000000 / CLOCK_HZ, Leds);
+		}
+
+		// Software download
+		if (Clocks == RESET_CLOCKS + DOWNLOAD_CLOCKS)
+			TxSend(Rom, RomSize);
+
+		if ((HostClocks == 0) && (Clocks > RESET_CLOCKS + DOWNLOAD_CLOCKS) && (Tx.Bits == 0) && (Tx.Head == Tx.Tail))
+			HostClocks = Clocks + HOST_CLOCKS;
+
+		if ((HostClocks == 0) || (Clocks < HostClocks))
+			continue;
+
+		// Host requests, then the standard input
+		if (HostSent < HostSize)
+			HostSent += TxSend(Host + HostSent, HostSize - HostSent);
+		else if (Input && ((Clocks % INPUT_CLOCKS) == 0) && ((Tx.Head - Tx.Tail) < UART_QUEUE / 2))
+		{
+			struct pollfd	Poll	= { STDIN_FILENO, POLLIN, 0 };
+			unsigned char	Keys[64];
+			ssize_t			Size;
+
+			if (poll(&Poll, 1, 0) > 0)
+			{
+				Size = read(STDIN_FILENO, Keys, sizeof(Keys));
+				if (Size > 0)
+					TxSend(Keys, (int)Size);
+				else if (!Terminal)
+					Input = 0;
+			}
+		}
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &End);
+	Seconds = (End.tv_sec - Start.tv_sec) + (End.tv_nsec - Start.tv_nsec) / 1e9;
+
+	fprintf(stderr, "\nINFO  : simulated %.3f ms in %.3f s (%.2f MHz FPGA clock, %.3f MHz CPU clock)\n",
+			(double)Clocks * 1000 / CLOCK_HZ, Seconds,
+			Seconds > 0 ? Clocks / Seconds / 1e6 : 0.0, Seconds > 0 ? Clocks / Seconds / 1e7 : 0.0);
+
+	Top->final();
+	delete Top;
+	delete Context;
+
+	if (UartFile != NULL)
+		fclose(UartFile);
+	free(Rom);
+	free(Host);
+	return 0;
+}
\ No newline at end of file
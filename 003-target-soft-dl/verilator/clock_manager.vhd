@@ -0,0 +1,103 @@
+-- Copyright 2023 Luca Bertossi
+--
+-- This file is part of B65.
+-- 
+--     B65 is free software: you can redistribute it and/or modify
+--     it under the terms of the GNU General Public License as published by
+--     the Free Software Foundation, either version 3 of the License, or
+--     (at your option) any later version.
+-- 
+--     B65 is distributed in the hope that it will be useful,
+--     but WITHOUT ANY WARRANTY; without even the implied warranty of
+--     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+--     GNU General Public License for more details.
+-- 
+--     You should have received a copy of the GNU General Public License
+--     along with B65.  If not, see <http://www.gnu.org/licenses/>.
+
+-------------------------------------------------------------------------------
+-- Clock generator - synthesizable model for the compiled simulation (see b65sim.cpp)
+--
+-- It replaces ../vhdl/clock_manager.vhd (the Xilinx clocking wizard in the FPGA): the FPGA clock
+-- is the input one and the CPU clock is divided from it, toggling every 5 rising edges with the
+-- same phase as the simulation model (CPU clock rising edges on FPGA clock rising edges).
+-- locked goes high 25 clocks (500ns) after the reset, as in the simulation model.
+
+-------------------------------------------------------------------------------
+-- Libraries
+
+library ieee;
+use ieee.std_logic_1164.all;
+
+library b65;
+
+-------------------------------------------------------------------------------
+-- Entity
+
+entity clock_manager is
+	generic	(
+				fast_sim				:			boolean				:= false			-- Unused (single generator)
+			);
+	port	(
+				-- General
+				clk_in1					: in		std_logic;								-- Clock
+				reset					: in		std_logic;								-- reset
+				locked					: out		std_logic;								-- locked
+				
+				-- Generated clocks
+				clk_out1				: out		std_logic;								-- 50MHz FPGA
+				clk_out2				: out		std_logic								--  5MHz 6502 CPU ph0
+			);
+end clock_manager;
+
+-------------------------------------------------------------------------------
+-- Architecture
+
+architecture behavioral of clock_manager is
+
+	----------------------------------------------------------------------------
+	-- Signals
+
+	signal cpu_clock		: std_logic						:= '0';
+	signal cpu_count		: integer range 0 to 4			:= 0;		-- FPGA clocks in the CPU half period
+	signal lock_count		: integer range 0 to 25			:= 0;		-- FPGA clocks from the reset
+
+begin
+
+	---------------------------------------------------------------------------
+	-- Hardwired
+
+	clk_out1	<= clk_in1;
+	clk_out2	<= cpu_clock;
+	locked		<= '1' when (lock_count = 25) else '0';
+
+	----------------------------------------------------------------------------
+	-- Processes
+
+	-- Locked generator
+	gen_locked : process(clk_in1) begin
+		if (clk_in1'event and clk_in1='1') then
+			if (reset = '1') then
+				lock_count			<= 0;
+			elsif (lock_count /= 25) then
+				lock_count			<= lock_count + 1;
+			end if;
+		end if; -- clock event
+	end process;
+
+	-- 6502 CPU clock generator (free running as the simulation model one)
+	cpu_clock_gen : process(clk_in1) begin
+		if (clk_in1'event and clk_in1='1') then
+			if (cpu_count = 4) then
+				cpu_count			<= 0;
+				cpu_clock			<= not cpu_clock;
+			else
+				cpu_count			<= cpu_count + 1;
+			end if;
+		end if; -- clock event
+	end process;
+
+end behavioral;
+
+-------------------------------------------------------------------------------
+-- EOF
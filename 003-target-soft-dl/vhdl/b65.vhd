@@ -35,6 +35,11 @@ use b65.PACK.all;
 -- Entity
 
 entity board is
+generic	(
+			checkpoint_save			:			integer				:= 0;				-- Save a checkpoint at the first CPU idle point after [us] (0 = none)
+			checkpoint_restore		:			boolean				:= false;			-- Start from the checkpoint instead of the software download
+			fast_sim				:			boolean				:= false				-- Simulation profile: no PWM and display multiplexing (digits in int_top.ext_digit)
+		);
 end board;
 
 -------------------------------------------------------------------------------
@@ -46,6 +51,22 @@ architecture behavioral of board is
 	-- Constants
 
 	constant filename	: string	:= "b65.rom";	-- rom filename
+	constant host_file	: string	:= "b65.host";	-- host requests (optional, see b65link)
+	constant uart_file	: string	:= "b65.uart";	-- bytes received from the board
+
+	-- Simulation checkpoint : the RAM (MAP_SIZE_RAM bytes) then the code ram (MAP_SIZE_ROM bytes)
+	--
+	-- It's saved when the CPU sleeps in cpu_wait (soft/direct.s): the CPU state is the stack pointer
+	-- and the return address on the stack, cpu_wait keeps them in a resume block at the top of page 0.
+	-- A restored run loads both memories at elaboration, the CPU boots at once (no download) and the
+	-- startup code goes back to sleep in cpu_wait with the saved stack, after setting the devices
+	-- again (they are out of reset, as their FIFOs). The host requests and the inputs simulation run
+	-- again from their start, as after a download.
+	constant checkpoint_file	: string						:= "b65.ckpt";
+	constant resume_mark		: integer						:= 16#FC#;		-- resume block valid flag address (see direct.s)
+	constant resume_valid		: std_logic_vector(7 downto 0)	:= x"B6";
+	constant checkpoint_idle	: integer						:= 100;			-- idle clocks before saving (10 CPU cycles, longer than any instruction)
+	constant checkpoint_timeout	: time							:= 50 ms;		-- no idle point found: WAI runs as a NOP (the CPU never stops)
 
 	----------------------------------------------------------------------------
 	-- Data types
@@ -54,7 +75,7 @@ architecture behavioral of board is
 	TYPE FSM_CTRL	is (ct_reset, ct_wait, ct_complete);
 
 	-- FSM - Donwload softwaew
-	TYPE FSM_DL	is (dl_wait, dl_run, dl_pause, dl_restart, dl_done);
+	TYPE FSM_DL	is (dl_wait, dl_run, dl_pause, dl_restart, dl_resume, dl_done);
 
 	-- File types
 	type CHAR_FILE is file of character;
@@ -76,6 +97,7 @@ architecture behavioral of board is
 	signal uart_control			: FSM_CTRL;												-- UART echo control FSM state
 	signal uart_rx				: std_logic;
 	signal uart_tx				: std_logic;
+	signal serial_loop			: std_logic_vector(SERIAL_CHANNELS - 1 downto 0);		-- Serial channels in loopback
 	signal uart_busy			: std_logic;
 	signal uart_rx_byte			: std_logic_vector(7 downto 0);
 	signal uart_rx_valid		: std_logic;
@@ -83,6 +105,8 @@ architecture behavioral of board is
 	signal uart_tx_valid		: std_logic;
 	signal uart_tx_byte_soft_dl	: std_logic_vector(7 downto 0);
 	signal uart_tx_valid_soft_dl: std_logic;
+	signal uart_tx_byte_host	: std_logic_vector(7 downto 0);
+	signal uart_tx_valid_host	: std_logic;
 	
 	-- Software download simulation
 	signal download_control		: FSM_DL;												-- Download control FSM
@@ -93,6 +117,10 @@ architecture behavioral of board is
 	-- Components
 
 	component top is
+	generic	(
+			restore_file			:			string				:= "";				-- RAM and code ram from a checkpoint
+			fast_sim				:			boolean				:= false				-- No PWM and display multiplexing
+		);
 	port(
 			-- General
 			clock					: in		std_logic;								-- Clock
@@ -109,21 +137,42 @@ architecture behavioral of board is
 
 			-- UART
 			uart_rx					: in		std_logic;								-- UART receive
-			uart_tx					: out		std_logic								-- UART transmit
+			uart_tx					: out		std_logic;								-- UART transmit
+
+			-- Serial channels (Pmod)
+			serial_rx				: in		std_logic_vector(SERIAL_CHANNELS - 1 downto 0);	-- Serial channels receive
+			serial_tx				: out		std_logic_vector(SERIAL_CHANNELS - 1 downto 0)	-- Serial channels transmit
 		);
 	end component;
+
+	----------------------------------------------------------------------------
+	-- Functions
+
+	-- Checkpoint file for the board, none for a normal run
+	function RestoreFile(restore : boolean) return string is
+	begin
+		if (restore) then
+			return checkpoint_file;
+		end if;
+
+		return "";
+	end;
  
 begin
 	---------------------------------------------------------------------------
 	-- Hardwired
 
-	uart_tx_byte	<= uart_tx_byte_soft_dl;
-	uart_tx_valid	<= uart_tx_valid_soft_dl;
+	uart_tx_byte	<= uart_tx_byte_host when (uart_tx_valid_host = '1') else uart_tx_byte_soft_dl;
+	uart_tx_valid	<= uart_tx_valid_soft_dl or uart_tx_valid_host;
 
 	----------------------------------------------------------------------------
 	-- Components map
 
 	int_top : top
+	generic map	(
+					restore_file				=> RestoreFile(checkpoint_restore),
+					fast_sim					=> fast_sim
+				)
 	port map	(
 					-- General
 					clock						=> clock,
@@ -135,7 +184,9 @@ begin
 					anode						=> open,
 					cathode						=> open,
 					uart_rx						=> uart_rx,
-					uart_tx						=> uart_tx
+					uart_tx						=> uart_tx,
+					serial_rx					=> serial_loop,
+					serial_tx					=> serial_loop
 			);
  	
 	inst_uart : uart
@@ -222,6 +273,10 @@ begin
 				download_done						<= '0';
 				download_wait						<= 0;
 				download_control					<= dl_wait;
+
+				if (checkpoint_restore) then
+					download_control				<= dl_resume;
+				end if;
 				
 				if (var_file_is_open /= 0) then
 					file_close(var_file_handle);
@@ -295,6 +350,12 @@ begin
 							end if;
 						end if;
 
+					-- Checkpoint restored: the code ram is already there, go on as after the download
+					when dl_resume =>
+						download_control			<= dl_done;
+						download_done				<= '1';
+						Log("Checkpoint [" & checkpoint_file & "] restored, no software download");
+
 					-- Download done, restart after 1M clocks (~20ms)
 					-- To simulate this ensure software main() routine calls upgrade() soon
 					when dl_done =>
@@ -316,6 +377,116 @@ begin
 		end if; -- clock
 	end process;	
 
+	-- Host requests : the b65.host file (b65link, b65cmd sim:<file>) is sent after the
+	-- software download, before the download restart (the board binary protocol)
+	host_requests : process
+		file		var_file_handle		: CHAR_FILE;
+		variable 	var_file_status		: FILE_OPEN_STATUS;
+		variable	var_char			: character;
+	begin
+		uart_tx_valid_host			<= '0';
+		uart_tx_byte_host			<= (others => '0');
+
+		wait until rising_edge(download_done);
+		wait for 1 ms;
+
+		file_open(var_file_status, var_file_handle, host_file, READ_MODE);
+		if (var_file_status = OPEN_OK) then
+			Log("Host requests start");
+
+			while not endfile(var_file_handle) loop
+				read(var_file_handle, var_char);
+
+				wait until rising_edge(clock);
+				uart_tx_byte_host	<= std_logic_vector(to_unsigned(character'pos(var_char), 8));
+				uart_tx_valid_host	<= '1';
+				wait until rising_edge(clock);
+				uart_tx_valid_host	<= '0';
+
+				-- Wait for the byte sent
+				loop
+					wait until rising_edge(clock);
+					exit when (uart_busy = '1');
+				end loop;
+				loop
+					wait until rising_edge(clock);
+					exit when (uart_busy = '0');
+				end loop;
+			end loop;
+
+			file_close(var_file_handle);
+			Log("Host requests completed");
+		end if;
+
+		wait;
+	end process;
+
+	-- Checkpoint save at the first CPU idle point after checkpoint_save microseconds: the resume block
+	-- is valid, no opcode fetch (the CPU is in WAI), no IRQ pending or being handled and both UARTs idle.
+	-- A CPU core running WAI as a NOP never stops fetching: the save gives up after checkpoint_timeout.
+	checkpoint : process
+		alias ram_memory		is <<signal .board.int_top.inst_ram.memory		: MEMORY_BYTES(0 to MAP_SIZE_RAM - 1)>>;
+		alias code_memory		is <<signal .board.int_top.inst_ram_code.memory	: MEMORY_BYTES(0 to MAP_SIZE_ROM - 1)>>;
+		alias cpu_sync			is <<signal .board.int_top.cpu_sync				: std_logic>>;
+		alias cpu_irq			is <<signal .board.int_top.cpu_irq				: std_logic>>;
+		alias zp_irq			is <<signal .board.int_top.zp_irq				: std_logic>>;
+		alias board_uart_busy	is <<signal .board.int_top.uart_busy			: std_logic>>;
+		file		var_file_handle		: CHAR_FILE;
+		variable	var_idle			: integer;
+		variable	var_start			: time;
+	begin
+		if (checkpoint_save = 0) then
+			wait;
+		end if;
+
+		wait for checkpoint_save * 1 us;
+		Log("Checkpoint waiting for the CPU idle");
+
+		var_idle	:= 0;
+		var_start	:= now;
+		while (var_idle < checkpoint_idle) loop
+			wait until rising_edge(clock);
+
+			if (now - var_start > checkpoint_timeout) then
+				Log("Checkpoint NOT saved: no CPU idle point in " & time'image(checkpoint_timeout) & " (WAI runs as a NOP? see the boot console command)");
+				wait;
+			end if;
+
+			if (ram_memory(resume_mark) = resume_valid) and (cpu_sync = '0') and (cpu_irq = '1') and (zp_irq = '0') and
+			   (board_uart_busy = '0') and (uart_busy = '0') then
+				var_idle	:= var_idle + 1;
+			else
+				var_idle	:= 0;
+			end if;
+		end loop;
+
+		file_open(var_file_handle, checkpoint_file, WRITE_MODE);
+
+		for address in 0 to MAP_SIZE_RAM - 1 loop
+			write(var_file_handle, character'val(to_integer(unsigned(ram_memory(address)))));
+		end loop;
+
+		for address in 0 to MAP_SIZE_ROM - 1 loop
+			write(var_file_handle, character'val(to_integer(unsigned(code_memory(address)))));
+		end loop;
+
+		file_close(var_file_handle);
+		Log("Checkpoint saved to [" & checkpoint_file & "]");
+
+		wait;
+	end process;
+
+	-- Capture the bytes sent by the board (b65cmd decode b65.uart shows the responses)
+	uart_capture : process(clock)
+		file		var_file_handle		: CHAR_FILE open WRITE_MODE is uart_file;
+	begin
+		if (clock'event and clock='1') then
+			if (reset = '0') and (uart_rx_valid = '1') then
+				write(var_file_handle, character'val(to_integer(unsigned(uart_rx_byte))));
+			end if;
+		end if;
+	end process;
+
 end behavioral;
 
 -------------------------------------------------------------------------------
@@ -34,6 +34,9 @@ library b65;
 -- Entity
 
 entity clock_manager is
+	generic	(
+				fast_sim				:			boolean				:= false			-- Simulation profile: one generator for both clocks
+			);
 	port	(
 				-- General
 				clk_in1					: in		std_logic;								-- Clock
@@ -64,28 +67,60 @@ begin
 		wait;
 	end process;
 
-	-- FPGA clock generator
-	fpga_clock : process begin
-		clk_out1		<= '0';
-		wait for (10 ns);
-		loop
-			clk_out1	<= '0';
-			wait for (10 ns);
-			clk_out1	<= '1';
-			wait for (10 ns);
-		end loop;
-	end process;
+	-- Separate generators
+	gen_clocks : if (not fast_sim) generate
 
-	-- 6502 CPU clock generator
-	cpu_clock : process begin
-		clk_out2		<= '0';
-		loop
-			clk_out2	<= '0';
-			wait for (100 ns);
-			clk_out2	<= '1';
-			wait for (100 ns);
-		end loop;
-	end process;
+		-- FPGA clock generator
+		fpga_clock : process begin
+			clk_out1		<= '0';
+			wait for (10 ns);
+			loop
+				clk_out1	<= '0';
+				wait for (10 ns);
+				clk_out1	<= '1';
+				wait for (10 ns);
+			end loop;
+		end process;
+
+		-- 6502 CPU clock generator
+		cpu_clock : process begin
+			clk_out2		<= '0';
+			loop
+				clk_out2	<= '0';
+				wait for (100 ns);
+				clk_out2	<= '1';
+				wait for (100 ns);
+			end loop;
+		end process;
+
+	end generate;
+
+	-- Simulation profile: the CPU clock is derived from the FPGA one in the same process (it toggles
+	-- every 5 FPGA clocks), the edges are the same as the separate generators ones
+	gen_fast : if (fast_sim) generate
+
+		fpga_cpu_clock : process
+			variable	var_half	: integer range 0 to 9;		-- FPGA clock toggles, the CPU clock toggles at 9
+		begin
+			clk_out1		<= '0';
+			clk_out2		<= '0';
+			var_half		:= 1;
+			wait for (20 ns);
+			loop
+				clk_out1	<= not clk_out1;
+
+				if (var_half = 9) then
+					clk_out2	<= not clk_out2;
+					var_half	:= 0;
+				else
+					var_half	:= var_half + 1;
+				end if;
+
+				wait for (10 ns);
+			end loop;
+		end process;
+
+	end generate;
 
 end behavioral;
 
@@ -0,0 +1,317 @@
+-- Copyright 2023 Luca Bertossi
+--
+-- This file is part of B65.
+-- 
+--     B65 is free software: you can redistribute it and/or modify
+--     it under the terms of the GNU General Public License as published by
+--     the Free Software Foundation, either version 3 of the License, or
+--     (at your option) any later version.
+-- 
+--     B65 is distributed in the hope that it will be useful,
+--     but WITHOUT ANY WARRANTY; without even the implied warranty of
+--     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+--     GNU General Public License for more details.
+-- 
+--     You should have received a copy of the GNU General Public License
+--     along with B65.  If not, see <http://www.gnu.org/licenses/>.
+
+----------------------------------------------------------------------------------
+-- CRC accelerator block
+
+-- Registers map (default all to zero)
+--
+--	Reg[0] : [RW] Control
+--			bit[7] = busy (read only, 1 while a memory transfer is running)
+--			bit[6] = unused
+--			bit[5] = unused
+--			bit[4] = unused
+--			bit[3] = unused
+--			bit[2] = start memory transfer (write 1, always read as 0)
+--			bit[1] = load seed into CRC    (write 1, always read as 0)
+--			bit[0] = CRC width             (0=CRC-16/CCITT    , 1=CRC-32)
+--
+--	Reg[1] : [RW] seed [ 7: 0]
+--	Reg[2] : [RW] seed [15: 8]
+--	Reg[3] : [RW] seed [23:16]
+--	Reg[4] : [RW] seed [31:24]
+--
+--	Reg[5] : [RO] result [ 7: 0]
+--	Reg[6] : [RO] result [15: 8]
+--	Reg[7] : [RO] result [23:16]
+--	Reg[8] : [RO] result [31:24]
+--
+--	Reg[9] : [WO] data byte to add to the CRC
+--
+--	Reg[A] : [RW] memory transfer start address [ 7: 0]
+--	Reg[B] : [RW] memory transfer start address [15: 8]
+--	Reg[C] : [RW] memory transfer length        [ 7: 0]
+--	Reg[D] : [RW] memory transfer length        [15: 8]
+--
+--	Reg[E] : unused
+--	Reg[F] : unused
+--
+-- CRC-16 is CRC-16/CCITT-FALSE : polynomial 0x1021, MSB first, result not inverted (seed is usually 0xFFFF)
+-- CRC-32 is CRC-32/ISO-HDLC    : polynomial 0x04C11DB7 reflected (0xEDB88320), LSB first, result inverted (seed is usually 0xFFFFFFFF)
+--
+-- The memory transfer reads [length] bytes starting from [address], from the RAM (below the registers)
+-- or from the code ram (MAP_START_ROM - 0xFFFF). A memory is read only when the CPU is not accessing it,
+-- the CPU is never stopped (polling the busy bit gives the maximum speed).
+-- Registers writes are ignored while the memory transfer is running.
+--
+
+-------------------------------------------------------------------------------
+-- Libraries
+
+library ieee;
+use ieee.std_logic_1164.all;
+use ieee.std_logic_unsigned.all;
+use ieee.numeric_std.all;
+
+library b65;
+use b65.PACK.all;
+
+-------------------------------------------------------------------------------
+-- Entity
+
+entity crc is
+	port	(
+				-- General
+				clock					: in		std_logic;								-- Clock
+				reset					: in		std_logic;								-- reset
+				enable					: in		std_logic;								-- block enable
+
+				-- Write interface
+				write_address			: in		std_logic_vector( 3	downto 0);			-- write Address
+				write_enable			: in		std_logic;								-- Write enable
+				write_data				: in		std_logic_vector( 7	downto 0);			-- Data IN
+
+				-- Read interface
+				read_address			: in		std_logic_vector( 3	downto 0);			-- read Address
+				read_data				: out		std_logic_vector( 7	downto 0);			-- Data OUT
+
+				-- Memory read interface
+				dma_request				: out		std_logic;								-- Memory read request
+				dma_grant				: in		std_logic;								-- Memory read granted (data is ready one clock later)
+				dma_address				: out		std_logic_vector(15	downto 0);			-- Memory read address
+				dma_data				: in		std_logic_vector( 7	downto 0)			-- Memory read data
+			);
+end crc;
+
+-------------------------------------------------------------------------------
+-- Architecture
+
+architecture behavioral of crc is
+
+	----------------------------------------------------------------------------
+	-- Data types
+
+	-- Memory data
+	type REGISTERS	is array(0 to  15) of std_logic_vector(7 downto 0);
+
+	-- FSM - Memory transfer
+	type FSM_DMA	is (dma_idle, dma_read, dma_wait);
+
+	----------------------------------------------------------------------------
+	-- Signals
+
+	-- Registers memory
+	signal reg						: REGISTERS;
+
+	-- Read / Write
+	signal read_keep				: std_logic;	-- Keep the samme value to read_data while enable is high
+	signal write_once				: std_logic;	-- Write once a register             while enable is high
+
+	-- CRC
+	signal crc_value				: std_logic_vector(31 downto 0);
+	signal crc_result				: std_logic_vector(31 downto 0);
+	signal crc_busy					: std_logic;
+
+	-- Memory transfer
+	signal dma_state				: FSM_DMA;
+	signal dma_next					: std_logic_vector(15 downto 0);
+	signal dma_count				: std_logic_vector(15 downto 0);
+
+	----------------------------------------------------------------------------
+	-- Functions
+
+	-- CRC-16/CCITT one byte update (MSB first)
+	function crc16_byte(value : std_logic_vector(31 downto 0); data : std_logic_vector(7 downto 0)) return std_logic_vector is
+		variable crc : std_logic_vector(15 downto 0);
+	begin
+		crc := value(15 downto 0);
+		for bit_id in 7 downto 0 loop
+			if ((crc(15) xor data(bit_id)) = '1') then
+				crc := (crc(14 downto 0) & '0') xor x"1021";
+			else
+				crc := (crc(14 downto 0) & '0');
+			end if;
+		end loop;
+		return x"0000" & crc;
+	end;
+
+	-- CRC-32 one byte update (LSB first)
+	function crc32_byte(value : std_logic_vector(31 downto 0); data : std_logic_vector(7 downto 0)) return std_logic_vector is
+		variable crc : std_logic_vector(31 downto 0);
+	begin
+		crc := value;
+		for bit_id in 0 to 7 loop
+			if ((crc(0) xor data(bit_id)) = '1') then
+				crc := ('0' & crc(31 downto 1)) xor x"EDB88320";
+			else
+				crc := ('0' & crc(31 downto 1));
+			end if;
+		end loop;
+		return crc;
+	end;
+
+	-- Add one byte to the CRC selected by the width bit
+	function crc_byte(width : std_logic; value : std_logic_vector(31 downto 0); data : std_logic_vector(7 downto 0)) return std_logic_vector is
+	begin
+		if (width = '0') then
+			return crc16_byte(value, data);
+		else
+			return crc32_byte(value, data);
+		end if;
+	end;
+
+begin
+
+	---------------------------------------------------------------------------
+	-- Hardwired
+
+	dma_address		<= dma_next;
+	dma_request		<= '1' when (dma_state = dma_read) else '0';
+	crc_busy		<= '0' when (dma_state = dma_idle) else '1';
+
+	-- CRC-32 result is inverted
+	crc_result		<= (x"0000" & crc_value(15 downto 0)) when (reg(0)(0) = '0') else not crc_value;
+
+	----------------------------------------------------------------------------
+	-- Processes
+
+	-- Register read
+	crc_read  : process(clock) begin
+		if (clock'event and clock='1') then
+			-- If reset
+			if (reset = '1') then
+				read_data						<= (others => '0');
+				read_keep						<= '0';
+			elsif (read_keep = '1') then
+
+				-- Prevent to modify read_data output while enable is high
+				if (enable = '0') then
+					read_keep					<= '0';
+				end if;
+
+			elsif (enable = '1') and (read_keep = '0') and (write_enable = '0') then
+
+				read_keep						<= '1';
+
+				case (read_address) is
+					when x"0"	=> read_data	<= crc_busy & reg(0)(6 downto 0);
+					when x"5"	=> read_data	<= crc_result( 7 downto  0);
+					when x"6"	=> read_data	<= crc_result(15 downto  8);
+					when x"7"	=> read_data	<= crc_result(23 downto 16);
+					when x"8"	=> read_data	<= crc_result(31 downto 24);
+					when others	=> read_data	<= reg(conv_integer(read_address));
+				end case;
+			end if; -- reset
+		end if; -- clock event
+	end process;
+
+	-- Register write, CRC computation and memory transfer
+	crc_write  : process(clock) begin
+		if (clock'event and clock='1') then
+			-- If reset
+			if (reset = '1') then
+				-- Reset
+				for address in 0 to 15 loop
+					reg(address)	<= (others => '0');
+				end loop;
+
+				crc_value			<= (others => '0');
+				dma_state			<= dma_idle;
+				dma_next			<= (others => '0');
+				dma_count			<= (others => '0');
+				write_once			<= '0';
+			else
+
+				-- Memory transfer
+				case dma_state is
+
+					when dma_idle =>
+						null;
+
+					-- Wait for the memory access
+					when dma_read =>
+						if (dma_grant = '1') then
+							dma_state				<= dma_wait;
+						end if;
+
+					-- Memory data is ready
+					when dma_wait =>
+						crc_value					<= crc_byte(reg(0)(0), crc_value, dma_data);
+						dma_next					<= dma_next  + 1;
+						dma_count					<= dma_count - 1;
+
+						if (dma_count = x"0001") then
+							dma_state				<= dma_idle;
+
+							-- synthesis translate_off
+							Log("INFO : crc memory transfer completed");
+							-- synthesis translate_on
+						else
+							dma_state				<= dma_read;
+						end if;
+				end case;
+
+				-- Registers action
+				if (write_enable = '1') and (enable = '1') and (write_once = '0') then
+
+					-- synthesis translate_off
+					Log("INFO : crc Write REG[" & integer'image(conv_integer(write_address)) & "]->[" & integer'image(conv_integer(write_data)) & "]");
+					-- synthesis translate_on
+
+					-- Ignore writes while the memory transfer is running
+					if (crc_busy = '0') then
+						case (write_address) is
+							when x"0"	=>												-- Reg[0] : [RW] Control
+								reg(0)			<= "0000000" & write_data(0);
+
+								-- Load seed
+								if (write_data(1) = '1') then
+									crc_value	<= reg(4) & reg(3) & reg(2) & reg(1);
+								end if;
+
+								-- Start memory transfer
+								if (write_data(2) = '1') and ((reg(13) & reg(12)) /= x"0000") then
+									dma_state	<= dma_read;
+									dma_next	<= reg(11) & reg(10);
+									dma_count	<= reg(13) & reg(12);
+								end if;
+
+							when x"1" | x"2" | x"3" | x"4" | x"A" | x"B" | x"C" | x"D" =>
+								reg(conv_integer(write_address))	<= write_data;
+
+							when x"9"	=>												-- Reg[9] : [WO] data byte
+								crc_value		<= crc_byte(reg(0)(0), crc_value, write_data);
+
+							when others	=> null;
+						end case;
+					end if;
+
+					write_once				<= '1';
+				end if;
+
+				if (enable = '0') then
+					write_once <= '0';
+				end if;
+
+			end if; -- reset
+		end if; -- clock event
+	end process;
+
+end behavioral;
+
+-------------------------------------------------------------------------------
+-- EOF
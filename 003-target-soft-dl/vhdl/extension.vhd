@@ -21,11 +21,12 @@
 -- Registers map (default all to zero)
 --
 --	Reg[0] : [RW] Mode
---			bit[7] = unused
---			bit[6] = unused
+--			bit[7] = UART tx interrupt      (0=disable         , 1=enable, see below)
+--			bit[6] = UART cooked mode       (0=raw             , 1=cooked, see below)
 --			bit[5] = start firmware upgrade
---			bit[4] = UART rx interrupt      (0=disable         , 1=enable)
---			bit[3] = input change interrupt (0=disable         , 1=enable)
+--			bit[4] = UART rx triggered      (status: set at every UART interrupt trigger, write 0 to clear)
+--			bit[3] = input changed          (status: set at every input change trigger  , write 0 to clear)
+--			         (the interrupt enables are in the interrupt controller, see intc.vhd Reg[0])
 --			bit[2] = output invert          (0=don't invert    , 1=invert)
 --			bit[1] = digits invert          (0=don't invert    , 1=invert)
 --			bit[0] = digits direct drive    (0=use CHARMAP     , 1=direct drive '.gfedcba')
@@ -55,8 +56,29 @@
 --	Reg[C] : [RW] digit 3 value
 --	
 --	Reg[D] : [RO] number of characters ready from UART
+--	         [WO] cooked mode line limit (maximum number of characters assembled in cooked mode)
 --	Reg[E] : [RO] UART Rx character
 --	Reg[F] : [WO] UART Tx character
+--	         [RO] UART Tx fifo free space (number of characters that can be written now)
+--
+-- UART tx interrupt
+--
+--	With Reg[0] bit[7] set the UART interrupt is triggered also when the Tx fifo goes down to
+--	UART_TX_LOW characters and when it gets empty, so the CPU refills it from its own buffer
+--	before the line goes idle. The Rx and Tx triggers share the same interrupt source.
+--
+-- UART cooked mode (line discipline without CPU involvement)
+--
+--	The cooked mode can be set only while the Rx fifo is empty (otherwise bit[6] is read back as 0).
+--	In cooked mode the received characters are handled without interrupt:
+--		- printable characters (0x20 - 0x7E) are echoed and added to the Rx fifo, up to the line limit
+--		- backspace (0x08 or 0x7F) removes the last added character and echoes backspace, space, backspace
+--	Any other character (CR, LF, control, escape, backspace with empty line or printable over the line limit)
+--	is added to the Rx fifo without echo, clears the cooked mode and triggers the UART rx interrupt.
+--	So the Rx fifo holds the echoed line followed by the character to be handled by the CPU.
+--	The echo never triggers the UART tx interrupt: in cooked mode it's triggered only if the CPU wrote
+--	characters since the last one, and the CPU leaves the Rx fifo alone until the cooked mode ends
+--	(the line is assembled in the fifo, see irq_uart in isr.s).
 --
 
 -------------------------------------------------------------------------------
@@ -74,13 +96,17 @@ use b65.PACK.all;
 -- Entity
 
 entity ext is
+	generic	(
+				fast_sim				:			boolean				:= false			-- Simulation profile: outputs and digits without PWM (see below)
+			);
 	port	(
 				-- General
 				clock					: in		std_logic;								-- Clock
 				reset					: in		std_logic;								-- reset
 				enable					: in		std_logic;								-- block enable
 				enable_inputs			: in		std_logic;								-- enable inputs and Rx
-				interrupt				: out		std_logic;								-- interrupt (active low)
+				trigger_input			: out		std_logic;								-- input change interrupt trigger (high for one clock)
+				trigger_uart			: out		std_logic;								-- UART rx/tx interrupt trigger   (high for one clock)
 				upgrade					: out		std_logic;								-- upgrade restart
 
 				-- Write interface
@@ -115,6 +141,8 @@ architecture behavioral of ext is
 	-- Constants
 
 	constant UART_FIFO_DEPTH : integer := 32;
+	constant UART_TX_SPACE   : integer := UART_FIFO_DEPTH - 2;	-- Tx fifo has UART_FIFO_DEPTH + 1 places, 3 are kept for the cooked mode echo
+	constant UART_TX_LOW     : integer := 8;					-- Tx interrupt level
 
 	----------------------------------------------------------------------------
 	-- Data types
@@ -139,9 +167,10 @@ architecture behavioral of ext is
 	signal pwm_counter				: std_logic_vector(7 downto 0);
 
 	-- Interrupt
-	signal int_delay				: std_logic_vector(7 downto 0);
 	signal int_trigger_input		: std_logic;
 	signal int_trigger_uart			: std_logic;
+	signal int_trigger_tx			: std_logic;
+	signal tx_cpu					: std_logic;	-- CPU characters written to the tx fifo since the last tx trigger
 		
 	-- UART rx fifo
 	signal uart_rx_write			: integer range 0 to UART_FIFO_DEPTH;
@@ -154,11 +183,22 @@ architecture behavioral of ext is
 	signal uart_tx_write			: integer range 0 to UART_FIFO_DEPTH;
 	signal uart_tx_read				: integer range 0 to UART_FIFO_DEPTH;
 	signal uart_tx_count			: std_logic_vector(7 downto 0);
+	signal uart_tx_free				: std_logic_vector(7 downto 0);
 	signal uart_tx_fifo				: UART_FIFO;
 
 	-- UART
 	signal uart_tx_valid_internal	: std_logic;
 
+	-- UART cooked mode
+	signal cooked_limit				: std_logic_vector(7 downto 0);		-- Line limit (Reg[D] write)
+	signal cooked_count				: std_logic_vector(7 downto 0);		-- Characters added in cooked mode
+	signal cooked_exit				: std_logic;						-- Clear cooked mode (high for one clock)
+	signal echo_request				: std_logic;						-- Echo echo_data (high for one clock)
+	signal echo_erase				: std_logic;						-- Echo backspace, space, backspace (high for one clock)
+	signal echo_data				: std_logic_vector( 7 downto 0);
+	signal echo_queue				: std_logic_vector(23 downto 0);	-- Echo characters to insert into the tx fifo
+	signal echo_left				: integer range 0 to 3;				-- Number of characters in echo_queue
+
 	----------------------------------------------------------------------------
 	-- Constants
 
@@ -219,6 +259,13 @@ begin
 	uart_tx_valid	<= uart_tx_valid_internal;
 	upgrade			<= reg(0)(5);
 
+	-- Interrupt triggers (latched by the interrupt controller, see intc.vhd)
+	trigger_input	<= int_trigger_input;
+	trigger_uart	<= int_trigger_uart or int_trigger_tx;
+
+	-- Tx fifo free space for the CPU
+	uart_tx_free	<= conv_std_logic_vector(UART_TX_SPACE - conv_integer(uart_tx_count), 8) when (conv_integer(uart_tx_count) < UART_TX_SPACE) else x"00";
+
 	----------------------------------------------------------------------------
 	-- Processes
 
@@ -233,25 +280,60 @@ begin
 				uart_rx_count					<= (others => '0');
 				uart_rx_fifo					<= (others => (others => '0'));
 				int_trigger_uart				<= '0';
+				cooked_count					<= (others => '0');
+				cooked_exit						<= '0';
+				echo_request					<= '0';
+				echo_erase						<= '0';
+				echo_data						<= (others => '0');
 			else
 				int_trigger_uart				<= '0';
+				cooked_exit						<= '0';
+				echo_request					<= '0';
+				echo_erase						<= '0';
+
+				if (reg(0)(6) = '0') then
+					cooked_count				<= (others => '0');
+				end if;
 
 				-- Insert serializer received data into the rx fifo
 				if (enable_inputs = '1') then
 					if (uart_rx_valid = '1') then
-						uart_rx_count				<= uart_rx_count + 1;
-						uart_rx_fifo(uart_rx_write)	<= uart_rx_byte;
-						if (uart_rx_write = UART_FIFO_DEPTH) then
-							uart_rx_write			<= 0;
+
+						if (reg(0)(6) = '1') and ((uart_rx_byte = x"08") or (uart_rx_byte = x"7F")) and (cooked_count /= x"00") and (uart_rx_count /= x"00") then
+							-- Cooked mode backspace: remove the last character
+							uart_rx_count			<= uart_rx_count - 1;
+							cooked_count			<= cooked_count - 1;
+							echo_erase				<= '1';
+							if (uart_rx_write = 0) then
+								uart_rx_write		<= UART_FIFO_DEPTH;
+							else
+								uart_rx_write		<= uart_rx_write - 1;
+							end if;
 						else
-							uart_rx_write			<= uart_rx_write + 1;
+							uart_rx_count				<= uart_rx_count + 1;
+							uart_rx_fifo(uart_rx_write)	<= uart_rx_byte;
+							if (uart_rx_write = UART_FIFO_DEPTH) then
+								uart_rx_write			<= 0;
+							else
+								uart_rx_write			<= uart_rx_write + 1;
+							end if;
+
+							if (reg(0)(6) = '1') and (uart_rx_byte >= x"20") and (uart_rx_byte <= x"7E") and (cooked_count < cooked_limit) then
+								-- Cooked mode printable character: echo without interrupt
+								cooked_count		<= cooked_count + 1;
+								echo_request		<= '1';
+								echo_data			<= uart_rx_byte;
+							else
+								-- Raw mode, or the cooked line is done
+								cooked_exit			<= reg(0)(6);
+								int_trigger_uart	<= '1';
+							end if;
 						end if;
-						int_trigger_uart			<= '1';
 					end if;
 				end if;
 			end if;
 
-			-- Standard registers read (Reg[F] is write only)
+			-- Standard registers read
 			if (reset = '1') then
 				read_data						<= (others => '0');
 				read_keep						<= '0';
@@ -262,7 +344,7 @@ begin
 					read_keep					<= '0';
 				end if;
 
-			elsif (enable = '1') and (read_keep = '0') and (conv_integer(read_address) <= 14) and (write_enable = '0') then
+			elsif (enable = '1') and (read_keep = '0') and (write_enable = '0') then
 				
 				read_keep						<= '1';
 
@@ -296,6 +378,10 @@ begin
 						-- synthesis translate_on
 					
 					end if;
+
+				elsif (read_address = x"0F") then
+					-- UART TX free space
+					read_data					<= uart_tx_free;
 				else
 					read_data					<= reg(conv_integer(read_address));
 
@@ -358,6 +444,7 @@ begin
 				end loop;
 				
 				digit_val			<= (others => (others => '0'));
+				cooked_limit		<= (others => '0');
 				int_trigger_input	<= '0';
 				uart_tx_send		<= '0';
 				write_once			<= '0';
@@ -388,7 +475,7 @@ begin
 						when x"A"	=> PROC_SET_DIGIT(1);		-- Reg[A] : [RW] digit 1 value
 						when x"B"	=> PROC_SET_DIGIT(2);		-- Reg[B] : [RW] digit 2 value
 						when x"C"	=> PROC_SET_DIGIT(3);		-- Reg[C] : [RW] digit 3 value
-				--		when x"D"	=> null;					-- Reg[D] : [RO] number of characters ready from UART
+						when x"D"	=> cooked_limit <= write_data;	-- Reg[D] : [WO] cooked mode line limit
 				--		when x"E"	=> null;					-- Reg[E] : [RO] UART Rx character
 						when x"F"	=> uart_tx_send <= '1';		-- Reg[F] : [WO] UART Tx character
 						when others	=> null;
@@ -411,6 +498,16 @@ begin
 
 					reg(conv_integer(write_address))	<= write_data;
 					write_once							<= '1';
+
+					-- Cooked mode can be set only with empty Rx fifo
+					if (conv_integer(write_address) = 0) and (uart_rx_count /= x"00") then
+						reg(0)(6)						<= '0';
+					end if;
+				end if;
+
+				-- Cooked line done
+				if (cooked_exit = '1') then
+					reg(0)(6)							<= '0';
 				end if;
 				
 				if (enable = '0') then
@@ -426,137 +523,126 @@ begin
 		end if; -- clock event
 	end process;
 
-	-- Interrupt generator
-	-- interrupt must be active some clock pulses
-	int_generator : process(clock) begin
-		if (clock'event and clock='1') then
-			-- If (system is in reset state)
-			if (reset = '1') then
-				int_delay				<= (others => '0');
-				interrupt				<= '1';
-			else
-				interrupt				<= '1';
-
-				if (int_trigger_input = '1') or (int_trigger_uart = '1') then
-					interrupt			<= '0';
-					int_delay			<= x"40";
-
-					-- synthesis translate_off
-					if (int_trigger_input = '1') then
-						Log("INFO : ext IRQ (input)");
-					end if;
-					if (int_trigger_uart = '1') then
-						Log("INFO : ext IRQ (uart receive '" & character'val(conv_integer(uart_rx_byte)) & "' [" & integer'image(conv_integer(uart_rx_count)) & "]bytes)");
-					end if;
-					-- synthesis translate_on				
-				end if;
-
-				if (int_delay /= x"00") then
-					int_delay			<= int_delay - x"01";
-					interrupt			<= '0';
-				end if;
-			end if; -- reset
-		end if; -- clock event
-	end process;
-
-	-- pwm counter
-	pwm_generator : process(clock) begin
-		if (clock'event and clock='1') then
-			-- If (system is in reset state)
-			if (reset = '1') then
-				pwm_counter				<= x"00";
-			else
-				-- Increment PWM counter
-				pwm_counter				<= pwm_counter + x"01";
-			end if; -- reset
-		end if; -- clock event
-	end process;
+	-- PWM outputs and digits (33% and 66% modes)
+	gen_pwm : if (not fast_sim) generate
 
-	-- generate the digit pwm output
-	set_pwm_digit : process(clock)
+		-- pwm counter
+		pwm_generator : process(clock) begin
+			if (clock'event and clock='1') then
+				-- If (system is in reset state)
+				if (reset = '1') then
+					pwm_counter				<= x"00";
+				else
+					-- Increment PWM counter
+					pwm_counter				<= pwm_counter + x"01";
+				end if; -- reset
+			end if; -- clock event
+		end process;
+
+		-- generate the digit pwm output
+		set_pwm_digit : process(clock)
 	
-		-- Set a digit
-		procedure PROC_SET_OUT(constant id : in integer; signal val : in std_logic_vector(1 downto 0)) is begin
+			-- Set a digit
+			procedure PROC_SET_OUT(constant id : in integer; signal val : in std_logic_vector(1 downto 0)) is begin
 
-			digit(id)			<= (others => '0');
+				digit(id)			<= (others => '0');
 
-			if (val = "00") then
-				digit(id)		<= (others => '0');
-			elsif (val = "01") then
-				if (pwm_counter > x"AA") then
-					digit(id)	<= digit_val(id);
-				end if;
-			elsif (val = "10") then
-				if (pwm_counter > x"55") then
-					digit(id)	<= digit_val(id);
-				end if;
-			else
-				digit(id)		<= digit_val(id);
-			end if;		
-		end procedure;
-	begin
-		if (clock'event and clock='1') then
-			-- If (system is in reset state)
-			if (reset = '1') then
-				digit			<= (others => (others => '0'));
-			else
-				PROC_SET_OUT(0, reg(5)(1 downto 0));
-				PROC_SET_OUT(1, reg(5)(3 downto 2));
-				PROC_SET_OUT(2, reg(5)(5 downto 4));
-				PROC_SET_OUT(3, reg(5)(7 downto 6));
-			end if; -- reset
-		end if; -- clock event
-	end process;
-
-	-- generate all the outputs
-	set_outputs : process(clock)
+				if (val = "00") then
+					digit(id)		<= (others => '0');
+				elsif (val = "01") then
+					if (pwm_counter > x"AA") then
+						digit(id)	<= digit_val(id);
+					end if;
+				elsif (val = "10") then
+					if (pwm_counter > x"55") then
+						digit(id)	<= digit_val(id);
+					end if;
+				else
+					digit(id)		<= digit_val(id);
+				end if;		
+			end procedure;
+		begin
+			if (clock'event and clock='1') then
+				-- If (system is in reset state)
+				if (reset = '1') then
+					digit			<= (others => (others => '0'));
+				else
+					PROC_SET_OUT(0, reg(5)(1 downto 0));
+					PROC_SET_OUT(1, reg(5)(3 downto 2));
+					PROC_SET_OUT(2, reg(5)(5 downto 4));
+					PROC_SET_OUT(3, reg(5)(7 downto 6));
+				end if; -- reset
+			end if; -- clock event
+		end process;
+
+		-- generate all the outputs
+		set_outputs : process(clock)
 		
-		-- Set the output bit 'oid'
-		procedure PROC_SET_OUT(constant oid : in integer; signal val : in std_logic_vector(1 downto 0)) is begin
-			outputs(oid)			<= reg(0)(2);
-			if (val = "00") then
-				outputs(oid)		<= reg(0)(2);
-			elsif (val = "01") then
-				if (pwm_counter > x"AA") then
-					outputs(oid)	<= not reg(0)(2);
-				end if;
-			elsif (val = "10") then
-				if (pwm_counter > x"55") then
-					outputs(oid)	<= not reg(0)(2);
+			-- Set the output bit 'oid'
+			procedure PROC_SET_OUT(constant oid : in integer; signal val : in std_logic_vector(1 downto 0)) is begin
+				outputs(oid)			<= reg(0)(2);
+				if (val = "00") then
+					outputs(oid)		<= reg(0)(2);
+				elsif (val = "01") then
+					if (pwm_counter > x"AA") then
+						outputs(oid)	<= not reg(0)(2);
+					end if;
+				elsif (val = "10") then
+					if (pwm_counter > x"55") then
+						outputs(oid)	<= not reg(0)(2);
+					end if;
+				else
+					outputs(oid)		<= not reg(0)(2);
 				end if;
-			else
-				outputs(oid)		<= not reg(0)(2);
-			end if;
-		end PROC_SET_OUT;
+			end PROC_SET_OUT;
 
-	begin
-		if (clock'event and clock='1') then
-			-- If (system is in reset state)
-			if (reset = '1') then
-				outputs <= (others => '0');
-			else
-				PROC_SET_OUT( 0, reg(1)(1 downto 0));
-				PROC_SET_OUT( 1, reg(1)(3 downto 2));
-				PROC_SET_OUT( 2, reg(1)(5 downto 4));
-				PROC_SET_OUT( 3, reg(1)(7 downto 6));
+		begin
+			if (clock'event and clock='1') then
+				-- If (system is in reset state)
+				if (reset = '1') then
+					outputs <= (others => '0');
+				else
+					PROC_SET_OUT( 0, reg(1)(1 downto 0));
+					PROC_SET_OUT( 1, reg(1)(3 downto 2));
+					PROC_SET_OUT( 2, reg(1)(5 downto 4));
+					PROC_SET_OUT( 3, reg(1)(7 downto 6));
 				
-				PROC_SET_OUT( 4, reg(2)(1 downto 0));
-				PROC_SET_OUT( 5, reg(2)(3 downto 2));
-				PROC_SET_OUT( 6, reg(2)(5 downto 4));
-				PROC_SET_OUT( 7, reg(2)(7 downto 6));
-
-				PROC_SET_OUT( 8, reg(3)(1 downto 0));
-				PROC_SET_OUT( 9, reg(3)(3 downto 2));
-				PROC_SET_OUT(10, reg(3)(5 downto 4));
-				PROC_SET_OUT(11, reg(3)(7 downto 6));
-
-				PROC_SET_OUT(12, reg(4)(1 downto 0));
-				PROC_SET_OUT(13, reg(4)(3 downto 2));
-				PROC_SET_OUT(14, reg(4)(5 downto 4));
-				PROC_SET_OUT(15, reg(4)(7 downto 6));
-			end if; -- reset
-		end if; -- clock event
-	end process;
+					PROC_SET_OUT( 4, reg(2)(1 downto 0));
+					PROC_SET_OUT( 5, reg(2)(3 downto 2));
+					PROC_SET_OUT( 6, reg(2)(5 downto 4));
+					PROC_SET_OUT( 7, reg(2)(7 downto 6));
+
+					PROC_SET_OUT( 8, reg(3)(1 downto 0));
+					PROC_SET_OUT( 9, reg(3)(3 downto 2));
+					PROC_SET_OUT(10, reg(3)(5 downto 4));
+					PROC_SET_OUT(11, reg(3)(7 downto 6));
+
+					PROC_SET_OUT(12, reg(4)(1 downto 0));
+					PROC_SET_OUT(13, reg(4)(3 downto 2));
+					PROC_SET_OUT(14, reg(4)(5 downto 4));
+					PROC_SET_OUT(15, reg(4)(7 downto 6));
+				end if; -- reset
+			end if; -- clock event
+		end process;
+
+	end generate;
+
+	-- Simulation profile: the PWM modes are full on, so outputs and digits change only on the registers
+	-- writes instead of every clock (nobody looks at the duty cycle in the simulated board)
+	gen_fast : if (fast_sim) generate
+
+		gen_outputs : for oid in 0 to 15 generate
+			outputs(oid)	<= '0'				when (reset = '1') else
+							   reg(0)(2)		when (reg(1 + oid / 4)(2 * (oid mod 4) + 1 downto 2 * (oid mod 4)) = "00") else
+							   not reg(0)(2);
+		end generate;
+
+		gen_digits : for id in 0 to 3 generate
+			digit(id)		<= (others => '0')	when (reset = '1') or (reg(5)(2 * id + 1 downto 2 * id) = "00") else
+							   digit_val(id);
+		end generate;
+
+	end generate;
 	
 	-- UART tx fifo
 	proc_uart_tx_fifo : process(clock) begin
@@ -570,19 +656,40 @@ begin
 
 				uart_tx_byte					<= (others => '0');
 				uart_tx_valid_internal			<= '0';
+				int_trigger_tx					<= '0';
+				tx_cpu							<= '0';
+				echo_queue						<= (others => '0');
+				echo_left						<= 0;
 			else
 				uart_tx_valid_internal			<= '0';
+				int_trigger_tx					<= '0';
 
-				-- Insert reg(15) into the tx fifo
-				if (uart_tx_send = '1') then
+				-- Insert reg(15) (or the cooked mode echo, when the CPU is not writing) into the tx fifo
+				if (uart_tx_send = '1') or (echo_left /= 0) then
 					uart_tx_count				<= uart_tx_count + 1;
-					uart_tx_fifo(uart_tx_write)	<= reg(15);
+					if (uart_tx_send = '1') then
+						uart_tx_fifo(uart_tx_write)	<= reg(15);
+						tx_cpu						<= '1';
+					else
+						uart_tx_fifo(uart_tx_write)	<= echo_queue(7 downto 0);
+						echo_queue					<= x"00" & echo_queue(23 downto 8);
+						echo_left					<= echo_left - 1;
+					end if;
 					if (uart_tx_write = UART_FIFO_DEPTH) then
 						uart_tx_write			<= 0;
 					else
 						uart_tx_write			<= uart_tx_write + 1;
 					end if;					
 				end if;
+
+				-- Cooked mode echo
+				if (echo_request = '1') then
+					echo_queue					<= x"0000" & echo_data;
+					echo_left					<= 1;
+				elsif (echo_erase = '1') then
+					echo_queue					<= x"082008";		-- backspace, space, backspace
+					echo_left					<= 3;
+				end if;
 				
 				-- Send one byte to the serializer
 				if (uart_tx_count /= x"00") and (uart_busy = '0') and (uart_tx_valid_internal = '0') then
@@ -594,10 +701,19 @@ begin
 					else
 						uart_tx_read			<= uart_tx_read + 1;
 					end if;					
+
+					-- Tx interrupt: the fifo goes down to the low level or gets empty (not if a byte is inserted now),
+					-- in cooked mode only for the CPU characters (not for the echo)
+					if (reg(0)(7) = '1') and (uart_tx_send = '0') and (echo_left = 0) and
+					   ((reg(0)(6) = '0') or (tx_cpu = '1')) and
+					   ((conv_integer(uart_tx_count) = UART_TX_LOW + 1) or (uart_tx_count = x"01")) then
+						int_trigger_tx			<= '1';
+						tx_cpu					<= '0';
+					end if;
 				end if;
 
 				-- Prevent to modify the fifo item count if there is a write and read in the same cycle
-				if (uart_tx_send = '1') and (uart_tx_count /= x"00") and (uart_busy = '0') and (uart_tx_valid_internal = '0') then
+				if ((uart_tx_send = '1') or (echo_left /= 0)) and (uart_tx_count /= x"00") and (uart_busy = '0') and (uart_tx_valid_internal = '0') then
 					uart_tx_count				<= uart_tx_count;
 				end if;
 			end if; -- reset
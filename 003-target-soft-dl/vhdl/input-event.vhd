@@ -0,0 +1,267 @@
+-- Copyright 2023 Luca Bertossi
+--
+-- This file is part of B65.
+-- 
+--     B65 is free software: you can redistribute it and/or modify
+--     it under the terms of the GNU General Public License as published by
+--     the Free Software Foundation, either version 3 of the License, or
+--     (at your option) any later version.
+-- 
+--     B65 is distributed in the hope that it will be useful,
+--     but WITHOUT ANY WARRANTY; without even the implied warranty of
+--     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+--     GNU General Public License for more details.
+-- 
+--     You should have received a copy of the GNU General Public License
+--     along with B65.  If not, see <http://www.gnu.org/licenses/>.
+
+----------------------------------------------------------------------------------
+-- Input events block
+
+-- Registers map (default all to zero)
+--
+--	Reg[0] : [RO] number of events in the queue
+--
+--	Reg[1] : [RW] Control
+--			bit[7] = overflow (set when an event is lost because the queue is full, write 1 to clear)
+--			bit[6] = unused
+--			bit[5] = unused
+--			bit[4] = unused
+--			bit[3] = unused
+--			bit[2] = unused
+--			bit[1] = unused
+--			bit[0] = remove the oldest event (write 1, always read as 0)
+--
+--	Reg[2] : [RO] oldest event changed inputs [ 7: 0]
+--	Reg[3] : [RO] oldest event changed inputs [15: 8]
+--	Reg[4] : [RO] oldest event changed inputs [23:16]
+--
+--	Reg[5] : [RO] oldest event inputs value   [ 7: 0]
+--	Reg[6] : [RO] oldest event inputs value   [15: 8]
+--	Reg[7] : [RO] oldest event inputs value   [23:16]
+--
+--	Reg[8] : [RO] oldest event timestamp in microseconds [ 7: 0]
+--	Reg[9] : [RO] oldest event timestamp in microseconds [15: 8]
+--	Reg[A] : [RO] oldest event timestamp in microseconds [23:16]
+--	Reg[B] : [RO] oldest event timestamp in microseconds [31:24]
+--
+--	Reg[C:F] : unused
+--
+-- Every change of the inputs is queued as (changed bits, new value, timestamp); the timestamp is
+-- the timer free running microseconds counter (see timer.vhd).
+-- The trigger output is high for one clock when an event is queued (see intc.vhd).
+--
+
+-------------------------------------------------------------------------------
+-- Libraries
+
+library ieee;
+use ieee.std_logic_1164.all;
+use ieee.std_logic_unsigned.all;
+use ieee.numeric_std.all;
+
+library b65;
+use b65.PACK.all;
+
+-------------------------------------------------------------------------------
+-- Entity
+
+entity input_event is
+	port	(
+				-- General
+				clock					: in		std_logic;								-- Clock
+				reset					: in		std_logic;								-- reset
+				enable					: in		std_logic;								-- block enable
+				enable_inputs			: in		std_logic;								-- enable inputs
+				trigger					: out		std_logic;								-- interrupt trigger (high for one clock)
+
+				-- Write interface
+				write_address			: in		std_logic_vector( 3	downto 0);			-- write Address
+				write_enable			: in		std_logic;								-- Write enable
+				write_data				: in		std_logic_vector( 7	downto 0);			-- Data IN
+
+				-- Read interface
+				read_address			: in		std_logic_vector( 3	downto 0);			-- read Address
+				read_data				: out		std_logic_vector( 7	downto 0);			-- Data OUT
+
+				-- Inputs
+				inputs					: in		std_logic_vector(23	downto 0);			-- Input wires
+				microseconds			: in		std_logic_vector(31	downto 0)			-- Timestamp
+			);
+end input_event;
+
+-------------------------------------------------------------------------------
+-- Architecture
+
+architecture behavioral of input_event is
+
+	----------------------------------------------------------------------------
+	-- Constants
+
+	constant EVENT_FIFO_DEPTH : integer := 16;
+
+	----------------------------------------------------------------------------
+	-- Data types
+
+	-- Event queue
+	type INPUTS_FIFO	is array(0 to EVENT_FIFO_DEPTH - 1) of std_logic_vector(23 downto 0);
+	type TIME_FIFO		is array(0 to EVENT_FIFO_DEPTH - 1) of std_logic_vector(31 downto 0);
+
+	----------------------------------------------------------------------------
+	-- Signals
+
+	-- Read / Write
+	signal read_keep				: std_logic;	-- Keep the samme value to read_data while enable is high
+	signal write_once				: std_logic;	-- Write once a register             while enable is high
+
+	-- Inputs
+	signal inputs_last				: std_logic_vector(23 downto 0);
+	signal overflow					: std_logic;
+
+	-- Event queue
+	signal event_write				: integer range 0 to EVENT_FIFO_DEPTH - 1;
+	signal event_read				: integer range 0 to EVENT_FIFO_DEPTH - 1;
+	signal event_count				: integer range 0 to EVENT_FIFO_DEPTH;
+	signal event_changed			: INPUTS_FIFO;
+	signal event_value				: INPUTS_FIFO;
+	signal event_time				: TIME_FIFO;
+
+begin
+
+	----------------------------------------------------------------------------
+	-- Processes
+
+	-- Register read (the oldest event)
+	event_read_reg  : process(clock) begin
+		if (clock'event and clock='1') then
+			-- If reset
+			if (reset = '1') then
+				read_data						<= (others => '0');
+				read_keep						<= '0';
+			elsif (read_keep = '1') then
+
+				-- Prevent to modify read_data output while enable is high
+				if (enable = '0') then
+					read_keep					<= '0';
+				end if;
+
+			elsif (enable = '1') and (read_keep = '0') and (write_enable = '0') then
+
+				read_keep						<= '1';
+
+				case (read_address) is
+					when x"0"	=> read_data	<= std_logic_vector(to_unsigned(event_count, 8));
+					when x"1"	=> read_data	<= overflow & "0000000";
+					when x"2"	=> read_data	<= event_changed(event_read)( 7 downto  0);
+					when x"3"	=> read_data	<= event_changed(event_read)(15 downto  8);
+					when x"4"	=> read_data	<= event_changed(event_read)(23 downto 16);
+					when x"5"	=> read_data	<= event_value(event_read)( 7 downto  0);
+					when x"6"	=> read_data	<= event_value(event_read)(15 downto  8);
+					when x"7"	=> read_data	<= event_value(event_read)(23 downto 16);
+					when x"8"	=> read_data	<= event_time(event_read)( 7 downto  0);
+					when x"9"	=> read_data	<= event_time(event_read)(15 downto  8);
+					when x"A"	=> read_data	<= event_time(event_read)(23 downto 16);
+					when x"B"	=> read_data	<= event_time(event_read)(31 downto 24);
+					when others	=> read_data	<= (others => '0');
+				end case;
+			end if; -- reset
+		end if; -- clock event
+	end process;
+
+	-- Register write and event queue
+	event_queue  : process(clock)
+		variable push : boolean;
+		variable pop  : boolean;
+	begin
+		if (clock'event and clock='1') then
+			-- If reset
+			if (reset = '1') then
+				inputs_last			<= (others => '0');
+				overflow			<= '0';
+				event_write			<= 0;
+				event_read			<= 0;
+				event_count			<= 0;
+				trigger				<= '0';
+				write_once			<= '0';
+			else
+				trigger				<= '0';
+				push				:= false;
+				pop					:= false;
+
+				-- Inputs change
+				if (enable_inputs = '1') and (inputs /= inputs_last) then
+					inputs_last		<= inputs;
+
+					if (event_count = EVENT_FIFO_DEPTH) then
+						overflow	<= '1';
+
+						-- synthesis translate_off
+						Log("INFO : input event lost (queue full)");
+						-- synthesis translate_on
+					else
+						push		:= true;
+					end if;
+				end if;
+
+				-- Registers action
+				if (write_enable = '1') and (enable = '1') and (write_once = '0') then
+
+					-- synthesis translate_off
+					Log("INFO : input event Write REG[" & integer'image(conv_integer(write_address)) & "]->[" & integer'image(conv_integer(write_data)) & "]");
+					-- synthesis translate_on
+
+					if (write_address = x"1") then
+						-- Clear overflow
+						if (write_data(7) = '1') then
+							overflow	<= '0';
+						end if;
+
+						-- Remove the oldest event
+						if (write_data(0) = '1') and (event_count /= 0) then
+							pop			:= true;
+						end if;
+					end if;
+
+					write_once				<= '1';
+				end if;
+
+				if (enable = '0') then
+					write_once <= '0';
+				end if;
+
+				-- Queue update
+				if (push) then
+					event_changed(event_write)	<= inputs xor inputs_last;
+					event_value(event_write)	<= inputs;
+					event_time(event_write)		<= microseconds;
+					trigger						<= '1';
+
+					if (event_write = EVENT_FIFO_DEPTH - 1) then
+						event_write				<= 0;
+					else
+						event_write				<= event_write + 1;
+					end if;
+				end if;
+
+				if (pop) then
+					if (event_read = EVENT_FIFO_DEPTH - 1) then
+						event_read				<= 0;
+					else
+						event_read				<= event_read + 1;
+					end if;
+				end if;
+
+				if (push) and (not pop) then
+					event_count					<= event_count + 1;
+				elsif (pop) and (not push) then
+					event_count					<= event_count - 1;
+				end if;
+
+			end if; -- reset
+		end if; -- clock event
+	end process;
+
+end behavioral;
+
+-------------------------------------------------------------------------------
+-- EOF
@@ -18,9 +18,16 @@
 -------------------------------------------------------------------------------
 -- b65 memory map (see software b65.cfg configuration file)
 --
+-- The map is described in memory.map, the MAP_xxx constants below and b65.cfg are generated from it.
+-- Default map with 8 KB of code space (with 24 KB, ROM starts at 0xA000 and the registers at 0x9C00):
+--
 --		0x0000       0         RAM          (56320 bytes = 55 KB)
 --		                       |
---		0xDBFF   56319         v        <-- (Stack is 0x400 bytes, growing from 0xDBFF to 0xD800)
+--		0xD5FF   54783         v
+--		0xD600   54784         IRQ C stack      (256 bytes, C stack of the IRQ handlers, see isr.s)
+--		0xD700   55040         Shadow page 0    (256 bytes, page 0 of the IRQ handlers, see intc.vhd)
+--		0xD800   55296         ^
+--		0xDBFF   56319         |        <-- (Stack is 0x400 bytes, growing from 0xDBFF to 0xD800)
 --		0xDC00   56320         \
 --		                        | Registers (1024 bytes =  1 KB)
 --		0xDFFF   57343         /
@@ -28,6 +35,15 @@
 --		                       |
 --		                       |
 --		0xFFFF   65535        ROM start     (8192 bytes =  8 KB)
+--
+-- Registers blocks (16 registers each)
+--
+--		0xDC00 - 0xDC0F        I/O extension    (see extension.vhd, offsets from MAP_START_REG)
+--		0xDC10 - 0xDC1F        CRC accelerator  (see crc.vhd)
+--		0xDC20 - 0xDC2F        Timer            (see timer.vhd)
+--		0xDC30 - 0xDC3F        Interrupts       (see intc.vhd)
+--		0xDC40 - 0xDC4F        Input events     (see input-event.vhd)
+--		0xDC50 - 0xDC8F        Serial channels  (see serial.vhd, one block for each of SERIAL_CHANNELS)
 
 -------------------------------------------------------------------------------
 -- The 6502 chip mirrors out the input clock, in this design this is
@@ -71,14 +87,31 @@ package PACK is
 	constant ROM_FILE		: string			:= "b65.rom";								-- rom filename
 	constant ROM_FILL		: std_logic_vector	:= x"FF";									-- rom fill value
 
+	-- Memory map begin (generated by b65.sh from memory.map, do not edit)
 	constant MAP_START_RAM	: integer			:= conv_integer(x"0000");					-- start address     0 : RAM
 	constant MAP_START_REG	: integer			:= conv_integer(x"DC00");					-- start address 56320 : devices registers
 	constant MAP_START_ROM	: integer			:= conv_integer(x"E000");					-- start address 57344 : ROM (growing from 0xFFFF down to 0xE000)
+	constant MAP_START_ZPS	: integer			:= conv_integer(x"D700");					-- start address 55040 : Shadow zero page (inside the RAM)
 
 	constant MAP_SIZE_RAM	: integer			:= conv_integer(x"DC00");					-- size  in bytes      : RAM
 	constant MAP_SIZE_REG	: integer			:= conv_integer(x"0400");					-- size  in bytes      : devices registers
 	constant MAP_SIZE_ROM	: integer			:= conv_integer(x"2000");					-- size  in bytes      : ROM
 
+	constant ROM_ADDRESS_BITS	: integer		:= 13;										-- code ram address width (ram_code, soft_dl)
+	-- Memory map end
+
+	constant MAP_START_EXT	: integer			:= MAP_START_REG + 16#00#;					-- I/O extension registers
+	constant MAP_START_CRC	: integer			:= MAP_START_REG + 16#10#;					-- CRC accelerator registers
+	constant MAP_START_TMR	: integer			:= MAP_START_REG + 16#20#;					-- Timer registers
+	constant MAP_START_INT	: integer			:= MAP_START_REG + 16#30#;					-- Interrupt controller registers
+	constant MAP_START_EVT	: integer			:= MAP_START_REG + 16#40#;					-- Input events registers
+	constant MAP_START_SER	: integer			:= MAP_START_REG + 16#50#;					-- Serial channels registers (16 for each channel)
+
+	----------------------------------------------------------------------------
+	-- Devices
+
+	constant SERIAL_CHANNELS	: integer		:= 2;										-- Additional UART channels (1 to 4, interrupt sources 4 to 7)
+
 	----------------------------------------------------------------------------
 	-- Data types
 
@@ -99,15 +132,26 @@ package PACK is
 	--
 	type LED7X4 is array(0 to 3) of std_logic_vector(7 downto 0);
 
+	-- Memories content (ram, ram_code)
+	type MEMORY_BYTES is array(natural range <>) of std_logic_vector(7 downto 0);
+
 	----------------------------------------------------------------------------
 	-- Procedures
 	
 	procedure Log(message : in string);
 
+	----------------------------------------------------------------------------
+	-- Functions
+
+	impure function CheckpointRead(file_name : string; offset : integer; size : integer) return MEMORY_BYTES;
+
 	----------------------------------------------------------------------------
 	-- Components
 
 	component clock_manager is
+	generic	(
+				fast_sim				:			boolean				:= false			-- Simulation profile: one generator for both clocks
+			);
 	port	(
 				-- General
 				clk_in1					: in		std_logic;								-- Clock
@@ -121,6 +165,9 @@ package PACK is
 	end component;
 
 	component ram is
+	generic	(
+				init_file				:			string				:= ""				-- Initial content (checkpoint file, see b65.vhd)
+			);
 	port	(
 				-- General
 				clka					: in		std_logic;								-- Clock
@@ -137,6 +184,9 @@ package PACK is
 	end component;
 
 	component ram_code is
+	generic	(
+				init_file				:			string				:= ""				-- Initial content (checkpoint file, see b65.vhd)
+			);
 	port	(
 				-- General
 				clka					: in		std_logic;								-- Clock
@@ -145,7 +195,7 @@ package PACK is
 				rsta_busy				: out		std_logic;								-- busy
 
 				-- Read / Write interface
-				addra					: in		std_logic_vector(12	downto 0);			-- Ram write Address
+				addra					: in		std_logic_vector(ROM_ADDRESS_BITS - 1	downto 0);	-- Ram write Address
 				wea						: in		std_logic_vector(0	downto 0);			-- Write enable
 				dina					: in		std_logic_vector( 7	downto 0);			-- Data IN
 				douta					: out		std_logic_vector( 7	downto 0)			-- Data OUT
@@ -153,13 +203,17 @@ package PACK is
 	end component;
 
 	component ext is
+	generic	(
+				fast_sim				:			boolean				:= false			-- Simulation profile: outputs and digits without PWM (see below)
+			);
 	port	(
 				-- General
 				clock					: in		std_logic;								-- Clock
 				reset					: in		std_logic;								-- reset
 				enable					: in		std_logic;								-- block enable
 				enable_inputs			: in		std_logic;								-- enable inputs and Rx
-				interrupt				: out		std_logic;								-- interrupt
+				trigger_input			: out		std_logic;								-- input change interrupt trigger
+				trigger_uart			: out		std_logic;								-- UART rx interrupt trigger
 				upgrade					: out		std_logic;								-- upgrade restart
 
 				-- Write interface
@@ -185,6 +239,105 @@ package PACK is
 			);
 	end component;
 
+	component crc is
+	port	(
+				-- General
+				clock					: in		std_logic;								-- Clock
+				reset					: in		std_logic;								-- reset
+				enable					: in		std_logic;								-- block enable
+
+				-- Write interface
+				write_address			: in		std_logic_vector( 3	downto 0);			-- write Address
+				write_enable			: in		std_logic;								-- Write enable
+				write_data				: in		std_logic_vector( 7	downto 0);			-- Data IN
+
+				-- Read interface
+				read_address			: in		std_logic_vector( 3	downto 0);			-- read Address
+				read_data				: out		std_logic_vector( 7	downto 0);			-- Data OUT
+
+				-- Memory read interface
+				dma_request				: out		std_logic;								-- Memory read request
+				dma_grant				: in		std_logic;								-- Memory read granted (data is ready one clock later)
+				dma_address				: out		std_logic_vector(15	downto 0);			-- Memory read address
+				dma_data				: in		std_logic_vector( 7	downto 0)			-- Memory read data
+			);
+	end component;
+
+	component timer is
+	port	(
+				-- General
+				clock					: in		std_logic;								-- Clock
+				reset					: in		std_logic;								-- reset
+				enable					: in		std_logic;								-- block enable
+				trigger					: out		std_logic;								-- interrupt trigger
+
+				-- Write interface
+				write_address			: in		std_logic_vector( 3	downto 0);			-- write Address
+				write_enable			: in		std_logic;								-- Write enable
+				write_data				: in		std_logic_vector( 7	downto 0);			-- Data IN
+
+				-- Read interface
+				read_address			: in		std_logic_vector( 3	downto 0);			-- read Address
+				read_data				: out		std_logic_vector( 7	downto 0);			-- Data OUT
+
+				-- Free running counter
+				microseconds			: out		std_logic_vector(31	downto 0)			-- Microseconds from reset
+			);
+	end component;
+
+	component input_event is
+	port	(
+				-- General
+				clock					: in		std_logic;								-- Clock
+				reset					: in		std_logic;								-- reset
+				enable					: in		std_logic;								-- block enable
+				enable_inputs			: in		std_logic;								-- enable inputs
+				trigger					: out		std_logic;								-- interrupt trigger
+
+				-- Write interface
+				write_address			: in		std_logic_vector( 3	downto 0);			-- write Address
+				write_enable			: in		std_logic;								-- Write enable
+				write_data				: in		std_logic_vector( 7	downto 0);			-- Data IN
+
+				-- Read interface
+				read_address			: in		std_logic_vector( 3	downto 0);			-- read Address
+				read_data				: out		std_logic_vector( 7	downto 0);			-- Data OUT
+
+				-- Inputs
+				inputs					: in		std_logic_vector(23	downto 0);			-- Input wires
+				microseconds			: in		std_logic_vector(31	downto 0)			-- Timestamp
+			);
+	end component;
+
+	component intc is
+	port	(
+				-- General
+				clock					: in		std_logic;								-- Clock
+				reset					: in		std_logic;								-- reset
+				enable					: in		std_logic;								-- block enable
+				interrupt				: out		std_logic;								-- interrupt (active low)
+
+				-- Sources
+				sources					: in		std_logic_vector( 7	downto 0);			-- Interrupt triggers
+
+				-- Write interface
+				write_address			: in		std_logic_vector( 3	downto 0);			-- write Address
+				write_enable			: in		std_logic;								-- Write enable
+				write_data				: in		std_logic_vector( 7	downto 0);			-- Data IN
+
+				-- Read interface
+				read_address			: in		std_logic_vector( 3	downto 0);			-- read Address
+				read_data				: out		std_logic_vector( 7	downto 0);			-- Data OUT
+
+				-- Zero page bank
+				zp_control				: out		std_logic_vector( 1	downto 0);			-- Reg[5] bit 1 and 0
+				zp_shadow				: in		std_logic;								-- Shadow bank in use
+
+				-- Boot status
+				boot_status				: in		std_logic_vector( 7	downto 0)			-- Reg[6]
+			);
+	end component;
+
 	component uart is
 	generic	(
 				clock_frequency			:			integer				:= 50000000;		-- clock frequency in hertz
@@ -207,11 +360,41 @@ package PACK is
 
 				-- outgoing data
 				tx_byte					: in		std_logic_vector(7 downto 0);			-- Byte to send to UART
-				tx_valid				: in		std_logic								-- High for one clock pulse to start transmission
+				tx_valid				: in		std_logic;								-- High for one clock pulse to start transmission
+
+				-- Run-time baud rate
+				baud_divisor			: in		std_logic_vector(15 downto 0)	:= x"0000"	-- Clocks per bit minus one (0 = use baud_rate generic)
 		);
 	end component;
 	
+	component serial is
+	port	(
+				-- General
+				clock					: in		std_logic;								-- Clock
+				reset					: in		std_logic;								-- reset
+				enable					: in		std_logic;								-- block enable
+				enable_inputs			: in		std_logic;								-- enable Rx
+				trigger					: out		std_logic;								-- interrupt trigger
+
+				-- Write interface
+				write_address			: in		std_logic_vector( 3	downto 0);			-- write Address
+				write_enable			: in		std_logic;								-- Write enable
+				write_data				: in		std_logic_vector( 7	downto 0);			-- Data IN
+
+				-- Read interface
+				read_address			: in		std_logic_vector( 3	downto 0);			-- read Address
+				read_data				: out		std_logic_vector( 7	downto 0);			-- Data OUT
+
+				-- Serial interface
+				uart_rx					: in		std_logic;								-- UART receive pin
+				uart_tx					: out		std_logic								-- UART transmit pin
+			);
+	end component;
+
 	component soft_dl is
+	generic	(
+				restored				:			boolean				:= false			-- Code ram restored from a checkpoint: no download
+			);
 	port	(
 				-- General
 				clock					: in		std_logic;								-- Clock
@@ -220,13 +403,14 @@ package PACK is
 				reset_devices			: out		std_logic;								-- CPU devices
 				led						: out		std_logic_vector(15 downto 0);			-- Led
 				upgrade					: in		std_logic;								-- upgrade restart
+				checkpoint				: out		std_logic;								-- CPU released on a restored code ram (no download since)
 
 				-- UART data receive
 				uart_rx_data			: in		std_logic_vector(7 downto 0);			-- UART received data
 				uart_rx_valid			: in		std_logic;								-- UART received data valid
 
 				-- Code ram write interface
-				write_address			: out		std_logic_vector(12	downto 0);			-- write Address
+				write_address			: out		std_logic_vector(ROM_ADDRESS_BITS - 1	downto 0);	-- write Address
 				write_enable			: out		std_logic_vector( 0 downto 0);			-- Write enable
 				write_data				: out		std_logic_vector( 7	downto 0)			-- Data IN
 			);
@@ -271,6 +455,37 @@ package body PACK is
 		writeline(output, var_log);
 	end Log;
 
+	----------------------------------------------------------------------------
+	-- Functions implementation
+
+	-- Memory content from a simulation checkpoint (see b65.vhd): [size] bytes from [offset],
+	-- all zero if there is no file name
+	impure function CheckpointRead(file_name : string; offset : integer; size : integer) return MEMORY_BYTES is
+		type CHAR_FILE is file of character;
+		file		var_file_handle		: CHAR_FILE;
+		variable	var_file_status		: FILE_OPEN_STATUS;
+		variable	var_char			: character;
+		variable	var_memory			: MEMORY_BYTES(0 to size - 1)	:= (others => (others => '0'));
+	begin
+		if (file_name /= "") then
+			file_open(var_file_status, var_file_handle, file_name, READ_MODE);
+			assert (var_file_status = OPEN_OK) report "Cannot open checkpoint [" & file_name & "]" severity failure;
+
+			for index in 0 to offset + size - 1 loop
+				assert not endfile(var_file_handle) report "Checkpoint [" & file_name & "] is too short (memory map changed?)" severity failure;
+				read(var_file_handle, var_char);
+
+				if (index >= offset) then
+					var_memory(index - offset)	:= std_logic_vector(to_unsigned(character'pos(var_char), 8));
+				end if;
+			end loop;
+
+			file_close(var_file_handle);
+		end if;
+
+		return var_memory;
+	end CheckpointRead;
+
 end PACK;
 
 -------------------------------------------------------------------------------
@@ -17,6 +17,10 @@
 
 ----------------------------------------------------------------------------------
 -- Static RAM memory - mimic an upgradable ROM
+--
+-- Size and address width follow the memory map (MAP_SIZE_ROM, ROM_ADDRESS_BITS, see memory.map);
+-- the memory is not cleared at reset so that it's inferred as a block RAM, the whole content is
+-- written by soft_dl before the CPU reset is released (or it's restored from a checkpoint, see b65.vhd).
 
 -------------------------------------------------------------------------------
 -- Libraries
@@ -27,11 +31,15 @@ use ieee.std_logic_unsigned.all;
 use ieee.numeric_std.all;
 
 library b65;
+use b65.PACK.all;
 
 -------------------------------------------------------------------------------
 -- Entity
 
 entity ram_code is
+	generic	(
+				init_file				:			string				:= ""				-- Initial content (checkpoint file, see b65.vhd)
+			);
 	port	(
 				-- General
 				clka					: in		std_logic;								-- Clock
@@ -40,7 +48,7 @@ entity ram_code is
 				rsta_busy				: out		std_logic;								-- busy
 
 				-- Read / Write interface
-				addra					: in		std_logic_vector(12	downto 0);			-- Ram write Address
+				addra					: in		std_logic_vector(ROM_ADDRESS_BITS - 1	downto 0);	-- Ram write Address
 				wea						: in		std_logic_vector(0	downto 0);			-- Write enable
 				dina					: in		std_logic_vector( 7	downto 0);			-- Data IN
 				douta					: out		std_logic_vector( 7	downto 0)			-- Data OUT
@@ -52,19 +60,13 @@ end ram_code;
 
 architecture behavioral of ram_code is
 
-	constant ram_cells : integer := 8192; -- number of memory cells
-
-	----------------------------------------------------------------------------
-	-- Data types
-
-	-- Memory data
-	type RAM_MEMORY is array(0 to ram_cells-1) of std_logic_vector(7 downto 0);
+	constant ram_cells : integer := MAP_SIZE_ROM; -- number of memory cells
 
 	----------------------------------------------------------------------------
 	-- Signals
 
-	-- Memory
-	signal memory : RAM_MEMORY;
+	-- Memory (the code follows the RAM in a checkpoint file)
+	signal memory : MEMORY_BYTES(0 to ram_cells-1) := CheckpointRead(init_file, MAP_SIZE_RAM, ram_cells);
 
 begin
 
@@ -91,16 +93,10 @@ begin
 	-- Memory write
 	ram_write  : process(clka) begin
 		if (clka'event and clka='1') then
-			-- If reset
-			if (rsta = '1')then
-				-- Reset RAM
-				for address in 0 to ram_cells-1 loop
-					memory(address) <= (others => '0');
-				end loop;				
-			elsif (ena = '1') and (wea(0) = '1') and (conv_integer(addra) < ram_cells) then
+			if (ena = '1') and (wea(0) = '1') and (conv_integer(addra) < ram_cells) then
 				-- Memory Write
 				memory(conv_integer(addra)) <= dina;
-			end if; -- reset
+			end if;
 		end if; -- clock event
 	end process;
 
@@ -27,11 +27,15 @@ use ieee.std_logic_unsigned.all;
 use ieee.numeric_std.all;
 
 library b65;
+use b65.PACK.all;
 
 -------------------------------------------------------------------------------
 -- Entity
 
 entity ram is
+	generic	(
+				init_file				:			string				:= ""				-- Initial content (checkpoint file, see b65.vhd)
+			);
 	port	(
 				-- General
 				clka					: in		std_logic;								-- Clock
@@ -55,19 +59,16 @@ architecture behavioral of ram is
 	----------------------------------------------------------------------------
 	-- Constants
 
-	constant RAM_CELLS : integer := 56320; -- number of memory cells
-
-	----------------------------------------------------------------------------
-	-- Data types
+	constant RAM_CELLS : integer := MAP_SIZE_RAM; -- number of memory cells
 
-	-- Memory data
-	type RAM_MEMORY is array(0 to RAM_CELLS-1) of std_logic_vector(7 downto 0);
+	-- Content after the reset: zero, or the RAM of a checkpoint (first in the file)
+	constant RAM_INIT : MEMORY_BYTES(0 to RAM_CELLS-1) := CheckpointRead(init_file, 0, RAM_CELLS);
 
 	----------------------------------------------------------------------------
 	-- Signals
 
 	-- Memory
-	signal memory : RAM_MEMORY;
+	signal memory : MEMORY_BYTES(0 to RAM_CELLS-1) := RAM_INIT;
 
 begin
 
@@ -98,7 +99,7 @@ begin
 			if (rsta = '1')then
 				-- Reset RAM
 				for address in 0 to RAM_CELLS-1 loop
-					memory(address) <= (others => '0');
+					memory(address) <= RAM_INIT(address);
 				end loop;				
 			elsif (ena = '1') and (wea(0) = '1') and (conv_integer(addra) < RAM_CELLS) then
 				-- Memory Write
@@ -33,6 +33,9 @@ use b65.PACK.all;
 -- Entity
 
 entity soft_dl is
+	generic	(
+				restored				:			boolean				:= false			-- Code ram restored from a checkpoint: no download
+			);
 	port	(
 				-- General
 				clock					: in		std_logic;								-- Clock
@@ -41,13 +44,14 @@ entity soft_dl is
 				reset_devices			: out		std_logic;								-- CPU devices
 				led						: out		std_logic_vector(15 downto 0);			-- Led
 				upgrade					: in		std_logic;								-- upgrade restart
+				checkpoint				: out		std_logic;								-- CPU released on a restored code ram (no download since)
 
 				-- UART data receive
 				uart_rx_data			: in		std_logic_vector(7 downto 0);			-- UART received data
 				uart_rx_valid			: in		std_logic;								-- UART received data valid
 
 				-- Code ram write interface
-				write_address			: out		std_logic_vector(12	downto 0);			-- write Address
+				write_address			: out		std_logic_vector(ROM_ADDRESS_BITS - 1	downto 0);	-- write Address
 				write_enable			: out		std_logic_vector( 0 downto 0);			-- Write enable
 				write_data				: out		std_logic_vector( 7	downto 0)			-- Data IN
 			);
@@ -70,18 +74,23 @@ architecture behavioral of soft_dl is
 	signal download_state	: SOFT_DL_FSM;
 	signal download_reset	: std_logic							:= '0';						-- Reset CPU (active low)
 	signal download_wait	: integer range 0 to 15;
+	signal download_skip	: std_logic							:= '0';						-- Code ram from a checkpoint, not downloaded
 	signal data_address		: std_logic_vector(15	downto 0)	:= (others => '0');			-- data Address
 
 begin
 	---------------------------------------------------------------------------
 	-- Hardwired
 
-	write_address	<= data_address(12 downto 0);
+	write_address	<= data_address(ROM_ADDRESS_BITS - 1 downto 0);
 
 	-- Reset CPU is active low
 	reset_cpu		<= download_reset;
 	reset_devices	<= not download_reset;
 
+	-- Only a restored simulation resumes a checkpoint, the RAM of any other boot is not trusted
+	-- (no reset clears it): always '0' in hardware, cleared by an upgrade download
+	checkpoint		<= download_skip;
+
 	---------------------------------------------------------------------------
 	-- Processes
 
@@ -90,7 +99,15 @@ begin
 		if (clock'event and clock='1') then
 			-- If reset
 			if (reset = '1') then
-				download_state											<= dl_start;
+				-- A restored code ram is ready: release the CPU as after a download
+				if (restored) then
+					download_state										<= dl_done;
+					download_skip										<= '1';
+				else
+					download_state										<= dl_start;
+					download_skip										<= '0';
+				end if;
+
 				led														<= x"0001";
 				data_address											<= (others => '1');
 				write_enable(0)											<= '0';
@@ -101,6 +118,7 @@ begin
 				case download_state is
 					when dl_start =>
 						download_state									<= dl_run;
+						download_skip									<= '0';
 						led												<= x"0001";
 						data_address									<= (others => '1');
 						write_enable(0)									<= '0';
@@ -111,21 +129,13 @@ begin
 						write_enable(0)									<= '0';
 						download_reset									<= '0';
 
-						if  (data_address = x"0200") then	led(1)		<= '1'; end if;
-						if  (data_address = x"0400") then	led(2)		<= '1'; end if;
-						if  (data_address = x"0600") then	led(3)		<= '1'; end if;
-						if  (data_address = x"0800") then	led(4)		<= '1'; end if;
-						if  (data_address = x"0A00") then	led(5)		<= '1'; end if;
-						if  (data_address = x"0C00") then	led(6)		<= '1'; end if;
-						if  (data_address = x"0E00") then	led(7)		<= '1'; end if;
-						if  (data_address = x"1000") then	led(8)		<= '1'; end if;
-						if  (data_address = x"1200") then	led(9)		<= '1'; end if;
-						if  (data_address = x"1400") then	led(10)		<= '1'; end if;
-						if  (data_address = x"1600") then	led(11)		<= '1'; end if;
-						if  (data_address = x"1800") then	led(12)		<= '1'; end if;
-						if  (data_address = x"1A00") then	led(13)		<= '1'; end if;
-						if  (data_address = x"1C00") then	led(14)		<= '1'; end if;
-						if  (data_address = x"1FFE") then	led(15)		<= '1'; end if;
+						-- Progress : one led every 1/16 of the code ram
+						for led_id in 1 to 14 loop
+							if (conv_integer(data_address) = led_id * (MAP_SIZE_ROM / 16)) then
+								led(led_id)								<= '1';
+							end if;
+						end loop;
+						if  (conv_integer(data_address) = MAP_SIZE_ROM - 2) then	led(15)		<= '1'; end if;
 
 						if (uart_rx_valid = '1') then
 							write_enable(0)								<= '1';
@@ -135,7 +145,7 @@ begin
 						end if;
 
 						-- software download completed
-						if  (data_address = x"1FFF") then
+						if  (conv_integer(data_address) = MAP_SIZE_ROM - 1) then
 							download_state								<= dl_done;
 							led											<= x"0000";
 						end if;
@@ -147,7 +157,9 @@ begin
 							download_reset								<= '0';
 							download_wait								<= 0;
 							
+							-- synthesis translate_off
 							Log("Restarting software download");
+							-- synthesis translate_on
 						end if;
 
 					when dl_restart =>
@@ -38,6 +38,10 @@ use b65.PACK.all;
 -- Entity
 
 entity top is
+generic	(
+			restore_file			:			string				:= "";				-- Simulation only: RAM and code ram from a checkpoint (see b65.vhd)
+			fast_sim				:			boolean				:= false				-- Simulation profile: no PWM and display multiplexing (see extension.vhd)
+		);
 port	(
 			-- General
 			clock					: in		std_logic;								-- Clock
@@ -54,7 +58,11 @@ port	(
 
 			-- UART
 			uart_rx					: in		std_logic;								-- UART receive
-			uart_tx					: out		std_logic								-- UART transmit
+			uart_tx					: out		std_logic;								-- UART transmit
+
+			-- Serial channels (Pmod)
+			serial_rx				: in		std_logic_vector(SERIAL_CHANNELS - 1 downto 0);	-- Serial channels receive
+			serial_tx				: out		std_logic_vector(SERIAL_CHANNELS - 1 downto 0)	-- Serial channels transmit
 		);
 end top;
 
@@ -96,9 +104,9 @@ architecture behavioral of top is
 	signal rom_enable_cpu		: std_logic;
 	signal rom_data				: std_logic_vector ( 7 downto 0);
 	signal rom_base				: std_logic_vector (15 downto 0);
-	signal rom_address			: std_logic_vector (12 downto 0);
-	signal rom_address_cpu		: std_logic_vector (12 downto 0);
-	signal rom_address_soft_dl	: std_logic_vector (12 downto 0)	:= (others => '0');
+	signal rom_address			: std_logic_vector (ROM_ADDRESS_BITS - 1 downto 0);
+	signal rom_address_cpu		: std_logic_vector (ROM_ADDRESS_BITS - 1 downto 0);
+	signal rom_address_soft_dl	: std_logic_vector (ROM_ADDRESS_BITS - 1 downto 0)	:= (others => '0');
 	signal rom_write_data		: std_logic_vector ( 7 downto 0)	:= (others => '0');
 	signal rom_write_enable		: std_logic_vector ( 0 downto 0)	:= (others => '0');
 
@@ -111,12 +119,85 @@ architecture behavioral of top is
 	signal ext_base				: std_logic_vector (15 downto 0);
 	signal ext_digit			: LED7X4;
 
+	-- CRC accelerator
+	signal crc_enable			: std_logic;
+	signal crc_read_data		: std_logic_vector ( 7 downto 0);
+	signal crc_write_data		: std_logic_vector ( 7 downto 0);
+	signal crc_write_enable		: std_logic;
+	signal crc_address			: std_logic_vector ( 3 downto 0);
+	signal crc_base				: std_logic_vector (15 downto 0);
+	signal crc_dma_request		: std_logic;
+	signal crc_dma_grant		: std_logic;
+	signal crc_dma_address		: std_logic_vector (15 downto 0);
+	signal crc_dma_rom			: std_logic_vector (15 downto 0);
+	signal crc_dma_data			: std_logic_vector ( 7 downto 0);
+
+	-- Timer
+	signal tmr_enable			: std_logic;
+	signal tmr_read_data		: std_logic_vector ( 7 downto 0);
+	signal tmr_write_data		: std_logic_vector ( 7 downto 0);
+	signal tmr_write_enable		: std_logic;
+	signal tmr_address			: std_logic_vector ( 3 downto 0);
+	signal tmr_base				: std_logic_vector (15 downto 0);
+
+	-- Input events
+	signal evt_enable			: std_logic;
+	signal evt_read_data		: std_logic_vector ( 7 downto 0);
+	signal evt_write_data		: std_logic_vector ( 7 downto 0);
+	signal evt_write_enable		: std_logic;
+	signal evt_address			: std_logic_vector ( 3 downto 0);
+	signal evt_base				: std_logic_vector (15 downto 0);
+	signal evt_inputs			: std_logic_vector (23 downto 0);
+	signal tmr_microseconds		: std_logic_vector (31 downto 0);
+
+	-- Serial channels
+	type SERIAL_DATA is array(0 to SERIAL_CHANNELS - 1) of std_logic_vector(7 downto 0);
+
+	signal ser_enable			: std_logic_vector (SERIAL_CHANNELS - 1 downto 0);
+	signal ser_read_data		: SERIAL_DATA;
+	signal ser_write_data		: std_logic_vector ( 7 downto 0);
+	signal ser_write_enable		: std_logic;
+	signal ser_address			: std_logic_vector ( 3 downto 0);
+	signal ser_base				: std_logic_vector (15 downto 0);
+	signal ser_trigger			: std_logic_vector (SERIAL_CHANNELS - 1 downto 0);
+
+	-- Interrupt controller
+	signal int_enable			: std_logic;
+	signal int_read_data		: std_logic_vector ( 7 downto 0);
+	signal int_write_data		: std_logic_vector ( 7 downto 0);
+	signal int_write_enable		: std_logic;
+	signal int_address			: std_logic_vector ( 3 downto 0);
+	signal int_base				: std_logic_vector (15 downto 0);
+	signal int_sources			: std_logic_vector ( 7 downto 0);
+
+	-- Interrupt triggers
+	signal ext_trigger_input	: std_logic;
+	signal ext_trigger_uart		: std_logic;
+	signal tmr_trigger			: std_logic;
+	signal evt_trigger			: std_logic;
+
 	-- 6502 CPU
 	signal cpu_address			: std_logic_vector (15 downto 0);
 	signal cpu_data_in			: std_logic_vector ( 7 downto 0);
 	signal cpu_data_out			: std_logic_vector ( 7 downto 0);
 	signal cpu_write_enable		: std_logic;
 	signal cpu_irq				: std_logic;
+	signal cpu_sync				: std_logic;
+	signal cpu_data_core		: std_logic_vector ( 7 downto 0);			-- data in of the core (WAI replaced by NOP)
+	signal cpu_wai				: std_logic;								-- CPU stopped by WAI until the IRQ line goes low
+	signal cpu_ready			: std_logic;
+
+	-- Zero page bank (see intc.vhd Reg[5])
+	signal zp_control			: std_logic_vector ( 1 downto 0);
+	signal zp_irq				: std_logic;								-- CPU is between IRQ vector fetch and RTI
+	signal zp_pushes			: std_logic_vector ( 2 downto 0);			-- last three CPU cycles were stack writes
+	signal zp_shadow			: std_logic;								-- page 0 goes to the shadow bank
+	signal zp_base				: std_logic_vector (15 downto 0);
+
+	-- Boot status (see intc.vhd Reg[6])
+	signal ram_clean			: std_logic							:= '1';	-- RAM zero from the FPGA configuration, not reset
+	signal checkpoint			: std_logic;								-- CPU released on a restored checkpoint (see soft-dl.vhd)
+	signal boot_status			: std_logic_vector ( 7 downto 0);
 
 	-- 7 segments driver
 	signal digit_delay			: std_logic_vector(23 downto 0);
@@ -160,14 +241,46 @@ begin
 	-- Hardwired
 
 --  ram_base			<= it's cpu_address;
-	ext_base			<= cpu_address - MAP_START_REG;
+	ext_base			<= cpu_address - MAP_START_EXT;
+	crc_base			<= cpu_address - MAP_START_CRC;
+	tmr_base			<= cpu_address - MAP_START_TMR;
+	int_base			<= cpu_address - MAP_START_INT;
+	evt_base			<= cpu_address - MAP_START_EVT;
+	ser_base			<= cpu_address - MAP_START_SER;
 	rom_base			<= cpu_address - MAP_START_ROM;
+	zp_base				<= cpu_address + MAP_START_ZPS;
+	crc_dma_rom			<= crc_dma_address - MAP_START_ROM;
+
+	-- Page 0 bank: selected by software or automatically while in the IRQ handler
+	zp_shadow			<= zp_control(1) or (zp_control(0) and zp_irq);
+
+	-- Boot status: the startup code resumes a checkpoint only in a restored simulation and
+	-- skips the BSS clear only while the RAM is clean
+	boot_status			<= "000000" & checkpoint & ram_clean;
+
+	-- CRC memory transfer reads the code ram or the RAM
+	crc_dma_data		<= rom_data				when (conv_integer(crc_dma_address) >= MAP_START_ROM) else ram_read_data;
 
 	-- Mux selecting CPU or soft-dl blocks
 	rom_address			<= rom_address_soft_dl	when (reset_cpu = '0') else rom_address_cpu;
 	rom_enable			<= '1'					when (reset_cpu = '0') else rom_enable_cpu;
 
 	led					<= led_soft_dl			when (reset_cpu = '0') else led_ext;
+
+	-- Interrupt sources by priority (see intc.vhd)
+	int_sources(3 downto 0)	<= evt_trigger & tmr_trigger & ext_trigger_input & ext_trigger_uart;
+
+	gen_serial_sources : for channel in 0 to 3 generate
+		gen_used : if (channel < SERIAL_CHANNELS) generate
+			int_sources(4 + channel)	<= ser_trigger(channel);
+		end generate;
+		gen_unused : if (channel >= SERIAL_CHANNELS) generate
+			int_sources(4 + channel)	<= '0';
+		end generate;
+	end generate;
+
+	-- Board inputs (buttons and slides)
+	evt_inputs			<= "0000" & push_debounce_up & slide;
 	
 	-- reset the clock manager only if there is pressed push(0) too (reset is not debounced)
 	--
@@ -194,6 +307,9 @@ begin
 	-- CPU is clocked at 5MHz because the FPGA cannot generate lower frequencies clocks
 
 	inst_clock_manager : clock_manager
+	generic map	(
+					fast_sim					=> fast_sim
+				)
 	port map	(
 					-- General
 					clk_in1						=> clock,				-- Input clock
@@ -208,17 +324,17 @@ begin
 	inst_core6502 : core
 	port map	(
 					 clk_clk_i					=> clock_5M,
-					 d_i						=> cpu_data_in,			-- data in                    input
+					 d_i						=> cpu_data_core,		-- data in                    input
 					 irq_n_i					=> cpu_irq,				-- interrupt                  input (active low)
 					 nmi_n_i					=> '1',					-- non maskable interrupt     input (active low)
-					 rdy_i						=> '1',					-- ready                      input
+					 rdy_i						=> cpu_ready,			-- ready                      input
 					 rst_rst_n_i				=> reset_cpu,			-- reset                      input (active low)
 					 so_n_i						=> '1',					-- set overflow               input (active low)
 
 					 a_o						=> cpu_address,			-- address                    output
 					 d_o						=> cpu_data_out,		-- data out                   output
 					 rd_o						=> open,
-					 sync_o						=> open,				-- high during ph1 (op fetch) output
+					 sync_o						=> cpu_sync,			-- high during ph1 (op fetch) output
 					 wr_n_o						=> open,
 					 wr_o						=> cpu_write_enable		-- write enable               output
 				);
@@ -245,6 +361,9 @@ begin
 	-- Ta (Access time) is the equivalent asynchronous device access time, in this case it's 40ns (2 clock pulses at 50MHz)
 
 	inst_ram : ram
+	generic map	(
+					init_file					=> restore_file
+				)
 	port map	(
 					-- General
 					clka						=> clock_50M,
@@ -261,6 +380,9 @@ begin
 
 	-- Code ram - the rom in previous targets
 	inst_ram_code : ram_code
+	generic map	(
+					init_file					=> restore_file
+				)
 	port map	(
 					-- General
 					clka						=> clock_50M,
@@ -295,13 +417,17 @@ begin
 				);
 
 	inst_ext : ext
+	generic map	(
+					fast_sim					=> fast_sim
+				)
 	port map	(
 					-- General
 					clock						=> clock_50M,
 					reset						=> reset_devices,
 					enable						=> ext_enable,
 					enable_inputs				=> reset_cpu,
-					interrupt					=> cpu_irq,
+					trigger_input				=> ext_trigger_input,
+					trigger_uart				=> ext_trigger_uart,
 					upgrade						=> upgrade,
 
 
@@ -316,7 +442,7 @@ begin
 					
 					-- I/O
 					outputs						=> led_ext,
-					inputs						=> "0000" & push_debounce_up & slide,
+					inputs						=> evt_inputs,
 					digit						=> ext_digit,
 
 					-- UART
@@ -328,7 +454,130 @@ begin
 					uart_tx_valid				=> uart_tx_valid
 				);
 
+	inst_crc : crc
+	port map	(
+					-- General
+					clock						=> clock_50M,
+					reset						=> reset_devices,
+					enable						=> crc_enable,
+
+					-- Write interface
+					write_address				=> crc_address,
+					write_enable				=> crc_write_enable,
+					write_data					=> crc_write_data,
+
+					-- Read interface
+					read_address				=> crc_address,
+					read_data					=> crc_read_data,
+
+					-- Memory read interface
+					dma_request					=> crc_dma_request,
+					dma_grant					=> crc_dma_grant,
+					dma_address					=> crc_dma_address,
+					dma_data					=> crc_dma_data
+				);
+
+	inst_timer : timer
+	port map	(
+					-- General
+					clock						=> clock_50M,
+					reset						=> reset_devices,
+					enable						=> tmr_enable,
+					trigger						=> tmr_trigger,
+
+					-- Write interface
+					write_address				=> tmr_address,
+					write_enable				=> tmr_write_enable,
+					write_data					=> tmr_write_data,
+
+					-- Read interface
+					read_address				=> tmr_address,
+					read_data					=> tmr_read_data,
+
+					-- Free running counter
+					microseconds				=> tmr_microseconds
+				);
+
+	inst_input_event : input_event
+	port map	(
+					-- General
+					clock						=> clock_50M,
+					reset						=> reset_devices,
+					enable						=> evt_enable,
+					enable_inputs				=> reset_cpu,
+					trigger						=> evt_trigger,
+
+					-- Write interface
+					write_address				=> evt_address,
+					write_enable				=> evt_write_enable,
+					write_data					=> evt_write_data,
+
+					-- Read interface
+					read_address				=> evt_address,
+					read_data					=> evt_read_data,
+
+					-- Inputs
+					inputs						=> evt_inputs,
+					microseconds				=> tmr_microseconds
+				);
+
+	gen_serial : for channel in 0 to SERIAL_CHANNELS - 1 generate
+		inst_serial : serial
+		port map	(
+						-- General
+						clock						=> clock_50M,
+						reset						=> reset_devices,
+						enable						=> ser_enable(channel),
+						enable_inputs				=> reset_cpu,
+						trigger						=> ser_trigger(channel),
+
+						-- Write interface
+						write_address				=> ser_address,
+						write_enable				=> ser_write_enable,
+						write_data					=> ser_write_data,
+
+						-- Read interface
+						read_address				=> ser_address,
+						read_data					=> ser_read_data(channel),
+
+						-- Serial interface
+						uart_rx						=> serial_rx(channel),
+						uart_tx						=> serial_tx(channel)
+					);
+	end generate;
+
+	inst_intc : intc
+	port map	(
+					-- General
+					clock						=> clock_50M,
+					reset						=> reset_devices,
+					enable						=> int_enable,
+					interrupt					=> cpu_irq,
+
+					-- Sources
+					sources						=> int_sources,
+
+					-- Write interface
+					write_address				=> int_address,
+					write_enable				=> int_write_enable,
+					write_data					=> int_write_data,
+
+					-- Read interface
+					read_address				=> int_address,
+					read_data					=> int_read_data,
+
+					-- Zero page bank
+					zp_control					=> zp_control,
+					zp_shadow					=> zp_shadow,
+
+					-- Boot status
+					boot_status					=> boot_status
+				);
+
 	inst_soft_dl: soft_dl
+	generic map	(
+					restored					=> (restore_file /= "")
+				)
 	port map	(
 					-- General
 					clock						=> clock_50M,
@@ -337,6 +586,7 @@ begin
 					reset_devices				=> reset_devices,
 					led							=> led_soft_dl,
 					upgrade						=> upgrade,
+					checkpoint					=> checkpoint,
 
 					-- UART data receive
 					uart_rx_data				=> uart_rx_byte,
@@ -408,20 +658,47 @@ begin
 				ext_write_data									<= (others => '0');
 				ext_address										<= (others => '0');
 
+				crc_enable										<= '0';
+				crc_write_data									<= (others => '0');
+				crc_address										<= (others => '0');
+				crc_dma_grant									<= '0';
+
+				tmr_enable										<= '0';
+				tmr_write_data									<= (others => '0');
+				tmr_address										<= (others => '0');
+
+				int_enable										<= '0';
+				int_write_data									<= (others => '0');
+				int_address										<= (others => '0');
+
+				evt_enable										<= '0';
+				evt_write_data									<= (others => '0');
+				evt_address										<= (others => '0');
+
+				ser_enable										<= (others => '0');
+				ser_write_data									<= (others => '0');
+				ser_address										<= (others => '0');
+
 				rom_enable_cpu									<= '0';
 				rom_address_cpu									<= (others => '0');
 			else
 				ram_enable										<= '0';
 				ext_enable										<= '0';
+				crc_enable										<= '0';
+				tmr_enable										<= '0';
+				int_enable										<= '0';
+				evt_enable										<= '0';
+				ser_enable										<= (others => '0');
 				rom_enable_cpu									<= '0';
+				crc_dma_grant									<= '0';
 				
 				if (conv_integer(cpu_address) >= MAP_START_ROM) then
 					-- ROM access
 					rom_enable_cpu								<= '1';
-					rom_address_cpu								<= rom_base(12 downto 0);
+					rom_address_cpu								<= rom_base(ROM_ADDRESS_BITS - 1 downto 0);
 					cpu_data_in									<= rom_data;
 
-				elsif (conv_integer(cpu_address) >= MAP_START_REG) and (conv_integer(cpu_address) <= MAP_START_REG + 15) then
+				elsif (conv_integer(cpu_address) >= MAP_START_EXT) and (conv_integer(cpu_address) <= MAP_START_EXT + 15) then
 					-- I/O EXTENSION access
 					ext_enable									<= reset_cpu;			-- disable ext if cpu is reset
 					cpu_data_in									<= ext_read_data;
@@ -429,6 +706,46 @@ begin
 					ext_write_data								<= cpu_data_out;
 					ext_write_enable							<= cpu_write_enable;
 
+				elsif (conv_integer(cpu_address) >= MAP_START_CRC) and (conv_integer(cpu_address) <= MAP_START_CRC + 15) then
+					-- CRC accelerator access
+					crc_enable									<= reset_cpu;			-- disable crc if cpu is reset
+					cpu_data_in									<= crc_read_data;
+					crc_address									<= crc_base(3 downto 0);
+					crc_write_data								<= cpu_data_out;
+					crc_write_enable							<= cpu_write_enable;
+
+				elsif (conv_integer(cpu_address) >= MAP_START_TMR) and (conv_integer(cpu_address) <= MAP_START_TMR + 15) then
+					-- Timer access
+					tmr_enable									<= reset_cpu;			-- disable timer if cpu is reset
+					cpu_data_in									<= tmr_read_data;
+					tmr_address									<= tmr_base(3 downto 0);
+					tmr_write_data								<= cpu_data_out;
+					tmr_write_enable							<= cpu_write_enable;
+
+				elsif (conv_integer(cpu_address) >= MAP_START_INT) and (conv_integer(cpu_address) <= MAP_START_INT + 15) then
+					-- Interrupt controller access
+					int_enable									<= reset_cpu;			-- disable intc if cpu is reset
+					cpu_data_in									<= int_read_data;
+					int_address									<= int_base(3 downto 0);
+					int_write_data								<= cpu_data_out;
+					int_write_enable							<= cpu_write_enable;
+
+				elsif (conv_integer(cpu_address) >= MAP_START_EVT) and (conv_integer(cpu_address) <= MAP_START_EVT + 15) then
+					-- Input events access
+					evt_enable									<= reset_cpu;			-- disable input events if cpu is reset
+					cpu_data_in									<= evt_read_data;
+					evt_address									<= evt_base(3 downto 0);
+					evt_write_data								<= cpu_data_out;
+					evt_write_enable							<= cpu_write_enable;
+
+				elsif (conv_integer(cpu_address) >= MAP_START_SER) and (conv_integer(cpu_address) <= MAP_START_SER + 16 * SERIAL_CHANNELS - 1) then
+					-- Serial channels access (16 registers each)
+					ser_enable(conv_integer(ser_base(7 downto 4)))	<= reset_cpu;		-- disable serial if cpu is reset
+					cpu_data_in									<= ser_read_data(conv_integer(ser_base(7 downto 4)));
+					ser_address									<= ser_base(3 downto 0);
+					ser_write_data								<= cpu_data_out;
+					ser_write_enable							<= cpu_write_enable;
+
 				elsif (conv_integer(cpu_address) >= MAP_START_REG) then
 					-- Registers access - unused
 
@@ -439,42 +756,151 @@ begin
 					ram_address									<= cpu_address;
 					ram_write_data								<= cpu_data_out;
 					ram_write_enable(0)							<= cpu_write_enable;
+
+					-- Page 0 in the shadow bank
+					if (zp_shadow = '1') and (cpu_address(15 downto 8) = x"00") then
+						ram_address								<= zp_base;
+					end if;
+				end if;
+
+				-- CRC memory transfer: read the memory only if the CPU is not accessing it
+				if (crc_dma_request = '1') then
+					if (conv_integer(crc_dma_address) >= MAP_START_ROM) then
+						if (conv_integer(cpu_address) < MAP_START_ROM) then
+							rom_enable_cpu						<= '1';
+							rom_address_cpu						<= crc_dma_rom(ROM_ADDRESS_BITS - 1 downto 0);
+							crc_dma_grant						<= '1';
+						end if;
+					elsif (conv_integer(crc_dma_address) < MAP_START_REG) then
+						if (conv_integer(cpu_address) >= MAP_START_REG) then
+							ram_enable							<= '1';
+							ram_address							<= crc_dma_address;
+							ram_write_enable(0)					<= '0';
+							crc_dma_grant						<= '1';
+						end if;
+					else
+						-- Registers are not readable, go on with a dummy value
+						crc_dma_grant							<= '1';
+					end if;
 				end if;
 			end if; -- reset
 		end if; -- clock event
 	end process;
 
-	-- Generate 7 segments digits signals
-	digits_gen : process(clock_50M) begin
-		if (clock_50M'event and clock_50M='1') then
-			-- If (system is in reset state)
-			if (reset_system = '1') then
-				anode											<= (others => '1');
-				cathode											<= (others => '1');
-				digit_delay										<= (others => '0');
-				digit_select									<= "1000";
-				digit_select_id									<= 3;
+	-- WAI (0xCB, a W65C02S opcode): the r65c02_tc core follows the Rockwell R65C02 and has no WAI,
+	-- so the opcode fetch gets a NOP (0xEA, one byte) and the core is held with RDY low from the
+	-- cycle after it until the IRQ line goes low, as the W65C02S does. With the interrupts disabled
+	-- the CPU goes on after the NOP, otherwise the interrupt is serviced first (see cpu_wait in
+	-- soft/direct.s). Sampled with the CPU clock: the core always gets a whole cycle after RDY.
+	cpu_data_core		<= x"EA" when (cpu_sync = '1') and (cpu_data_in = x"CB") else cpu_data_in;
+	cpu_ready			<= not cpu_wai;
+
+	proc_wai : process(clock_5M)
+		-- synthesis translate_off
+		variable var_logged : boolean := false;
+		-- synthesis translate_on
+	begin
+		if (clock_5M'event and clock_5M='1') then
+			-- If CPU reset
+			if (reset_cpu = '0') then
+				cpu_wai											<= '0';
+			elsif (cpu_sync = '1') and (cpu_data_in = x"CB") and (cpu_irq = '1') then
+				cpu_wai											<= '1';
+
+				-- synthesis translate_off
+				if (not var_logged) then
+					Log("INFO : WAI at [" & integer'image(conv_integer(cpu_address)) & "], CPU stopped until the next interrupt");
+					var_logged := true;
+				end if;
+				-- synthesis translate_on
+			elsif (cpu_irq = '0') then
+				cpu_wai											<= '0';
+			end if;
+		end if; -- clock event
+	end process;
+
+	-- IRQ handler tracking for the zero page bank, sampled with the CPU clock (address, sync and data
+	-- in are stable at the rising edge):
+	--   - the IRQ/BRK vector fetch is the handler entry: a 0xFFFE read after three stack writes
+	--     (PCH, PCL, P), a program reading 0xFFFE is not taken as an entry
+	--   - an RTI opcode fetch is the handler exit (the following cycles read only the page 1 stack)
+	-- The handler must not be interrupted (no nesting): there is only one shadow bank.
+	proc_zp : process(clock_5M) begin
+		if (clock_5M'event and clock_5M='1') then
+			-- If CPU reset
+			if (reset_cpu = '0') then
+				zp_irq											<= '0';
+				zp_pushes										<= (others => '0');
 			else
-				-- Drive the output inverting the signals
-				anode											<= not digit_select;
-				cathode											<= not ext_digit(digit_select_id);
+				if (cpu_write_enable = '1') and (cpu_address(15 downto 8) = x"01") then
+					zp_pushes									<= zp_pushes(1 downto 0) & '1';
+				else
+					zp_pushes									<= zp_pushes(1 downto 0) & '0';
+				end if;
 
-				digit_delay										<= digit_delay + 1;
+				if (cpu_address = x"FFFE") and (zp_pushes = "111") then
+					zp_irq										<= '1';
+				elsif (cpu_sync = '1') and (cpu_data_in = x"40") then
+					zp_irq										<= '0';
+				end if;
+			end if;
+		end if; -- clock event
+	end process;
 
-				-- Wait for refresh delay:  50MHz clock and a delay of 4ms : 4m * 50M = 200000 = x030D40
-				if (digit_delay = x"030D40") then
-					digit_delay									<= (others => '0');
-					digit_select								<= digit_select(2 downto 0) & digit_select(3);
+	-- RAM clean flag: the RAM block is zero after the FPGA configuration (no init file) and no
+	-- reset clears it (see basys3/ram.xci), so the flag is cleared by the first write and set
+	-- again only by a new configuration. A checkpoint RAM is never clean.
+	proc_ram_clean : process(clock_50M) begin
+		if (clock_50M'event and clock_50M='1') then
+			if ((ram_enable = '1') and (ram_write_enable(0) = '1')) or (restore_file /= "") then
+				ram_clean										<= '0';
+			end if;
+		end if; -- clock event
+	end process;
+
+	-- 7 segments digits multiplexing
+	gen_digits : if (not fast_sim) generate
+
+		-- Generate 7 segments digits signals
+		digits_gen : process(clock_50M) begin
+			if (clock_50M'event and clock_50M='1') then
+				-- If (system is in reset state)
+				if (reset_system = '1') then
+					anode											<= (others => '1');
+					cathode											<= (others => '1');
+					digit_delay										<= (others => '0');
+					digit_select									<= "1000";
+					digit_select_id									<= 3;
+				else
+					-- Drive the output inverting the signals
+					anode											<= not digit_select;
+					cathode											<= not ext_digit(digit_select_id);
+
+					digit_delay										<= digit_delay + 1;
+
+					-- Wait for refresh delay:  50MHz clock and a delay of 4ms : 4m * 50M = 200000 = x030D40
+					if (digit_delay = x"030D40") then
+						digit_delay									<= (others => '0');
+						digit_select								<= digit_select(2 downto 0) & digit_select(3);
 					
-					if (digit_select_id = 3) then
-						digit_select_id							<= 0;
-					else
-						digit_select_id							<= digit_select_id + 1;
+						if (digit_select_id = 3) then
+							digit_select_id							<= 0;
+						else
+							digit_select_id							<= digit_select_id + 1;
+						end if;
 					end if;
 				end if;
 			end if;
-		end if;
-	end process;
+		end process;
+
+	end generate;
+
+	-- Simulation profile: no multiplexing, the pins stay on the first selected digit (3), all the
+	-- digits are in ext_digit
+	gen_digits_fast : if (fast_sim) generate
+		anode			<= (others => '1')	when (reset_system = '1') else "0111";
+		cathode			<= (others => '1')	when (reset_system = '1') else not ext_digit(3);
+	end generate;
 
 end behavioral;
 
@@ -67,7 +67,10 @@ entity uart is
 
 				-- outgoing data
 				tx_byte					: in		std_logic_vector(7 downto 0);			-- Byte to send to UART
-				tx_valid				: in		std_logic								-- High for one clock pulse to start transmission
+				tx_valid				: in		std_logic;								-- High for one clock pulse to start transmission
+
+				-- Run-time baud rate
+				baud_divisor			: in		std_logic_vector(15 downto 0)	:= x"0000"	-- Clocks per bit minus one (0 = use baud_rate generic)
 		);
 end uart;
 
@@ -114,6 +117,10 @@ architecture behavioral of uart is
 	-- Serial TX Control machine
 	signal ctrl_state			: FSM_TX_CTRL;													-- FSM Control state
 
+	-- Baud rate
+	signal baud_full_delay		: std_logic_vector(15 downto 0);								-- Clocks per bit minus one
+	signal baud_half_delay		: std_logic_vector(15 downto 0);								-- Clocks per half bit minus one
+
 	-------------------------------------------------------------------------------
 	-- Baud rate computation
 
@@ -129,6 +136,12 @@ architecture behavioral of uart is
 
 begin
 
+	-------------------------------------------------------------------------------
+	-- Baud rate selection
+
+	baud_full_delay		<= baud_rate_to_full_delay(clock_frequency, baud_rate)	when (baud_divisor = x"0000") else baud_divisor;
+	baud_half_delay		<= baud_rate_to_half_delay(clock_frequency, baud_rate)	when (baud_divisor = x"0000") else '0' & baud_divisor(15 downto 1);
+
 	-------------------------------------------------------------------------------
 	-- RX section
 
@@ -176,7 +189,7 @@ begin
 						end if;
 
 						-- line is high for more than a bit, is considered idle, discard nothing
-						if (clock_rx_align > baud_rate_to_full_delay(clock_frequency, baud_rate) ) then
+						if (clock_rx_align > baud_full_delay) then
 							clock_rx_align					<= x"0000";
 							clock_rx_state					<= ck_wait;
 							clock_rx_discard				<= "00000";
@@ -193,7 +206,7 @@ begin
 							clock_rx_align					<= x"0000";
 						end if;
 
-						if (clock_rx_align > baud_rate_to_half_delay(clock_frequency, baud_rate)) then
+						if (clock_rx_align > baud_half_delay) then
 							clock_rx_state					<= ck_wait;
 						end if;
 
@@ -208,7 +221,7 @@ begin
 							clock_rx_counter				<= clock_rx_counter + x"0001";
 							
 							-- Go to high state half bit length
-							if (clock_rx_counter = baud_rate_to_half_delay(clock_frequency, baud_rate)) then
+							if (clock_rx_counter = baud_half_delay) then
 								clock_rx_state				<= ck_high;
 							end if;
 						end if;
@@ -247,7 +260,7 @@ begin
 						rx_valid							<= '0';
 
 						-- go to high state
-						if (clock_rx_counter = baud_rate_to_full_delay(clock_frequency, baud_rate)) then
+						if (clock_rx_counter = baud_full_delay) then
 							clock_rx_state					<= ck_high;
 						end if;
 
@@ -289,7 +302,7 @@ begin
 						clock_tx_counter					<= clock_tx_counter + x"0001";		-- reset clock counter
 
 						-- go to high state
-						if (clock_tx_counter = baud_rate_to_full_delay(clock_frequency, baud_rate)) then
+						if (clock_tx_counter = baud_full_delay) then
 							clock_tx_state					<= ck_high;
 						end if;
 
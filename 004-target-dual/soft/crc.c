@@ -0,0 +1,95 @@
+// Copyright 2023 Luca Bertossi
+//
+// This file is part of B65.
+// 
+//     B65 is free software: you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation, either version 3 of the License, or
+//     (at your option) any later version.
+// 
+//     B65 is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+// 
+//     You should have received a copy of the GNU General Public License
+//     along with B65.  If not, see <http://www.gnu.org/licenses/>.
+
+
+///////////////////////////////////////////////////////////
+// Includes
+
+#include "extension.h"
+#include "crc.h"
+
+///////////////////////////////////////////////////////////
+// Functions
+
+///////////////////////////////////////////////////////////
+///
+/// Start a new CRC computation
+///
+///	\param	Width	:	CRC_16 or CRC_32
+///
+///////////////////////////////////////////////////////////
+void crcStart(const unsigned char Width)
+{
+	R_CRC_SEED = 0xFFFFFFFF;
+	R_CRC_CTRL = CRC_CTRL_SEED | Width;
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Add bytes to the current CRC computation
+///
+///	\param	Data	:	bytes to add
+///	\param	Length	:	number of bytes to add
+///
+///////////////////////////////////////////////////////////
+void crcAdd(const unsigned char *Data, unsigned char Length)
+{
+	while (Length--)
+	{
+		R_CRC_DATA = *Data;
+		++Data;
+	}
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Get the current CRC value
+///
+/// \return unsigned long	:	CRC value (CRC-16 is in the lower 16 bits)
+///
+///////////////////////////////////////////////////////////
+unsigned long crcResult(void)
+{
+	return R_CRC_RESULT;
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Compute the CRC of a memory buffer (RAM or code)
+///
+///	\param	Width	:	CRC_16 or CRC_32
+///	\param	Data	:	buffer start address
+///	\param	Length	:	buffer length in bytes
+///
+/// \return unsigned long	:	CRC value (CRC-16 is in the lower 16 bits)
+///
+/// \note	the buffer is read by the CRC block while the CPU
+///			waits for the end polling the busy bit
+///
+///////////////////////////////////////////////////////////
+unsigned long crcMemory(const unsigned char Width, const void *Data, unsigned short Length)
+{
+	crcStart(Width);
+
+	R_CRC_ADDRESS	= (unsigned short) Data;
+	R_CRC_LENGTH	= Length;
+	R_CRC_CTRL		= CRC_CTRL_START | Width;
+
+	while (R_CRC_CTRL & CRC_CTRL_BUSY);
+
+	return R_CRC_RESULT;
+}
\ No newline at end of file
@@ -0,0 +1,32 @@
+// Copyright 2023 Luca Bertossi
+//
+// This file is part of B65.
+// 
+//     B65 is free software: you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation, either version 3 of the License, or
+//     (at your option) any later version.
+// 
+//     B65 is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+// 
+//     You should have received a copy of the GNU General Public License
+//     along with B65.  If not, see <http://www.gnu.org/licenses/>.
+
+
+///////////////////////////////////////////////////////////
+// CRC definitions
+
+// CRC width
+#define CRC_16					0x00	// CRC-16/CCITT-FALSE (seed 0xFFFF)
+#define CRC_32					0x01	// CRC-32/ISO-HDLC    (seed 0xFFFFFFFF)
+
+///////////////////////////////////////////////////////////
+// Functions
+
+void			crcStart	(const unsigned char Width);
+void			crcAdd		(const unsigned char *Data, unsigned char Length);
+unsigned long	crcResult	(void);
+unsigned long	crcMemory	(const unsigned char Width, const void *Data, unsigned short Length);
\ No newline at end of file
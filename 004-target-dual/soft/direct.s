@@ -0,0 +1,52 @@
+; Copyright 2023 Luca Bertossi
+;
+; This file is part of B65.
+; 
+;     B65 is free software: you can redistribute it and/or modify
+;     it under the terms of the GNU General Public License as published by
+;     the Free Software Foundation, either version 3 of the License, or
+;     (at your option) any later version.
+; 
+;     B65 is distributed in the hope that it will be useful,
+;     but WITHOUT ANY WARRANTY; without even the implied warranty of
+;     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+;     GNU General Public License for more details.
+; 
+;     You should have received a copy of the GNU General Public License
+;     along with B65.  If not, see <http://www.gnu.org/licenses/>.
+
+; ---------------------------------------------------------------------------
+; direct.s
+; ---------------------------------------------------------------------------
+;
+; Direct low level routines
+
+.export   _reboot, _cpu_wait
+
+.segment  "CODE"
+.PC02                             ; Force 65C02 assembly mode
+
+; ---------------------------------------------------------------------------
+; reboot the CPU
+
+_reboot:
+            JMP ($FFFC)           ; Jump to reset vector
+
+
+; ---------------------------------------------------------------------------
+; Stop the CPU until an interrupt arrives
+;
+; The caller disables the interrupts (SEI) before checking for pending
+; events, then calls this routine only if there is nothing to do.
+; WAI runs with the interrupts still disabled: it goes on as soon as the
+; IRQ line is low (at once if an interrupt arrived after the check), then
+; CLI services the interrupt before returning (SEI, WAI, CLI: the W65C02S
+; idiom, no wake up waits for the next interrupt).
+; top.vhd feeds the core a NOP for WAI and holds it (RDY low) until the IRQ
+; line is low. On a core without that (plain Rockwell R65C02) the opcode runs
+; as a NOP and the main loop just polls again, the behaviour is the same
+
+_cpu_wait:
+            .byte $CB             ; WAI, interrupts disabled: goes on when the IRQ line is low
+            CLI                   ; The interrupt is serviced here
+            RTS
\ No newline at end of file
@@ -0,0 +1,191 @@
+; Copyright 2023 Luca Bertossi
+;
+; This file is part of B65.
+; 
+;     B65 is free software: you can redistribute it and/or modify
+;     it under the terms of the GNU General Public License as published by
+;     the Free Software Foundation, either version 3 of the License, or
+;     (at your option) any later version.
+; 
+;     B65 is distributed in the hope that it will be useful,
+;     but WITHOUT ANY WARRANTY; without even the implied warranty of
+;     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+;     GNU General Public License for more details.
+; 
+;     You should have received a copy of the GNU General Public License
+;     along with B65.  If not, see <http://www.gnu.org/licenses/>.
+
+; this file is a modified version from the guide at https://cc65.github.io/doc/customizing.html
+
+; ---------------------------------------------------------------------------
+; interrupt.s
+; ---------------------------------------------------------------------------
+;
+; Interrupt handlers
+
+; C interrupt handler notes from the cc65 manual (FAQ section):
+;
+; As any non  trivial  6502 program, the code  generated by cc65 makes use of the zero page.
+; Zero page  locations  are also used  for the  argument stack, and as temporary storage for
+; most of the  runtime  support  functions. So  when writing interrupt  handlers in C, it is
+; necessary to save the CPU  registers plus these  zero page locations. In addition to that,
+; the functions that manipulate  the stack  pointer are  not reentrant, so you have to setup
+; a separate stack for the interrupt handler.
+
+; This means that  interrupt handlers cannot be  done without  some assembler code. For many
+; applications, the  wrapper code written  in assembler is more  than what has to be done in
+; the interrupt handler itself, so I do usually suggest to think about writing the interrupt
+; handler  completely in  assembler (provided  it is rather short). If you  don't want to do
+; this  for some  reason or  another, you  may  want  to have  a look  at the  break handler
+; functions in libsrc/dbg/dbgsupp.s. They do  contain all code that would also be needed for
+; an interrupt handler (saving registers and zero page locations, calling a C function). 
+
+; Moreover from https://cc65.github.io/mailarchive/2004-10/4623.html
+; [...] The overhead for saving and  restoring the zero  page locations used by the compiler
+; and runtime  is so high that I would  still advise people  to write  interrupt handlers in
+; assembler.
+
+.export   _irq_int, _nmi_int
+.import   _g_uart_rx_count, _g_input_event, _g_timer_ticks, _g_serial_event, _g_mbox_event
+
+.segment  "CODE"
+
+.PC02                             ; Force 65C02 assembly mode
+
+; ---------------------------------------------------------------------------
+; Non-maskable interrupt (NMI) service routine
+
+_nmi_int:  
+           ; Disable interrupts
+           SEI
+
+           PHX                    ; Save X register contents to stack
+           TSX                    ; Transfer stack pointer to X
+           PHA                    ; Save accumulator contents to stack
+           INX                    ; Increment X so it points to the status
+           INX                    ;   register value saved on the stack
+           LDA $100,X             ; Load status register contents
+           AND #$10               ; Isolate B status bit
+           BNE irq_halt           ; If B = 1, BRK detected
+
+            ; Interrupt code handler starts here
+
+           JMP irq_ret
+
+; ---------------------------------------------------------------------------
+; Maskable interrupt (IRQ) service routine
+
+_irq_int:  
+           ; Disable interrupts
+           SEI
+
+           PHX                    ; Save X register contents to stack
+           TSX                    ; Transfer stack pointer to X
+           PHA                    ; Save accumulator contents to stack
+           INX                    ; Increment X so it points to the status
+           INX                    ;   register value saved on the stack
+           LDA $100,X             ; Load status register contents
+           AND #$10               ; Isolate B status bit
+           BNE irq_halt           ; If B = 1, BRK detected
+
+            ; Interrupt code handler starts here
+
+            ; Dispatch the highest priority pending source (see intc.vhd);
+            ; every handler comes back here until no source is pending
+irq_dispatch:
+            LDX $DC30+3           ; Load R_INT_VECTOR (source * 2, 0x10 if none)
+            JMP (irq_table,X)     ; Jump to the source handler
+
+irq_table:
+            .word irq_uart        ; Source 0 : UART rx
+            .word irq_input       ; Source 1 : input change
+            .word irq_timer       ; Source 2 : timer expiration
+            .word irq_event       ; Source 3 : input event
+            .word irq_serial      ; Source 4 : serial channel 0
+            .word irq_serial      ; Source 5 : serial channel 1
+            .word irq_serial      ; Source 6 : serial channel 2
+            .word irq_mbox        ; Source 7 : mailbox
+            .word irq_ret         ; No source pending
+
+irq_uart:
+            ; Acknowledge and update _g_uart_rx_count
+			;   R_INT_ACK = INT_UART;
+			;   _g_uart_rx_count = REGEXTD_RX_COUNT;
+			;
+            LDA #$01              ; Set A = INT_UART
+            STA $DC30+2           ; Acknowledge (before reading the count, a new byte triggers again)
+			LDA $DC0D             ; Load REGEXTD_RX_COUNT
+            STA _g_uart_rx_count  ; Copy loaded value to _g_uart_rx_count
+            BRA irq_dispatch
+
+irq_input:
+            ; Acknowledge and set _g_input_event
+			;   R_INT_ACK = INT_INPUT;
+			;   _g_input_event = INT_INPUT;
+			;
+            LDA #$02              ; Set A = INT_INPUT
+            STA $DC30+2           ; Acknowledge
+            STA _g_input_event    ; Set _g_input_event (not zero)
+            BRA irq_dispatch
+
+irq_event:
+            ; Acknowledge and set _g_input_event (events are read from the queue)
+			;   R_INT_ACK = INT_EVENT;
+			;   _g_input_event = INT_EVENT;
+			;
+            LDA #$08              ; Set A = INT_EVENT
+            STA $DC30+2           ; Acknowledge
+            STA _g_input_event    ; Set _g_input_event (not zero)
+            BRA irq_dispatch
+
+irq_serial:
+            ; Acknowledge all the active serial channels and set their bits in _g_serial_event
+			;   A = R_INT_ACTIVE & 0x70;
+			;   R_INT_ACK = A;
+			;   _g_serial_event |= A;
+			;
+            LDA $DC30+4           ; Load R_INT_ACTIVE
+            AND #$70              ; Isolate serial channels (sources 4 to 6)
+            STA $DC30+2           ; Acknowledge
+            ORA _g_serial_event   ; Add the channels to _g_serial_event
+            STA _g_serial_event
+            BRA irq_dispatch
+
+irq_mbox:
+            ; Acknowledge and set _g_mbox_event (messages are read from the mailbox)
+			;   R_INT_ACK = INT_MBOX;
+			;   _g_mbox_event = INT_MBOX;
+			;
+            LDA #$80              ; Set A = INT_MBOX
+            STA $DC30+2           ; Acknowledge
+            STA _g_mbox_event     ; Set _g_mbox_event (not zero)
+            BRA irq_dispatch
+
+irq_timer:
+            ; Acknowledge and count the tick
+			;   R_INT_ACK = INT_TIMER;
+			;   _g_timer_ticks++;
+			;
+            LDA #$04              ; Set A = INT_TIMER
+            STA $DC30+2           ; Acknowledge
+            INC _g_timer_ticks    ; Increment _g_timer_ticks low byte
+            BNE irq_dispatch      ; if no carry dispatch the next source
+            INC _g_timer_ticks+1  ; Increment _g_timer_ticks high byte
+            BRA irq_dispatch
+
+; ---------------------------------------------------------------------------
+; IRQ return
+
+irq_ret:   PLA                    ; Restore accumulator contents
+           PLX                    ; Restore X register contents
+           
+            ; Enable interrupts
+            CLI
+           
+           RTI                    ; Return from all IRQ interrupts
+
+; ---------------------------------------------------------------------------
+; BRK detected, stop
+
+irq_halt:  JMP irq_halt           ; If BRK is detected, something very bad
+                                  ;   has happened, so stop running
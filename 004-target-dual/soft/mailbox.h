@@ -0,0 +1,70 @@
+// Copyright 2023 Luca Bertossi
+//
+// This file is part of B65.
+// 
+//     B65 is free software: you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation, either version 3 of the License, or
+//     (at your option) any later version.
+// 
+//     B65 is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+// 
+//     You should have received a copy of the GNU General Public License
+//     along with B65.  If not, see <http://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////
+// Mailbox and shared RAM definitions, used by both cores
+// (core 1 sources include this file from ../soft)
+
+///////////////////////////////////////////////////////////
+// Registers
+
+// Mailbox registers (see mbox.vhd), the same address on both cores
+#define REGMBX_BASE				0xDC90
+
+#define R_MBX_ID				(*((unsigned char*)  REGMBX_BASE + 0x00))
+#define R_MBX_CTRL				(*((unsigned char*)  REGMBX_BASE + 0x01))
+#define R_MBX_RX_COUNT			(*((unsigned char*)  REGMBX_BASE + 0x02))
+#define R_MBX_TX_FREE			(*((unsigned char*)  REGMBX_BASE + 0x03))
+#define R_MBX_RX				(*((unsigned char*)  REGMBX_BASE + 0x04))
+#define R_MBX_TX				(*((unsigned char*)  REGMBX_BASE + 0x05))
+#define R_MBX_LOCK(Lock)		(*((unsigned char*)  REGMBX_BASE + 0x08 + (Lock)))		// Read is test and set (0 = taken), write releases
+
+// R_MBX_CTRL bits
+#define MBX_CTRL_RX_IRQ			0x01
+
+///////////////////////////////////////////////////////////
+// Spinlocks (0 to 7)
+
+#define LOCK_SHARED				0		// g_shared.alive
+
+#define mbxLock(Lock)			while (R_MBX_LOCK(Lock) != 0)
+#define mbxUnlock(Lock)			R_MBX_LOCK(Lock) = 0
+
+///////////////////////////////////////////////////////////
+// Messages
+
+#define MBX_CMD_PRIMES			0x01	// core 0 -> core 1 : count the primes below g_shared.limit
+#define MBX_DONE_PRIMES			0x81	// core 1 -> core 0 : g_shared.count is ready
+
+///////////////////////////////////////////////////////////
+// Shared RAM (see b65.cfg SHARED memory area)
+//
+// Both images place their own data in the private RAM, the shared
+// data lives at a fixed address known by both cores.
+// A message is sent after writing the data it refers to (the mailbox
+// keeps the order), data updated while the other core reads it is
+// protected by a spinlock
+
+#define SHARED_BASE				0x8000
+
+typedef struct
+{
+	unsigned long	alive;		// core 1 main loop counter (LOCK_SHARED)
+	unsigned short	limit;		// MBX_CMD_PRIMES parameter
+	unsigned short	count;		// MBX_DONE_PRIMES result
+} SHARED_DATA;
+
+#define g_shared				(*((SHARED_DATA*) SHARED_BASE))
\ No newline at end of file
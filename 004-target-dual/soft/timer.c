@@ -0,0 +1,84 @@
+// Copyright 2023 Luca Bertossi
+//
+// This file is part of B65.
+// 
+//     B65 is free software: you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation, either version 3 of the License, or
+//     (at your option) any later version.
+// 
+//     B65 is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+// 
+//     You should have received a copy of the GNU General Public License
+//     along with B65.  If not, see <http://www.gnu.org/licenses/>.
+
+
+///////////////////////////////////////////////////////////
+// Includes
+
+#include "extension.h"
+#include "timer.h"
+
+///////////////////////////////////////////////////////////
+// Globals
+
+// Variable shared with assembler; it's updated in IRQ handler (see isr.s)
+unsigned short	g_timer_ticks;
+
+///////////////////////////////////////////////////////////
+// Functions
+
+///////////////////////////////////////////////////////////
+///
+/// Start the timer
+///
+///	\param	Prescaler	:	tick frequency is 50MHz / (Prescaler + 1)
+///	\param	Reload		:	timer period is (Reload + 1) ticks
+///	\param	Mode		:	TMR_CTRL_PERIODIC and/or TMR_CTRL_IRQ
+///							(zero for one-shot without interrupt)
+///
+///////////////////////////////////////////////////////////
+void timerStart(unsigned short Prescaler, unsigned short Reload, unsigned char Mode)
+{
+	R_TMR_CTRL		= 0;
+	R_TMR_STATUS	= TMR_STATUS_EXPIRED;
+	R_TMR_PRESCALER	= Prescaler;
+	R_TMR_RELOAD	= Reload;
+	R_TMR_CTRL		= Mode | TMR_CTRL_RUN;
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Stop the timer
+///
+///////////////////////////////////////////////////////////
+void timerStop(void)
+{
+	R_TMR_CTRL		= 0;
+	R_TMR_STATUS	= TMR_STATUS_EXPIRED;
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Read the free running microseconds counter
+///
+/// \return unsigned long	:	microseconds elapsed from reset
+///
+/// \note	the lowest byte must be read first, it latches the others
+///			(a long read is not used: cc65 reads the highest byte first)
+///
+///////////////////////////////////////////////////////////
+unsigned long timerMicroseconds(void)
+{
+	unsigned long Value;
+
+	((unsigned char*) &Value)[0] = R_TMR_MICROSECONDS0;
+	((unsigned char*) &Value)[1] = R_TMR_MICROSECONDS1;
+	((unsigned char*) &Value)[2] = R_TMR_MICROSECONDS2;
+	((unsigned char*) &Value)[3] = R_TMR_MICROSECONDS3;
+
+	return Value;
+}
\ No newline at end of file
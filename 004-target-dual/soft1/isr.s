@@ -0,0 +1,66 @@
+; Copyright 2023 Luca Bertossi
+;
+; This file is part of B65.
+; 
+;     B65 is free software: you can redistribute it and/or modify
+;     it under the terms of the GNU General Public License as published by
+;     the Free Software Foundation, either version 3 of the License, or
+;     (at your option) any later version.
+; 
+;     B65 is distributed in the hope that it will be useful,
+;     but WITHOUT ANY WARRANTY; without even the implied warranty of
+;     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+;     GNU General Public License for more details.
+; 
+;     You should have received a copy of the GNU General Public License
+;     along with B65.  If not, see <http://www.gnu.org/licenses/>.
+
+; ---------------------------------------------------------------------------
+; interrupt.s
+; ---------------------------------------------------------------------------
+;
+; Interrupt handlers of core 1
+;
+; Core 1 has no interrupt controller: its IRQ line is driven by the mailbox
+; (see mbox.vhd) and it's low while a message is waiting with R_MBX_CTRL
+; RX interrupt enabled. The main loop polls the mailbox, so the handler
+; only masks the source (the main loop enables it again if it wants to be
+; woken up, e.g. before a WAI on a core supporting it)
+
+.export   _irq_int, _nmi_int
+
+.segment  "CODE"
+
+.PC02                             ; Force 65C02 assembly mode
+
+; ---------------------------------------------------------------------------
+; Non-maskable interrupt (NMI) service routine (not connected)
+
+_nmi_int:  
+           RTI
+
+; ---------------------------------------------------------------------------
+; Maskable interrupt (IRQ) service routine
+
+_irq_int:  
+           PHA                    ; Save accumulator contents to stack
+           PHX                    ; Save X register contents to stack
+           TSX                    ; Transfer stack pointer to X
+           LDA $103,X             ; Load status register contents
+           AND #$10               ; Isolate B status bit
+           BNE irq_halt           ; If B = 1, BRK detected
+
+            ; Mask the mailbox interrupt (the IRQ line is a level)
+			;   R_MBX_CTRL = 0;
+			;
+           STZ $DC90+1            ; R_MBX_CTRL = 0
+
+           PLX                    ; Restore X register contents
+           PLA                    ; Restore accumulator contents
+           RTI                    ; Return from interrupt
+
+; ---------------------------------------------------------------------------
+; BRK detected, stop
+
+irq_halt:  JMP irq_halt           ; If BRK is detected, something very bad
+                                  ;   has happened, so stop running
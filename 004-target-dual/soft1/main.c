@@ -0,0 +1,114 @@
+// Copyright 2023 Luca Bertossi
+//
+// This file is part of B65.
+// 
+//     B65 is free software: you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation, either version 3 of the License, or
+//     (at your option) any later version.
+// 
+//     B65 is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+// 
+//     You should have received a copy of the GNU General Public License
+//     along with B65.  If not, see <http://www.gnu.org/licenses/>.
+///////////////////////////////////////////////////////////
+// Core 1 software
+//
+// Core 1 sees only its private RAM, the shared RAM and the
+// mailbox registers: it computes what core 0 asks through
+// the mailbox, core 0 handles all the I/O
+
+///////////////////////////////////////////////////////////
+// Includes
+
+#include <string.h>
+
+#include "../soft/mailbox.h"
+
+///////////////////////////////////////////////////////////
+// Defines
+
+#define SIEVE_SIZE		0x4000		// Highest limit for MBX_CMD_PRIMES
+
+///////////////////////////////////////////////////////////
+// Globals
+
+// Sieve of Eratosthenes (private RAM)
+static unsigned char	s_sieve[SIEVE_SIZE];
+
+///////////////////////////////////////////////////////////
+// Functions
+
+///////////////////////////////////////////////////////////
+///
+/// Count the prime numbers below a limit
+///
+///	\param	Limit		:	Upper limit (excluded, up to SIEVE_SIZE)
+///
+///	\return	number of primes
+///
+///////////////////////////////////////////////////////////
+unsigned short primes(unsigned short Limit)
+{
+	unsigned short	Count = 0;
+	unsigned short	Index;
+	unsigned short	Multiple;
+
+	if (Limit > SIEVE_SIZE)
+		Limit = SIEVE_SIZE;
+
+	memset(s_sieve, 1, Limit);
+
+	for (Index = 2; Index < Limit; Index++)
+	{
+		if (s_sieve[Index])
+		{
+			Count++;
+
+			for (Multiple = Index + Index; Multiple < Limit; Multiple += Index)
+				s_sieve[Multiple] = 0;
+		}
+	}
+
+	return Count;
+}
+
+///////////////////////////////////////////////////////////
+// Entry point
+
+///////////////////////////////////////////////////////////
+///
+/// Entry point
+///
+///////////////////////////////////////////////////////////
+void main(void)
+{
+	// The startup code clears only the private RAM
+	mbxLock(LOCK_SHARED);
+	g_shared.alive = 0;
+	mbxUnlock(LOCK_SHARED);
+
+	while(1)
+	{
+		// Commands from core 0
+		while (R_MBX_RX_COUNT != 0)
+		{
+			if (R_MBX_RX == MBX_CMD_PRIMES)
+			{
+				// The result comes before the answer (see mailbox.h)
+				g_shared.count = primes(g_shared.limit);
+
+				while (R_MBX_TX_FREE == 0);
+				R_MBX_TX = MBX_DONE_PRIMES;
+			}
+		}
+
+		// Alive counter, read by core 0 while it's updated
+		mbxLock(LOCK_SHARED);
+		g_shared.alive++;
+		mbxUnlock(LOCK_SHARED);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,206 @@
+-- Copyright 2023 Luca Bertossi
+--
+-- This file is part of B65.
+-- 
+--     B65 is free software: you can redistribute it and/or modify
+--     it under the terms of the GNU General Public License as published by
+--     the Free Software Foundation, either version 3 of the License, or
+--     (at your option) any later version.
+-- 
+--     B65 is distributed in the hope that it will be useful,
+--     but WITHOUT ANY WARRANTY; without even the implied warranty of
+--     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+--     GNU General Public License for more details.
+-- 
+--     You should have received a copy of the GNU General Public License
+--     along with B65.  If not, see <http://www.gnu.org/licenses/>.
+
+----------------------------------------------------------------------------------
+-- Interrupt controller block
+
+-- Registers map (default all to zero)
+--
+--	Reg[0] : [RW] Enable                    (bit[n] = source n, 0=disable, 1=enable)
+--	Reg[1] : [RO] Pending                   (bit[n] = source n triggered, regardless of enable)
+--	Reg[2] : [WO] Acknowledge               (bit[n] = write 1 to clear pending source n)
+--	Reg[3] : [RO] Vector                    (2 * number of the highest priority enabled pending source, 0x10 if none)
+--	Reg[4] : [RO] Active                    (bit[n] = source n enabled and pending)
+--
+--	Reg[5:F] : unused
+--
+-- Sources (source 0 has the highest priority)
+--
+--	0 : UART rx          (see extension.vhd)
+--	1 : input change     (see extension.vhd)
+--	2 : timer expiration (see timer.vhd)
+--	3 : input event      (see input-event.vhd)
+--	4 : serial channel 0 (see serial.vhd)
+--	5 : serial channel 1
+--	6 : serial channel 2
+--	7 : mailbox          (see mbox.vhd, messages from core 1)
+--
+-- A source trigger (high for one clock) sets its pending bit; the bit is kept until acknowledged,
+-- so no trigger is lost even if the CPU has the interrupts disabled.
+-- The interrupt (active low) is held while any enabled source is pending.
+-- The vector is an index for the 65C02 'JMP (table,X)' instruction (two bytes per table entry).
+--
+
+-------------------------------------------------------------------------------
+-- Libraries
+
+library ieee;
+use ieee.std_logic_1164.all;
+use ieee.std_logic_unsigned.all;
+use ieee.numeric_std.all;
+
+library b65;
+use b65.PACK.all;
+
+-------------------------------------------------------------------------------
+-- Entity
+
+entity intc is
+	port	(
+				-- General
+				clock					: in		std_logic;								-- Clock
+				reset					: in		std_logic;								-- reset
+				enable					: in		std_logic;								-- block enable
+				interrupt				: out		std_logic;								-- interrupt (active low)
+
+				-- Sources
+				sources					: in		std_logic_vector( 7	downto 0);			-- Interrupt triggers (high for one clock)
+
+				-- Write interface
+				write_address			: in		std_logic_vector( 3	downto 0);			-- write Address
+				write_enable			: in		std_logic;								-- Write enable
+				write_data				: in		std_logic_vector( 7	downto 0);			-- Data IN
+
+				-- Read interface
+				read_address			: in		std_logic_vector( 3	downto 0);			-- read Address
+				read_data				: out		std_logic_vector( 7	downto 0)			-- Data OUT
+			);
+end intc;
+
+-------------------------------------------------------------------------------
+-- Architecture
+
+architecture behavioral of intc is
+
+	----------------------------------------------------------------------------
+	-- Signals
+
+	-- Registers
+	signal int_enable				: std_logic_vector(7 downto 0);
+	signal int_pending				: std_logic_vector(7 downto 0);
+	signal int_active				: std_logic_vector(7 downto 0);
+	signal int_vector				: std_logic_vector(7 downto 0);
+
+	-- Read / Write
+	signal read_keep				: std_logic;	-- Keep the samme value to read_data while enable is high
+	signal write_once				: std_logic;	-- Write once a register             while enable is high
+
+	----------------------------------------------------------------------------
+	-- Functions
+
+	-- Fixed priority encoder (source 0 first)
+	function priority_vector(active : std_logic_vector(7 downto 0)) return std_logic_vector is
+	begin
+		for source in 0 to 7 loop
+			if (active(source) = '1') then
+				return std_logic_vector(to_unsigned(source * 2, 8));
+			end if;
+		end loop;
+		return x"10";
+	end;
+
+begin
+
+	---------------------------------------------------------------------------
+	-- Hardwired
+
+	int_active		<= int_pending and int_enable;
+	int_vector		<= priority_vector(int_active);
+	interrupt		<= '1' when (int_active = x"00") else '0';
+
+	----------------------------------------------------------------------------
+	-- Processes
+
+	-- Register read
+	intc_read  : process(clock) begin
+		if (clock'event and clock='1') then
+			-- If reset
+			if (reset = '1') then
+				read_data						<= (others => '0');
+				read_keep						<= '0';
+			elsif (read_keep = '1') then
+
+				-- Prevent to modify read_data output while enable is high
+				if (enable = '0') then
+					read_keep					<= '0';
+				end if;
+
+			elsif (enable = '1') and (read_keep = '0') and (write_enable = '0') then
+
+				read_keep						<= '1';
+
+				case (read_address) is
+					when x"0"	=> read_data	<= int_enable;
+					when x"1"	=> read_data	<= int_pending;
+					when x"3"	=> read_data	<= int_vector;
+					when x"4"	=> read_data	<= int_active;
+					when others	=> read_data	<= (others => '0');
+				end case;
+			end if; -- reset
+		end if; -- clock event
+	end process;
+
+	-- Register write and pending sources
+	intc_write  : process(clock)
+		variable pending : std_logic_vector(7 downto 0);
+	begin
+		if (clock'event and clock='1') then
+			-- If reset
+			if (reset = '1') then
+				int_enable			<= (others => '0');
+				int_pending			<= (others => '0');
+				write_once			<= '0';
+			else
+				pending				:= int_pending;
+
+				-- Registers action
+				if (write_enable = '1') and (enable = '1') and (write_once = '0') then
+
+					-- synthesis translate_off
+					Log("INFO : intc Write REG[" & integer'image(conv_integer(write_address)) & "]->[" & integer'image(conv_integer(write_data)) & "]");
+					-- synthesis translate_on
+
+					case (write_address) is
+						when x"0"	=> int_enable	<= write_data;						-- Reg[0] : [RW] Enable
+						when x"2"	=> pending		:= pending and not write_data;		-- Reg[2] : [WO] Acknowledge
+						when others	=> null;
+					end case;
+
+					write_once				<= '1';
+				end if;
+
+				if (enable = '0') then
+					write_once <= '0';
+				end if;
+
+				-- A trigger in the same clock of its acknowledge is kept pending
+				int_pending			<= pending or sources;
+
+				-- synthesis translate_off
+				if (sources /= x"00") then
+					Log("INFO : intc IRQ sources [" & integer'image(conv_integer(sources)) & "]");
+				end if;
+				-- synthesis translate_on
+
+			end if; -- reset
+		end if; -- clock event
+	end process;
+
+end behavioral;
+
+-------------------------------------------------------------------------------
+-- EOF
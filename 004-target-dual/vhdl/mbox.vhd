@@ -0,0 +1,283 @@
+-- Copyright 2023 Luca Bertossi
+--
+-- This file is part of B65.
+-- 
+--     B65 is free software: you can redistribute it and/or modify
+--     it under the terms of the GNU General Public License as published by
+--     the Free Software Foundation, either version 3 of the License, or
+--     (at your option) any later version.
+-- 
+--     B65 is distributed in the hope that it will be useful,
+--     but WITHOUT ANY WARRANTY; without even the implied warranty of
+--     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+--     GNU General Public License for more details.
+-- 
+--     You should have received a copy of the GNU General Public License
+--     along with B65.  If not, see <http://www.gnu.org/licenses/>.
+
+----------------------------------------------------------------------------------
+-- Mailbox block - messages and spinlocks between the CPU cores
+
+-- Registers map (default all to zero), the same for each core: "rx" are the messages
+-- sent by the other core, "tx" are the messages sent to the other core
+--
+--	Reg[0] : [RO] core id (0 or 1)
+--
+--	Reg[1] : [RW] Control
+--			bit[7:1] = unused
+--			bit[0]   = RX interrupt             (0=disable         , 1=enable)
+--
+--	Reg[2] : [RO] number of messages in the RX fifo
+--	Reg[3] : [RO] free space in the TX fifo
+--	Reg[4] : [RO] RX message (read removes it from the fifo)
+--	Reg[5] : [WO] TX message (dropped if the TX fifo is full)
+--
+--	Reg[6:7] : unused
+--
+--	Reg[8:F] : [RW] spinlocks 0 to 7
+--			read  = test and set : 0x00 the lock was free and now it's owned by the reading core
+--			                       0x80 + owner core id if the lock is already owned
+--			write = release the lock (ignored if the writing core is not the owner)
+--
+-- A register access of the two cores in the same clock is served in core order (core 0
+-- first), so a lock can never be given to both cores.
+-- The trigger output of a core is high for one clock when a message is added to its RX fifo
+-- (RX interrupt enabled), see intc.vhd; the interrupt output of a core is low while its RX fifo
+-- is not empty (RX interrupt enabled), for a core without the interrupt controller.
+--
+
+-------------------------------------------------------------------------------
+-- Libraries
+
+library ieee;
+use ieee.std_logic_1164.all;
+use ieee.std_logic_unsigned.all;
+use ieee.numeric_std.all;
+
+library b65;
+use b65.PACK.all;
+
+-------------------------------------------------------------------------------
+-- Entity
+
+entity mbox is
+	port	(
+				-- General
+				clock					: in		std_logic;								-- Clock
+				reset					: in		std_logic;								-- reset
+				enable					: in		std_logic_vector(CPU_CORES - 1 downto 0);	-- block enable
+				trigger					: out		std_logic_vector(CPU_CORES - 1 downto 0);	-- interrupt trigger (high for one clock)
+				interrupt				: out		std_logic_vector(CPU_CORES - 1 downto 0);	-- interrupt (active low)
+
+				-- Write interface
+				write_address			: in		CORE_ADDRESS;							-- write Address
+				write_enable			: in		std_logic_vector(CPU_CORES - 1 downto 0);	-- Write enable
+				write_data				: in		CORE_DATA;								-- Data IN
+
+				-- Read interface
+				read_address			: in		CORE_ADDRESS;							-- read Address
+				read_data				: out		CORE_DATA								-- Data OUT
+			);
+end mbox;
+
+-------------------------------------------------------------------------------
+-- Architecture
+
+architecture behavioral of mbox is
+
+	----------------------------------------------------------------------------
+	-- Constants
+
+	constant MBOX_FIFO_DEPTH : integer := 16;
+
+	----------------------------------------------------------------------------
+	-- Data types
+
+	-- Messages fifo, one for each receiving core
+	type MBOX_FIFO		is array(0 to MBOX_FIFO_DEPTH - 1) of std_logic_vector(7 downto 0);
+	type MBOX_FIFOS		is array(0 to CPU_CORES - 1) of MBOX_FIFO;
+	type MBOX_INDEX		is array(0 to CPU_CORES - 1) of integer range 0 to MBOX_FIFO_DEPTH - 1;
+	type MBOX_COUNT		is array(0 to CPU_CORES - 1) of integer range 0 to MBOX_FIFO_DEPTH;
+	type MBOX_FLAGS		is array(0 to CPU_CORES - 1) of boolean;
+
+	----------------------------------------------------------------------------
+	-- Signals
+
+	-- Registers
+	signal reg_control				: CORE_DATA;
+
+	-- Read / Write
+	signal read_keep				: std_logic_vector(CPU_CORES - 1 downto 0);	-- Keep the samme value to read_data while enable is high
+	signal write_once				: std_logic_vector(CPU_CORES - 1 downto 0);	-- Write once a register             while enable is high
+
+	-- Messages fifo (index is the receiving core)
+	signal fifo						: MBOX_FIFOS;
+	signal fifo_write				: MBOX_INDEX;
+	signal fifo_read				: MBOX_INDEX;
+	signal fifo_count				: MBOX_COUNT;
+
+	-- Spinlocks
+	signal lock_taken				: std_logic_vector(7 downto 0);
+	signal lock_owner				: std_logic_vector(7 downto 0);
+
+begin
+
+	---------------------------------------------------------------------------
+	-- Hardwired
+
+	gen_interrupt : for core in 0 to CPU_CORES - 1 generate
+		interrupt(core)	<= '0' when (reg_control(core)(0) = '1') and (fifo_count(core) /= 0) else '1';
+	end generate;
+
+	----------------------------------------------------------------------------
+	-- Processes
+
+	-- Registers read / write, messages and spinlocks (one process: the cores are served in order)
+	mbox_access  : process(clock)
+		variable push		: MBOX_FLAGS;
+		variable pop		: MBOX_FLAGS;
+		variable taken		: std_logic_vector(7 downto 0);
+		variable owner		: std_logic_vector(7 downto 0);
+		variable lock		: integer range 0 to 7;
+		variable peer		: integer range 0 to CPU_CORES - 1;
+	begin
+		if (clock'event and clock='1') then
+			-- If reset
+			if (reset = '1') then
+				for core in 0 to CPU_CORES - 1 loop
+					reg_control(core)				<= (others => '0');
+					read_data(core)					<= (others => '0');
+					fifo_write(core)				<= 0;
+					fifo_read(core)					<= 0;
+					fifo_count(core)				<= 0;
+				end loop;
+
+				read_keep							<= (others => '0');
+				write_once							<= (others => '0');
+				trigger								<= (others => '0');
+				lock_taken							<= (others => '0');
+				lock_owner							<= (others => '0');
+			else
+				trigger								<= (others => '0');
+				taken								:= lock_taken;
+				owner								:= lock_owner;
+
+				for core in 0 to CPU_CORES - 1 loop
+					push(core)						:= false;
+					pop(core)						:= false;
+				end loop;
+
+				for core in 0 to CPU_CORES - 1 loop
+
+					peer							:= CPU_CORES - 1 - core;
+					lock							:= conv_integer(read_address(core)(2 downto 0));
+
+					-- Registers read
+					if (read_keep(core) = '1') then
+
+						-- Prevent to modify read_data output while enable is high
+						if (enable(core) = '0') then
+							read_keep(core)			<= '0';
+						end if;
+
+					elsif (enable(core) = '1') and (write_enable(core) = '0') then
+
+						read_keep(core)				<= '1';
+
+						case (read_address(core)) is
+							when x"0"	=> read_data(core)	<= std_logic_vector(to_unsigned(core, 8));
+							when x"1"	=> read_data(core)	<= reg_control(core);
+							when x"2"	=> read_data(core)	<= std_logic_vector(to_unsigned(fifo_count(core), 8));
+							when x"3"	=> read_data(core)	<= std_logic_vector(to_unsigned(MBOX_FIFO_DEPTH - fifo_count(peer), 8));
+							when x"4"	=>
+								-- RX message
+								if (fifo_count(core) /= 0) then
+									read_data(core)	<= fifo(core)(fifo_read(core));
+									pop(core)		:= true;
+								else
+									read_data(core)	<= (others => '0');
+								end if;
+							when x"8" | x"9" | x"A" | x"B" | x"C" | x"D" | x"E" | x"F" =>
+								-- Spinlock test and set
+								if (taken(lock) = '0') then
+									read_data(core)	<= x"00";
+									taken(lock)		:= '1';
+									owner(lock)		:= to_unsigned(core, 1)(0);
+								else
+									read_data(core)	<= "1000000" & owner(lock);
+								end if;
+							when others	=> read_data(core)	<= (others => '0');
+						end case;
+					end if;
+
+					-- Registers write
+					if (write_enable(core) = '1') and (enable(core) = '1') and (write_once(core) = '0') then
+
+						-- synthesis translate_off
+						Log("INFO : mbox core " & integer'image(core) & " Write REG[" & integer'image(conv_integer(write_address(core))) & "]->[" & integer'image(conv_integer(write_data(core))) & "]");
+						-- synthesis translate_on
+
+						lock						:= conv_integer(write_address(core)(2 downto 0));
+
+						case (write_address(core)) is
+							when x"1"	=> reg_control(core)	<= "0000000" & write_data(core)(0);
+							when x"5"	=>
+								-- TX message
+								if (fifo_count(peer) /= MBOX_FIFO_DEPTH) then
+									fifo(peer)(fifo_write(peer))	<= write_data(core);
+									push(peer)						:= true;
+									trigger(peer)					<= reg_control(peer)(0);
+								end if;
+							when x"8" | x"9" | x"A" | x"B" | x"C" | x"D" | x"E" | x"F" =>
+								-- Spinlock release (owner only)
+								if (owner(lock) = to_unsigned(core, 1)(0)) then
+									taken(lock)		:= '0';
+								end if;
+							when others	=> null;
+						end case;
+
+						write_once(core)			<= '1';
+					end if;
+
+					if (enable(core) = '0') then
+						write_once(core)			<= '0';
+					end if;
+
+				end loop;
+
+				-- Fifo update
+				for core in 0 to CPU_CORES - 1 loop
+					if (push(core)) then
+						if (fifo_write(core) = MBOX_FIFO_DEPTH - 1) then
+							fifo_write(core)		<= 0;
+						else
+							fifo_write(core)		<= fifo_write(core) + 1;
+						end if;
+					end if;
+
+					if (pop(core)) then
+						if (fifo_read(core) = MBOX_FIFO_DEPTH - 1) then
+							fifo_read(core)			<= 0;
+						else
+							fifo_read(core)			<= fifo_read(core) + 1;
+						end if;
+					end if;
+
+					if (push(core)) and (not pop(core)) then
+						fifo_count(core)			<= fifo_count(core) + 1;
+					elsif (pop(core)) and (not push(core)) then
+						fifo_count(core)			<= fifo_count(core) - 1;
+					end if;
+				end loop;
+
+				lock_taken							<= taken;
+				lock_owner							<= owner;
+
+			end if; -- reset
+		end if; -- clock event
+	end process;
+
+end behavioral;
+
+-------------------------------------------------------------------------------
+-- EOF
@@ -0,0 +1,479 @@
+-- Copyright 2023 Luca Bertossi
+--
+-- This file is part of B65.
+-- 
+--     B65 is free software: you can redistribute it and/or modify
+--     it under the terms of the GNU General Public License as published by
+--     the Free Software Foundation, either version 3 of the License, or
+--     (at your option) any later version.
+-- 
+--     B65 is distributed in the hope that it will be useful,
+--     but WITHOUT ANY WARRANTY; without even the implied warranty of
+--     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+--     GNU General Public License for more details.
+-- 
+--     You should have received a copy of the GNU General Public License
+--     along with B65.  If not, see <http://www.gnu.org/licenses/>.
+
+-------------------------------------------------------------------------------
+-- b65 memory map (see software b65.cfg configuration file)
+--
+-- Each CPU core sees the same map, only the shared RAM is the same memory for both cores
+--
+--		0x0000       0         RAM          (32768 bytes = 32 KB, private for each core)
+--		                       |
+--		0x7FFF   32767         v        <-- (Stack is 0x400 bytes, growing from 0x7FFF to 0x7C00)
+--		0x8000   32768         Shared RAM   (23552 bytes = 23 KB, true dual port, see ram-shared.vhd)
+--		                       |
+--		0xDBFF   56319         v
+--		0xDC00   56320         \
+--		                        | Registers (1024 bytes =  1 KB)
+--		0xDFFF   57343         /
+--		0xE000   57344         ^
+--		                       |
+--		                       |
+--		0xFFFF   65535        ROM start     (8192 bytes =  8 KB, private for each core)
+--
+-- Registers blocks (16 registers each)
+--
+--		0xDC00 - 0xDC0F        I/O extension    (see extension.vhd)
+--		0xDC10 - 0xDC1F        CRC accelerator  (see crc.vhd)
+--		0xDC20 - 0xDC2F        Timer            (see timer.vhd)
+--		0xDC30 - 0xDC3F        Interrupts       (see intc.vhd)
+--		0xDC40 - 0xDC4F        Input events     (see input-event.vhd)
+--		0xDC50 - 0xDC8F        Serial channels  (see serial.vhd, one block for each of SERIAL_CHANNELS)
+--		0xDC90 - 0xDC9F        Mailbox          (see mbox.vhd, the only registers block seen by core 1)
+
+-------------------------------------------------------------------------------
+-- The 6502 chip mirrors out the input clock, in this design this is
+-- done in clockgenerator
+---
+--  - ph0 and ph1,ph2 could have a minimum delay (neglected)
+--  - ph1 and ph2 are inverted without delay
+--
+--		                    +------+
+--		 5MHz input ph0 -->	|      | ---> ph1
+--		                    | 6502 |
+--		                    |      | ---> ph2
+--		                    +------+
+--		         ___     ___     ___
+--		 ph0 ___|   |___|   |___|   |___
+--		         ___     ___     ___
+--		 ph1 ___|   |___|   |___|   |___
+--		     ___     ___     ___     ___
+--		 ph2    |___|   |___|   |___|
+
+-------------------------------------------------------------------------------
+-- Libraries
+
+library ieee;
+use ieee.std_logic_1164.all;
+use ieee.std_logic_unsigned.all;
+use ieee.numeric_std.all;
+use std.textio.all;
+use ieee.std_logic_textio.all;
+
+library b65;
+
+-------------------------------------------------------------------------------
+-- Package
+
+package PACK is
+
+	----------------------------------------------------------------------------
+	-- Constants
+
+	constant ROM_FILE		: string			:= "b65.rom";								-- rom filename
+	constant ROM_FILL		: std_logic_vector	:= x"FF";									-- rom fill value
+
+	constant MAP_START_RAM	: integer			:= conv_integer(x"0000");					-- start address     0 : RAM (private)
+	constant MAP_START_SHR	: integer			:= conv_integer(x"8000");					-- start address 32768 : RAM (shared)
+	constant MAP_START_REG	: integer			:= conv_integer(x"DC00");					-- start address 56320 : devices registers
+	constant MAP_START_ROM	: integer			:= conv_integer(x"E000");					-- start address 57344 : ROM (growing from 0xFFFF down to 0xE000)
+
+	constant MAP_START_EXT	: integer			:= conv_integer(x"DC00");					-- start address 56320 : I/O extension registers
+	constant MAP_START_CRC	: integer			:= conv_integer(x"DC10");					-- start address 56336 : CRC accelerator registers
+	constant MAP_START_TMR	: integer			:= conv_integer(x"DC20");					-- start address 56352 : Timer registers
+	constant MAP_START_INT	: integer			:= conv_integer(x"DC30");					-- start address 56368 : Interrupt controller registers
+	constant MAP_START_EVT	: integer			:= conv_integer(x"DC40");					-- start address 56384 : Input events registers
+	constant MAP_START_SER	: integer			:= conv_integer(x"DC50");					-- start address 56400 : Serial channels registers (16 for each channel)
+	constant MAP_START_MBX	: integer			:= conv_integer(x"DC90");					-- start address 56464 : Mailbox registers
+
+	constant MAP_SIZE_RAM	: integer			:= conv_integer(x"8000");					-- size  in bytes      : RAM (private)
+	constant MAP_SIZE_SHR	: integer			:= conv_integer(x"5C00");					-- size  in bytes      : RAM (shared)
+	constant MAP_SIZE_REG	: integer			:= conv_integer(x"0400");					-- size  in bytes      : devices registers
+	constant MAP_SIZE_ROM	: integer			:= conv_integer(x"2000");					-- size  in bytes      : ROM
+
+	----------------------------------------------------------------------------
+	-- Devices
+
+	constant SERIAL_CHANNELS	: integer		:= 2;										-- Additional UART channels (1 to 3, interrupt sources 4 to 6)
+	constant CPU_CORES			: integer		:= 2;										-- CPU cores (mailbox interrupt source 7 on core 0)
+
+	----------------------------------------------------------------------------
+	-- Data types
+
+	-- 7 segments (+ dot) LED display x 4 digits
+	--
+	--   --      --      --      --             a
+	--  |  |    |  |    |  |    |  |          f   b
+	--   --      --      --      --      ->     g
+	--  |  |    |  |    |  |    |  |          e   c 
+	--   --  .   --  .   --  .   --  .          d   .
+	--
+	--
+	--   0       1       2       3     -> array(0 to 3)
+	--
+	-- std_logic_vector(7 downto 0) is organized as '.gfedcba'
+	--                                               |
+	--                                           display dot bit 7
+	--
+	type LED7X4 is array(0 to 3) of std_logic_vector(7 downto 0);
+
+	-- Registers bus, one for each CPU core
+	type CORE_ADDRESS	is array(0 to CPU_CORES - 1) of std_logic_vector(3 downto 0);
+	type CORE_DATA		is array(0 to CPU_CORES - 1) of std_logic_vector(7 downto 0);
+
+	----------------------------------------------------------------------------
+	-- Procedures
+	
+	procedure Log(message : in string);
+
+	----------------------------------------------------------------------------
+	-- Components
+
+	component clock_manager is
+	generic	(
+				fast_sim				:			boolean				:= false			-- Simulation profile: one generator for both clocks
+			);
+	port	(
+				-- General
+				clk_in1					: in		std_logic;								-- Clock
+				reset					: in		std_logic;								-- reset
+				locked					: out		std_logic;								-- locked
+				
+				-- Generated clocks
+				clk_out1				: out		std_logic;								-- 50MHz FPGA
+				clk_out2				: out		std_logic								--  5MHz 6502 CPU ph0
+			);
+	end component;
+
+	component ram is
+	port	(
+				-- General
+				clka					: in		std_logic;								-- Clock
+				ena						: in		std_logic;								-- enable
+				rsta					: in		std_logic;								-- reset
+				rsta_busy				: out		std_logic;								-- busy
+
+				-- Read / Write interface
+				addra					: in		std_logic_vector(15	downto 0);			-- Ram write Address
+				wea						: in		std_logic_vector(0	downto 0);			-- Write enable
+				dina					: in		std_logic_vector( 7	downto 0);			-- Data IN
+				douta					: out		std_logic_vector( 7	downto 0)			-- Data OUT
+			);
+	end component;
+
+	component ram_code is
+	port	(
+				-- General
+				clka					: in		std_logic;								-- Clock
+				ena						: in		std_logic;								-- enable
+				rsta					: in		std_logic;								-- reset
+				rsta_busy				: out		std_logic;								-- busy
+
+				-- Read / Write interface
+				addra					: in		std_logic_vector(12	downto 0);			-- Ram write Address
+				wea						: in		std_logic_vector(0	downto 0);			-- Write enable
+				dina					: in		std_logic_vector( 7	downto 0);			-- Data IN
+				douta					: out		std_logic_vector( 7	downto 0)			-- Data OUT
+			);
+	end component;
+
+	component ram_shared is
+	port	(
+				-- General
+				clka					: in		std_logic;								-- Clock (both ports)
+
+				-- Port A
+				ena						: in		std_logic;								-- enable
+				addra					: in		std_logic_vector(14	downto 0);			-- Ram Address
+				wea						: in		std_logic_vector(0	downto 0);			-- Write enable
+				dina					: in		std_logic_vector( 7	downto 0);			-- Data IN
+				douta					: out		std_logic_vector( 7	downto 0);			-- Data OUT
+
+				-- Port B
+				enb						: in		std_logic;								-- enable
+				addrb					: in		std_logic_vector(14	downto 0);			-- Ram Address
+				web						: in		std_logic_vector(0	downto 0);			-- Write enable
+				dinb					: in		std_logic_vector( 7	downto 0);			-- Data IN
+				doutb					: out		std_logic_vector( 7	downto 0)			-- Data OUT
+			);
+	end component;
+
+	component ext is
+	generic	(
+				fast_sim				:			boolean				:= false			-- Simulation profile: outputs and digits without PWM (see below)
+			);
+	port	(
+				-- General
+				clock					: in		std_logic;								-- Clock
+				reset					: in		std_logic;								-- reset
+				enable					: in		std_logic;								-- block enable
+				enable_inputs			: in		std_logic;								-- enable inputs and Rx
+				trigger_input			: out		std_logic;								-- input change interrupt trigger
+				trigger_uart			: out		std_logic;								-- UART rx interrupt trigger
+				upgrade					: out		std_logic;								-- upgrade restart
+
+				-- Write interface
+				write_address			: in		std_logic_vector( 3	downto 0);			-- write Address
+				write_enable			: in		std_logic;								-- Write enable
+				write_data				: in		std_logic_vector( 7	downto 0);			-- Data IN
+
+				-- Read interface
+				read_address			: in		std_logic_vector( 3	downto 0);			-- read Address
+				read_data				: out		std_logic_vector( 7	downto 0);			-- Data OUT
+				
+				-- I/O
+				outputs					: out		std_logic_vector(15	downto 0);			-- Output wires
+				inputs					: in		std_logic_vector(23	downto 0);			-- Input  wires
+				digit					: out		LED7X4;									-- 4x 7-segments digits
+
+				-- UART
+				uart_busy				: in		std_logic;								-- UART busy
+				uart_rx_byte			: in		std_logic_vector(7 downto 0);			-- Received data
+				uart_rx_valid			: in		std_logic;								-- High if received data is valid
+				uart_tx_byte			: out		std_logic_vector(7 downto 0);			-- Byte to send
+				uart_tx_valid			: out		std_logic								-- High for one clock pulse to start transmission
+			);
+	end component;
+
+	component crc is
+	port	(
+				-- General
+				clock					: in		std_logic;								-- Clock
+				reset					: in		std_logic;								-- reset
+				enable					: in		std_logic;								-- block enable
+
+				-- Write interface
+				write_address			: in		std_logic_vector( 3	downto 0);			-- write Address
+				write_enable			: in		std_logic;								-- Write enable
+				write_data				: in		std_logic_vector( 7	downto 0);			-- Data IN
+
+				-- Read interface
+				read_address			: in		std_logic_vector( 3	downto 0);			-- read Address
+				read_data				: out		std_logic_vector( 7	downto 0);			-- Data OUT
+
+				-- Memory read interface
+				dma_request				: out		std_logic;								-- Memory read request
+				dma_grant				: in		std_logic;								-- Memory read granted (data is ready one clock later)
+				dma_address				: out		std_logic_vector(15	downto 0);			-- Memory read address
+				dma_data				: in		std_logic_vector( 7	downto 0)			-- Memory read data
+			);
+	end component;
+
+	component timer is
+	port	(
+				-- General
+				clock					: in		std_logic;								-- Clock
+				reset					: in		std_logic;								-- reset
+				enable					: in		std_logic;								-- block enable
+				trigger					: out		std_logic;								-- interrupt trigger
+
+				-- Write interface
+				write_address			: in		std_logic_vector( 3	downto 0);			-- write Address
+				write_enable			: in		std_logic;								-- Write enable
+				write_data				: in		std_logic_vector( 7	downto 0);			-- Data IN
+
+				-- Read interface
+				read_address			: in		std_logic_vector( 3	downto 0);			-- read Address
+				read_data				: out		std_logic_vector( 7	downto 0);			-- Data OUT
+
+				-- Free running counter
+				microseconds			: out		std_logic_vector(31	downto 0)			-- Microseconds from reset
+			);
+	end component;
+
+	component input_event is
+	port	(
+				-- General
+				clock					: in		std_logic;								-- Clock
+				reset					: in		std_logic;								-- reset
+				enable					: in		std_logic;								-- block enable
+				enable_inputs			: in		std_logic;								-- enable inputs
+				trigger					: out		std_logic;								-- interrupt trigger
+
+				-- Write interface
+				write_address			: in		std_logic_vector( 3	downto 0);			-- write Address
+				write_enable			: in		std_logic;								-- Write enable
+				write_data				: in		std_logic_vector( 7	downto 0);			-- Data IN
+
+				-- Read interface
+				read_address			: in		std_logic_vector( 3	downto 0);			-- read Address
+				read_data				: out		std_logic_vector( 7	downto 0);			-- Data OUT
+
+				-- Inputs
+				inputs					: in		std_logic_vector(23	downto 0);			-- Input wires
+				microseconds			: in		std_logic_vector(31	downto 0)			-- Timestamp
+			);
+	end component;
+
+	component intc is
+	port	(
+				-- General
+				clock					: in		std_logic;								-- Clock
+				reset					: in		std_logic;								-- reset
+				enable					: in		std_logic;								-- block enable
+				interrupt				: out		std_logic;								-- interrupt (active low)
+
+				-- Sources
+				sources					: in		std_logic_vector( 7	downto 0);			-- Interrupt triggers
+
+				-- Write interface
+				write_address			: in		std_logic_vector( 3	downto 0);			-- write Address
+				write_enable			: in		std_logic;								-- Write enable
+				write_data				: in		std_logic_vector( 7	downto 0);			-- Data IN
+
+				-- Read interface
+				read_address			: in		std_logic_vector( 3	downto 0);			-- read Address
+				read_data				: out		std_logic_vector( 7	downto 0)			-- Data OUT
+			);
+	end component;
+
+	component uart is
+	generic	(
+				clock_frequency			:			integer				:= 50000000;		-- clock frequency in hertz
+				baud_rate				:			integer				:= 921600;			-- desired baud rate
+				start_silence			:			integer				:= 32				-- Number of bytes to discard at start if line is not idle
+			);
+	port	(
+				-- General
+				clock					: in		std_logic;								-- Main clock (assumed to be 32 MHz)
+				reset					: in		std_logic;								-- Reset FSM
+				busy					: out		std_logic;								-- High if busy
+
+				-- Serial interface
+				uart_rx					: in		std_logic;								-- UART receive pin
+				uart_tx					: out		std_logic;								-- UART transmit pin
+				
+				-- incoming data
+				rx_byte					: out		std_logic_vector(7 downto 0);			-- Received data
+				rx_valid				: out		std_logic;								-- High if received_data is valid
+
+				-- outgoing data
+				tx_byte					: in		std_logic_vector(7 downto 0);			-- Byte to send to UART
+				tx_valid				: in		std_logic;								-- High for one clock pulse to start transmission
+
+				-- Run-time baud rate
+				baud_divisor			: in		std_logic_vector(15 downto 0)	:= x"0000"	-- Clocks per bit minus one (0 = use baud_rate generic)
+		);
+	end component;
+	
+	component serial is
+	port	(
+				-- General
+				clock					: in		std_logic;								-- Clock
+				reset					: in		std_logic;								-- reset
+				enable					: in		std_logic;								-- block enable
+				enable_inputs			: in		std_logic;								-- enable Rx
+				trigger					: out		std_logic;								-- interrupt trigger
+
+				-- Write interface
+				write_address			: in		std_logic_vector( 3	downto 0);			-- write Address
+				write_enable			: in		std_logic;								-- Write enable
+				write_data				: in		std_logic_vector( 7	downto 0);			-- Data IN
+
+				-- Read interface
+				read_address			: in		std_logic_vector( 3	downto 0);			-- read Address
+				read_data				: out		std_logic_vector( 7	downto 0);			-- Data OUT
+
+				-- Serial interface
+				uart_rx					: in		std_logic;								-- UART receive pin
+				uart_tx					: out		std_logic								-- UART transmit pin
+			);
+	end component;
+
+	component mbox is
+	port	(
+				-- General
+				clock					: in		std_logic;								-- Clock
+				reset					: in		std_logic;								-- reset
+				enable					: in		std_logic_vector(CPU_CORES - 1 downto 0);	-- block enable
+				trigger					: out		std_logic_vector(CPU_CORES - 1 downto 0);	-- interrupt trigger
+				interrupt				: out		std_logic_vector(CPU_CORES - 1 downto 0);	-- interrupt (active low)
+
+				-- Write interface
+				write_address			: in		CORE_ADDRESS;							-- write Address
+				write_enable			: in		std_logic_vector(CPU_CORES - 1 downto 0);	-- Write enable
+				write_data				: in		CORE_DATA;								-- Data IN
+
+				-- Read interface
+				read_address			: in		CORE_ADDRESS;							-- read Address
+				read_data				: out		CORE_DATA								-- Data OUT
+			);
+	end component;
+
+	component soft_dl is
+	port	(
+				-- General
+				clock					: in		std_logic;								-- Clock
+				reset					: in		std_logic;								-- reset
+				reset_cpu				: out		std_logic;								-- CPU reset
+				reset_devices			: out		std_logic;								-- CPU devices
+				led						: out		std_logic_vector(15 downto 0);			-- Led
+				upgrade					: in		std_logic;								-- upgrade restart
+
+				-- UART data receive
+				uart_rx_data			: in		std_logic_vector(7 downto 0);			-- UART received data
+				uart_rx_valid			: in		std_logic;								-- UART received data valid
+
+				-- Code ram write interface (bit 13 selects the core)
+				write_address			: out		std_logic_vector(13	downto 0);			-- write Address
+				write_enable			: out		std_logic_vector( 0 downto 0);			-- Write enable
+				write_data				: out		std_logic_vector( 7	downto 0)			-- Data IN
+			);
+	end component;
+
+	component debounce is
+	generic (
+				active_high				: 			std_logic			:= '1'				-- Button logic (active high = signal_in is high if button is pressed)
+			);
+	port	(
+				-- General
+				clock					: in		std_logic;								-- Clock
+				reset					: in		std_logic;								-- Reset
+
+				-- Signal input
+				signal_in				: in		std_logic;								-- Input signal
+
+				-- Signal output
+				button_down				: out		std_logic;								-- "button down" event (1CK on button event)
+				button_up				: out		std_logic								-- "button up" event   (1CK on button event)
+			);
+	end component;
+
+end PACK;
+
+package body PACK is
+
+	----------------------------------------------------------------------------
+	-- Procedures implementation
+	
+	procedure Log(message : in string) is
+		variable var_log	: line;	
+	begin
+		-- Insert timestamp
+		write(var_log, now, right, 12);
+		write(var_log, string'(": "));
+		
+		-- Insert user log message
+		write(var_log, message);
+
+		-- Write to output
+		writeline(output, var_log);
+	end Log;
+
+end PACK;
+
+-------------------------------------------------------------------------------
+-- EOF
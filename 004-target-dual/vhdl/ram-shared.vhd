@@ -0,0 +1,109 @@
+-- Copyright 2023 Luca Bertossi
+--
+-- This file is part of B65.
+-- 
+--     B65 is free software: you can redistribute it and/or modify
+--     it under the terms of the GNU General Public License as published by
+--     the Free Software Foundation, either version 3 of the License, or
+--     (at your option) any later version.
+-- 
+--     B65 is distributed in the hope that it will be useful,
+--     but WITHOUT ANY WARRANTY; without even the implied warranty of
+--     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+--     GNU General Public License for more details.
+-- 
+--     You should have received a copy of the GNU General Public License
+--     along with B65.  If not, see <http://www.gnu.org/licenses/>.
+
+----------------------------------------------------------------------------------
+-- Shared static RAM memory - true dual port, one port for each CPU core
+--
+-- Both ports can read and write in the same clock; if both write the same address port B
+-- wins, use the mailbox spinlocks (see mbox.vhd) to serialize the accesses to a shared data
+-- structure. Both ports run on the 50MHz clock, as the RAM and code ram of each core.
+--
+-- The memory is inferred (no reset) so it is mapped to a block RAM without an IP core.
+--
+
+-------------------------------------------------------------------------------
+-- Libraries
+
+library ieee;
+use ieee.std_logic_1164.all;
+use ieee.std_logic_unsigned.all;
+use ieee.numeric_std.all;
+
+library b65;
+use b65.PACK.all;
+
+-------------------------------------------------------------------------------
+-- Entity
+
+entity ram_shared is
+	port	(
+				-- General
+				clka					: in		std_logic;								-- Clock (both ports)
+
+				-- Port A
+				ena						: in		std_logic;								-- enable
+				addra					: in		std_logic_vector(14	downto 0);			-- Ram Address
+				wea						: in		std_logic_vector(0	downto 0);			-- Write enable
+				dina					: in		std_logic_vector( 7	downto 0);			-- Data IN
+				douta					: out		std_logic_vector( 7	downto 0);			-- Data OUT
+
+				-- Port B
+				enb						: in		std_logic;								-- enable
+				addrb					: in		std_logic_vector(14	downto 0);			-- Ram Address
+				web						: in		std_logic_vector(0	downto 0);			-- Write enable
+				dinb					: in		std_logic_vector( 7	downto 0);			-- Data IN
+				doutb					: out		std_logic_vector( 7	downto 0)			-- Data OUT
+			);
+end ram_shared;
+
+-------------------------------------------------------------------------------
+-- Architecture
+
+architecture behavioral of ram_shared is
+
+	----------------------------------------------------------------------------
+	-- Data types
+
+	-- Memory data
+	type RAM_MEMORY is array(0 to MAP_SIZE_SHR-1) of std_logic_vector(7 downto 0);
+
+	----------------------------------------------------------------------------
+	-- Signals
+
+	-- Memory
+	signal memory : RAM_MEMORY;
+
+begin
+
+	----------------------------------------------------------------------------
+	-- Processes
+
+	-- Memory read / write (port B is the last one, it wins on a write collision)
+	ram_ports  : process(clka) begin
+		if (clka'event and clka='1') then
+			-- Port A
+			if (ena = '1') and (conv_integer(addra) < MAP_SIZE_SHR) then
+				douta								<= memory(conv_integer(addra));
+				if (wea(0) = '1') then
+					memory(conv_integer(addra))		<= dina;
+				end if;
+			end if;
+
+			-- Port B
+			if (enb = '1') and (conv_integer(addrb) < MAP_SIZE_SHR) then
+				doutb								<= memory(conv_integer(addrb));
+				if (web(0) = '1') then
+					memory(conv_integer(addrb))		<= dinb;
+				end if;
+			end if;
+		end if; -- clock event
+	end process;
+
+end behavioral;
+
+-------------------------------------------------------------------------------
+-- EOF
@@ -0,0 +1,368 @@
+-- Copyright 2023 Luca Bertossi
+--
+-- This file is part of B65.
+-- 
+--     B65 is free software: you can redistribute it and/or modify
+--     it under the terms of the GNU General Public License as published by
+--     the Free Software Foundation, either version 3 of the License, or
+--     (at your option) any later version.
+-- 
+--     B65 is distributed in the hope that it will be useful,
+--     but WITHOUT ANY WARRANTY; without even the implied warranty of
+--     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+--     GNU General Public License for more details.
+-- 
+--     You should have received a copy of the GNU General Public License
+--     along with B65.  If not, see <http://www.gnu.org/licenses/>.
+
+----------------------------------------------------------------------------------
+-- Serial channel block (one additional UART with its own FIFOs)
+
+-- Registers map (default all to zero)
+--
+--	Reg[0] : [RW] Control
+--			bit[7:2] = unused
+--			bit[1]   = TX empty interrupt       (0=disable         , 1=enable)
+--			bit[0]   = RX interrupt             (0=disable         , 1=enable)
+--
+--	Reg[1] : [RW] Status
+--			bit[7]   = RX overflow (set when a received byte is lost because the RX fifo is full, write 1 to clear)
+--			bit[6:3] = unused
+--			bit[2]   = TX fifo full
+--			bit[1]   = TX idle (TX fifo empty and last byte sent)
+--			bit[0]   = RX data ready
+--
+--	Reg[2] : [RW] baud divisor [ 7: 0]
+--	Reg[3] : [RW] baud divisor [15: 8]      clocks per bit minus one (50MHz / baud - 1), 0 = 921600 baud
+--
+--	Reg[4] : [RO] number of characters in the RX fifo
+--	Reg[5] : [RO] free space in the TX fifo
+--	Reg[6] : [RO] RX character
+--	Reg[7] : [WO] TX character
+--
+--	Reg[8:F] : unused
+--
+-- The trigger output is high for one clock when a byte is received (RX interrupt enabled) or
+-- when the TX fifo becomes empty (TX empty interrupt enabled), see intc.vhd.
+-- Change the baud divisor only while the channel is idle.
+--
+
+-------------------------------------------------------------------------------
+-- Libraries
+
+library ieee;
+use ieee.std_logic_1164.all;
+use ieee.std_logic_unsigned.all;
+use ieee.numeric_std.all;
+
+library b65;
+use b65.PACK.all;
+
+-------------------------------------------------------------------------------
+-- Entity
+
+entity serial is
+	port	(
+				-- General
+				clock					: in		std_logic;								-- Clock
+				reset					: in		std_logic;								-- reset
+				enable					: in		std_logic;								-- block enable
+				enable_inputs			: in		std_logic;								-- enable Rx
+				trigger					: out		std_logic;								-- interrupt trigger (high for one clock)
+
+				-- Write interface
+				write_address			: in		std_logic_vector( 3	downto 0);			-- write Address
+				write_enable			: in		std_logic;								-- Write enable
+				write_data				: in		std_logic_vector( 7	downto 0);			-- Data IN
+
+				-- Read interface
+				read_address			: in		std_logic_vector( 3	downto 0);			-- read Address
+				read_data				: out		std_logic_vector( 7	downto 0);			-- Data OUT
+
+				-- Serial interface
+				uart_rx					: in		std_logic;								-- UART receive pin
+				uart_tx					: out		std_logic								-- UART transmit pin
+			);
+end serial;
+
+-------------------------------------------------------------------------------
+-- Architecture
+
+architecture behavioral of serial is
+
+	----------------------------------------------------------------------------
+	-- Constants
+
+	constant SERIAL_FIFO_DEPTH : integer := 32;
+
+	----------------------------------------------------------------------------
+	-- Data types
+
+	-- UART fifo
+	type SERIAL_FIFO	is array(0 to SERIAL_FIFO_DEPTH - 1) of std_logic_vector(7 downto 0);
+
+	----------------------------------------------------------------------------
+	-- Signals
+
+	-- Registers
+	signal reg_control				: std_logic_vector( 7 downto 0);
+	signal reg_divisor				: std_logic_vector(15 downto 0);
+
+	-- Read / Write
+	signal read_keep				: std_logic;	-- Keep the samme value to read_data while enable is high
+	signal write_once				: std_logic;	-- Write once a register             while enable is high
+
+	-- UART
+	signal uart_busy				: std_logic;
+	signal uart_rx_byte				: std_logic_vector(7 downto 0);
+	signal uart_rx_valid			: std_logic;
+	signal uart_tx_byte				: std_logic_vector(7 downto 0);
+	signal uart_tx_valid			: std_logic;
+
+	-- UART rx fifo
+	signal rx_write					: integer range 0 to SERIAL_FIFO_DEPTH - 1;
+	signal rx_read					: integer range 0 to SERIAL_FIFO_DEPTH - 1;
+	signal rx_count					: integer range 0 to SERIAL_FIFO_DEPTH;
+	signal rx_fifo					: SERIAL_FIFO;
+	signal rx_overflow				: std_logic;
+	signal rx_trigger				: std_logic;
+
+	-- UART tx fifo
+	signal tx_write					: integer range 0 to SERIAL_FIFO_DEPTH - 1;
+	signal tx_read					: integer range 0 to SERIAL_FIFO_DEPTH - 1;
+	signal tx_count					: integer range 0 to SERIAL_FIFO_DEPTH;
+	signal tx_fifo					: SERIAL_FIFO;
+	signal tx_idle					: std_logic;
+	signal tx_idle_last				: std_logic;
+	signal tx_trigger				: std_logic;
+
+begin
+
+	---------------------------------------------------------------------------
+	-- Hardwired
+
+	tx_idle			<= '1' when (tx_count = 0) and (uart_busy = '0') and (uart_tx_valid = '0') else '0';
+	trigger			<= rx_trigger or tx_trigger;
+
+	----------------------------------------------------------------------------
+	-- Components map
+
+	inst_uart : uart
+	port map	(
+					-- General
+					clock						=> clock,
+					reset						=> reset,
+					busy						=> uart_busy,
+
+					-- Serial interface
+					uart_rx						=> uart_rx,
+					uart_tx						=> uart_tx,
+
+					-- incoming data
+					rx_byte						=> uart_rx_byte,
+					rx_valid					=> uart_rx_valid,
+
+					-- outgoing data
+					tx_byte						=> uart_tx_byte,
+					tx_valid					=> uart_tx_valid,
+
+					-- Run-time baud rate
+					baud_divisor				=> reg_divisor
+				);
+
+	----------------------------------------------------------------------------
+	-- Processes
+
+	-- Register read and UART RX
+	serial_read  : process(clock)
+		variable push : boolean;
+		variable pop  : boolean;
+	begin
+		if (clock'event and clock='1') then
+			-- If reset
+			if (reset = '1') then
+				read_data						<= (others => '0');
+				read_keep						<= '0';
+				rx_write						<= 0;
+				rx_read							<= 0;
+				rx_count						<= 0;
+				rx_overflow						<= '0';
+				rx_trigger						<= '0';
+			else
+				rx_trigger						<= '0';
+				push							:= false;
+				pop								:= false;
+
+				-- Insert serializer received data into the rx fifo
+				if (enable_inputs = '1') and (uart_rx_valid = '1') then
+					if (rx_count = SERIAL_FIFO_DEPTH) then
+						rx_overflow				<= '1';
+					else
+						push					:= true;
+						rx_fifo(rx_write)		<= uart_rx_byte;
+						rx_trigger				<= reg_control(0);
+					end if;
+				end if;
+
+				-- Clear overflow (Reg[1] bit 7)
+				if (write_enable = '1') and (enable = '1') and (write_address = x"1") and (write_data(7) = '1') then
+					rx_overflow					<= '0';
+				end if;
+
+				-- Registers read
+				if (read_keep = '1') then
+
+					-- Prevent to modify read_data output while enable is high
+					if (enable = '0') then
+						read_keep				<= '0';
+					end if;
+
+				elsif (enable = '1') and (write_enable = '0') then
+
+					read_keep					<= '1';
+
+					case (read_address) is
+						when x"0"	=> read_data	<= reg_control;
+						when x"1"	=>
+							read_data			<= rx_overflow & "0000" & '0' & tx_idle & '0';
+							if (tx_count = SERIAL_FIFO_DEPTH) then
+								read_data(2)	<= '1';
+							end if;
+							if (rx_count /= 0) then
+								read_data(0)	<= '1';
+							end if;
+						when x"2"	=> read_data	<= reg_divisor( 7 downto 0);
+						when x"3"	=> read_data	<= reg_divisor(15 downto 8);
+						when x"4"	=> read_data	<= std_logic_vector(to_unsigned(rx_count, 8));
+						when x"5"	=> read_data	<= std_logic_vector(to_unsigned(SERIAL_FIFO_DEPTH - tx_count, 8));
+						when x"6"	=>
+							-- RX character
+							if (rx_count /= 0) then
+								read_data		<= rx_fifo(rx_read);
+								pop				:= true;
+							else
+								read_data		<= (others => '0');
+							end if;
+						when others	=> read_data	<= (others => '0');
+					end case;
+				end if;
+
+				-- RX fifo update
+				if (push) then
+					if (rx_write = SERIAL_FIFO_DEPTH - 1) then
+						rx_write				<= 0;
+					else
+						rx_write				<= rx_write + 1;
+					end if;
+				end if;
+
+				if (pop) then
+					if (rx_read = SERIAL_FIFO_DEPTH - 1) then
+						rx_read					<= 0;
+					else
+						rx_read					<= rx_read + 1;
+					end if;
+				end if;
+
+				if (push) and (not pop) then
+					rx_count					<= rx_count + 1;
+				elsif (pop) and (not push) then
+					rx_count					<= rx_count - 1;
+				end if;
+
+			end if; -- reset
+		end if; -- clock event
+	end process;
+
+	-- Register write and UART TX
+	serial_write  : process(clock)
+		variable push : boolean;
+		variable pop  : boolean;
+	begin
+		if (clock'event and clock='1') then
+			-- If reset
+			if (reset = '1') then
+				reg_control				<= (others => '0');
+				reg_divisor				<= (others => '0');
+				tx_write				<= 0;
+				tx_read					<= 0;
+				tx_count				<= 0;
+				tx_idle_last			<= '1';
+				tx_trigger				<= '0';
+				uart_tx_byte			<= (others => '0');
+				uart_tx_valid			<= '0';
+				write_once				<= '0';
+			else
+				uart_tx_valid			<= '0';
+				push					:= false;
+				pop						:= false;
+
+				-- TX empty interrupt
+				tx_idle_last			<= tx_idle;
+				tx_trigger				<= tx_idle and (not tx_idle_last) and reg_control(1);
+
+				-- Registers action
+				if (write_enable = '1') and (enable = '1') and (write_once = '0') then
+
+					-- synthesis translate_off
+					Log("INFO : serial Write REG[" & integer'image(conv_integer(write_address)) & "]->[" & integer'image(conv_integer(write_data)) & "]");
+					-- synthesis translate_on
+
+					case (write_address) is
+						when x"0"	=> reg_control					<= "000000" & write_data(1 downto 0);
+						when x"2"	=> reg_divisor( 7 downto 0)		<= write_data;
+						when x"3"	=> reg_divisor(15 downto 8)		<= write_data;
+						when x"7"	=>
+							-- TX character (dropped if the fifo is full)
+							if (tx_count /= SERIAL_FIFO_DEPTH) then
+								tx_fifo(tx_write)					<= write_data;
+								push								:= true;
+							end if;
+						when others	=> null;
+					end case;
+
+					write_once				<= '1';
+				end if;
+
+				if (enable = '0') then
+					write_once <= '0';
+				end if;
+
+				-- Send the next character
+				if (tx_count /= 0) and (uart_busy = '0') and (uart_tx_valid = '0') then
+					uart_tx_byte			<= tx_fifo(tx_read);
+					uart_tx_valid			<= '1';
+					pop						:= true;
+				end if;
+
+				-- TX fifo update
+				if (push) then
+					if (tx_write = SERIAL_FIFO_DEPTH - 1) then
+						tx_write			<= 0;
+					else
+						tx_write			<= tx_write + 1;
+					end if;
+				end if;
+
+				if (pop) then
+					if (tx_read = SERIAL_FIFO_DEPTH - 1) then
+						tx_read				<= 0;
+					else
+						tx_read				<= tx_read + 1;
+					end if;
+				end if;
+
+				if (push) and (not pop) then
+					tx_count				<= tx_count + 1;
+				elsif (pop) and (not push) then
+					tx_count				<= tx_count - 1;
+				end if;
+
+			end if; -- reset
+		end if; -- clock event
+	end process;
+
+end behavioral;
+
+-------------------------------------------------------------------------------
+-- EOF
@@ -0,0 +1,278 @@
+-- Copyright 2023 Luca Bertossi
+--
+-- This file is part of B65.
+-- 
+--     B65 is free software: you can redistribute it and/or modify
+--     it under the terms of the GNU General Public License as published by
+--     the Free Software Foundation, either version 3 of the License, or
+--     (at your option) any later version.
+-- 
+--     B65 is distributed in the hope that it will be useful,
+--     but WITHOUT ANY WARRANTY; without even the implied warranty of
+--     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+--     GNU General Public License for more details.
+-- 
+--     You should have received a copy of the GNU General Public License
+--     along with B65.  If not, see <http://www.gnu.org/licenses/>.
+
+----------------------------------------------------------------------------------
+-- Timer block
+
+-- Registers map (default all to zero)
+--
+--	Reg[0] : [RW] Control
+--			bit[7] = unused
+--			bit[6] = unused
+--			bit[5] = unused
+--			bit[4] = unused
+--			bit[3] = unused
+--			bit[2] = interrupt              (0=disable         , 1=enable)
+--			bit[1] = mode                   (0=one-shot        , 1=periodic)
+--			bit[0] = run                    (0=stop            , 1=run, cleared at expiration in one-shot mode)
+--
+--	Reg[1] : [RW] Status
+--			bit[0] = expired (set at counter expiration, write 1 to clear)
+--
+--	Reg[2] : [RW] prescaler [ 7: 0]
+--	Reg[3] : [RW] prescaler [15: 8]         tick frequency is 50MHz / (prescaler + 1)
+--
+--	Reg[4] : [RW] reload    [ 7: 0]
+--	Reg[5] : [RW] reload    [15: 8]         period is (reload + 1) ticks
+--
+--	Reg[6] : [RO] counter   [ 7: 0]         reading Reg[6] latches Reg[7]
+--	Reg[7] : [RO] counter   [15: 8]
+--
+--	Reg[8] : [RO] free running microseconds counter [ 7: 0]     reading Reg[8] latches Reg[9:B]
+--	Reg[9] : [RO] free running microseconds counter [15: 8]
+--	Reg[A] : [RO] free running microseconds counter [23:16]
+--	Reg[B] : [RO] free running microseconds counter [31:24]
+--
+--	Reg[C] : unused
+--	Reg[D] : unused
+--	Reg[E] : unused
+--	Reg[F] : unused
+--
+-- Writing Reg[0] with run bit set (re)loads the counter with the reload value and restarts the prescaler.
+-- If the interrupt is enabled, the trigger output is high for one clock at every expiration (see intc.vhd).
+--
+
+-------------------------------------------------------------------------------
+-- Libraries
+
+library ieee;
+use ieee.std_logic_1164.all;
+use ieee.std_logic_unsigned.all;
+use ieee.numeric_std.all;
+
+library b65;
+use b65.PACK.all;
+
+-------------------------------------------------------------------------------
+-- Entity
+
+entity timer is
+	port	(
+				-- General
+				clock					: in		std_logic;								-- Clock
+				reset					: in		std_logic;								-- reset
+				enable					: in		std_logic;								-- block enable
+				trigger					: out		std_logic;								-- interrupt trigger (high for one clock)
+
+				-- Write interface
+				write_address			: in		std_logic_vector( 3	downto 0);			-- write Address
+				write_enable			: in		std_logic;								-- Write enable
+				write_data				: in		std_logic_vector( 7	downto 0);			-- Data IN
+
+				-- Read interface
+				read_address			: in		std_logic_vector( 3	downto 0);			-- read Address
+				read_data				: out		std_logic_vector( 7	downto 0);			-- Data OUT
+
+				-- Free running counter
+				microseconds			: out		std_logic_vector(31	downto 0)			-- Microseconds from reset
+			);
+end timer;
+
+-------------------------------------------------------------------------------
+-- Architecture
+
+architecture behavioral of timer is
+
+	----------------------------------------------------------------------------
+	-- Constants
+
+	constant MICROSECOND			: integer := 49;	-- 50MHz clocks in one microsecond (minus one)
+
+	----------------------------------------------------------------------------
+	-- Data types
+
+	-- Memory data
+	type REGISTERS	is array(0 to  15) of std_logic_vector(7 downto 0);
+
+	----------------------------------------------------------------------------
+	-- Signals
+
+	-- Registers memory
+	signal reg						: REGISTERS;
+
+	-- Read / Write
+	signal read_keep				: std_logic;	-- Keep the samme value to read_data while enable is high
+	signal write_once				: std_logic;	-- Write once a register             while enable is high
+
+	-- Timer
+	signal timer_prescaler			: std_logic_vector(15 downto 0);
+	signal timer_counter			: std_logic_vector(15 downto 0);
+	signal timer_latch				: std_logic_vector( 7 downto 0);
+
+	-- Free running counter
+	signal free_prescaler			: integer range 0 to MICROSECOND;
+	signal free_counter				: std_logic_vector(31 downto 0);
+	signal free_latch				: std_logic_vector(23 downto 0);
+
+begin
+
+	---------------------------------------------------------------------------
+	-- Hardwired
+
+	microseconds	<= free_counter;
+
+	----------------------------------------------------------------------------
+	-- Processes
+
+	-- Register read
+	timer_read  : process(clock) begin
+		if (clock'event and clock='1') then
+			-- If reset
+			if (reset = '1') then
+				read_data						<= (others => '0');
+				read_keep						<= '0';
+				timer_latch						<= (others => '0');
+				free_latch						<= (others => '0');
+			elsif (read_keep = '1') then
+
+				-- Prevent to modify read_data output while enable is high
+				if (enable = '0') then
+					read_keep					<= '0';
+				end if;
+
+			elsif (enable = '1') and (read_keep = '0') and (write_enable = '0') then
+
+				read_keep						<= '1';
+
+				case (read_address) is
+					when x"6"	=>
+						read_data				<= timer_counter( 7 downto 0);
+						timer_latch				<= timer_counter(15 downto 8);
+					when x"7"	=> read_data	<= timer_latch;
+					when x"8"	=>
+						read_data				<= free_counter( 7 downto 0);
+						free_latch				<= free_counter(31 downto 8);
+					when x"9"	=> read_data	<= free_latch( 7 downto  0);
+					when x"A"	=> read_data	<= free_latch(15 downto  8);
+					when x"B"	=> read_data	<= free_latch(23 downto 16);
+					when others	=> read_data	<= reg(conv_integer(read_address));
+				end case;
+			end if; -- reset
+		end if; -- clock event
+	end process;
+
+	-- Register write and timer
+	timer_write  : process(clock) begin
+		if (clock'event and clock='1') then
+			-- If reset
+			if (reset = '1') then
+				-- Reset
+				for address in 0 to 15 loop
+					reg(address)	<= (others => '0');
+				end loop;
+
+				timer_prescaler		<= (others => '0');
+				timer_counter		<= (others => '0');
+				trigger				<= '0';
+				write_once			<= '0';
+			else
+				trigger					<= '0';
+
+				-- Timer
+				if (reg(0)(0) = '1') then
+					if (timer_prescaler = reg(3) & reg(2)) then
+						timer_prescaler			<= (others => '0');
+
+						if (timer_counter = x"0000") then
+							-- Expired
+							reg(1)(0)			<= '1';
+							trigger				<= reg(0)(2);
+							timer_counter		<= reg(5) & reg(4);
+
+							-- One-shot stops at expiration
+							if (reg(0)(1) = '0') then
+								reg(0)(0)		<= '0';
+							end if;
+						else
+							timer_counter		<= timer_counter - 1;
+						end if;
+					else
+						timer_prescaler			<= timer_prescaler + 1;
+					end if;
+				end if;
+
+				-- Registers action
+				if (write_enable = '1') and (enable = '1') and (write_once = '0') then
+
+					-- synthesis translate_off
+					Log("INFO : timer Write REG[" & integer'image(conv_integer(write_address)) & "]->[" & integer'image(conv_integer(write_data)) & "]");
+					-- synthesis translate_on
+
+					case (write_address) is
+						when x"0"	=>													-- Reg[0] : [RW] Control
+							reg(0)				<= "00000" & write_data(2 downto 0);
+
+							-- (re)start
+							if (write_data(0) = '1') then
+								timer_prescaler	<= (others => '0');
+								timer_counter	<= reg(5) & reg(4);
+							end if;
+
+						when x"1"	=>													-- Reg[1] : [RW] Status (write 1 to clear)
+							if (write_data(0) = '1') then
+								reg(1)(0)		<= '0';
+							end if;
+
+						when x"2" | x"3" | x"4" | x"5" =>
+							reg(conv_integer(write_address))	<= write_data;
+
+						when others	=> null;
+					end case;
+
+					write_once					<= '1';
+				end if;
+
+				if (enable = '0') then
+					write_once <= '0';
+				end if;
+
+			end if; -- reset
+		end if; -- clock event
+	end process;
+
+	-- Free running microseconds counter
+	free_running : process(clock) begin
+		if (clock'event and clock='1') then
+			-- If reset
+			if (reset = '1') then
+				free_prescaler			<= 0;
+				free_counter			<= (others => '0');
+			else
+				if (free_prescaler = MICROSECOND) then
+					free_prescaler		<= 0;
+					free_counter		<= free_counter + 1;
+				else
+					free_prescaler		<= free_prescaler + 1;
+				end if;
+			end if; -- reset
+		end if; -- clock event
+	end process;
+
+end behavioral;
+
+-------------------------------------------------------------------------------
+-- EOF
@@ -0,0 +1,1063 @@
+-- Copyright 2023 Luca Bertossi
+--
+-- This file is part of B65.
+-- 
+--     B65 is free software: you can redistribute it and/or modify
+--     it under the terms of the GNU General Public License as published by
+--     the Free Software Foundation, either version 3 of the License, or
+--     (at your option) any later version.
+-- 
+--     B65 is distributed in the hope that it will be useful,
+--     but WITHOUT ANY WARRANTY; without even the implied warranty of
+--     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+--     GNU General Public License for more details.
+-- 
+--     You should have received a copy of the GNU General Public License
+--     along with B65.  If not, see <http://www.gnu.org/licenses/>.
+
+-------------------------------------------------------------------------------
+-- 6502 board top - two CPU cores
+--
+-- Core 0 owns all the devices, core 1 sees only the mailbox registers (see mbox.vhd).
+-- Each core has its own RAM (zero page and stacks included) and code ram, the shared
+-- RAM is a true dual port memory (see ram-shared.vhd and pack.vhd memory map).
+
+-------------------------------------------------------------------------------
+-- Libraries
+
+library ieee;
+use ieee.std_logic_1164.all;
+use ieee.std_logic_unsigned.all;
+use ieee.numeric_std.all;
+use std.textio.all;
+use ieee.std_logic_textio.all;
+
+library r65c02_tc;
+use r65c02_tc.all;
+
+library b65;
+use b65.PACK.all;
+
+-------------------------------------------------------------------------------
+-- Entity
+
+entity top is
+generic	(
+			fast_sim				:			boolean				:= false				-- Simulation profile: no PWM and display multiplexing (see extension.vhd)
+		);
+port	(
+			-- General
+			clock					: in		std_logic;								-- Clock
+			reset					: in		std_logic;								-- reset
+
+			-- Interface
+			led						: out		std_logic_vector(15 downto 0);			-- Output leds
+			slide					: in		std_logic_vector(15 downto 0);			-- Input slides
+			push					: in		std_logic_vector( 3 downto 0);			-- Input push buttons
+
+			-- 4x 7segments digits
+			anode					: out		std_logic_vector(3 downto 0);			-- Anode  7 segments driver
+			cathode					: out		std_logic_vector(7 downto 0);			-- Cathod 7 segments driver (DOT,G,F,E,D,C,B,A)
+
+			-- UART
+			uart_rx					: in		std_logic;								-- UART receive
+			uart_tx					: out		std_logic;								-- UART transmit
+
+			-- Serial channels (Pmod)
+			serial_rx				: in		std_logic_vector(SERIAL_CHANNELS - 1 downto 0);	-- Serial channels receive
+			serial_tx				: out		std_logic_vector(SERIAL_CHANNELS - 1 downto 0)	-- Serial channels transmit
+		);
+end top;
+
+-------------------------------------------------------------------------------
+-- Architecture
+
+architecture behavioral of top is
+
+	----------------------------------------------------------------------------
+	-- Signals
+
+	-- Clock
+	signal clock_50M			: std_logic;								-- System clock @ 50MHz
+	signal clock_5M				: std_logic;								-- CPU    clock @  5MHz
+
+	-- General
+	signal locked				: std_logic;
+	signal locked_delay			: std_logic_vector ( 7 downto 0);
+	signal reset_clock			: std_logic							:= '1';
+	signal reset_system			: std_logic							:= '1';	-- Reset
+	signal reset_devices		: std_logic							:= '1';	-- Reset devices (extension(s))
+	signal reset_cpu			: std_logic							:= '0';	-- Reset (CPU only)
+
+	-- debounce
+	signal push_debounce_up		: std_logic_vector( 3 downto 0);			-- Input push buttons debounce up   event
+	signal push_debounce_down	: std_logic_vector( 3 downto 0);			-- Input push buttons debounce down event
+
+	signal upgrade				: std_logic							:= '0';	-- upgrade restart
+
+	-- Ram
+	signal ram_enable			: std_logic;
+	signal ram_read_data		: std_logic_vector ( 7 downto 0);
+	signal ram_write_data		: std_logic_vector ( 7 downto 0);
+	signal ram_write_enable		: std_logic_vector ( 0 downto 0);
+	signal ram_address			: std_logic_vector (15 downto 0);
+
+	-- Ram (core 1)
+	signal ram1_enable			: std_logic;
+	signal ram1_read_data		: std_logic_vector ( 7 downto 0);
+	signal ram1_write_data		: std_logic_vector ( 7 downto 0);
+	signal ram1_write_enable	: std_logic_vector ( 0 downto 0);
+	signal ram1_address			: std_logic_vector (15 downto 0);
+
+	-- Shared ram (port A is core 0, port B is core 1)
+	signal shr_enable			: std_logic;
+	signal shr_read_data		: std_logic_vector ( 7 downto 0);
+	signal shr_write_data		: std_logic_vector ( 7 downto 0);
+	signal shr_write_enable		: std_logic_vector ( 0 downto 0);
+	signal shr_address			: std_logic_vector (14 downto 0);
+	signal shr_base				: std_logic_vector (15 downto 0);
+	signal shr_dma				: std_logic_vector (15 downto 0);
+	signal shr1_enable			: std_logic;
+	signal shr1_read_data		: std_logic_vector ( 7 downto 0);
+	signal shr1_write_data		: std_logic_vector ( 7 downto 0);
+	signal shr1_write_enable	: std_logic_vector ( 0 downto 0);
+	signal shr1_address			: std_logic_vector (14 downto 0);
+	signal shr1_base			: std_logic_vector (15 downto 0);
+
+	-- Rom
+	signal rom_enable			: std_logic;
+	signal rom_enable_cpu		: std_logic;
+	signal rom_data				: std_logic_vector ( 7 downto 0);
+	signal rom_base				: std_logic_vector (15 downto 0);
+	signal rom_address			: std_logic_vector (12 downto 0);
+	signal rom_address_cpu		: std_logic_vector (12 downto 0);
+	signal rom_address_soft_dl	: std_logic_vector (13 downto 0)	:= (others => '0');
+	signal rom_write_soft_dl	: std_logic_vector ( 0 downto 0)	:= (others => '0');
+	signal rom_write_data		: std_logic_vector ( 7 downto 0)	:= (others => '0');
+	signal rom_write_enable		: std_logic_vector ( 0 downto 0)	:= (others => '0');
+
+	-- Rom (core 1)
+	signal rom1_enable			: std_logic;
+	signal rom1_enable_cpu		: std_logic;
+	signal rom1_data			: std_logic_vector ( 7 downto 0);
+	signal rom1_base			: std_logic_vector (15 downto 0);
+	signal rom1_address			: std_logic_vector (12 downto 0);
+	signal rom1_address_cpu		: std_logic_vector (12 downto 0);
+	signal rom1_write_enable	: std_logic_vector ( 0 downto 0)	:= (others => '0');
+
+	-- I/O Extension
+	signal ext_enable			: std_logic;
+	signal ext_read_data		: std_logic_vector ( 7 downto 0);
+	signal ext_write_data		: std_logic_vector ( 7 downto 0);
+	signal ext_write_enable		: std_logic;
+	signal ext_address			: std_logic_vector ( 3 downto 0);
+	signal ext_base				: std_logic_vector (15 downto 0);
+	signal ext_digit			: LED7X4;
+
+	-- CRC accelerator
+	signal crc_enable			: std_logic;
+	signal crc_read_data		: std_logic_vector ( 7 downto 0);
+	signal crc_write_data		: std_logic_vector ( 7 downto 0);
+	signal crc_write_enable		: std_logic;
+	signal crc_address			: std_logic_vector ( 3 downto 0);
+	signal crc_base				: std_logic_vector (15 downto 0);
+	signal crc_dma_request		: std_logic;
+	signal crc_dma_grant		: std_logic;
+	signal crc_dma_address		: std_logic_vector (15 downto 0);
+	signal crc_dma_rom			: std_logic_vector (15 downto 0);
+	signal crc_dma_data			: std_logic_vector ( 7 downto 0);
+
+	-- Timer
+	signal tmr_enable			: std_logic;
+	signal tmr_read_data		: std_logic_vector ( 7 downto 0);
+	signal tmr_write_data		: std_logic_vector ( 7 downto 0);
+	signal tmr_write_enable		: std_logic;
+	signal tmr_address			: std_logic_vector ( 3 downto 0);
+	signal tmr_base				: std_logic_vector (15 downto 0);
+
+	-- Input events
+	signal evt_enable			: std_logic;
+	signal evt_read_data		: std_logic_vector ( 7 downto 0);
+	signal evt_write_data		: std_logic_vector ( 7 downto 0);
+	signal evt_write_enable		: std_logic;
+	signal evt_address			: std_logic_vector ( 3 downto 0);
+	signal evt_base				: std_logic_vector (15 downto 0);
+	signal evt_inputs			: std_logic_vector (23 downto 0);
+	signal tmr_microseconds		: std_logic_vector (31 downto 0);
+
+	-- Serial channels
+	type SERIAL_DATA is array(0 to SERIAL_CHANNELS - 1) of std_logic_vector(7 downto 0);
+
+	signal ser_enable			: std_logic_vector (SERIAL_CHANNELS - 1 downto 0);
+	signal ser_read_data		: SERIAL_DATA;
+	signal ser_write_data		: std_logic_vector ( 7 downto 0);
+	signal ser_write_enable		: std_logic;
+	signal ser_address			: std_logic_vector ( 3 downto 0);
+	signal ser_base				: std_logic_vector (15 downto 0);
+	signal ser_trigger			: std_logic_vector (SERIAL_CHANNELS - 1 downto 0);
+
+	-- Mailbox (index is the core)
+	signal mbx_enable			: std_logic_vector (CPU_CORES - 1 downto 0);
+	signal mbx_read_data		: CORE_DATA;
+	signal mbx_write_data		: CORE_DATA;
+	signal mbx_write_enable		: std_logic_vector (CPU_CORES - 1 downto 0);
+	signal mbx_address			: CORE_ADDRESS;
+	signal mbx_base				: std_logic_vector (15 downto 0);
+	signal mbx1_base			: std_logic_vector (15 downto 0);
+	signal mbx_trigger			: std_logic_vector (CPU_CORES - 1 downto 0);
+	signal mbx_interrupt		: std_logic_vector (CPU_CORES - 1 downto 0);
+
+	-- Interrupt controller
+	signal int_enable			: std_logic;
+	signal int_read_data		: std_logic_vector ( 7 downto 0);
+	signal int_write_data		: std_logic_vector ( 7 downto 0);
+	signal int_write_enable		: std_logic;
+	signal int_address			: std_logic_vector ( 3 downto 0);
+	signal int_base				: std_logic_vector (15 downto 0);
+	signal int_sources			: std_logic_vector ( 7 downto 0);
+
+	-- Interrupt triggers
+	signal ext_trigger_input	: std_logic;
+	signal ext_trigger_uart		: std_logic;
+	signal tmr_trigger			: std_logic;
+	signal evt_trigger			: std_logic;
+
+	-- 6502 CPU
+	signal cpu_address			: std_logic_vector (15 downto 0);
+	signal cpu_data_in			: std_logic_vector ( 7 downto 0);
+	signal cpu_data_out			: std_logic_vector ( 7 downto 0);
+	signal cpu_write_enable		: std_logic;
+	signal cpu_irq				: std_logic;
+	signal cpu_sync				: std_logic;
+	signal cpu_data_core		: std_logic_vector ( 7 downto 0);			-- data in of the core (WAI replaced by NOP)
+	signal cpu_wai				: std_logic;								-- CPU stopped by WAI until the IRQ line goes low
+	signal cpu_ready			: std_logic;
+
+	-- 6502 CPU (core 1)
+	signal cpu1_address			: std_logic_vector (15 downto 0);
+	signal cpu1_data_in			: std_logic_vector ( 7 downto 0);
+	signal cpu1_data_out		: std_logic_vector ( 7 downto 0);
+	signal cpu1_write_enable	: std_logic;
+
+	-- 7 segments driver
+	signal digit_delay			: std_logic_vector(23 downto 0);
+	signal digit_select			: std_logic_vector( 3 downto 0);
+	signal digit_select_id		: integer range 0 to 3;
+	
+	-- UART serializer component
+	signal uart_busy			: std_logic;
+	signal uart_rx_byte			: std_logic_vector(7 downto 0);
+	signal uart_rx_valid		: std_logic;
+	signal uart_tx_byte			: std_logic_vector(7 downto 0);
+	signal uart_tx_valid		: std_logic;
+
+	-- Led (muxed between ext and soft-dl)
+	signal led_ext				: std_logic_vector(15 downto 0);
+	signal led_soft_dl			: std_logic_vector(15 downto 0);
+
+	----------------------------------------------------------------------------
+	-- Components
+
+	component core is
+	port	(
+				clk_clk_i				: in		std_logic ;
+				d_i						: in		std_logic_vector( 7 downto 0);
+				irq_n_i					: in		std_logic ;
+				nmi_n_i					: in		std_logic ;
+				rdy_i					: in		std_logic ;
+				rst_rst_n_i 			: in		std_logic ;
+				so_n_i					: in		std_logic ;
+				a_o						: out		std_logic_vector(15 downto 0);
+				d_o						: out		std_logic_vector( 7 downto 0);
+				rd_o					: out		std_logic ;
+				sync_o					: out		std_logic ;
+				wr_n_o					: out		std_logic ;
+				wr_o					: out		std_logic 
+			);
+	end component;
+ 
+begin
+	---------------------------------------------------------------------------
+	-- Hardwired
+
+--  ram_base			<= it's cpu_address;
+	ext_base			<= cpu_address - MAP_START_EXT;
+	crc_base			<= cpu_address - MAP_START_CRC;
+	tmr_base			<= cpu_address - MAP_START_TMR;
+	int_base			<= cpu_address - MAP_START_INT;
+	evt_base			<= cpu_address - MAP_START_EVT;
+	ser_base			<= cpu_address - MAP_START_SER;
+	mbx_base			<= cpu_address - MAP_START_MBX;
+	shr_base			<= cpu_address - MAP_START_SHR;
+	rom_base			<= cpu_address - MAP_START_ROM;
+	crc_dma_rom			<= crc_dma_address - MAP_START_ROM;
+	shr_dma				<= crc_dma_address - MAP_START_SHR;
+
+	-- Core 1
+	mbx1_base			<= cpu1_address - MAP_START_MBX;
+	shr1_base			<= cpu1_address - MAP_START_SHR;
+	rom1_base			<= cpu1_address - MAP_START_ROM;
+
+	-- CRC memory transfer reads the code ram, the shared RAM or the RAM of core 0
+	crc_dma_data		<= rom_data				when (conv_integer(crc_dma_address) >= MAP_START_ROM) else
+						   shr_read_data		when (conv_integer(crc_dma_address) >= MAP_START_SHR) else ram_read_data;
+
+	-- Mux selecting CPU or soft-dl blocks (the downloaded image is core 0 code followed by core 1 code)
+	rom_address			<= rom_address_soft_dl(12 downto 0)	when (reset_cpu = '0') else rom_address_cpu;
+	rom_enable			<= '1'					when (reset_cpu = '0') else rom_enable_cpu;
+	rom1_address		<= rom_address_soft_dl(12 downto 0)	when (reset_cpu = '0') else rom1_address_cpu;
+	rom1_enable			<= '1'					when (reset_cpu = '0') else rom1_enable_cpu;
+
+	rom_write_enable(0)		<= rom_write_soft_dl(0) and (not rom_address_soft_dl(13));
+	rom1_write_enable(0)	<= rom_write_soft_dl(0) and rom_address_soft_dl(13);
+
+	led					<= led_soft_dl			when (reset_cpu = '0') else led_ext;
+
+	-- Interrupt sources by priority (see intc.vhd)
+	int_sources(3 downto 0)	<= evt_trigger & tmr_trigger & ext_trigger_input & ext_trigger_uart;
+
+	gen_serial_sources : for channel in 0 to 2 generate
+		gen_used : if (channel < SERIAL_CHANNELS) generate
+			int_sources(4 + channel)	<= ser_trigger(channel);
+		end generate;
+		gen_unused : if (channel >= SERIAL_CHANNELS) generate
+			int_sources(4 + channel)	<= '0';
+		end generate;
+	end generate;
+
+	int_sources(7)		<= mbx_trigger(0);
+
+	-- Board inputs (buttons and slides)
+	evt_inputs			<= "0000" & push_debounce_up & slide;
+	
+	-- reset the clock manager only if there is pressed push(0) too (reset is not debounced)
+	--
+	-- On basys3 : reset is the center (c) button and push(0) is the left (l) one:
+	--         __                  _______________           _____________                 _________                            ___
+	--  l ----|   \  reset_clock  |               | locked  |   _         | reset_system  |         | --> reset_cpu           _|
+	--        |    |------------->| clock_manager |-------->| _^   delay  |-------------->| soft_dl |                         _
+	--  c --+-|__ /               |_______________|         |_____________|               |_________| --> reset_devices (ex)   |___
+	--      |                                                        ^
+	--      |________________________________________________________|
+	--
+	-- Suggested sequence is:
+	--   - press reset (c) to reset the design
+	--   - if it's not sufficient (never happened to me) it means the clock_manager could be faulty
+	--   - keeping reset (c) pressed, press also the left button (l)
+	--   - release the left button only (l) to restart the clock_manager
+	--   - release the reset button (c) to restart the design
+	--
+	reset_clock			<= reset and push(0);
+
+	----------------------------------------------------------------------------
+	-- Components map
+
+	-- CPU is clocked at 5MHz because the FPGA cannot generate lower frequencies clocks
+
+	inst_clock_manager : clock_manager
+	generic map	(
+					fast_sim					=> fast_sim
+				)
+	port map	(
+					-- General
+					clk_in1						=> clock,				-- Input clock
+					reset						=> reset_clock,
+					locked						=> locked,
+
+					-- Generated clocks
+					clk_out1					=> clock_50M,			-- fpga 50MHz clock
+					clk_out2					=> clock_5M				-- CPU 6502 (6502 chip pin 37) input clock (5MHz)
+				);
+
+	inst_core6502 : core
+	port map	(
+					 clk_clk_i					=> clock_5M,
+					 d_i						=> cpu_data_core,		-- data in                    input
+					 irq_n_i					=> cpu_irq,				-- interrupt                  input (active low)
+					 nmi_n_i					=> '1',					-- non maskable interrupt     input (active low)
+					 rdy_i						=> cpu_ready,			-- ready                      input
+					 rst_rst_n_i				=> reset_cpu,			-- reset                      input (active low)
+					 so_n_i						=> '1',					-- set overflow               input (active low)
+
+					 a_o						=> cpu_address,			-- address                    output
+					 d_o						=> cpu_data_out,		-- data out                   output
+					 rd_o						=> open,
+					 sync_o						=> cpu_sync,			-- high during ph1 (op fetch) output
+					 wr_n_o						=> open,
+					 wr_o						=> cpu_write_enable		-- write enable               output
+				);
+
+	-- Core 1 : same clock and reset, its interrupt is driven by the mailbox only
+	inst_core6502_1 : core
+	port map	(
+					 clk_clk_i					=> clock_5M,
+					 d_i						=> cpu1_data_in,		-- data in                    input
+					 irq_n_i					=> mbx_interrupt(1),	-- interrupt                  input (active low)
+					 nmi_n_i					=> '1',					-- non maskable interrupt     input (active low)
+					 rdy_i						=> '1',					-- ready                      input
+					 rst_rst_n_i				=> reset_cpu,			-- reset                      input (active low)
+					 so_n_i						=> '1',					-- set overflow               input (active low)
+
+					 a_o						=> cpu1_address,		-- address                    output
+					 d_o						=> cpu1_data_out,		-- data out                   output
+					 rd_o						=> open,
+					 sync_o						=> open,				-- high during ph1 (op fetch) output
+					 wr_n_o						=> open,
+					 wr_o						=> cpu1_write_enable	-- write enable               output
+				);
+
+	-- RAM and ROM are synchronous @50MHz vs CPU at @5MHz: it's like having asynchronous devices as in retro boards
+	--                      ___     ___     ___     ___     ___     ___     ___     ___     ___     ___     __
+	--  50MHz          ____|   |___|   |___|   |___|   |___|   |___|   |___|   |___|   |___|   |___|   |___|
+	--                      _______________________________________                                         __
+	--   5MHz          ____|                                       |_______________________________________|
+	--                      __________________________________________________________________________________
+	--  CPU address    ____/ VALID address out
+	--                     \__________________________________________________________________________________
+	--                              __________________________________________________________________________
+	--  Device enable  ____________|
+	--                              __________________________________________________________________________
+	--  Device address ____________/ VALID address to the device (RAM/ROM) input
+	--                             \__________________________________________________________________________
+	--                                      __________________________________________________________________
+	--  Data           ____________________/ VALID data
+	--                                     \__________________________________________________________________
+	--                 
+	--                     |<---- Ta ----->|
+	--
+	-- Ta (Access time) is the equivalent asynchronous device access time, in this case it's 40ns (2 clock pulses at 50MHz)
+
+	inst_ram : ram
+	port map	(
+					-- General
+					clka						=> clock_50M,
+					ena							=> ram_enable,
+					rsta						=> reset_system,
+					rsta_busy					=> open,
+
+					-- Read / Write interface
+					addra						=> ram_address,
+					wea							=> ram_write_enable,
+					dina						=> ram_write_data,
+					douta						=> ram_read_data
+				);
+
+	inst_ram1 : ram
+	port map	(
+					-- General
+					clka						=> clock_50M,
+					ena							=> ram1_enable,
+					rsta						=> reset_system,
+					rsta_busy					=> open,
+
+					-- Read / Write interface
+					addra						=> ram1_address,
+					wea							=> ram1_write_enable,
+					dina						=> ram1_write_data,
+					douta						=> ram1_read_data
+				);
+
+	inst_ram_shared : ram_shared
+	port map	(
+					-- General
+					clka						=> clock_50M,
+
+					-- Port A (core 0)
+					ena							=> shr_enable,
+					addra						=> shr_address,
+					wea							=> shr_write_enable,
+					dina						=> shr_write_data,
+					douta						=> shr_read_data,
+
+					-- Port B (core 1)
+					enb							=> shr1_enable,
+					addrb						=> shr1_address,
+					web							=> shr1_write_enable,
+					dinb						=> shr1_write_data,
+					doutb						=> shr1_read_data
+				);
+
+	-- Code ram - the rom in previous targets
+	inst_ram_code : ram_code
+	port map	(
+					-- General
+					clka						=> clock_50M,
+					ena							=> rom_enable,
+					rsta						=> reset_system,
+
+					-- Read interface   
+					addra						=> rom_address,
+					wea							=> rom_write_enable,
+					douta						=> rom_data,
+					dina						=> rom_write_data					
+				);
+
+	inst_ram_code1 : ram_code
+	port map	(
+					-- General
+					clka						=> clock_50M,
+					ena							=> rom1_enable,
+					rsta						=> reset_system,
+
+					-- Read interface   
+					addra						=> rom1_address,
+					wea							=> rom1_write_enable,
+					douta						=> rom1_data,
+					dina						=> rom_write_data					
+				);
+	
+	inst_uart : uart
+	port map	(
+					-- General
+					clock						=> clock_50M,
+					reset						=> reset_system,
+					busy						=> uart_busy,
+
+					-- Serial interface
+					uart_rx						=> uart_rx,
+					uart_tx						=> uart_tx,
+		
+					-- incoming data
+					rx_byte						=> uart_rx_byte,
+					rx_valid					=> uart_rx_valid,
+
+					-- outgoing data
+					tx_byte						=> uart_tx_byte,
+					tx_valid					=> uart_tx_valid
+				);
+
+	inst_ext : ext
+	generic map	(
+					fast_sim					=> fast_sim
+				)
+	port map	(
+					-- General
+					clock						=> clock_50M,
+					reset						=> reset_devices,
+					enable						=> ext_enable,
+					enable_inputs				=> reset_cpu,
+					trigger_input				=> ext_trigger_input,
+					trigger_uart				=> ext_trigger_uart,
+					upgrade						=> upgrade,
+
+
+					-- Write interface
+					write_address				=> ext_address,
+					write_enable				=> ext_write_enable,
+					write_data					=> ext_write_data,
+
+					-- Read interface
+					read_address				=> ext_address,
+					read_data					=> ext_read_data,
+					
+					-- I/O
+					outputs						=> led_ext,
+					inputs						=> evt_inputs,
+					digit						=> ext_digit,
+
+					-- UART
+					uart_busy					=> uart_busy,
+
+					uart_rx_byte				=> uart_rx_byte,
+					uart_rx_valid				=> uart_rx_valid,
+					uart_tx_byte				=> uart_tx_byte,
+					uart_tx_valid				=> uart_tx_valid
+				);
+
+	inst_crc : crc
+	port map	(
+					-- General
+					clock						=> clock_50M,
+					reset						=> reset_devices,
+					enable						=> crc_enable,
+
+					-- Write interface
+					write_address				=> crc_address,
+					write_enable				=> crc_write_enable,
+					write_data					=> crc_write_data,
+
+					-- Read interface
+					read_address				=> crc_address,
+					read_data					=> crc_read_data,
+
+					-- Memory read interface
+					dma_request					=> crc_dma_request,
+					dma_grant					=> crc_dma_grant,
+					dma_address					=> crc_dma_address,
+					dma_data					=> crc_dma_data
+				);
+
+	inst_timer : timer
+	port map	(
+					-- General
+					clock						=> clock_50M,
+					reset						=> reset_devices,
+					enable						=> tmr_enable,
+					trigger						=> tmr_trigger,
+
+					-- Write interface
+					write_address				=> tmr_address,
+					write_enable				=> tmr_write_enable,
+					write_data					=> tmr_write_data,
+
+					-- Read interface
+					read_address				=> tmr_address,
+					read_data					=> tmr_read_data,
+
+					-- Free running counter
+					microseconds				=> tmr_microseconds
+				);
+
+	inst_input_event : input_event
+	port map	(
+					-- General
+					clock						=> clock_50M,
+					reset						=> reset_devices,
+					enable						=> evt_enable,
+					enable_inputs				=> reset_cpu,
+					trigger						=> evt_trigger,
+
+					-- Write interface
+					write_address				=> evt_address,
+					write_enable				=> evt_write_enable,
+					write_data					=> evt_write_data,
+
+					-- Read interface
+					read_address				=> evt_address,
+					read_data					=> evt_read_data,
+
+					-- Inputs
+					inputs						=> evt_inputs,
+					microseconds				=> tmr_microseconds
+				);
+
+	gen_serial : for channel in 0 to SERIAL_CHANNELS - 1 generate
+		inst_serial : serial
+		port map	(
+						-- General
+						clock						=> clock_50M,
+						reset						=> reset_devices,
+						enable						=> ser_enable(channel),
+						enable_inputs				=> reset_cpu,
+						trigger						=> ser_trigger(channel),
+
+						-- Write interface
+						write_address				=> ser_address,
+						write_enable				=> ser_write_enable,
+						write_data					=> ser_write_data,
+
+						-- Read interface
+						read_address				=> ser_address,
+						read_data					=> ser_read_data(channel),
+
+						-- Serial interface
+						uart_rx						=> serial_rx(channel),
+						uart_tx						=> serial_tx(channel)
+					);
+	end generate;
+
+	inst_intc : intc
+	port map	(
+					-- General
+					clock						=> clock_50M,
+					reset						=> reset_devices,
+					enable						=> int_enable,
+					interrupt					=> cpu_irq,
+
+					-- Sources
+					sources						=> int_sources,
+
+					-- Write interface
+					write_address				=> int_address,
+					write_enable				=> int_write_enable,
+					write_data					=> int_write_data,
+
+					-- Read interface
+					read_address				=> int_address,
+					read_data					=> int_read_data
+				);
+
+	inst_mbox : mbox
+	port map	(
+					-- General
+					clock						=> clock_50M,
+					reset						=> reset_devices,
+					enable						=> mbx_enable,
+					trigger						=> mbx_trigger,
+					interrupt					=> mbx_interrupt,
+
+					-- Write interface
+					write_address				=> mbx_address,
+					write_enable				=> mbx_write_enable,
+					write_data					=> mbx_write_data,
+
+					-- Read interface
+					read_address				=> mbx_address,
+					read_data					=> mbx_read_data
+				);
+
+	inst_soft_dl: soft_dl
+	port map	(
+					-- General
+					clock						=> clock_50M,
+					reset						=> reset_system,
+					reset_cpu					=> reset_cpu,
+					reset_devices				=> reset_devices,
+					led							=> led_soft_dl,
+					upgrade						=> upgrade,
+
+					-- UART data receive
+					uart_rx_data				=> uart_rx_byte,
+					uart_rx_valid				=> uart_rx_valid,
+
+					-- Code ram write interface
+					write_address				=> rom_address_soft_dl,
+					write_enable				=> rom_write_soft_dl,
+					write_data					=> rom_write_data
+				);
+
+	push_debounce : for id in 0 to 3 generate
+	inst_debounce: debounce
+	generic map	(
+					active_high					=> '1'
+				)
+	port map	(
+					-- General
+					clock						=> clock_50M,
+					reset						=> reset_system,
+
+				-- Signal input
+				signal_in						=> push(id),
+
+				-- Signal output
+				button_down						=> push_debounce_down(id),
+				button_up						=> push_debounce_up(id)
+			);
+	end generate;
+
+	---------------------------------------------------------------------------
+	-- Processes
+
+	-- reset_system generation
+	proc_lock : process(clock_50M) begin
+		if (clock_50M'event and clock_50M='1') then
+			-- If reset
+			if (reset = '1') then
+				reset_system									<= '1';
+				locked_delay									<= (others => '0');
+			else
+				if (locked = '0') then
+					locked_delay								<= (others => '0');
+				else
+					if (locked_delay /= x"20") then
+						locked_delay							<= locked_delay + 1;
+					end if;
+					
+					-- Remove system reset
+					if (locked_delay = x"20") then
+						reset_system							<= '0';
+					end if;
+				end if;
+			end if;
+		end if; -- clock event
+	end process;
+
+	-- Select the target component
+	proc_select : process(clock_50M) begin
+		if (clock_50M'event and clock_50M='1') then
+			-- If reset
+			if (reset_system = '1') then
+				cpu_data_in										<= (others => '0');
+
+				ram_enable										<= '0';
+				ram_address										<= (others => '0');
+
+				ext_enable										<= '0';
+				ext_write_data									<= (others => '0');
+				ext_address										<= (others => '0');
+
+				crc_enable										<= '0';
+				crc_write_data									<= (others => '0');
+				crc_address										<= (others => '0');
+				crc_dma_grant									<= '0';
+
+				tmr_enable										<= '0';
+				tmr_write_data									<= (others => '0');
+				tmr_address										<= (others => '0');
+
+				int_enable										<= '0';
+				int_write_data									<= (others => '0');
+				int_address										<= (others => '0');
+
+				evt_enable										<= '0';
+				evt_write_data									<= (others => '0');
+				evt_address										<= (others => '0');
+
+				ser_enable										<= (others => '0');
+				ser_write_data									<= (others => '0');
+				ser_address										<= (others => '0');
+
+				mbx_enable(0)									<= '0';
+				mbx_write_data(0)								<= (others => '0');
+				mbx_address(0)									<= (others => '0');
+
+				shr_enable										<= '0';
+				shr_address										<= (others => '0');
+
+				rom_enable_cpu									<= '0';
+				rom_address_cpu									<= (others => '0');
+			else
+				ram_enable										<= '0';
+				ext_enable										<= '0';
+				crc_enable										<= '0';
+				tmr_enable										<= '0';
+				int_enable										<= '0';
+				evt_enable										<= '0';
+				ser_enable										<= (others => '0');
+				mbx_enable(0)									<= '0';
+				shr_enable										<= '0';
+				rom_enable_cpu									<= '0';
+				crc_dma_grant									<= '0';
+				
+				if (conv_integer(cpu_address) >= MAP_START_ROM) then
+					-- ROM access
+					rom_enable_cpu								<= '1';
+					rom_address_cpu								<= rom_base(12 downto 0);
+					cpu_data_in									<= rom_data;
+
+				elsif (conv_integer(cpu_address) >= MAP_START_EXT) and (conv_integer(cpu_address) <= MAP_START_EXT + 15) then
+					-- I/O EXTENSION access
+					ext_enable									<= reset_cpu;			-- disable ext if cpu is reset
+					cpu_data_in									<= ext_read_data;
+					ext_address									<= ext_base(3 downto 0);
+					ext_write_data								<= cpu_data_out;
+					ext_write_enable							<= cpu_write_enable;
+
+				elsif (conv_integer(cpu_address) >= MAP_START_CRC) and (conv_integer(cpu_address) <= MAP_START_CRC + 15) then
+					-- CRC accelerator access
+					crc_enable									<= reset_cpu;			-- disable crc if cpu is reset
+					cpu_data_in									<= crc_read_data;
+					crc_address									<= crc_base(3 downto 0);
+					crc_write_data								<= cpu_data_out;
+					crc_write_enable							<= cpu_write_enable;
+
+				elsif (conv_integer(cpu_address) >= MAP_START_TMR) and (conv_integer(cpu_address) <= MAP_START_TMR + 15) then
+					-- Timer access
+					tmr_enable									<= reset_cpu;			-- disable timer if cpu is reset
+					cpu_data_in									<= tmr_read_data;
+					tmr_address									<= tmr_base(3 downto 0);
+					tmr_write_data								<= cpu_data_out;
+					tmr_write_enable							<= cpu_write_enable;
+
+				elsif (conv_integer(cpu_address) >= MAP_START_INT) and (conv_integer(cpu_address) <= MAP_START_INT + 15) then
+					-- Interrupt controller access
+					int_enable									<= reset_cpu;			-- disable intc if cpu is reset
+					cpu_data_in									<= int_read_data;
+					int_address									<= int_base(3 downto 0);
+					int_write_data								<= cpu_data_out;
+					int_write_enable							<= cpu_write_enable;
+
+				elsif (conv_integer(cpu_address) >= MAP_START_EVT) and (conv_integer(cpu_address) <= MAP_START_EVT + 15) then
+					-- Input events access
+					evt_enable									<= reset_cpu;			-- disable input events if cpu is reset
+					cpu_data_in									<= evt_read_data;
+					evt_address									<= evt_base(3 downto 0);
+					evt_write_data								<= cpu_data_out;
+					evt_write_enable							<= cpu_write_enable;
+
+				elsif (conv_integer(cpu_address) >= MAP_START_SER) and (conv_integer(cpu_address) <= MAP_START_SER + 16 * SERIAL_CHANNELS - 1) then
+					-- Serial channels access (16 registers each)
+					ser_enable(conv_integer(ser_base(7 downto 4)))	<= reset_cpu;		-- disable serial if cpu is reset
+					cpu_data_in									<= ser_read_data(conv_integer(ser_base(7 downto 4)));
+					ser_address									<= ser_base(3 downto 0);
+					ser_write_data								<= cpu_data_out;
+					ser_write_enable							<= cpu_write_enable;
+
+				elsif (conv_integer(cpu_address) >= MAP_START_MBX) and (conv_integer(cpu_address) <= MAP_START_MBX + 15) then
+					-- Mailbox access
+					mbx_enable(0)								<= reset_cpu;			-- disable mailbox if cpu is reset
+					cpu_data_in									<= mbx_read_data(0);
+					mbx_address(0)								<= mbx_base(3 downto 0);
+					mbx_write_data(0)							<= cpu_data_out;
+					mbx_write_enable(0)							<= cpu_write_enable;
+
+				elsif (conv_integer(cpu_address) >= MAP_START_REG) then
+					-- Registers access - unused
+
+				elsif (conv_integer(cpu_address) >= MAP_START_SHR) then
+					-- Shared RAM access
+					shr_enable									<= '1';
+					cpu_data_in									<= shr_read_data;
+					shr_address									<= shr_base(14 downto 0);
+					shr_write_data								<= cpu_data_out;
+					shr_write_enable(0)							<= cpu_write_enable;
+
+				else
+					-- RAM access
+					ram_enable									<= '1';
+					cpu_data_in									<= ram_read_data;
+					ram_address									<= cpu_address;
+					ram_write_data								<= cpu_data_out;
+					ram_write_enable(0)							<= cpu_write_enable;
+				end if;
+
+				-- CRC memory transfer: read the memory only if the CPU is not accessing it
+				if (crc_dma_request = '1') then
+					if (conv_integer(crc_dma_address) >= MAP_START_ROM) then
+						if (conv_integer(cpu_address) < MAP_START_ROM) then
+							rom_enable_cpu						<= '1';
+							rom_address_cpu						<= crc_dma_rom(12 downto 0);
+							crc_dma_grant						<= '1';
+						end if;
+					elsif (conv_integer(crc_dma_address) >= MAP_START_REG) then
+						-- Registers are not readable, go on with a dummy value
+						crc_dma_grant							<= '1';
+					elsif (conv_integer(crc_dma_address) >= MAP_START_SHR) then
+						if (conv_integer(cpu_address) < MAP_START_SHR) or (conv_integer(cpu_address) >= MAP_START_REG) then
+							shr_enable							<= '1';
+							shr_address							<= shr_dma(14 downto 0);
+							shr_write_enable(0)					<= '0';
+							crc_dma_grant						<= '1';
+						end if;
+					else
+						if (conv_integer(cpu_address) >= MAP_START_SHR) then
+							ram_enable							<= '1';
+							ram_address							<= crc_dma_address;
+							ram_write_enable(0)					<= '0';
+							crc_dma_grant						<= '1';
+						end if;
+					end if;
+				end if;
+			end if; -- reset
+		end if; -- clock event
+	end process;
+
+	-- Select the target component (core 1)
+	proc_select1 : process(clock_50M) begin
+		if (clock_50M'event and clock_50M='1') then
+			-- If reset
+			if (reset_system = '1') then
+				cpu1_data_in									<= (others => '0');
+
+				ram1_enable										<= '0';
+				ram1_address									<= (others => '0');
+
+				mbx_enable(1)									<= '0';
+				mbx_write_data(1)								<= (others => '0');
+				mbx_address(1)									<= (others => '0');
+
+				shr1_enable										<= '0';
+				shr1_address									<= (others => '0');
+
+				rom1_enable_cpu									<= '0';
+				rom1_address_cpu								<= (others => '0');
+			else
+				ram1_enable										<= '0';
+				mbx_enable(1)									<= '0';
+				shr1_enable										<= '0';
+				rom1_enable_cpu									<= '0';
+
+				if (conv_integer(cpu1_address) >= MAP_START_ROM) then
+					-- ROM access
+					rom1_enable_cpu								<= '1';
+					rom1_address_cpu							<= rom1_base(12 downto 0);
+					cpu1_data_in								<= rom1_data;
+
+				elsif (conv_integer(cpu1_address) >= MAP_START_MBX) and (conv_integer(cpu1_address) <= MAP_START_MBX + 15) then
+					-- Mailbox access
+					mbx_enable(1)								<= reset_cpu;			-- disable mailbox if cpu is reset
+					cpu1_data_in								<= mbx_read_data(1);
+					mbx_address(1)								<= mbx1_base(3 downto 0);
+					mbx_write_data(1)							<= cpu1_data_out;
+					mbx_write_enable(1)							<= cpu1_write_enable;
+
+				elsif (conv_integer(cpu1_address) >= MAP_START_REG) then
+					-- Registers access - core 0 devices are not visible
+
+				elsif (conv_integer(cpu1_address) >= MAP_START_SHR) then
+					-- Shared RAM access
+					shr1_enable									<= '1';
+					cpu1_data_in								<= shr1_read_data;
+					shr1_address								<= shr1_base(14 downto 0);
+					shr1_write_data								<= cpu1_data_out;
+					shr1_write_enable(0)						<= cpu1_write_enable;
+
+				else
+					-- RAM access
+					ram1_enable									<= '1';
+					cpu1_data_in								<= ram1_read_data;
+					ram1_address								<= cpu1_address;
+					ram1_write_data								<= cpu1_data_out;
+					ram1_write_enable(0)						<= cpu1_write_enable;
+				end if;
+			end if; -- reset
+		end if; -- clock event
+	end process;
+
+	-- WAI on core 0 (see cpu_wait in soft/direct.s): the r65c02_tc core has no WAI, the opcode fetch
+	-- gets a NOP and the core is held with RDY low until the IRQ line goes low (as in 003 top.vhd).
+	-- Core 1 never runs WAI.
+	cpu_data_core		<= x"EA" when (cpu_sync = '1') and (cpu_data_in = x"CB") else cpu_data_in;
+	cpu_ready			<= not cpu_wai;
+
+	proc_wai : process(clock_5M) begin
+		if (clock_5M'event and clock_5M='1') then
+			-- If CPU reset
+			if (reset_cpu = '0') then
+				cpu_wai											<= '0';
+			elsif (cpu_sync = '1') and (cpu_data_in = x"CB") and (cpu_irq = '1') then
+				cpu_wai											<= '1';
+			elsif (cpu_irq = '0') then
+				cpu_wai											<= '0';
+			end if;
+		end if; -- clock event
+	end process;
+
+	-- 7 segments digits multiplexing
+	gen_digits : if (not fast_sim) generate
+
+		-- Generate 7 segments digits signals
+		digits_gen : process(clock_50M) begin
+			if (clock_50M'event and clock_50M='1') then
+				-- If (system is in reset state)
+				if (reset_system = '1') then
+					anode											<= (others => '1');
+					cathode											<= (others => '1');
+					digit_delay										<= (others => '0');
+					digit_select									<= "1000";
+					digit_select_id									<= 3;
+				else
+					-- Drive the output inverting the signals
+					anode											<= not digit_select;
+					cathode											<= not ext_digit(digit_select_id);
+
+					digit_delay										<= digit_delay + 1;
+
+					-- Wait for refresh delay:  50MHz clock and a delay of 4ms : 4m * 50M = 200000 = x030D40
+					if (digit_delay = x"030D40") then
+						digit_delay									<= (others => '0');
+						digit_select								<= digit_select(2 downto 0) & digit_select(3);
+					
+						if (digit_select_id = 3) then
+							digit_select_id							<= 0;
+						else
+							digit_select_id							<= digit_select_id + 1;
+						end if;
+					end if;
+				end if;
+			end if;
+		end process;
+
+	end generate;
+
+	-- Simulation profile: no multiplexing, the pins stay on the first selected digit (3), all the
+	-- digits are in ext_digit
+	gen_digits_fast : if (fast_sim) generate
+		anode			<= (others => '1')	when (reset_system = '1') else "0111";
+		cathode			<= (others => '1')	when (reset_system = '1') else not ext_digit(3);
+	end generate;
+
+end behavioral;
+
+-------------------------------------------------------------------------------
+-- EOF
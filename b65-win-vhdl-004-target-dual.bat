@@ -0,0 +1,19 @@
+@echo off
+rem Copyright 2023 Luca Bertossi
+rem
+rem This file is part of B65.
+rem 
+rem     B65 is free software: you can redistribute it and/or modify
+rem     it under the terms of the GNU General Public License as published by
+rem     the Free Software Foundation, either version 3 of the License, or
+rem     (at your option) any later version.
+rem 
+rem     B65 is distributed in the hope that it will be useful,
+rem     but WITHOUT ANY WARRANTY; without even the implied warranty of
+rem     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+rem     GNU General Public License for more details.
+rem 
+rem     You should have received a copy of the GNU General Public License
+rem     along with B65.  If not, see <http://www.gnu.org/licenses/>.
+
+b65-win-vhdl.bat 004-target-dual 500ms
\ No newline at end of file
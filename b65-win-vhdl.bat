@@ -57,6 +57,12 @@ if not exist "r65c02_tc-obj08.cf" (
 
 echo INFO  : building b65 board
 
+rem Software image package (rom.vhd, generated by rom2coe in the software build)
+if exist ..\soft\b65_rom.vhd (
+	echo         ..\soft\b65_rom.vhd
+	ghdl -a --ieee=synopsys -fexplicit --std=08 --work=b65 ..\soft\b65_rom.vhd
+)
+
 rem Pack must be compiled first
 echo         ..\..\..\%TARGET%\vhdl\pack.vhd
 ghdl -a --ieee=synopsys -fexplicit --std=08 --work=b65 ..\..\..\%TARGET%\vhdl\pack.vhd
@@ -97,6 +103,15 @@ if not exist "..\soft\b65.rom" (
 
 copy ..\soft\b65.rom . >NUL
 
+rem testbench generics
+rem simulation checkpoint (003 target, see the checkpoint process in b65.vhd)
+rem set CHECKPOINT_SAVE=<us> to save b65.ckpt, set CHECKPOINT_RESTORE=yes to start from it
+rem simulation profile (002-004 targets): set FAST_SIM=yes for no PWM and display multiplexing
+set GENERICS=
+if "%FAST_SIM%" EQU "yes" set GENERICS=%GENERICS% -gfast_sim=true
+if "%CHECKPOINT_SAVE%" NEQ "" if "%CHECKPOINT_SAVE%" NEQ "0" set GENERICS=%GENERICS% -gcheckpoint_save=%CHECKPOINT_SAVE%
+if "%CHECKPOINT_RESTORE%" EQU "yes" set GENERICS=%GENERICS% -gcheckpoint_restore=true
+
 if "%WAVE%" EQU "wave" (
 
 	rem write the (optional) GHDL signals-to-save file
@@ -116,15 +131,15 @@ rem	echo /board/int_top/inst_ext/*				>> signals.ghd
 rem	echo /board/int_top/inst_soft_dl/*			>> signals.ghd
 
 	rem --ieee-asserts=disable-at-0 disables some warnings from r65c02_tc at 0ms
-rem	board.exe --ieee-asserts=disable-at-0 --wave=cpu.ghw --stop-time=%SIMRUNTIME%
-rem	board.exe --ieee-asserts=disable-at-0 --write-wave-opt=signals.ghd --wave=cpu.ghw --stop-time=1ns
-	board.exe --ieee-asserts=disable-at-0 --read-wave-opt=signals.ghd  --wave=cpu.ghw --stop-time=%SIMRUNTIME%
+rem	board.exe %GENERICS% --ieee-asserts=disable-at-0 --wave=cpu.ghw --stop-time=%SIMRUNTIME%
+rem	board.exe %GENERICS% --ieee-asserts=disable-at-0 --write-wave-opt=signals.ghd --wave=cpu.ghw --stop-time=1ns
+	board.exe %GENERICS% --ieee-asserts=disable-at-0 --read-wave-opt=signals.ghd  --wave=cpu.ghw --stop-time=%SIMRUNTIME%
 
 	rem open waveform viewer
 	gtkwave -f cpu.ghw --save ..\..\..\%TARGET%\wave.gtkw
 ) else (
 	rem --ieee-asserts=disable-at-0 disables some warnings from r65c02_tc at 0ms
-	board.exe --ieee-asserts=disable-at-0 --stop-time=%SIMRUNTIME%
+	board.exe %GENERICS% --ieee-asserts=disable-at-0 --stop-time=%SIMRUNTIME%
 )
 
 cd ..\..\..
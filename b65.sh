@@ -19,11 +19,18 @@
 FOLDER_OUTPUT=out
 FOLDER_CC65=cc65-2.19
 FOLDER_ROM2COE=rom2coe
+FOLDER_B65LINK=b65link
 FOLDER_6502=cpu65c02_true_cycle
 FILENAME_CC65=download/${FOLDER_CC65}.tar.gz
 FILENAME_6502=download/${FOLDER_6502}_latest.tar.gz
 FOUND_GHDL=no
 FOUND_GTKWAVE=no
+SOFT_ASM=${SOFT_ASM:-1}		# firmware hot routines in hand written assembly (soft/fast.s), 0 for the C versions
+CHECKPOINT_SAVE=${CHECKPOINT_SAVE:-0}		# 003 simulation: save b65.ckpt at the first CPU idle point after [us] (0 = none)
+CHECKPOINT_RESTORE=${CHECKPOINT_RESTORE:-no}	# 003 simulation: start from b65.ckpt instead of the software download (yes/no)
+FAST_SIM=${FAST_SIM:-no}					# 002-004 simulation: no PWM and display multiplexing, one clock generator (yes/no)
+VERILATOR=${VERILATOR:-no}					# 003 simulation: compiled C++ model (ghdl --synth and verilator) instead of ghdl (yes/no)
+VERILATOR_THREADS=${VERILATOR_THREADS:-2}	# 003 simulation: verilator model threads (1 = single threaded model)
 
 b65Help()
 {
@@ -32,6 +39,20 @@ b65Help()
 	echo
 	echo "If simulation time is not specified, it defaults to 20ms"
 	echo "If wave is specified, waveform is saved and gtkwave is opened"
+	echo
+	echo "003 target simulation checkpoint (environment):"
+	echo "  CHECKPOINT_SAVE=<us>    save b65.ckpt at the first CPU idle point after <us> microseconds"
+	echo "  CHECKPOINT_RESTORE=yes  start from b65.ckpt instead of the software download"
+	echo
+	echo "002-004 targets simulation profile (environment):"
+	echo "  FAST_SIM=yes            no PWM and display multiplexing, fewer events per CPU cycle"
+	echo
+	echo "003 target compiled simulation (environment, needs ghdl with synthesis and verilator):"
+	echo "  VERILATOR=yes           run the verilator model of the board instead of the ghdl one"
+	echo "  VERILATOR_THREADS=<n>   verilator model threads (default 2, 1 for a single threaded model)"
+	echo
+	echo "003 target firmware (environment):"
+	echo "  SOFT_ASM=0              C versions of the soft/fast.s routines (the ROM segments report shows the size)"
 }
 
 b65Prerequisites()
@@ -68,6 +89,14 @@ b65Prerequisites()
 	else
 		FOUND_GTKWAVE='yes'
 	fi
+
+	if [ "$VERILATOR" == "yes" ]; then
+		verilator --version &> /dev/null
+		if [ $? -ne 0 ]; then
+			echo "ERROR : verilator not found, please install verilator or run without VERILATOR=yes"
+			exit 1
+		fi
+	fi
 }
 
 b65Extract()
@@ -126,6 +155,19 @@ b65CompileRomToCoe()
 	fi
 }
 
+b65CompileLink()
+{
+	if [ ! -d "$FOLDER_OUTPUT/b65link" ]; then
+
+		mkdir "$FOLDER_OUTPUT/b65link"
+
+		echo "INFO  : building b65link host tools (binary protocol client)"
+
+		cp --preserve=timestamps $FOLDER_B65LINK/* "$FOLDER_OUTPUT/b65link"
+		make -C "$FOLDER_OUTPUT/b65link"
+	fi
+}
+
 b65Compile6502CPU()
 {
 	local Target=$1
@@ -159,6 +201,12 @@ b65CompileBoard()
 
 	echo "INFO  : building b65 board"
 
+	# Software image package (rom.vhd, generated by rom2coe in the software build)
+	if [ -e ../soft/b65_rom.vhd ]; then
+		echo "       ../soft/b65_rom.vhd"
+		ghdl -a --ieee=synopsys -fexplicit --std=08 --work=b65 ../soft/b65_rom.vhd
+	fi
+
 	echo "       ../../../$Target/vhdl/pack.vhd"
 	ghdl -a --ieee=synopsys -fexplicit --std=08 --work=b65 ../../../$Target/vhdl/pack.vhd
 
@@ -191,50 +239,314 @@ b65LinkBoard()
 	cd ../../..
 }
 
+b65ReplaceBlock()
+{
+	local File=$1
+	local Name=$2
+	local Block=$3
+
+	if ! grep -q "$Name begin" "$File" || ! grep -q "$Name end" "$File"; then
+		echo "ERROR : [$Name begin/end] markers not found in [$File]"
+		exit 1
+	fi
+
+	# Keep the marker lines, replace everything between them with the block file
+	LC_ALL=C awk -v name="$Name" -v block="$Block" '
+		index($0, name " begin") { print; while ((getline line < block) > 0) print line; close(block); skip = 1; next }
+		index($0, name " end")   { skip = 0 }
+		!skip
+	' "$File" > "$File.tmp" && mv "$File.tmp" "$File"
+}
+
+b65GenerateMemory()
+{
+	local Target=$1
+	local Block="$FOLDER_OUTPUT/$Target/memory.tmp"
+	local ROM_SIZE REG_SIZE STACK_SIZE ISTACK_SIZE RAM_PROGRAM
+	local RomStart RegStart StackStart ZpsStart IstackStart RomBits
+
+	echo "INFO  : generating memory map from [$Target/memory.map]"
+
+	source "$Target/memory.map"
+
+	if (( ROM_SIZE < 0x2000 || ROM_SIZE > 0x6000 || ROM_SIZE % 0x400 != 0 )); then
+		echo "ERROR : ROM_SIZE must be 0x2000 to 0x6000 in 0x400 steps [$Target/memory.map]"
+		exit 1
+	fi
+
+	if (( REG_SIZE < 0x100 || REG_SIZE % 0x100 != 0 || STACK_SIZE % 0x100 != 0 || ISTACK_SIZE < 0x100 || ISTACK_SIZE % 0x100 != 0 )); then
+		echo "ERROR : REG_SIZE, STACK_SIZE and ISTACK_SIZE must be not zero multiples of 0x100 [$Target/memory.map]"
+		exit 1
+	fi
+
+	# Areas from the top of the address space down (see memory.map)
+	RomStart=$((    0x10000    - ROM_SIZE    ))
+	RegStart=$((    RomStart   - REG_SIZE    ))
+	StackStart=$((  RegStart   - STACK_SIZE  ))
+	ZpsStart=$((    StackStart - 0x100       ))
+	IstackStart=$(( ZpsStart   - ISTACK_SIZE ))
+
+	if (( RAM_PROGRAM < 0x200 || RAM_PROGRAM % 0x100 != 0 || RAM_PROGRAM >= IstackStart )); then
+		echo "ERROR : RAM_PROGRAM must be a multiple of 0x100 inside the RAM [$Target/memory.map]"
+		exit 1
+	fi
+
+	# Code ram address width
+	RomBits=0
+	while (( (1 << RomBits) < ROM_SIZE )); do
+		RomBits=$(( RomBits + 1 ))
+	done
+
+	# VHDL package constants
+	{
+		printf '\tconstant MAP_START_RAM\t: integer\t\t\t:= conv_integer(x"%04X");\t\t\t\t\t-- start address %5d : RAM\n'                                  0           0
+		printf '\tconstant MAP_START_REG\t: integer\t\t\t:= conv_integer(x"%04X");\t\t\t\t\t-- start address %5d : devices registers\n'                     $RegStart   $RegStart
+		printf '\tconstant MAP_START_ROM\t: integer\t\t\t:= conv_integer(x"%04X");\t\t\t\t\t-- start address %5d : ROM (growing from 0xFFFF down to 0x%04X)\n' $RomStart $RomStart $RomStart
+		printf '\tconstant MAP_START_ZPS\t: integer\t\t\t:= conv_integer(x"%04X");\t\t\t\t\t-- start address %5d : Shadow zero page (inside the RAM)\n'    $ZpsStart   $ZpsStart
+		printf '\n'
+		printf '\tconstant MAP_SIZE_RAM\t: integer\t\t\t:= conv_integer(x"%04X");\t\t\t\t\t-- size  in bytes      : RAM\n'                                $RegStart
+		printf '\tconstant MAP_SIZE_REG\t: integer\t\t\t:= conv_integer(x"%04X");\t\t\t\t\t-- size  in bytes      : devices registers\n'                  $REG_SIZE
+		printf '\tconstant MAP_SIZE_ROM\t: integer\t\t\t:= conv_integer(x"%04X");\t\t\t\t\t-- size  in bytes      : ROM\n'                                $ROM_SIZE
+		printf '\n'
+		printf '\tconstant ROM_ADDRESS_BITS\t: integer\t\t:= %d;\t\t\t\t\t\t\t\t\t\t-- code ram address width (ram_code, soft_dl)\n'                 $RomBits
+	} > "$Block"
+	b65ReplaceBlock "$Target/vhdl/pack.vhd" "Memory map" "$Block"
+
+	# Linker memory areas
+	{
+		printf '    RAM:      start = %5s, size = %5s,              define = yes;\n'                                                   "\$$(printf %X 0x200)"        "\$$(printf %X $(( IstackStart - 0x200 )))"
+		printf '\tISTACK:   start = %5s, size = %5s,              define = yes;                  # IRQ handlers C stack (see isr.s)\n'  "\$$(printf %X $IstackStart)" "\$$(printf %X $ISTACK_SIZE)"
+		printf '\tZPSHADOW: start = %5s, size = %5s, type   = rw, define = yes;                  # IRQ handlers zero page (see intc.vhd)\n' "\$$(printf %X $ZpsStart)" "\$$(printf %X 0x100)"
+		printf '\tSTACK:    start = %5s, size = %5s;                                             # Application Stack\n'                  "\$$(printf %X $StackStart)"  "\$$(printf %X $STACK_SIZE)"
+		printf '\tREG:      start = %5s, size = %5s, type   = rw, define = yes;\n'                                                     "\$$(printf %X $RegStart)"    "\$$(printf %X $REG_SIZE)"
+		printf '    ROM:      start = %5s, size = %5s, file   = %%O, fill = yes, fillval = $ff;\n'                                     "\$$(printf %X $RomStart)"    "\$$(printf %X $ROM_SIZE)"
+	} > "$Block"
+	b65ReplaceBlock "$Target/soft/b65.cfg" "Memory map" "$Block"
+
+	printf '    __STACKSIZE__:  type = weak, value = %s;\n' "\$$(printf %X $STACK_SIZE)" > "$Block"
+	b65ReplaceBlock "$Target/soft/b65.cfg" "Stack size" "$Block"
+
+	# Software defines
+	{
+		printf '// b65 memory map (generated by b65.sh from memory.map, do not edit)\n'
+		printf '\n'
+		printf '#define MAP_START_REG\t\t\t0x%04X\t\t// devices registers\n' $RegStart
+		printf '#define MAP_START_ROM\t\t\t0x%04X\t\t// code ram\n'          $RomStart
+		printf '#define MAP_SIZE_ROM\t\t\t0x%04X\n'                         $ROM_SIZE
+		printf '#define MAP_START_PROGRAM\t\t0x%04X\t\t// RAM programs\n'    $RAM_PROGRAM
+		printf '#define MAP_SIZE_PROGRAM\t\t0x%04X\n'                        $(( IstackStart - RAM_PROGRAM ))
+	} > "$Target/soft/memory.h"
+
+	# RAM programs linker memory area
+	if [ -e "$Target/ram/ram.cfg" ]; then
+		printf '    RAM:      start = %5s, size = %5s, file   = %%O, define = yes;\n' "\$$(printf %X $RAM_PROGRAM)" "\$$(printf %X $(( IstackStart - RAM_PROGRAM )))" > "$Block"
+		b65ReplaceBlock "$Target/ram/ram.cfg" "Memory map" "$Block"
+	fi
+
+	rm -f "$Block"
+}
+
+b65GenerateCommands()
+{
+	local Target=$1
+	local List="$Target/soft/commands.lst"
+	local Header="$Target/soft/commands.h"
+	local Sorted="$FOLDER_OUTPUT/$Target/commands.tmp"
+	local Name Handler Help Condition
+
+	echo "INFO  : generating console commands table from [$List]"
+
+	# Drop comments and empty lines, trim the fields and sort by name (byte order, as strcmp)
+	grep -v '^[[:space:]]*#' "$List" | grep -v '^[[:space:]]*$' |
+		sed -e 's/[[:space:]]*|[[:space:]]*/|/g' -e 's/^[[:space:]]*//' -e 's/[[:space:]]*$//' |
+		LC_ALL=C sort -t '|' -k 1,1 > "$Sorted"
+
+	if [ -n "$(cut -d '|' -f 1 "$Sorted" | uniq -d)" ]; then
+		echo "ERROR : duplicated commands in [$List]: $(cut -d '|' -f 1 "$Sorted" | uniq -d | tr '\n' ' ')"
+		exit 1
+	fi
+
+	{
+		printf '// Console commands table (generated by b65.sh from commands.lst, do not edit)\n'
+		printf '//\n'
+		printf '// Sorted by command name: ConsoleExecute finds a command with a binary search\n'
+		printf '\n'
+		printf '///////////////////////////////////////////////////////////\n'
+		printf '// Commands handlers\n'
+		printf '\n'
+
+		while IFS='|' read -r Name Handler Help Condition; do
+			if [ -n "$Condition" ]; then printf '#if (%s)\n' "$Condition"; fi
+			printf 'CONSOLE_HANDLER(%s);\n' "$Handler"
+			if [ -n "$Condition" ]; then printf '#endif\n'; fi
+		done < "$Sorted"
+
+		printf '\n'
+		printf '///////////////////////////////////////////////////////////\n'
+		printf '// Console commands table\n'
+		printf '\n'
+		printf 'static const CONSOLE_COMMAND g_ConsoleCommand[] =\n'
+		printf '{\n'
+
+		while IFS='|' read -r Name Handler Help Condition; do
+			if [ -n "$Condition" ]; then printf '#if (%s)\n' "$Condition"; fi
+			printf '\tCONSOLE_ENTRY("%s", %s, "%s"),\n' "$Name" "$Handler" "$Help"
+			if [ -n "$Condition" ]; then printf '#endif\n'; fi
+		done < "$Sorted"
+
+		printf '};\n'
+	} > "$Header"
+
+	rm -f "$Sorted"
+}
+
+b65CheckIrqHandlers()
+{
+	local Handlers
+	local Handler
+	local Body
+
+	# C IRQ handlers are the irqXxx functions (see soft/irq.h), read from the cc65 output in
+	# the current folder: a handler enabling the interrupts would nest on the shadow zero page
+	Handlers=$(grep -ho '^\.proc[[:space:]]*_irq[A-Z][A-Za-z0-9_]*' *.s 2>/dev/null | sed 's/^\.proc[[:space:]]*//')
+
+	for Handler in $Handlers; do
+		Body=$(awk -v Name="$Handler" '$1 == ".proc" && $2 == Name":" { On = 1 } On { print } $1 == ".endproc" { On = 0 }' *.s)
+
+		if echo "$Body" | grep -Eiq '^[[:space:]]+cli\b'; then
+			echo "ERROR : IRQ handler [$Handler] enables the interrupts (no nesting, see soft/irq.h)"
+			exit 1
+		fi
+
+		echo "INFO  : IRQ handler [$Handler]"
+	done
+}
+
 b65BuildSoftware()
 {
 	local Target=$1
-	local LinkFiles=""
+	local Soft=$2
+	local AsmFiles=""
+	local CFiles=""
+	local RomUsed=0
+	local Name Start End Size Align
 
 	if [ ! -e "$FOLDER_CC65/lib/supervision.lib" ]; then
 		echo "ERROR : cannot find compiler library [$FOLDER_CC65/lib/supervision.lib], something went wrong in cc65 build process"
 		exit 1	
 	fi
 
-	cd "$FOLDER_OUTPUT/$Target/soft"
+	cd "$FOLDER_OUTPUT/$Target/$Soft"
 
-	echo "INFO  : compiling software"
+	echo "INFO  : compiling software [$Soft]"
 
 	# Customize library
 	# Instructions from https://cc65.github.io/doc/customizing.html
 	cp ../../../$FOLDER_CC65/lib/supervision.lib b65.lib
-	../../../$FOLDER_CC65/bin/ca65 ../../../$Target/soft/crt0.s -o crt0.o
+	../../../$FOLDER_CC65/bin/ca65 ../../../$Target/$Soft/crt0.s -o crt0.o
 	../../../$FOLDER_CC65/bin/ar65 a b65.lib crt0.o
 
+	# Compile sources (c), first: the IRQ handlers check reads their output
+	for Source in ../../../$Target/$Soft/*.c; do
+		echo "       $Source"
+		Filename=$(basename $Source .c)
+		../../../$FOLDER_CC65/bin/cc65 -t none -O --cpu 65sc02 -D SOFT_ASM=$SOFT_ASM $Source -o $Filename.s
+		../../../$FOLDER_CC65/bin/ca65 --cpu 65sc02 $Filename.s
+		CFiles="$CFiles $Filename.o"
+	done
+
+	b65CheckIrqHandlers
+
+	# Compile sources (asm)
+	for Source in ../../../$Target/$Soft/*.s; do
+		echo "       $Source"
+		Filename=$(basename $Source .s)
+		../../../$FOLDER_CC65/bin/ca65 --cpu 65sc02 -D SOFT_ASM=$SOFT_ASM $Source -o $Filename.o
+		AsmFiles="$AsmFiles $Filename.o"
+	done
+
+	# Link and generate rom file
+	echo "INFO  : generating .rom file"
+	if ! ../../../$FOLDER_CC65/bin/ld65 -C ../../../$Target/$Soft/b65.cfg -m main.map $AsmFiles $CFiles b65.lib -o b65.rom; then
+		echo "ERROR : link failed on [$Target/$Soft], on a ROM overflow raise ROM_SIZE in [$Target/memory.map]"
+		exit 1
+	fi
+
+	# ROM use: the segments loaded in ROM from the map file segment list (hex sizes, see b65.cfg)
+	while read -r Name Start End Size Align; do
+		case "$Name" in
+			STARTUP|ONCE|CODE|RODATA|DATA|VECTORS)
+				printf '       %-8s %5d bytes\n' "$Name" $(( 16#$Size ))
+				RomUsed=$(( RomUsed + 16#$Size ))
+				;;
+		esac
+	done < <(sed -n '/^Segment list:/,/^$/p' main.map)
+	echo "INFO  : ROM segments $RomUsed bytes (SOFT_ASM=$SOFT_ASM)"
+
+	# convet rom to coe, VHDL package (ROM simulation model), readmemh and Intel HEX
+	echo "INFO  : generating .coe .vhd .mem .hex files"
+	if ! ../../rom2coe/rom2coe b65.rom 8 coe vhd mem hex; then
+		echo "ERROR : rom2coe failed on [$FOLDER_OUTPUT/$Target/$Soft/b65.rom]"
+		exit 1
+	fi
+
+	cd ../../..
+}
+
+b65BuildRamProgram()
+{
+	local Target=$1
+	local LinkFiles=""
+
+	cd "$FOLDER_OUTPUT/$Target/ram"
+
+	echo "INFO  : compiling RAM program [ram]"
+
+	# RAM programs startup (see ram/crt0.s)
+	cp ../../../$FOLDER_CC65/lib/supervision.lib ram.lib
+	../../../$FOLDER_CC65/bin/ca65 ../../../$Target/ram/crt0.s -o crt0.o
+	../../../$FOLDER_CC65/bin/ar65 a ram.lib crt0.o
+
 	# Compile sources (asm)
-	for Source in ../../../$Target/soft/*.s; do
+	for Source in ../../../$Target/ram/*.s; do
 		echo "       $Source"
 		Filename=$(basename $Source .s)
 		../../../$FOLDER_CC65/bin/ca65 --cpu 65sc02 $Source -o $Filename.o
 		LinkFiles="$LinkFiles $Filename.o"
 	done
 
-	# Compile sources (c)
-	for Source in ../../../$Target/soft/*.c; do
+	# Compile sources (c), the firmware headers are shared
+	for Source in ../../../$Target/ram/*.c; do
 		echo "       $Source"
 		Filename=$(basename $Source .c)
-		../../../$FOLDER_CC65/bin/cc65 -t none -O --cpu 65sc02 $Source -o $Filename.s
+		../../../$FOLDER_CC65/bin/cc65 -t none -O --cpu 65sc02 -I ../../../$Target/soft $Source -o $Filename.s
 		../../../$FOLDER_CC65/bin/ca65 --cpu 65sc02 $Filename.s
 		LinkFiles="$LinkFiles $Filename.o"
 	done
 
-	# Link and generate rom file
-	echo "INFO  : generating .rom file"
-	../../../$FOLDER_CC65/bin/ld65 -C ../../../$Target/soft/b65.cfg -m main.map $LinkFiles b65.lib -o b65.rom
+	# Link the flat binary (console load command)
+	echo "INFO  : generating ram.bin file"
+	../../../$FOLDER_CC65/bin/ld65 -C ../../../$Target/ram/ram.cfg -m ram.map $LinkFiles ram.lib -o ram.bin
 
-	# convet rom to coe
-	echo "INFO  : generating .coe file"
-	../../rom2coe/rom2coe b65.rom
+	cd ../../..
+}
+
+b65MergeSoftware()
+{
+	local Target=$1
+
+	# Second core image (dual core targets) : the download is core 0 code followed by core 1 code
+	echo "INFO  : appending core 1 .rom file"
+	cat "$FOLDER_OUTPUT/$Target/soft1/b65.rom" >> "$FOLDER_OUTPUT/$Target/soft/b65.rom"
+
+	# The .coe .vhd .mem .hex files of the core 0 build hold core 0 code only: generate them again
+	cd "$FOLDER_OUTPUT/$Target/soft"
+
+	echo "INFO  : generating .coe .vhd .mem .hex files of the merged .rom file"
+	if ! ../../rom2coe/rom2coe b65.rom 8 coe vhd mem hex; then
+		echo "ERROR : rom2coe failed on [$FOLDER_OUTPUT/$Target/soft/b65.rom]"
+		exit 1
+	fi
 
 	cd ../../..
 }
@@ -256,6 +568,29 @@ b65Run()
 	# copy software rom file to board.exe folder
 	cp ../soft/b65.rom .
 
+	# testbench generics: simulation checkpoint (see the checkpoint process in 003 b65.vhd) and profile
+	local Generics=""
+	if [ "$FAST_SIM" == "yes" ]; then
+		if grep -q fast_sim "../../../$Target/vhdl/b65.vhd"; then
+			Generics="$Generics -gfast_sim=true"
+			echo "INFO  : Fast simulation profile (no PWM and display multiplexing)"
+		else
+			echo "INFO  : [$Target] has no fast simulation profile, running the full model"
+		fi
+	fi
+	if [ "$CHECKPOINT_SAVE" != "0" ]; then
+		Generics="$Generics -gcheckpoint_save=$CHECKPOINT_SAVE"
+		echo "INFO  : Saving checkpoint b65.ckpt after" $CHECKPOINT_SAVE "us"
+	fi
+	if [ "$CHECKPOINT_RESTORE" == "yes" ]; then
+		if [ ! -e "b65.ckpt" ]; then
+			echo "ERROR : cannot find checkpoint file [$FOLDER_OUTPUT/$Target/vhdl/b65.ckpt], run with CHECKPOINT_SAVE first"
+			exit 1
+		fi
+		Generics="$Generics -gcheckpoint_restore=true"
+		echo "INFO  : Restoring checkpoint b65.ckpt"
+	fi
+
 	# write the (optional) GHDL signals-to-save file
 	# use --write-wave-opt=<filename> to generate signals hierarchy (tip : run for 1ns to avoid useless waits)
 	# use --read-wave-opt=<filename>  to save only indicated signals to simulation file
@@ -273,16 +608,81 @@ b65Run()
 #	echo /board/int_top/inst_soft_dl/*			>> signals.ghd
 
 	# --ieee-asserts=disable-at-0 disables some warnings from r65c02_tc at 0ms
+	local Start=$SECONDS
 	if [ "$Wave" == "wave" ]; then
-	#	./board --ieee-asserts=disable-at-0 --wave=cpu.ghw --stop-time=$SimRunTime
-	#	./board --ieee-asserts=disable-at-0 --write-wave-opt=signals.ghd --wave=cpu.ghw --stop-time=$SimRunTime
-		./board --ieee-asserts=disable-at-0 --read-wave-opt=signals.ghd  --wave=cpu.ghw --stop-time=$SimRunTime
+	#	./board $Generics --ieee-asserts=disable-at-0 --wave=cpu.ghw --stop-time=$SimRunTime
+	#	./board $Generics --ieee-asserts=disable-at-0 --write-wave-opt=signals.ghd --wave=cpu.ghw --stop-time=$SimRunTime
+		./board $Generics --ieee-asserts=disable-at-0 --read-wave-opt=signals.ghd  --wave=cpu.ghw --stop-time=$SimRunTime
 	else
-	#	./board --ieee-asserts=disable-at-0 --stop-time=$SimRunTime
-	#	./board --ieee-asserts=disable-at-0 --write-wave-opt=signals.ghd --stop-time=$SimRunTime
-		./board --ieee-asserts=disable-at-0 --read-wave-opt=signals.ghd  --stop-time=$SimRunTime
+	#	./board $Generics --ieee-asserts=disable-at-0 --stop-time=$SimRunTime
+	#	./board $Generics --ieee-asserts=disable-at-0 --write-wave-opt=signals.ghd --stop-time=$SimRunTime
+		./board $Generics --ieee-asserts=disable-at-0 --read-wave-opt=signals.ghd  --stop-time=$SimRunTime
 	fi
 
+	# wall clock time, to compare the simulation profiles
+	echo "INFO  : Simulation of $SimRunTime took $((SECONDS - Start)) s"
+
+	cd ../../..
+}
+
+b65Verilator()
+{
+	local Target=$1
+	local SimRunTime=${2:-20ms}
+	local Options=""
+
+	if [ ! -d "$FOLDER_OUTPUT/$Target/verilator" ]; then mkdir "$FOLDER_OUTPUT/$Target/verilator"; fi
+	cd "$FOLDER_OUTPUT/$Target/verilator"
+
+	if [ ! -e "../soft/b65.rom" ]; then
+		echo "ERROR : cannot find rom file [$FOLDER_OUTPUT/$Target/soft/b65.rom], something went wrong building software"
+		exit 1
+	fi
+
+	# Own work libraries: the RAM IP, the code ram and the clocking wizard models are the synthesizable ones of verilator/
+	echo "INFO  : synthesizing b65 board for verilator"
+	if [ ! -e "r65c02_tc-obj08.cf" ]; then
+		for Source in fsm_execution_unit fsm_intnmi reg_pc reg_sp regbank_axy core; do
+			ghdl -a --ieee=synopsys -fexplicit --std=08 --work=r65c02_tc ../../../$FOLDER_6502/trunk/released/rtl/vhdl/$Source.vhd
+		done
+	fi
+
+	ghdl -a --ieee=synopsys -fexplicit --std=08 --work=b65 ../../../$Target/vhdl/pack.vhd
+	for Source in ../../../$Target/vhdl/*.vhd; do
+		case $(basename $Source) in
+			pack.vhd | top.vhd | b65.vhd | ram.vhd | ram-code.vhd | clock_manager.vhd) ;;
+			*) ghdl -a --ieee=synopsys -fexplicit --std=08 --work=b65 $Source ;;
+		esac
+	done
+	ghdl -a --ieee=synopsys -fexplicit --std=08 --work=b65 ../../../$Target/verilator/ram.vhd
+	ghdl -a --ieee=synopsys -fexplicit --std=08 --work=b65 ../../../$Target/verilator/ram-code.vhd
+	ghdl -a --ieee=synopsys -fexplicit --std=08 --work=b65 ../../../$Target/verilator/clock_manager.vhd
+	ghdl -a --ieee=synopsys -fexplicit --std=08 ../../../$Target/vhdl/top.vhd
+
+	# Verilog netlist of the board (fast simulation profile: no PWM and display multiplexing)
+	if ! ghdl --synth --ieee=synopsys -fexplicit --std=08 -gfast_sim=true --out=verilog top > top.v; then
+		echo "ERROR : ghdl synthesis failed (ghdl must be built with synthesis support)"
+		exit 1
+	fi
+
+	# C++ model and testbench
+	echo "INFO  : building verilator model ($VERILATOR_THREADS threads)"
+	if ! verilator --cc --exe --build -O3 --threads $VERILATOR_THREADS -Wno-fatal -Wno-lint -Wno-style \
+			--top-module top top.v ../../../$Target/verilator/b65sim.cpp -o b65sim > verilator.log; then
+		echo "ERROR : verilator build failed, see [$FOLDER_OUTPUT/$Target/verilator/verilator.log]"
+		exit 1
+	fi
+
+	# Same files as the ghdl testbench (host requests from the vhdl folder, see b65link)
+	if [ -e "../vhdl/b65.host" ]; then
+		Options="-h ../vhdl/b65.host"
+	fi
+
+	echo "INFO  : Running b65 verilator model for" $SimRunTime
+	local Start=$SECONDS
+	./obj_dir/b65sim -t $SimRunTime $Options -u b65.uart ../soft/b65.rom
+	echo "INFO  : Simulation of $SimRunTime took $((SECONDS - Start)) s"
+
 	cd ../../..
 }
 
@@ -328,23 +728,57 @@ b65main()
 	if [ ! -d "$FOLDER_OUTPUT/$Target" ];      then mkdir "$FOLDER_OUTPUT/$Target";      fi
 	if [ ! -d "$FOLDER_OUTPUT/$Target/vhdl" ]; then mkdir "$FOLDER_OUTPUT/$Target/vhdl"; fi
 	if [ ! -d "$FOLDER_OUTPUT/$Target/soft" ]; then mkdir "$FOLDER_OUTPUT/$Target/soft"; fi
+	if [ -d "$Target/soft1" ] && [ ! -d "$FOLDER_OUTPUT/$Target/soft1" ]; then mkdir "$FOLDER_OUTPUT/$Target/soft1"; fi
+	if [ -d "$Target/ram" ]   && [ ! -d "$FOLDER_OUTPUT/$Target/ram" ];   then mkdir "$FOLDER_OUTPUT/$Target/ram";   fi
 
 	# Build rom to coe utility
 	b65CompileRomToCoe
 
+	# Build host tools (b65cmd talks to the board binary protocol, see readme)
+	b65CompileLink
+
+	# Memory map (targets with a memory description)
+	if [ -e "$Target/memory.map" ]; then
+		b65GenerateMemory $Target
+	fi
+
+	# Console commands table (targets with a commands list)
+	if [ -e "$Target/soft/commands.lst" ]; then
+		b65GenerateCommands $Target
+	fi
+
 	# Software build 
-	b65BuildSoftware $Target
+	b65BuildSoftware $Target soft
+
+	if [ -d "$Target/soft1" ]; then
+		b65BuildSoftware $Target soft1
+		b65MergeSoftware $Target
+	fi
+
+	# RAM programs (console load command)
+	if [ -d "$Target/ram" ]; then
+		b65BuildRamProgram $Target
+	fi
 
 	# if GHDL was found
 	if [ "$FOUND_GHDL" == "yes" ]; then
 
-		# VHDL build
-		b65Compile6502CPU $Target
-		b65CompileBoard   $Target
-		b65LinkBoard      $Target
+		if [ "$VERILATOR" == "yes" ] && [ -d "$Target/verilator" ]; then
+			# Compiled simulation (synthesized board, verilator C++ model)
+			b65Verilator $Target $SimRunTime
+		else
+			if [ "$VERILATOR" == "yes" ]; then
+				echo "INFO  : [$Target] has no verilator model, running the ghdl simulation"
+			fi
+
+			# VHDL build
+			b65Compile6502CPU $Target
+			b65CompileBoard   $Target
+			b65LinkBoard      $Target
 
-		# Run VHDL (simulation executing software)
-		b65Run $Target $SimRunTime $Wave
+			# Run VHDL (simulation executing software)
+			b65Run $Target $SimRunTime $Wave
+		fi
 	fi
 	
 	# Open GTKwave
@@ -0,0 +1,490 @@
+// Copyright 2023 Luca Bertossi
+// 
+// This file is part of B65.
+// 
+//     B65 is free software: you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation, either version 3 of the License, or
+//     (at your option) any later version.
+// 
+//     B65 is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+// 
+//     You should have received a copy of the GNU General Public License
+//     along with B65.  If not, see <http://www.gnu.org/licenses/>.
+
+///////////////////////////////////////////////////////////
+// Fake board for the b65link tools (see test.sh)
+//
+// A pseudo terminal plays the 003 board UART: the soft_dl download (exactly the
+// ROM size, then the boot), the console commands upgrade and binary and the
+// binary protocol of soft/proto.c on a 64k memory. Faults can be injected to
+// exercise the host retries.
+//
+// With -s it plays the testbench instead (see b65.vhd): the ROM is downloaded, the
+// requests recorded by the tools with sim:<file> are sent, the board output is
+// written to the capture file (b65cmd decode).
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "b65link.h"
+
+///////////////////////////////////////////////////////////
+// Defines
+
+// Board memory size
+#define MEMORY_SIZE		0x10000
+
+// Byte of the ROM changed by a corrupted download
+#define CORRUPT_OFFSET	0x100
+
+// Banner printed at the boot
+#define BOARD_BANNER	"\r\nB65 fake board\r\n> "
+
+///////////////////////////////////////////////////////////
+// Enumeratives
+
+typedef enum _BOARD_MODE_
+{
+	BOARD_DOWNLOAD,							// soft_dl block receiving the ROM
+	BOARD_CONSOLE,							// Console commands
+	BOARD_BINARY							// Binary protocol (console command binary)
+
+} BOARD_MODE;
+
+///////////////////////////////////////////////////////////
+// Structures
+
+typedef struct _BOARD_
+{
+	int				fd;						// Board output
+	BOARD_MODE		mode;
+	size_t			romSize;
+	size_t			received;				// Download bytes so far
+
+	// Console line
+	char			line[32];
+	size_t			lineLength;
+
+	// Request frame being received
+	unsigned char	frame[B65_MAX_PAYLOAD + 5];
+	size_t			frameLength;
+
+	// Counters and faults (the n-th event, 0 for none)
+	int				downloads;
+	int				requests;
+	int				reads;
+	int				corruptDownload;		// ROM byte changed after this download
+	int				dropRequests;			// First requests without a response
+	int				breakRead;				// Read response with a wrong checksum
+
+	unsigned char	memory[MEMORY_SIZE];
+
+} BOARD;
+
+///////////////////////////////////////////////////////////
+///
+/// Print the usage
+///
+///////////////////////////////////////////////////////////
+static void Usage(void)
+{
+	printf("Usage : \n");
+	printf("b65board [-c <n>] [-p <n>] [-f <n>] <link> <rom size>\n");
+	printf("b65board -s <rom file> <request file> <capture file>\n");
+	printf(" Fake board on a pseudo terminal, <link> is a symbolic link to it (the port of the tools)\n");
+	printf(" The board waits for the download of <rom size> bytes, as after its reset\n");
+	printf("  -c <n>            corrupt the ROM after the n-th download (verify fails)\n");
+	printf("  -p <n>            no response to the first n requests (ping retries)\n");
+	printf("  -f <n>            wrong checksum on the n-th read response\n");
+	printf("  -s                testbench: download the ROM, send the requests, capture the output\n");
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Write the board output
+///
+///////////////////////////////////////////////////////////
+static void BoardSend(BOARD *Board, const void *Data, size_t Length)
+{
+	const unsigned char	   *Byte = Data;
+	ssize_t					Written;
+
+	while (Length > 0)
+	{
+		Written = write(Board->fd, Byte, Length);
+		if (Written <= 0)
+			return;
+
+		Byte	+= Written;
+		Length	-= Written;
+	}
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Send a response frame
+///
+///////////////////////////////////////////////////////////
+static void BoardReply(BOARD *Board, unsigned char Status, const unsigned char *Data, unsigned char Length, int Broken)
+{
+	unsigned char	Header[4];
+	unsigned char	Sum;
+	size_t			Index;
+
+	Header[0]	= B65_SYNC_RESPONSE;
+	Header[1]	= Board->frame[1];
+	Header[2]	= Status;
+	Header[3]	= Length;
+
+	Sum = Header[1] + Header[2] + Header[3];
+	for (Index = 0; Index < Length; Index++)
+		Sum += Data[Index];
+
+	Sum = 0 - Sum;
+	if (Broken)
+		Sum ^= 0x5A;
+
+	BoardSend(Board, Header, 4);
+	BoardSend(Board, Data, Length);
+	BoardSend(Board, &Sum, 1);
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Execute a request frame (see ProtoExecute in proto.c)
+///
+///////////////////////////////////////////////////////////
+static void BoardExecute(BOARD *Board)
+{
+	unsigned char	Data[B65_MAX_DATA];
+	unsigned char	Length	= Board->frame[3];
+	unsigned char  *Payload	= &Board->frame[4];
+	unsigned short	Address	= Payload[0] | (Payload[1] << 8);
+	unsigned char	Sum		= 0;
+	size_t			Index;
+	int				Broken;
+
+	if (++Board->requests <= Board->dropRequests)
+	{
+		fprintf(stderr, "board: request %d dropped\n", Board->requests);
+		return;
+	}
+
+	for (Index = 1; Index < 5 + (size_t) Length; Index++)
+		Sum += Board->frame[Index];
+
+	if (Sum != 0)
+	{
+		BoardReply(Board, B65_ERR_CHECKSUM, NULL, 0, 0);
+		return;
+	}
+
+	switch (Board->frame[2])
+	{
+		case B65_CMD_PING:
+			Data[0] = B65_VERSION;
+			Data[1] = B65_MAX_DATA;
+			BoardReply(Board, B65_OK, Data, 2, 0);
+		return;
+
+		case B65_CMD_READ:
+		case B65_CMD_REG_READ:
+			if ((Length != 3) || (Payload[2] > B65_MAX_DATA))
+				break;
+
+			for (Index = 0; Index < Payload[2]; Index++)
+				Data[Index] = Board->memory[(Board->frame[2] == B65_CMD_READ) ? ((Address + Index) & 0xFFFF) : Address];
+
+			Broken = (Board->frame[2] == B65_CMD_READ) && (++Board->reads == Board->breakRead);
+			if (Broken)
+				fprintf(stderr, "board: read response %d broken\n", Board->reads);
+
+			BoardReply(Board, B65_OK, Data, Payload[2], Broken);
+		return;
+
+		case B65_CMD_WRITE:
+		case B65_CMD_REG_WRITE:
+			if (Length < 2)
+				break;
+
+			for (Index = 2; Index < Length; Index++)
+				Board->memory[(Board->frame[2] == B65_CMD_WRITE) ? ((Address + Index - 2) & 0xFFFF) : Address] = Payload[Index];
+
+			BoardReply(Board, B65_OK, NULL, 0, 0);
+		return;
+
+		// No CPU: the call returns 0
+		case B65_CMD_EXEC:
+			if (Length != 2)
+				break;
+
+			memset(Data, 0, 2);
+			BoardReply(Board, B65_OK, Data, 2, 0);
+		return;
+
+		case B65_CMD_EXIT:
+			BoardReply(Board, B65_OK, NULL, 0, 0);
+			Board->mode = BOARD_CONSOLE;
+		return;
+
+		default:
+			BoardReply(Board, B65_ERR_COMMAND, NULL, 0, 0);
+		return;
+	}
+
+	// Wrong payload length for the command
+	BoardReply(Board, B65_ERR_LENGTH, NULL, 0, 0);
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Process one byte received by the board
+///
+///////////////////////////////////////////////////////////
+static void BoardInput(BOARD *Board, unsigned char Byte)
+{
+	switch (Board->mode)
+	{
+		// The ROM ends at 0xFFFF, the board boots after the last byte
+		case BOARD_DOWNLOAD:
+			Board->memory[MEMORY_SIZE - Board->romSize + Board->received++] = Byte;
+			if (Board->received < Board->romSize)
+				break;
+
+			Board->downloads++;
+			fprintf(stderr, "board: download %d, %zu bytes\n", Board->downloads, Board->received);
+
+			if (Board->downloads == Board->corruptDownload)
+			{
+				Board->memory[MEMORY_SIZE - Board->romSize + CORRUPT_OFFSET] ^= 0xFF;
+				fprintf(stderr, "board: download %d corrupted at 0x%.4zX\n", Board->downloads, MEMORY_SIZE - Board->romSize + CORRUPT_OFFSET);
+			}
+
+			Board->mode			= BOARD_CONSOLE;
+			Board->lineLength	= 0;
+			BoardSend(Board, BOARD_BANNER, strlen(BOARD_BANNER));
+		break;
+
+		// CTRL+C clears the line, the commands are echoed
+		case BOARD_CONSOLE:
+			if (Byte == '\003')
+			{
+				Board->lineLength = 0;
+				break;
+			}
+
+			if (Byte != '\r')
+			{
+				if (Board->lineLength < sizeof(Board->line) - 1)
+					Board->line[Board->lineLength++] = Byte;
+
+				BoardSend(Board, &Byte, 1);
+				break;
+			}
+
+			Board->line[Board->lineLength]	= '\0';
+			Board->lineLength				= 0;
+
+			if (strcmp(Board->line, "upgrade") == 0)
+			{
+				BoardSend(Board, "\r\n", 2);
+				Board->mode		= BOARD_DOWNLOAD;
+				Board->received	= 0;
+			}
+			else if (strcmp(Board->line, "binary") == 0)
+			{
+				BoardSend(Board, "\r\n", 2);
+				Board->mode			= BOARD_BINARY;
+				Board->frameLength	= 0;
+			}
+			else
+				BoardSend(Board, "\r\n> ", 4);
+		break;
+
+		// Anything else than the sync byte is discarded before a frame
+		case BOARD_BINARY:
+			if ((Board->frameLength == 0) && (Byte != B65_SYNC_REQUEST))
+				break;
+
+			Board->frame[Board->frameLength++] = Byte;
+			if (Board->frameLength < 4)
+				break;
+
+			if (Board->frame[3] > B65_MAX_PAYLOAD)
+			{
+				BoardReply(Board, B65_ERR_LENGTH, NULL, 0, 0);
+				Board->frameLength = 0;
+			}
+			else if (Board->frameLength == 5 + (size_t) Board->frame[3])
+			{
+				Board->frameLength = 0;
+				BoardExecute(Board);
+			}
+		break;
+	}
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Open the pseudo terminal, the slave side is kept open
+/// (raw) so the tools can open and close it
+///
+///	\return	master file descriptor or -1
+///
+///////////////////////////////////////////////////////////
+static int BoardOpenPty(const char *Link)
+{
+	struct termios	Tty;
+	const char	   *Name;
+	int				Master;
+	int				Slave;
+
+	Master = posix_openpt(O_RDWR | O_NOCTTY);
+	if ((Master < 0) || (grantpt(Master) != 0) || (unlockpt(Master) != 0) || ((Name = ptsname(Master)) == NULL))
+		return -1;
+
+	Slave = open(Name, O_RDWR | O_NOCTTY);
+	if ((Slave < 0) || (tcgetattr(Slave, &Tty) != 0))
+		return -1;
+
+	cfmakeraw(&Tty);
+	if (tcsetattr(Slave, TCSANOW, &Tty) != 0)
+		return -1;
+
+	unlink(Link);
+	if (symlink(Name, Link) != 0)
+		return -1;
+
+	return Master;
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Play the testbench: the ROM download, then the host
+/// requests (b65.host), the output goes to the capture
+///
+///	\return	0 or 1 (an error is printed)
+///
+///////////////////////////////////////////////////////////
+static int BoardSimulation(BOARD *Board, const char *Rom, const char *Requests, const char *Capture)
+{
+	const char	   *Filename[2]	= { Rom, Requests };
+	FILE		   *File;
+	size_t			Index;
+	int				Byte;
+
+	Board->fd = open(Capture, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (Board->fd < 0)
+	{
+		printf("Error: unable to open [%s]\n", Capture);
+		return 1;
+	}
+
+	for (Index = 0; Index < 2; Index++)
+	{
+		File = fopen(Filename[Index], "rb");
+		if (File == NULL)
+		{
+			printf("Error: unable to open [%s]\n", Filename[Index]);
+			close(Board->fd);
+			return 1;
+		}
+
+		// The board takes exactly the ROM size
+		if (Index == 0)
+		{
+			fseek(File, 0, SEEK_END);
+			Board->romSize = ftell(File);
+			rewind(File);
+
+			if ((Board->romSize == 0) || (Board->romSize > MEMORY_SIZE))
+			{
+				printf("Error: invalid rom file [%s]\n", Rom);
+				fclose(File);
+				close(Board->fd);
+				return 1;
+			}
+		}
+
+		while ((Byte = fgetc(File)) != EOF)
+			BoardInput(Board, Byte);
+
+		fclose(File);
+	}
+
+	close(Board->fd);
+
+	return 0;
+}
+
+// Fake board command line tool
+int main(int argc, char **argv)
+{
+	static BOARD	Board;
+	unsigned char	Data[512];
+	ssize_t			Count;
+	ssize_t			Index;
+	int				Arg;
+
+	Board.mode = BOARD_DOWNLOAD;
+
+	if ((argc == 5) && (strcmp(argv[1], "-s") == 0))
+		return BoardSimulation(&Board, argv[2], argv[3], argv[4]);
+
+	for (Arg = 1; (Arg + 1 < argc) && (argv[Arg][0] == '-'); Arg += 2)
+	{
+		if (strcmp(argv[Arg], "-c") == 0)
+			Board.corruptDownload = atoi(argv[Arg + 1]);
+		else if (strcmp(argv[Arg], "-p") == 0)
+			Board.dropRequests = atoi(argv[Arg + 1]);
+		else if (strcmp(argv[Arg], "-f") == 0)
+			Board.breakRead = atoi(argv[Arg + 1]);
+		else
+		{
+			Usage();
+			return 1;
+		}
+	}
+
+	if (Arg + 2 != argc)
+	{
+		Usage();
+		return (argc == 1) ? 0 : 1;
+	}
+
+	Board.romSize = strtoul(argv[Arg + 1], NULL, 0);
+	if ((Board.romSize == 0) || (Board.romSize > MEMORY_SIZE))
+	{
+		printf("Error: invalid rom size [%s]\n", argv[Arg + 1]);
+		return 1;
+	}
+
+	Board.fd = BoardOpenPty(argv[Arg]);
+	if (Board.fd < 0)
+	{
+		printf("Error: unable to open the pseudo terminal [%s]\n", argv[Arg]);
+		return 1;
+	}
+
+	// Until killed
+	for (;;)
+	{
+		Count = read(Board.fd, Data, sizeof(Data));
+		if ((Count < 0) && (errno != EINTR) && (errno != EAGAIN) && (errno != EIO))
+			return 1;
+
+		for (Index = 0; Index < Count; Index++)
+			BoardInput(&Board, Data[Index]);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,269 @@
+// Copyright 2023 Luca Bertossi
+//
+// This file is part of B65.
+// 
+//     B65 is free software: you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation, either version 3 of the License, or
+//     (at your option) any later version.
+// 
+//     B65 is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+// 
+//     You should have received a copy of the GNU General Public License
+//     along with B65.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "b65link.h"
+
+// Board memory size
+#define MEMORY_SIZE		0x10000
+
+// Command line error (the board status are 8 bit)
+#define ERROR_ARGS		0x100
+
+///////////////////////////////////////////////////////////
+///
+/// Print the usage
+///
+///////////////////////////////////////////////////////////
+static void Usage(void)
+{
+	printf("Usage : \n");
+	printf("b65cmd <port> <command> [<command> ...]\n");
+	printf("b65cmd decode <capture file>\n");
+	printf(" port is the board serial port (e.g. /dev/ttyUSB1) or sim:<file> to write the\n");
+	printf(" requests for the simulation (b65.host, the responses are captured in b65.uart)\n");
+	printf("\n");
+	printf(" Commands (numbers are 0x hex or decimal):\n");
+	printf("  ping                              protocol version and max data per request\n");
+	printf("  read <address> <length>           hex dump of the memory\n");
+	printf("  save <address> <length> <file>    memory to file\n");
+	printf("  load <address> <file>             file to memory\n");
+	printf("  peek <address> <count>            read a register count times\n");
+	printf("  poke <address> <byte>             write a register\n");
+	printf("  exec <address>                    call the code at address (A/X returned)\n");
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Parse a number argument
+///
+///	\return	0 if valid, otherwise 1 (an error is printed)
+///
+///////////////////////////////////////////////////////////
+static int Number(const char *Arg, unsigned long Max, unsigned long *Value)
+{
+	char *End;
+
+	*Value = strtoul(Arg, &End, 0);
+	if ((*Arg == '\0') || (*End != '\0') || (*Value > Max))
+	{
+		printf("Error: invalid number [%s], maximum is [0x%lX]\n", Arg, Max);
+		return 1;
+	}
+
+	return 0;
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Print a hex dump, 16 bytes per line
+///
+///////////////////////////////////////////////////////////
+static void Dump(unsigned long Address, const unsigned char *Data, size_t Length)
+{
+	size_t Index;
+
+	for (Index = 0; Index < Length; Index++)
+	{
+		if ((Index % 16) == 0)
+			printf("%s%.4lX :", (Index > 0) ? "\n" : "", Address + Index);
+
+		printf(" %.2X", Data[Index]);
+	}
+
+	printf("\n");
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Decode the responses of a testbench capture file
+///
+///////////////////////////////////////////////////////////
+static int Decode(const char *Filename)
+{
+	B65_LINK		Link;
+	unsigned char	Payload[B65_MAX_PAYLOAD];
+	unsigned char	Seq;
+	unsigned char	Status;
+	unsigned char	Length;
+	int				Result;
+
+	if (b65OpenCapture(&Link, Filename) != 0)
+	{
+		printf("Error: unable to open [%s]\n", Filename);
+		return 2;
+	}
+
+	while ((Result = b65Receive(&Link, &Seq, &Status, Payload, &Length)) != B65_ERR_TIMEOUT)
+	{
+		if (Result != 0)
+		{
+			printf("Error: broken response\n");
+			continue;
+		}
+
+		printf("seq %3d status %d length %3d\n", Seq, Status, Length);
+		if (Length > 0)
+			Dump(0, Payload, Length);
+	}
+
+	return 0;
+}
+
+// Binary protocol command line client
+int main(int argc, char **argv)
+{
+	static unsigned char	Data[MEMORY_SIZE];
+	B65_LINK				Link;
+	unsigned long			Address;
+	unsigned long			Length;
+	unsigned long			Value;
+	unsigned short			Result;
+	unsigned char			Version;
+	unsigned char			MaxData;
+	unsigned char			Byte;
+	const char			   *Command;
+	FILE				   *File;
+	int						Arg;
+	int						Error	= 0;
+
+	if (argc < 3)
+	{
+		Usage();
+		return 0;
+	}
+
+	if (strcmp(argv[1], "decode") == 0)
+		return Decode(argv[2]);
+
+	Error = b65Open(&Link, argv[1]);
+	if (Error != 0)
+	{
+		printf("Error: unable to open the link on [%s] (%d)\n", argv[1], Error);
+		return 2;
+	}
+
+	for (Arg = 2; (Arg < argc) && (Error == 0); )
+	{
+		Command = argv[Arg++];
+
+		if (strcmp(Command, "ping") == 0)
+		{
+			Error = b65Ping(&Link, &Version, &MaxData);
+			if ((Error == 0) && !Link.record)
+				printf("version %d, max data %d\n", Version, MaxData);
+		}
+		else if ((strcmp(Command, "read") == 0) && (Arg + 2 <= argc))
+		{
+			if (Number(argv[Arg], 0xFFFF, &Address) || Number(argv[Arg + 1], MEMORY_SIZE - Address, &Length))
+				Error = ERROR_ARGS;
+			else if (((Error = b65Read(&Link, Address, Data, Length)) == 0) && !Link.record)
+				Dump(Address, Data, Length);
+
+			Arg += 2;
+		}
+		else if ((strcmp(Command, "save") == 0) && (Arg + 3 <= argc))
+		{
+			if (Number(argv[Arg], 0xFFFF, &Address) || Number(argv[Arg + 1], MEMORY_SIZE - Address, &Length))
+				Error = ERROR_ARGS;
+			else if (((Error = b65Read(&Link, Address, Data, Length)) == 0) && !Link.record)
+			{
+				File = fopen(argv[Arg + 2], "wb");
+				if ((File == NULL) || (fwrite(Data, 1, Length, File) != Length))
+				{
+					printf("Error: unable to write [%s]\n", argv[Arg + 2]);
+					Error = ERROR_ARGS;
+				}
+
+				if (File != NULL)
+					fclose(File);
+			}
+
+			Arg += 3;
+		}
+		else if ((strcmp(Command, "load") == 0) && (Arg + 2 <= argc))
+		{
+			if (Number(argv[Arg], 0xFFFF, &Address))
+				Error = ERROR_ARGS;
+			else
+			{
+				File = fopen(argv[Arg + 1], "rb");
+				if (File == NULL)
+				{
+					printf("Error: unable to open [%s]\n", argv[Arg + 1]);
+					Error = ERROR_ARGS;
+				}
+				else
+				{
+					Length = fread(Data, 1, MEMORY_SIZE - Address, File);
+					fclose(File);
+
+					Error = b65Write(&Link, Address, Data, Length);
+				}
+			}
+
+			Arg += 2;
+		}
+		else if ((strcmp(Command, "peek") == 0) && (Arg + 2 <= argc))
+		{
+			if (Number(argv[Arg], 0xFFFF, &Address) || Number(argv[Arg + 1], Link.maxData, &Length))
+				Error = ERROR_ARGS;
+			else if (((Error = b65RegRead(&Link, Address, Data, Length)) == 0) && !Link.record)
+				Dump(Address, Data, Length);
+
+			Arg += 2;
+		}
+		else if ((strcmp(Command, "poke") == 0) && (Arg + 2 <= argc))
+		{
+			if (Number(argv[Arg], 0xFFFF, &Address) || Number(argv[Arg + 1], 0xFF, &Value))
+				Error = ERROR_ARGS;
+			else
+			{
+				Byte	= Value;
+				Error	= b65RegWrite(&Link, Address, &Byte, 1);
+			}
+
+			Arg += 2;
+		}
+		else if ((strcmp(Command, "exec") == 0) && (Arg + 1 <= argc))
+		{
+			if (Number(argv[Arg], 0xFFFF, &Address))
+				Error = ERROR_ARGS;
+			else if (((Error = b65Exec(&Link, Address, &Result)) == 0) && !Link.record)
+				printf("A/X %.4X\n", Result);
+
+			Arg += 1;
+		}
+		else
+		{
+			printf("Error: unknown command or missing arguments [%s]\n", Command);
+			Error = ERROR_ARGS;
+		}
+
+		if (Error < 0)
+			printf("Error: link error [%d] on [%s]\n", Error, Command);
+		else if ((Error > 0) && (Error < ERROR_ARGS))
+			printf("Error: board status [%d] on [%s]\n", Error, Command);
+	}
+
+	b65Close(&Link);
+
+	return (Error == 0) ? 0 : 1;
+}
\ No newline at end of file
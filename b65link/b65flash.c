@@ -0,0 +1,227 @@
+// Copyright 2023 Luca Bertossi
+//
+// This file is part of B65.
+// 
+//     B65 is free software: you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation, either version 3 of the License, or
+//     (at your option) any later version.
+// 
+//     B65 is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+// 
+//     You should have received a copy of the GNU General Public License
+//     along with B65.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "b65link.h"
+
+// Board ROM sizes (see memory.map ROM_SIZE)
+#define ROM_SIZE_MIN	0x2000
+#define ROM_SIZE_MAX	0x6000
+#define ROM_SIZE_STEP	0x400
+
+// Command line error (the board status are 8 bit)
+#define ERROR_ARGS		0x100
+
+///////////////////////////////////////////////////////////
+///
+/// Print the usage
+///
+///////////////////////////////////////////////////////////
+static void Usage(void)
+{
+	printf("Usage : \n");
+	printf("b65flash [-u] [-n] [-r <retries>] <port> <rom file>\n");
+	printf(" Download b65.rom to the board (soft_dl block) and verify it with the binary protocol\n");
+	printf("  -u                the board runs a console: send the upgrade command first\n");
+	printf("                    (otherwise the board waits for the download after its reset)\n");
+	printf("  -n                no verification (the board software has no binary protocol)\n");
+	printf("  -r <retries>      downloads again after a failure, with upgrade (default 2)\n");
+	printf(" The exit code is 0 when the software is downloaded and verified\n");
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Print the download progress
+///
+///////////////////////////////////////////////////////////
+static void Progress(size_t Sent, size_t Length)
+{
+	printf("\r  sent %5zu / %zu bytes", Sent, Length);
+	fflush(stdout);
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Elapsed seconds from Start
+///
+///////////////////////////////////////////////////////////
+static double Elapsed(const struct timespec *Start)
+{
+	struct timespec Now;
+
+	clock_gettime(CLOCK_MONOTONIC, &Now);
+
+	return (Now.tv_sec - Start->tv_sec) + (Now.tv_nsec - Start->tv_nsec) / 1e9;
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Read the software image
+///
+///	\return	image length, 0 on error (an error is printed)
+///
+///////////////////////////////////////////////////////////
+static size_t ReadImage(const char *Filename, unsigned char *Image)
+{
+	FILE   *File;
+	size_t	Length;
+	int		Error;
+
+	File = fopen(Filename, "rb");
+	if (File == NULL)
+	{
+		printf("Error: unable to open [%s]\n", Filename);
+		return 0;
+	}
+
+	// One byte more to detect an image too large
+	Length	= fread(Image, 1, ROM_SIZE_MAX + 1, File);
+	Error	= ferror(File);
+	fclose(File);
+
+	if (Error)
+	{
+		printf("Error: unable to read [%s]\n", Filename);
+		return 0;
+	}
+
+	// The board takes exactly the code ram size, any other length hangs or corrupts the download
+	if ((Length < ROM_SIZE_MIN) || (Length > ROM_SIZE_MAX) || ((Length % ROM_SIZE_STEP) != 0))
+	{
+		printf("Error: [%s] is %zu bytes, a ROM image is 0x%X to 0x%X bytes in 0x%X steps\n", Filename, Length, ROM_SIZE_MIN, ROM_SIZE_MAX, ROM_SIZE_STEP);
+		return 0;
+	}
+
+	return Length;
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Read back the ROM with the binary protocol
+///
+///	\return	0, a board error status or a negative error
+///
+///////////////////////////////////////////////////////////
+static int Verify(const char *Port, const unsigned char *Image, size_t Length)
+{
+	static unsigned char	Data[ROM_SIZE_MAX];
+	B65_LINK				Link;
+	size_t					Index;
+	int						Result;
+
+	Result = b65Open(&Link, Port);
+	if (Result != 0)
+		return Result;
+
+	// The ROM ends at 0xFFFF
+	Result = b65Read(&Link, 0x10000 - Length, Data, Length);
+	b65Close(&Link);
+
+	if (Result != 0)
+		return Result;
+
+	for (Index = 0; Index < Length; Index++)
+	{
+		if (Data[Index] != Image[Index])
+		{
+			printf("  verify failed at 0x%.4zX : 0x%.2X instead of 0x%.2X\n", 0x10000 - Length + Index, Data[Index], Image[Index]);
+			return B65_ERR_FRAME;
+		}
+	}
+
+	return 0;
+}
+
+// Software download command line tool
+int main(int argc, char **argv)
+{
+	static unsigned char	Image[ROM_SIZE_MAX + 1];
+	struct timespec			Start;
+	const char			   *Port;
+	size_t					Length;
+	int						Upgrade	= 0;
+	int						Check	= 1;
+	int						Retries	= 2;
+	int						Attempt;
+	int						Arg;
+	int						Result	= ERROR_ARGS;
+
+	for (Arg = 1; (Arg < argc) && (argv[Arg][0] == '-'); Arg++)
+	{
+		if (strcmp(argv[Arg], "-u") == 0)
+			Upgrade = 1;
+		else if (strcmp(argv[Arg], "-n") == 0)
+			Check = 0;
+		else if ((strcmp(argv[Arg], "-r") == 0) && (Arg + 1 < argc))
+			Retries = atoi(argv[++Arg]);
+		else
+		{
+			Usage();
+			return 1;
+		}
+	}
+
+	if (Arg + 2 != argc)
+	{
+		Usage();
+		return (argc == 1) ? 0 : 1;
+	}
+
+	Port	= argv[Arg];
+	Length	= ReadImage(argv[Arg + 1], Image);
+	if (Length == 0)
+		return 1;
+
+	for (Attempt = 0; Attempt <= Retries; Attempt++)
+	{
+		// A retry finds the board running a software (the failed one or the previous one)
+		printf("download [%s] to [%s]%s\n", argv[Arg + 1], Port, (Upgrade || (Attempt > 0)) ? " with upgrade" : "");
+
+		clock_gettime(CLOCK_MONOTONIC, &Start);
+
+		Result = b65Download(Port, Image, Length, Upgrade || (Attempt > 0), Progress);
+		if (Result != 0)
+		{
+			printf("\nError: download failed (%d)\n", Result);
+			continue;
+		}
+
+		printf(" in %.2f s\n", Elapsed(&Start));
+
+		if (!Check)
+			break;
+
+		// The new software boots and prints its banner
+		usleep(B65_BOOT_MS * 1000);
+
+		Result = Verify(Port, Image, Length);
+		if (Result == 0)
+		{
+			printf("  verified\n");
+			break;
+		}
+
+		printf("Error: verify failed (%d)\n", Result);
+	}
+
+	return (Result == 0) ? 0 : 1;
+}
\ No newline at end of file
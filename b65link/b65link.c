@@ -0,0 +1,724 @@
+// Copyright 2023 Luca Bertossi
+//
+// This file is part of B65.
+// 
+//     B65 is free software: you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation, either version 3 of the License, or
+//     (at your option) any later version.
+// 
+//     B65 is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+// 
+//     You should have received a copy of the GNU General Public License
+//     along with B65.  If not, see <http://www.gnu.org/licenses/>.
+
+///////////////////////////////////////////////////////////
+// Includes
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "b65link.h"
+
+///////////////////////////////////////////////////////////
+// Defines
+
+// Console line that switches the board to the binary protocol (CTRL+C clears the line first)
+#define B65_CONSOLE_START		"\003binary\r"
+
+// Console line that restarts the software download (CTRL+C clears the line first)
+#define B65_CONSOLE_UPGRADE		"\003upgrade\r"
+
+// Port prefix of the simulation request file
+#define B65_PORT_SIM			"sim:"
+
+///////////////////////////////////////////////////////////
+// Static functions
+
+///////////////////////////////////////////////////////////
+///
+/// Write all the bytes
+///
+///	\return	0 or B65_ERR_IO
+///
+///////////////////////////////////////////////////////////
+static int b65WriteAll(B65_LINK *Link, const unsigned char *Data, size_t Length)
+{
+	ssize_t Written;
+
+	while (Length > 0)
+	{
+		Written = write(Link->fd, Data, Length);
+		if (Written <= 0)
+			return B65_ERR_IO;
+
+		Data	+= Written;
+		Length	-= Written;
+	}
+
+	return 0;
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Read one byte (the serial port is read in blocks)
+///
+///	\return	0, B65_ERR_TIMEOUT or B65_ERR_IO
+///
+///////////////////////////////////////////////////////////
+static int b65ReadByte(B65_LINK *Link, unsigned char *Byte)
+{
+	struct pollfd	Poll;
+	ssize_t			Count;
+
+	if (Link->rxIndex == Link->rxCount)
+	{
+		Poll.fd			= Link->fd;
+		Poll.events		= POLLIN;
+		Poll.revents	= 0;
+
+		if (poll(&Poll, 1, B65_TIMEOUT_MS) <= 0)
+			return B65_ERR_TIMEOUT;
+
+		Count = read(Link->fd, Link->rx, sizeof(Link->rx));
+		if (Count < 0)
+			return B65_ERR_IO;
+
+		// End of a capture file
+		if (Count == 0)
+			return B65_ERR_TIMEOUT;
+
+		Link->rxCount	= Count;
+		Link->rxIndex	= 0;
+	}
+
+	*Byte = Link->rx[Link->rxIndex++];
+
+	return 0;
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Send one request frame
+///
+///	\return	0 or B65_ERR_IO
+///
+///////////////////////////////////////////////////////////
+static int b65SendRequest(B65_LINK *Link, B65_REQUEST *Request)
+{
+	unsigned char	Frame[B65_MAX_PAYLOAD + 5];
+	unsigned char	Sum;
+	size_t			Index;
+
+	Request->seq	= Link->seq++;
+
+	Frame[0]		= B65_SYNC_REQUEST;
+	Frame[1]		= Request->seq;
+	Frame[2]		= Request->command;
+	Frame[3]		= Request->length;
+	memcpy(&Frame[4], Request->payload, Request->length);
+
+	// The 8 bit sum from seq to checksum is zero
+	Sum = 0;
+	for (Index = 1; Index < 4 + (size_t) Request->length; Index++)
+		Sum += Frame[Index];
+
+	Frame[4 + Request->length] = (unsigned char) (0 - Sum);
+
+	return b65WriteAll(Link, Frame, 5 + Request->length);
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Open a serial port at B65_BAUD_RATE, raw mode
+///
+///	\return	file descriptor or -1
+///
+///////////////////////////////////////////////////////////
+static int b65OpenSerial(const char *Port)
+{
+	struct termios	Tty;
+	int				fd;
+
+	fd = open(Port, O_RDWR | O_NOCTTY);
+	if (fd < 0)
+		return -1;
+
+	if (tcgetattr(fd, &Tty) != 0)
+	{
+		close(fd);
+		return -1;
+	}
+
+	cfmakeraw(&Tty);
+	Tty.c_cflag		|= CLOCAL | CREAD;
+	Tty.c_cflag		&= ~CRTSCTS;
+	Tty.c_cc[VMIN]	 = 1;
+	Tty.c_cc[VTIME]	 = 0;
+
+	if ((cfsetispeed(&Tty, B921600) != 0) || (cfsetospeed(&Tty, B921600) != 0) || (tcsetattr(fd, TCSANOW, &Tty) != 0))
+	{
+		close(fd);
+		return -1;
+	}
+
+	return fd;
+}
+
+///////////////////////////////////////////////////////////
+// Functions
+
+///////////////////////////////////////////////////////////
+///
+/// Open the link and switch the board to the binary protocol
+///
+///	\param	Link	:	Link context
+///	\param	Port	:	serial port, or "sim:<file>" to write the
+///						requests to a file (simulation, see b65.vhd)
+///
+///	\return	0 or a negative error
+///
+///////////////////////////////////////////////////////////
+int b65Open(B65_LINK *Link, const char *Port)
+{
+	unsigned char	Flush[B65_MAX_PAYLOAD + 5];
+	unsigned char	Version;
+	unsigned char	MaxData;
+	int				Retry;
+	int				Result;
+
+	memset(Link, 0, sizeof(B65_LINK));
+	Link->fd		= -1;					// not open: b65Close does nothing
+	Link->maxData	= B65_MAX_DATA;
+
+	// Simulation: the requests are recorded, the responses come from the testbench capture
+	if (strncmp(Port, B65_PORT_SIM, strlen(B65_PORT_SIM)) == 0)
+	{
+		Link->record	= 1;
+		Link->fd		= open(Port + strlen(B65_PORT_SIM), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+		if (Link->fd < 0)
+			return B65_ERR_IO;
+
+		return b65WriteAll(Link, (const unsigned char*) B65_CONSOLE_START, strlen(B65_CONSOLE_START));
+	}
+
+	Link->fd = b65OpenSerial(Port);
+	if (Link->fd < 0)
+		return B65_ERR_IO;
+
+	// The console text before the binary mode is discarded by the response sync
+	Result = b65WriteAll(Link, (const unsigned char*) B65_CONSOLE_START, strlen(B65_CONSOLE_START));
+
+	for (Retry = 0; (Result == 0) || (Result == B65_ERR_TIMEOUT); Retry++)
+	{
+		Result = b65Ping(Link, &Version, &MaxData);
+		if (Result == 0)
+		{
+			if ((Version != B65_VERSION) || (MaxData == 0) || (MaxData > B65_MAX_DATA))
+				Result = B65_ERR_FRAME;
+			else
+				Link->maxData = MaxData;
+
+			break;
+		}
+
+		if (Retry == 2)
+			break;
+
+		// A broken request may be waiting for its bytes: complete it, then forget any response
+		memset(Flush, 0, sizeof(Flush));
+		b65WriteAll(Link, Flush, sizeof(Flush));
+		usleep(100000);
+		tcflush(Link->fd, TCIFLUSH);
+		Link->rxCount = 0;
+		Link->rxIndex = 0;
+		Result = 0;
+	}
+
+	if (Result != 0)
+	{
+		close(Link->fd);
+		Link->fd = -1;
+	}
+
+	return Result;
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Open a file of received bytes (the testbench capture,
+/// see b65.vhd) to decode the responses with b65Receive
+///
+///	\param	Link		:	Link context
+///	\param	Filename	:	capture file
+///
+///	\return	0 or B65_ERR_IO
+///
+///////////////////////////////////////////////////////////
+int b65OpenCapture(B65_LINK *Link, const char *Filename)
+{
+	memset(Link, 0, sizeof(B65_LINK));
+	Link->fd = -1;							// not open: b65Close does nothing
+
+	Link->fd = open(Filename, O_RDONLY);
+
+	return (Link->fd < 0) ? B65_ERR_IO : 0;
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Send the board back to the console and close the link
+///
+///	\param	Link	:	Link context
+///
+///////////////////////////////////////////////////////////
+void b65Close(B65_LINK *Link)
+{
+	B65_REQUEST Request;
+
+	if (Link->fd < 0)
+		return;
+
+	memset(&Request, 0, sizeof(Request));
+	Request.command = B65_CMD_EXIT;
+
+	b65Transfer(Link, &Request, 1);
+
+	close(Link->fd);
+	Link->fd = -1;
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Receive one response frame
+///
+///	\param	Link	:	Link context
+///	\param	Seq		:	response seq
+///	\param	Status	:	response status
+///	\param	Payload	:	response payload (B65_MAX_PAYLOAD bytes)
+///	\param	Length	:	response payload length
+///
+///	\return	0 or a negative error
+///
+///////////////////////////////////////////////////////////
+int b65Receive(B65_LINK *Link, unsigned char *Seq, unsigned char *Status, unsigned char *Payload, unsigned char *Length)
+{
+	unsigned char	Header[3];
+	unsigned char	Byte;
+	unsigned char	Sum;
+	size_t			Index;
+	int				Result;
+
+	// Skip anything before the sync (console text)
+	do
+	{
+		Result = b65ReadByte(Link, &Byte);
+		if (Result != 0)
+			return Result;
+	}
+	while (Byte != B65_SYNC_RESPONSE);
+
+	for (Index = 0; Index < 3; Index++)
+	{
+		Result = b65ReadByte(Link, &Header[Index]);
+		if (Result != 0)
+			return Result;
+	}
+
+	if (Header[2] > B65_MAX_PAYLOAD)
+		return B65_ERR_FRAME;
+
+	Sum = Header[0] + Header[1] + Header[2];
+	for (Index = 0; Index <= Header[2]; Index++)
+	{
+		Result = b65ReadByte(Link, &Byte);
+		if (Result != 0)
+			return Result;
+
+		if (Index < Header[2])
+			Payload[Index] = Byte;
+
+		Sum += Byte;
+	}
+
+	if (Sum != 0)
+		return B65_ERR_FRAME;
+
+	*Seq	= Header[0];
+	*Status	= Header[1];
+	*Length	= Header[2];
+
+	return 0;
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Send the requests and collect the responses
+///
+/// The requests are sent while the bytes waiting for a
+/// response fit B65_WINDOW, so the board RX ring never
+/// overflows and the line is kept busy
+///
+///	\param	Link	:	Link context
+///	\param	Request	:	requests (status and response are set)
+///	\param	Count	:	number of requests
+///
+///	\return	0, the first board error status or a negative error
+///
+///////////////////////////////////////////////////////////
+int b65Transfer(B65_LINK *Link, B65_REQUEST *Request, size_t Count)
+{
+	unsigned char	Payload[B65_MAX_PAYLOAD];
+	unsigned char	Seq;
+	size_t			Sent		= 0;
+	size_t			Done		= 0;
+	size_t			Pending		= 0;
+	int				Error		= 0;
+	int				Result;
+
+	while (Done < Count)
+	{
+		// Fill the window (at least one request)
+		while ((Sent < Count) && ((Sent == Done) || (Pending + Request[Sent].length + 5 <= B65_WINDOW)))
+		{
+			Result = b65SendRequest(Link, &Request[Sent]);
+			if (Result != 0)
+				return Result;
+
+			Pending += Request[Sent].length + 5;
+			Sent++;
+		}
+
+		// Simulation: no response
+		if (Link->record)
+		{
+			Done	= Sent;
+			Pending	= 0;
+			continue;
+		}
+
+		Result = b65Receive(Link, &Seq, &Request[Done].status, Payload, &Request[Done].responseLength);
+		if (Result != 0)
+			return Result;
+
+		if (Seq != Request[Done].seq)
+			return B65_ERR_FRAME;
+
+		if ((Request[Done].status == B65_OK) && (Request[Done].responseLength > Request[Done].responseSize))
+			return B65_ERR_FRAME;
+
+		if ((Request[Done].status == B65_OK) && (Request[Done].response != NULL))
+			memcpy(Request[Done].response, Payload, Request[Done].responseLength);
+
+		if ((Error == 0) && (Request[Done].status != B65_OK))
+			Error = Request[Done].status;
+
+		Pending -= Request[Done].length + 5;
+		Done++;
+	}
+
+	return Error;
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Check the board protocol
+///
+///	\param	Link	:	Link context
+///	\param	Version	:	board protocol version
+///	\param	MaxData	:	board max data per request
+///
+///	\return	0, a board error status or a negative error
+///
+///////////////////////////////////////////////////////////
+int b65Ping(B65_LINK *Link, unsigned char *Version, unsigned char *MaxData)
+{
+	B65_REQUEST		Request;
+	unsigned char	Response[2]	= { B65_VERSION, B65_MAX_DATA };
+	int				Result;
+
+	memset(&Request, 0, sizeof(Request));
+	Request.command		= B65_CMD_PING;
+	Request.response	= Response;
+	Request.responseSize	= sizeof(Response);
+
+	Result = b65Transfer(Link, &Request, 1);
+	if ((Result == 0) && (!Link->record) && (Request.responseLength != 2))
+		Result = B65_ERR_FRAME;
+
+	*Version	= Response[0];
+	*MaxData	= Response[1];
+
+	return Result;
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Read or write memory with pipelined requests
+///
+///	\return	0, a board error status or a negative error
+///
+///////////////////////////////////////////////////////////
+static int b65Memory(B65_LINK *Link, unsigned char Command, unsigned short Address, unsigned char *Data, size_t Length)
+{
+	B65_REQUEST	   *Request;
+	size_t			Count;
+	size_t			Index;
+	size_t			Offset;
+	size_t			Size;
+	int				Result;
+
+	if (Length == 0)
+		return 0;
+
+	Count	= (Length + Link->maxData - 1) / Link->maxData;
+	Request	= calloc(Count, sizeof(B65_REQUEST));
+	if (Request == NULL)
+		return B65_ERR_IO;
+
+	for (Index = 0, Offset = 0; Index < Count; Index++, Offset += Size)
+	{
+		Size = Length - Offset;
+		if (Size > Link->maxData)
+			Size = Link->maxData;
+
+		Request[Index].command		= Command;
+		Request[Index].payload[0]	= (Address + Offset) & 0xFF;
+		Request[Index].payload[1]	= (Address + Offset) >> 8;
+
+		if (Command == B65_CMD_READ)
+		{
+			Request[Index].length		= 3;
+			Request[Index].payload[2]	= Size;
+			Request[Index].response		= &Data[Offset];
+			Request[Index].responseSize	= Size;
+		}
+		else
+		{
+			Request[Index].length		= 2 + Size;
+			memcpy(&Request[Index].payload[2], &Data[Offset], Size);
+		}
+	}
+
+	Result = b65Transfer(Link, Request, Count);
+
+	free(Request);
+
+	return Result;
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Read memory
+///
+///	\param	Link	:	Link context
+///	\param	Address	:	start address
+///	\param	Data	:	read bytes
+///	\param	Length	:	number of bytes
+///
+///	\return	0, a board error status or a negative error
+///
+///////////////////////////////////////////////////////////
+int b65Read(B65_LINK *Link, unsigned short Address, unsigned char *Data, size_t Length)
+{
+	return b65Memory(Link, B65_CMD_READ, Address, Data, Length);
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Write memory
+///
+///	\param	Link	:	Link context
+///	\param	Address	:	start address
+///	\param	Data	:	bytes to write
+///	\param	Length	:	number of bytes
+///
+///	\return	0, a board error status or a negative error
+///
+///////////////////////////////////////////////////////////
+int b65Write(B65_LINK *Link, unsigned short Address, const unsigned char *Data, size_t Length)
+{
+	return b65Memory(Link, B65_CMD_WRITE, Address, (unsigned char*) Data, Length);
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Read a register Count times (e.g. a fifo)
+///
+///	\param	Link	:	Link context
+///	\param	Address	:	register address
+///	\param	Data	:	read bytes
+///	\param	Count	:	number of reads (up to the board max data)
+///
+///	\return	0, a board error status or a negative error
+///
+///////////////////////////////////////////////////////////
+int b65RegRead(B65_LINK *Link, unsigned short Address, unsigned char *Data, unsigned char Count)
+{
+	B65_REQUEST Request;
+
+	if (Count > Link->maxData)
+		return B65_ERR_LENGTH;
+
+	memset(&Request, 0, sizeof(Request));
+	Request.command		= B65_CMD_REG_READ;
+	Request.length		= 3;
+	Request.payload[0]	= Address & 0xFF;
+	Request.payload[1]	= Address >> 8;
+	Request.payload[2]	= Count;
+	Request.response	= Data;
+	Request.responseSize	= Count;
+
+	return b65Transfer(Link, &Request, 1);
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Write a register Count times (e.g. a fifo)
+///
+///	\param	Link	:	Link context
+///	\param	Address	:	register address
+///	\param	Data	:	bytes to write in order
+///	\param	Count	:	number of writes (up to the board max data)
+///
+///	\return	0, a board error status or a negative error
+///
+///////////////////////////////////////////////////////////
+int b65RegWrite(B65_LINK *Link, unsigned short Address, const unsigned char *Data, unsigned char Count)
+{
+	B65_REQUEST Request;
+
+	if (Count > Link->maxData)
+		return B65_ERR_LENGTH;
+
+	memset(&Request, 0, sizeof(Request));
+	Request.command		= B65_CMD_REG_WRITE;
+	Request.length		= 2 + Count;
+	Request.payload[0]	= Address & 0xFF;
+	Request.payload[1]	= Address >> 8;
+	memcpy(&Request.payload[2], Data, Count);
+
+	return b65Transfer(Link, &Request, 1);
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Call the code at Address, the response comes when it returns
+///
+///	\param	Link	:	Link context
+///	\param	Address	:	code address
+///	\param	Result	:	returned A (low) and X (high)
+///
+///	\return	0, a board error status or a negative error
+///
+///////////////////////////////////////////////////////////
+int b65Exec(B65_LINK *Link, unsigned short Address, unsigned short *Result)
+{
+	B65_REQUEST		Request;
+	unsigned char	Response[2] = { 0, 0 };
+	int				Status;
+
+	memset(&Request, 0, sizeof(Request));
+	Request.command		= B65_CMD_EXEC;
+	Request.length		= 2;
+	Request.payload[0]	= Address & 0xFF;
+	Request.payload[1]	= Address >> 8;
+	Request.response	= Response;
+	Request.responseSize	= sizeof(Response);
+
+	Status	= b65Transfer(Link, &Request, 1);
+	*Result	= Response[0] | (Response[1] << 8);
+
+	return Status;
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Download a software image to the board (soft_dl block)
+///
+/// The image goes out with large non-blocking writes, so
+/// the line is never idle; the board takes exactly the
+/// code ram size, then it boots the new software
+///
+///	\param	Port		:	serial port
+///	\param	Image		:	b65.rom content
+///	\param	Length		:	image length (the board ROM size)
+///	\param	Upgrade		:	send the console command upgrade first
+///							(otherwise the board waits for the download
+///							after its reset)
+///	\param	Progress	:	progress callback (NULL for none)
+///
+///	\return	0, B65_ERR_IO or B65_ERR_TIMEOUT
+///
+///////////////////////////////////////////////////////////
+int b65Download(const char *Port, const unsigned char *Image, size_t Length, int Upgrade, B65_PROGRESS Progress)
+{
+	B65_LINK		Link;
+	struct pollfd	Poll;
+	size_t			Sent	= 0;
+	ssize_t			Written;
+	int				Result	= 0;
+
+	memset(&Link, 0, sizeof(B65_LINK));
+
+	Link.fd = b65OpenSerial(Port);
+	if (Link.fd < 0)
+		return B65_ERR_IO;
+
+	// The download starts at the console command, the echo is discarded
+	if (Upgrade)
+	{
+		Result = b65WriteAll(&Link, (const unsigned char*) B65_CONSOLE_UPGRADE, strlen(B65_CONSOLE_UPGRADE));
+		tcdrain(Link.fd);
+		usleep(B65_UPGRADE_MS * 1000);
+		tcflush(Link.fd, TCIOFLUSH);
+	}
+
+	if ((Result == 0) && (fcntl(Link.fd, F_SETFL, fcntl(Link.fd, F_GETFL) | O_NONBLOCK) != 0))
+		Result = B65_ERR_IO;
+
+	while ((Result == 0) && (Sent < Length))
+	{
+		Poll.fd			= Link.fd;
+		Poll.events		= POLLOUT;
+		Poll.revents	= 0;
+
+		if (poll(&Poll, 1, B65_TIMEOUT_MS) <= 0)
+		{
+			Result = B65_ERR_TIMEOUT;
+			break;
+		}
+
+		// As much as the driver takes
+		Written = write(Link.fd, Image + Sent, Length - Sent);
+		if (Written < 0)
+		{
+			if ((errno != EAGAIN) && (errno != EINTR))
+				Result = B65_ERR_IO;
+
+			continue;
+		}
+
+		Sent += Written;
+
+		if (Progress != NULL)
+			Progress(Sent, Length);
+	}
+
+	// Wait until the last byte is on the line
+	if (Result == 0)
+		tcdrain(Link.fd);
+
+	close(Link.fd);
+
+	return Result;
+}
\ No newline at end of file
@@ -0,0 +1,128 @@
+// Copyright 2023 Luca Bertossi
+//
+// This file is part of B65.
+// 
+//     B65 is free software: you can redistribute it and/or modify
+//     it under the terms of the GNU General Public License as published by
+//     the Free Software Foundation, either version 3 of the License, or
+//     (at your option) any later version.
+// 
+//     B65 is distributed in the hope that it will be useful,
+//     but WITHOUT ANY WARRANTY; without even the implied warranty of
+//     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//     GNU General Public License for more details.
+// 
+//     You should have received a copy of the GNU General Public License
+//     along with B65.  If not, see <http://www.gnu.org/licenses/>.
+
+///////////////////////////////////////////////////////////
+// b65 binary protocol host library
+//
+// The board side is 003-target-soft-dl/soft/proto.c (console command 'binary'):
+// frames and values below are the same of proto.h
+//
+// Request  : B65_SYNC_REQUEST  seq command length [payload] checksum
+// Response : B65_SYNC_RESPONSE seq status  length [payload] checksum
+//
+// Requests are pipelined: they are sent while the bytes waiting for a response
+// fit the board RX ring (B65_WINDOW), the responses come back in order.
+
+#include <stddef.h>
+
+///////////////////////////////////////////////////////////
+// Defines
+
+#define B65_VERSION				1
+
+#define B65_SYNC_REQUEST		0xB6
+#define B65_SYNC_RESPONSE		0xB7
+
+#define B65_MAX_DATA			128
+#define B65_MAX_PAYLOAD			(B65_MAX_DATA + 2)
+
+// Commands
+#define B65_CMD_PING			0x00
+#define B65_CMD_READ			0x01
+#define B65_CMD_WRITE			0x02
+#define B65_CMD_REG_READ		0x03
+#define B65_CMD_REG_WRITE		0x04
+#define B65_CMD_EXEC			0x05
+#define B65_CMD_EXIT			0x06
+
+// Board status (positive return values)
+#define B65_OK					0x00
+#define B65_ERR_CHECKSUM		0x01
+#define B65_ERR_COMMAND			0x02
+#define B65_ERR_LENGTH			0x03
+
+// Host errors (negative return values)
+#define B65_ERR_IO				-1		// Serial port or file error
+#define B65_ERR_TIMEOUT			-2		// No response (or end of the capture file)
+#define B65_ERR_FRAME			-3		// Broken response or unexpected seq
+
+// Request bytes on the wire without a response (the board RX ring is 256 bytes)
+#define B65_WINDOW				224
+
+// Board UART
+#define B65_BAUD_RATE			921600
+
+// Response timeout
+#define B65_TIMEOUT_MS			1000
+
+// Board software download (see soft-dl.vhd): time to enter the download after the console
+// command upgrade, time to boot the new software after the last byte
+#define B65_UPGRADE_MS			100
+#define B65_BOOT_MS				200
+
+///////////////////////////////////////////////////////////
+// Structures
+
+typedef struct _B65_LINK_
+{
+	int				fd;							// Serial port, request file or capture file
+	int				record;						// Requests are written to a file (simulation), no response
+	unsigned char	seq;						// Next request seq
+	unsigned char	maxData;					// Board max data per request (see b65Ping)
+
+	// Received bytes not parsed yet
+	unsigned char	rx[512];
+	size_t			rxCount;
+	size_t			rxIndex;
+
+} B65_LINK;
+
+typedef struct _B65_REQUEST_
+{
+	unsigned char	command;
+	unsigned char	length;
+	unsigned char	payload[B65_MAX_PAYLOAD];
+
+	unsigned char  *response;					// Response payload destination (NULL to discard)
+	unsigned char	responseSize;				// Response payload destination size
+	unsigned char	responseLength;				// Response payload length (set by b65Transfer)
+	unsigned char	status;						// Response status (set by b65Transfer)
+	unsigned char	seq;						// Request seq (set by b65Transfer)
+
+} B65_REQUEST;
+
+// Download progress (bytes sent so far)
+typedef void (*B65_PROGRESS)(size_t Sent, size_t Length);
+
+///////////////////////////////////////////////////////////
+// Functions
+
+int		b65Open			(B65_LINK *Link, const char *Port);
+int		b65OpenCapture	(B65_LINK *Link, const char *Filename);
+void	b65Close		(B65_LINK *Link);
+
+int		b65Transfer		(B65_LINK *Link, B65_REQUEST *Request, size_t Count);
+int		b65Receive		(B65_LINK *Link, unsigned char *Seq, unsigned char *Status, unsigned char *Payload, unsigned char *Length);
+
+int		b65Ping			(B65_LINK *Link, unsigned char *Version, unsigned char *MaxData);
+int		b65Read			(B65_LINK *Link, unsigned short Address, unsigned char *Data, size_t Length);
+int		b65Write		(B65_LINK *Link, unsigned short Address, const unsigned char *Data, size_t Length);
+int		b65RegRead		(B65_LINK *Link, unsigned short Address, unsigned char *Data, unsigned char Count);
+int		b65RegWrite		(B65_LINK *Link, unsigned short Address, const unsigned char *Data, unsigned char Count);
+int		b65Exec			(B65_LINK *Link, unsigned short Address, unsigned short *Result);
+
+int		b65Download		(const char *Port, const unsigned char *Image, size_t Length, int Upgrade, B65_PROGRESS Progress);
\ No newline at end of file
@@ -0,0 +1,212 @@
+#!/bin/bash
+
+# Copyright 2023 Luca Bertossi
+#
+# This file is part of B65.
+#
+#     B65 is free software: you can redistribute it and/or modify
+#     it under the terms of the GNU General Public License as published by
+#     the Free Software Foundation, either version 3 of the License, or
+#     (at your option) any later version.
+#
+#     B65 is distributed in the hope that it will be useful,
+#     but WITHOUT ANY WARRANTY; without even the implied warranty of
+#     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#     GNU General Public License for more details.
+#
+#     You should have received a copy of the GNU General Public License
+#     along with B65.  If not, see <http://www.gnu.org/licenses/>.
+
+# b65link tools against the fake board (b65board, a pseudo terminal): run with make test
+# With ghdl as argument only the sim: round trip runs, on the 003 testbench (b65.sh, needs ghdl and
+# cc65): run with make test-ghdl
+# The exit code is the number of failed checks
+
+FOLDER_TEST=$(mktemp -d)
+PORT=$FOLDER_TEST/board
+FAILED=0
+BOARD_PID=0
+
+testCleanup()
+{
+	if [ $BOARD_PID -ne 0 ]; then
+		kill $BOARD_PID 2> /dev/null
+		wait $BOARD_PID 2> /dev/null
+	fi
+
+	BOARD_PID=0
+}
+
+testBoard()
+{
+	local Size=$1
+
+	# Fake board with the ROM size and its options, the port is ready when the link exists
+	shift
+	testCleanup
+	rm -f $PORT
+	./b65board "$@" $PORT $Size 2>> $FOLDER_TEST/board.log &
+	BOARD_PID=$!
+
+	for Retry in $(seq 50); do
+		[ -e $PORT ] && return
+		sleep 0.1
+	done
+
+	echo "ERROR : the fake board did not start"
+	exit 1
+}
+
+testCheck()
+{
+	local Name=$1
+	local Expected=$2
+	local Result=$3
+	local Pattern=$4
+
+	if [ "$Result" -ne "$Expected" ]; then
+		echo "FAIL  : $Name, exit code $Result instead of $Expected"
+		FAILED=$((FAILED + 1))
+	elif [ -n "$Pattern" ] && ! grep -q -- "$Pattern" $FOLDER_TEST/out.log; then
+		echo "FAIL  : $Name, [$Pattern] not in the output"
+		FAILED=$((FAILED + 1))
+	else
+		echo "PASS  : $Name"
+		return
+	fi
+
+	sed 's/^/        /' $FOLDER_TEST/out.log
+}
+
+testFlash()
+{
+	./b65flash "$@" > $FOLDER_TEST/out.log 2>&1
+}
+
+testRoundTrip()
+{
+	local Board=$1
+	local Root
+	local Host=$FOLDER_TEST/b65.host
+	local Capture=$FOLDER_TEST/b65.uart
+	local Result
+
+	# Requests recorded with sim: (seq 0 to 5: ping, write, read, register write, register read, exit),
+	# at the RAM programs area (see ram/ram.cfg), within the board RX ring
+	head -c 64 /dev/urandom > $FOLDER_TEST/data.bin
+	if ! ./b65cmd sim:$Host ping load 0x1000 $FOLDER_TEST/data.bin read 0x1000 64 poke 0x1040 0x5A peek 0x1040 1 > $FOLDER_TEST/out.log; then
+		testCheck "b65cmd sim: requests" 0 1
+		return
+	fi
+
+	# The board runs them, its output is the capture
+	if [ "$Board" == "ghdl" ]; then
+		# Repository root from b65link or out/b65link
+		Root=$(cd ..; [ -e b65.sh ] || cd ..; pwd)
+		Host=$Root/out/003-target-soft-dl/vhdl/b65.host
+		Capture=$Root/out/003-target-soft-dl/vhdl/b65.uart
+
+		mkdir -p $(dirname $Host)
+		cp $FOLDER_TEST/b65.host $Host
+		(cd $Root; bash b65.sh 003-target-soft-dl 120ms) > $FOLDER_TEST/out.log 2>&1
+		Result=$?
+		rm -f $Host
+		testCheck "ghdl testbench run" 0 $Result
+	else
+		./b65board -s $FOLDER_TEST/8k.rom $Host $Capture 2>> $FOLDER_TEST/board.log
+		Result=$?
+		testCheck "b65board -s run" 0 $Result
+	fi
+
+	if [ $Result -ne 0 ]; then
+		return
+	fi
+
+	# Expected responses, the read data is the written one
+	{
+		echo "seq   0 status 0 length   2"
+		echo "0000 : 01 80"
+		echo "seq   1 status 0 length   0"
+		echo "seq   2 status 0 length  64"
+		od -An -v -tx1 -w16 $FOLDER_TEST/data.bin | tr a-f A-F | awk '{ printf "%.4X :", (NR - 1) * 16; for (i = 1; i <= NF; i++) printf " %s", $i; printf "\n" }'
+		echo "seq   3 status 0 length   0"
+		echo "seq   4 status 0 length   1"
+		echo "0000 : 5A"
+		echo "seq   5 status 0 length   0"
+	} > $FOLDER_TEST/expected.log
+
+	./b65cmd decode $Capture > $FOLDER_TEST/decode.log
+	diff $FOLDER_TEST/expected.log $FOLDER_TEST/decode.log > $FOLDER_TEST/out.log
+	testCheck "b65cmd sim: round trip on $Board, decoded capture" 0 $?
+}
+
+trap "testCleanup; rm -rf $FOLDER_TEST" EXIT
+
+# Images: 8k and 24k of random bytes
+head -c 8192 /dev/urandom > $FOLDER_TEST/8k.rom
+head -c 24576 /dev/urandom > $FOLDER_TEST/24k.rom
+head -c 8193 /dev/urandom > $FOLDER_TEST/bad.rom
+
+if [ "$1" == "ghdl" ]; then
+	testRoundTrip ghdl
+	exit $FAILED
+fi
+
+# b65flash: download after the reset, then verify (the ROM read back from 0x10000 - length)
+testBoard 0x2000
+testFlash $PORT $FOLDER_TEST/8k.rom
+testCheck "b65flash 8k" 0 $? "verified"
+
+testBoard 0x6000
+testFlash $PORT $FOLDER_TEST/24k.rom
+testCheck "b65flash 24k" 0 $? "verified"
+
+# Board running a console: upgrade first
+testBoard 0x2000
+testFlash $PORT $FOLDER_TEST/8k.rom
+testFlash -u $PORT $FOLDER_TEST/8k.rom
+testCheck "b65flash upgrade" 0 $? "with upgrade"
+
+# Corrupted download: the verify reports the address, the retry downloads again with upgrade
+testBoard 0x2000 -c 1
+testFlash $PORT $FOLDER_TEST/8k.rom
+Result=$?
+testCheck "b65flash verify retry" 0 $Result "verify failed at 0xE100"
+testCheck "b65flash verify retry with upgrade" 0 $Result "rom] to \[.*\] with upgrade"
+
+# Broken read response: frame error, retry
+testBoard 0x6000 -f 10
+testFlash $PORT $FOLDER_TEST/24k.rom
+testCheck "b65flash broken response retry" 0 $? "verify failed (-3)"
+
+# No response to the first ping: b65Open retries the ping
+testBoard 0x2000 -p 1
+testFlash $PORT $FOLDER_TEST/8k.rom
+testCheck "b65flash ping retry" 0 $? "verified"
+
+# Retries exhausted
+testBoard 0x2000 -c 1
+testFlash -r 0 $PORT $FOLDER_TEST/8k.rom
+testCheck "b65flash no retry" 1 $? "verify failed at 0xE100"
+
+# Image size
+testBoard 0x2000
+testFlash $PORT $FOLDER_TEST/bad.rom
+testCheck "b65flash image size" 1 $? "a ROM image is"
+
+# No verification
+testBoard 0x2000
+testFlash -n $PORT $FOLDER_TEST/8k.rom
+testCheck "b65flash no verification" 0 $? "sent  8192 / 8192"
+
+# b65cmd sim: and decode (b65OpenCapture) with the fake board as testbench
+testRoundTrip b65board
+
+testCleanup
+
+if [ $FAILED -ne 0 ]; then
+	echo "ERROR : $FAILED checks failed, fake board log:"
+	cat $FOLDER_TEST/board.log
+fi
+
+exit $FAILED
\ No newline at end of file
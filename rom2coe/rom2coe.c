@@ -15,33 +15,277 @@
 //     You should have received a copy of the GNU General Public License
 //     along with B65.  If not, see <http://www.gnu.org/licenses/>.
 
+#include <ctype.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-// ROM to COE file converter
+// Output formats
+#define FORMAT_COE		0		// Xilinx .coe (memory_initialization_vector)
+#define FORMAT_VHD		1		// VHDL package with the ROM_INIT constant (<name>_rom.vhd)
+#define FORMAT_MEM		2		// $readmemh .mem
+#define FORMAT_HEX		3		// Intel HEX (byte addresses from 0), last: the only byte stream format
+#define FORMATS			4
+
+// Words per line (coe, vhd, mem) and bytes per Intel HEX record
+#define LINE_WORDS		16
+#define HEX_RECORD		16
+
+static const char *g_FormatName[FORMATS]	= { "coe", "vhd", "mem", "hex" };
+static const char *g_FormatSuffix[FORMATS]	= { ".coe", "_rom.vhd", ".mem", ".hex" };
+
+typedef struct _OUTPUT_
+{
+	FILE			*file;
+	char			filename[512];
+	unsigned long	words;							// Words written
+	unsigned char	record[HEX_RECORD];				// Intel HEX record not written yet
+	size_t			recordLength;
+	unsigned long	address;						// Intel HEX next record address
+
+} OUTPUT;
+
+///////////////////////////////////////////////////////////
+///
+/// Print the usage
+///
+///////////////////////////////////////////////////////////
+static void Usage(void)
+{
+	printf("Usage : \n");
+	printf("rom2coe <input bin file> [data width] [format ...]\n");
+	printf(" Optional data width can be 8 (default), 16 or 32 bit (little endian words)\n");
+	printf(" Optional formats (default coe), the output is the input name with the format extension:\n");
+	printf("  coe    Xilinx memory initialization file\n");
+	printf("  vhd    VHDL package <name>_rom with the ROM_INIT constant array (<name>_rom.vhd)\n");
+	printf("  mem    $readmemh file, one word per line\n");
+	printf("  hex    Intel HEX, the image bytes from address 0 (the data width is ignored, no padding)\n");
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Write one Intel HEX record
+///
+///////////////////////////////////////////////////////////
+static void HexRecord(FILE *File, unsigned char Type, unsigned short Address, const unsigned char *Data, size_t Length)
+{
+	unsigned char	Sum;
+	size_t			Index;
+
+	Sum = Length + (Address >> 8) + (Address & 0xFF) + Type;
+	fprintf(File, ":%.2X%.4X%.2X", (unsigned int) Length, Address, Type);
+
+	for (Index = 0; Index < Length; Index++)
+	{
+		fprintf(File, "%.2X", Data[Index]);
+		Sum += Data[Index];
+	}
+
+	fprintf(File, "%.2X\n", (unsigned char) (0 - Sum));
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Write the Intel HEX pending record (with the extended
+/// linear address record at every 64K boundary)
+///
+///////////////////////////////////////////////////////////
+static void HexFlush(OUTPUT *Output)
+{
+	unsigned char Upper[2];
+
+	if (Output->recordLength == 0)
+		return;
+
+	if ((Output->address > 0xFFFF) && ((Output->address & 0xFFFF) == 0))
+	{
+		Upper[0] = Output->address >> 24;
+		Upper[1] = Output->address >> 16;
+		HexRecord(Output->file, 0x04, 0, Upper, 2);
+	}
+
+	HexRecord(Output->file, 0x00, Output->address & 0xFFFF, Output->record, Output->recordLength);
+
+	Output->address		 += Output->recordLength;
+	Output->recordLength  = 0;
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Add one image byte to the Intel HEX output (the image
+/// bytes only: no word padding, see OutputWord)
+///
+///////////////////////////////////////////////////////////
+static void HexByte(OUTPUT *Output, unsigned char Byte)
+{
+	Output->record[Output->recordLength++] = Byte;
+	if (Output->recordLength == HEX_RECORD)
+		HexFlush(Output);
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Open an output and write its header
+///
+///	\return	0 if ok, otherwise 1 (an error is printed)
+///
+///////////////////////////////////////////////////////////
+static int OutputOpen(OUTPUT *Output, int Format, const char *Base, const char *Name, int DataWidth)
+{
+	memset(Output, 0, sizeof(OUTPUT));
+
+	snprintf(Output->filename, sizeof(Output->filename), "%s%s", Base, g_FormatSuffix[Format]);
+
+	Output->file = fopen(Output->filename, "w");
+	if (Output->file == NULL)
+	{
+		printf("Error: unable to create [%s]\n", Output->filename);
+		return 1;
+	}
+
+	switch (Format)
+	{
+		case FORMAT_COE:
+			fprintf(Output->file, "memory_initialization_radix=16;\n");
+			fprintf(Output->file, "memory_initialization_vector=\n");
+		break;
+
+		case FORMAT_VHD:
+			fprintf(Output->file, "-- Generated by rom2coe, do not edit\n");
+			fprintf(Output->file, "\n");
+			fprintf(Output->file, "library ieee;\n");
+			fprintf(Output->file, "use ieee.std_logic_1164.all;\n");
+			fprintf(Output->file, "\n");
+			fprintf(Output->file, "package %s_rom is\n", Name);
+			fprintf(Output->file, "\n");
+			fprintf(Output->file, "\ttype ROM_DATA is array(natural range <>) of std_logic_vector(%d downto 0);\n", DataWidth - 1);
+			fprintf(Output->file, "\n");
+			fprintf(Output->file, "\t-- ROM content from address 0 (ROM_INIT'length words)\n");
+			fprintf(Output->file, "\tconstant ROM_INIT : ROM_DATA := (");
+		break;
+	}
+
+	return 0;
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Write one word (Bytes are the word bytes, little endian)
+///
+/// The Intel HEX output takes the bytes from the input
+/// stream instead (see HexByte)
+///
+///////////////////////////////////////////////////////////
+static void OutputWord(OUTPUT *Output, int Format, int DataWidth, const unsigned char *Bytes)
+{
+	unsigned long	Value	= 0;
+	int				Digits	= DataWidth / 4;
+	int				Index;
+
+	for (Index = DataWidth / 8 - 1; Index >= 0; Index--)
+		Value = (Value << 8) | Bytes[Index];
+
+	switch (Format)
+	{
+		// Words separated by ", " in the line, no separator at the end of line
+		case FORMAT_COE:
+			fprintf(Output->file, "%s%.*lX", ((Output->words % LINE_WORDS) == 0) ? ((Output->words > 0) ? "\n" : "") : ", ", Digits, Value);
+		break;
+
+		case FORMAT_VHD:
+			fprintf(Output->file, "%s%sx\"%.*lX\"", (Output->words > 0) ? "," : "", ((Output->words % LINE_WORDS) == 0) ? "\n\t\t" : " ", Digits, Value);
+		break;
+
+		case FORMAT_MEM:
+			fprintf(Output->file, "%.*lX\n", Digits, Value);
+		break;
+	}
+
+	Output->words++;
+}
+
+///////////////////////////////////////////////////////////
+///
+/// Write the output trailer and close it
+///
+///	\return	0 if ok, otherwise 1 (an error is printed)
+///
+///////////////////////////////////////////////////////////
+static int OutputClose(OUTPUT *Output, int Format)
+{
+	int Error = 0;
+
+	switch (Format)
+	{
+		case FORMAT_COE:
+		case FORMAT_MEM:
+			if (Output->words > 0)
+				fprintf(Output->file, "\n");
+		break;
+
+		case FORMAT_VHD:
+			// A positional aggregate needs two elements at least
+			if (Output->words < 2)
+			{
+				printf("Error: [%s] needs two words at least\n", Output->filename);
+				Error = 1;
+			}
+
+			fprintf(Output->file, "\n\t);\n");
+			fprintf(Output->file, "\n");
+			fprintf(Output->file, "end package;\n");
+		break;
+
+		case FORMAT_HEX:
+			HexFlush(Output);
+			HexRecord(Output->file, 0x01, 0, NULL, 0);
+		break;
+	}
+
+	if (ferror(Output->file))
+		Error = 1;
+
+	if ((fclose(Output->file) != 0) || Error)
+	{
+		if (Error == 0)
+			printf("Error: unable to write [%s]\n", Output->filename);
+
+		remove(Output->filename);
+		return 1;
+	}
+
+	return 0;
+}
+
+// ROM to COE (and VHDL package, readmemh, Intel HEX) file converter
 int main(int argc, char **argv)
 {
-	int		DataWidth	= 8;
-	int		LineIndex	= 0;
-	int		LineChar	= 0;
-	size_t	Index		= 0;
-	size_t	Length;
-	size_t	FileSize;
-	char	CoeFilename[255];
-	char	*InBuffer;
-	char	OutLine[1024];
-	FILE	*File;
+	OUTPUT			Output[FORMATS];
+	int				Selected[FORMATS]	= { 0 };
+	int				DataWidth			= 8;
+	int				Format;
+	int				Arg;
+	int				Error				= 0;
+	size_t			Count;
+	size_t			Index;
+	size_t			WordBytes;
+	size_t			Length;
+	char			Base[480];
+	char			Name[sizeof(Base) + 4];			// base name with the "rom_" prefix
+	char		   *Dot;
+	const char	   *Slash;
+	unsigned char	Buffer[4096];
+	unsigned char	Word[4];
+	FILE		   *File;
 
 	if (argc < 2)
 	{
-		printf("Usage : \n");
-		printf("rom2coe <input bin file> [data width]\n");
-		printf(" Optional data width can be 8 (default), 16 or 32 bit\n");
+		Usage();
 		return 0;
 	}
-	
-	if (argc > 2)
+
+	Arg = 2;
+	if ((argc > 2) && isdigit((unsigned char) argv[2][0]))
 	{
 		DataWidth = strtol(argv[2], NULL, 0);
 		if ((DataWidth != 8) && (DataWidth != 16) && (DataWidth != 32))
@@ -49,81 +293,126 @@ int main(int argc, char **argv)
 			printf("Error: unsupported data width [%d], only 8,16 or 32 supported\n", DataWidth);
 			return 1;
 		}
+
+		Arg++;
 	}
 
-	File = fopen(argv[1], "r");
-	if (File == NULL)
+	for (; Arg < argc; Arg++)
 	{
-		printf("Error: unable to open [%s]\n", argv[1]);
-		return 2;
+		for (Format = 0; (Format < FORMATS) && (strcmp(argv[Arg], g_FormatName[Format]) != 0); Format++);
+
+		if (Format == FORMATS)
+		{
+			printf("Error: unsupported format [%s], only coe, vhd, mem or hex supported\n", argv[Arg]);
+			return 1;
+		}
+
+		Selected[Format] = 1;
 	}
-	
-	// Get file size
-	fseek(File, 0, SEEK_END);
-	FileSize = ftell(File);
-	fseek(File, 0, 0);
-	
-	// Allocate buffer
-	InBuffer = malloc(FileSize);
-	if (InBuffer == NULL)
+
+	// Default output (the Xilinx ROM initialization)
+	if (!Selected[FORMAT_VHD] && !Selected[FORMAT_MEM] && !Selected[FORMAT_HEX])
+		Selected[FORMAT_COE] = 1;
+
+	// Output base: the input name without extension
+	if (strlen(argv[1]) >= sizeof(Base))
 	{
-		printf("Error: unable to allocate [%d] bytes\n", (int) FileSize);
-		fclose(File);
-		return 3;
+		printf("Error: input name too long [%s]\n", argv[1]);
+		return 1;
 	}
 
-	// Load file	
-	fread(InBuffer, FileSize, 1, File);
-	fclose(File);
-	
-	// Remove 3 chars bin extension and append coe extension
-	strncpy(CoeFilename, argv[1], 255);
-	Length = strlen(CoeFilename);
-	CoeFilename[Length-3] = '\0';
-	strcat(CoeFilename, "coe");
-
-	// Open output file
-	File = fopen(CoeFilename, "w+");
+	strcpy(Base, argv[1]);
+	Slash	= strrchr(Base, '/');
+	Slash	= (Slash == NULL) ? Base : Slash + 1;
+	Dot		= strrchr(Slash, '.');
+	if (Dot != NULL)
+		*Dot = '\0';
+
+	// VHDL package name: the base name as identifier
+	snprintf(Name, sizeof(Name), "%s%s", isalpha((unsigned char) Slash[0]) ? "" : "rom_", Slash);
+	for (Index = 0; Name[Index] != '\0'; Index++)
+		if (!isalnum((unsigned char) Name[Index]))
+			Name[Index] = '_';
+
+	File = fopen(argv[1], "rb");
 	if (File == NULL)
 	{
-		printf("Error: unable to create [%s]\n", CoeFilename);
-		free(InBuffer);
-		return 4;
+		printf("Error: unable to open [%s]\n", argv[1]);
+		return 2;
 	}
 
-	// printf("Converting [%d] bytes ROM file [%s] to [%d] bit width COE [%s]\n", (int) FileSize, argv[1], DataWidth, CoeFilename);
-	
-	fprintf(File, "memory_initialization_radix=16;\n");
-	fprintf(File, "memory_initialization_vector=\n");
-
-	while (Index < FileSize)
+	for (Format = 0; Format < FORMATS; Format++)
 	{
-		switch (DataWidth)
+		if (Selected[Format] && OutputOpen(&Output[Format], Format, Base, Name, DataWidth))
 		{
-			case  8: LineIndex += sprintf(&OutLine[LineIndex], "%.2X, ",             InBuffer[Index]  & 0x000000FF); Index += 1; break;
-			case 16: LineIndex += sprintf(&OutLine[LineIndex], "%.4X, ", *((short*) &InBuffer[Index]) & 0x0000FFFF); Index += 2; break;
-			case 32: LineIndex += sprintf(&OutLine[LineIndex], "%.8X, ", *((int  *) &InBuffer[Index]));              Index += 4; break;
+			Selected[Format]	= 0;
+			Error				= 4;
 		}
+	}
 
-		LineChar++;
-		if (LineChar == 16)
+	// Stream the input, a last partial word is padded with zeros (not in the Intel HEX output)
+	WordBytes	= 0;
+	Length		= 0;
+
+	while ((Error == 0) && ((Count = fread(Buffer, 1, sizeof(Buffer), File)) > 0))
+	{
+		for (Index = 0; Index < Count; Index++)
 		{
-			OutLine[LineIndex - 2]  = '\n';
-			OutLine[LineIndex - 1]  = '\0';
-			fputs(OutLine, File);
-			LineChar	= 0;
-			LineIndex	= 0;
+			Word[WordBytes++] = Buffer[Index];
+
+			if (Selected[FORMAT_HEX])
+				HexByte(&Output[FORMAT_HEX], Buffer[Index]);
+
+			if (WordBytes == (size_t) DataWidth / 8)
+			{
+				for (Format = 0; Format < FORMAT_HEX; Format++)
+					if (Selected[Format])
+						OutputWord(&Output[Format], Format, DataWidth, Word);
+
+				WordBytes = 0;
+			}
 		}
+
+		Length += Count;
 	}
 
-	if (LineIndex > 2)
+	if (ferror(File))
 	{
-		OutLine[LineIndex - 2]  = '\n';
-		OutLine[LineIndex - 1]  = '\0';
-		fputs(OutLine, File);
+		printf("Error: unable to read [%s]\n", argv[1]);
+		Error = 3;
 	}
 
 	fclose(File);
-	free(InBuffer);
-	return 0;
+
+	if ((Error == 0) && (WordBytes > 0))
+	{
+		memset(&Word[WordBytes], 0, sizeof(Word) - WordBytes);
+
+		for (Format = 0; Format < FORMAT_HEX; Format++)
+			if (Selected[Format])
+				OutputWord(&Output[Format], Format, DataWidth, Word);
+	}
+
+	if ((Error == 0) && (Length == 0))
+	{
+		printf("Error: empty input [%s]\n", argv[1]);
+		Error = 3;
+	}
+
+	// Close everything, the outputs are removed after an error
+	for (Format = 0; Format < FORMATS; Format++)
+	{
+		if (!Selected[Format])
+			continue;
+
+		if (Error != 0)
+		{
+			fclose(Output[Format].file);
+			remove(Output[Format].filename);
+		}
+		else if (OutputClose(&Output[Format], Format))
+			Error = 4;
+	}
+
+	return Error;
 }
\ No newline at end of file